@@ -0,0 +1,28 @@
+# - Try to find LZ4
+# Once done, this will define
+#
+#  LZ4_FOUND - system has LZ4
+#  LZ4_INCLUDE_DIRS - the LZ4 include directories
+#  LZ4_LIBRARIES - link these to use LZ4
+#
+# LZ4_HOME can be set (as a CMake or environment variable) to the LZ4 install directory
+
+find_path(LZ4_INCLUDE_DIR
+    NAMES lz4.h
+    HINTS ${LZ4_HOME} $ENV{LZ4_HOME}
+    PATH_SUFFIXES include)
+
+find_library(LZ4_LIBRARY
+    NAMES lz4 liblz4
+    HINTS ${LZ4_HOME} $ENV{LZ4_HOME}
+    PATH_SUFFIXES lib)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(LZ4 DEFAULT_MSG LZ4_LIBRARY LZ4_INCLUDE_DIR)
+
+if(LZ4_FOUND)
+    set(LZ4_INCLUDE_DIRS ${LZ4_INCLUDE_DIR})
+    set(LZ4_LIBRARIES ${LZ4_LIBRARY})
+endif()
+
+mark_as_advanced(LZ4_INCLUDE_DIR LZ4_LIBRARY)
@@ -30,12 +30,14 @@
 #include "render/ODFrameListener.h"
 #include "render/TextRenderer.h"
 #include "utils/ConfigManager.h"
+#include "utils/Helper.h"
 #include "utils/LogManager.h"
 #include "utils/LogSinkConsole.h"
 #include "utils/LogSinkFile.h"
 #include "utils/LogSinkOgre.h"
 #include "utils/Random.h"
 #include "utils/ResourceManager.h"
+#include "utils/TraceRecorder.h"
 
 #include <OgreErrorDialog.h>
 #include <OgreRenderWindow.h>
@@ -59,6 +61,13 @@ void ODApplication::startGame(boost::program_options::variables_map& options)
     logMgr.addSink(std::unique_ptr<LogSink>(new LogSinkConsole()));
     logMgr.addSink(std::unique_ptr<LogSink>(new LogSinkFile(resMgr.getLogFile())));
 
+    std::unique_ptr<TraceRecorder> traceRecorder;
+    if(!resMgr.getTraceFile().empty())
+    {
+        OD_LOG_INF("Recording trace in " + resMgr.getTraceFile());
+        traceRecorder.reset(new TraceRecorder(resMgr.getTraceFile()));
+    }
+
     if(resMgr.isServerMode())
         startServer();
     else
@@ -71,7 +80,11 @@ void ODApplication::startServer()
 
     OD_LOG_INF("Initializing");
 
-    Random::initialize();
+    if(resMgr.hasRandomSeed())
+        Random::initialize(resMgr.getRandomSeed());
+    else
+        Random::initialize();
+    OD_LOG_INF("Game seed=" + Helper::toString(Random::getSeed()));
     ConfigManager configManager(resMgr.getConfigPath(), "", resMgr.getSoundPath());
     OD_LOG_INF("Launching server");
 
@@ -105,7 +118,11 @@ void ODApplication::startClient()
         //the application segfaults on exit for some reason.
         sf::Music m;
     }
-    Random::initialize();
+    if(resMgr.hasRandomSeed())
+        Random::initialize(resMgr.getRandomSeed());
+    else
+        Random::initialize();
+    OD_LOG_INF("Game seed=" + Helper::toString(Random::getSeed()));
     //NOTE: The order of initialisation of the different "manager" classes is important,
     //as many of them depend on each other.
     OD_LOG_INF("Creating OGRE::Root instance; Plugins path: " + resMgr.getPluginsPath());
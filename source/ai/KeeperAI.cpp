@@ -79,6 +79,11 @@ bool KeeperAI::doTurn(double timeSinceLastTurn)
     if(getDungeonTemple() == nullptr)
         return false;
 
+    if(!mRandomStream.isSeeded())
+        mRandomStream.seed(Random::getStreamSeed(RandomStreamType::keeperAI, static_cast<uint64_t>(mPlayer.getSeat()->getId())));
+
+    RandomStream::Scope randomScope(mRandomStream);
+
     if(!mIsFirstUpkeepDone)
     {
         mIsFirstUpkeepDone = true;
@@ -124,16 +129,9 @@ bool KeeperAI::checkTreasury()
     }
     mCooldownCheckTreasury = Random::Int(10,30);
 
-    int totalGold = 0;
-    int totalStorage = 0;
-    for(Room* room : mGameMap.getRooms())
-    {
-        if(room->getSeat() != mPlayer.getSeat())
-            continue;
-
-        totalGold += room->getTotalGoldStored();
-        totalStorage += room->getTotalGoldStorage();
-    }
+    const SeatStats& stats = mPlayer.getSeat()->getStats();
+    int totalGold = stats.getGoldStored();
+    int totalStorage = stats.getGoldStorage();
 
     // We want at least to be allowed to store 3000 gold
     if(totalStorage >= 3000)
@@ -369,14 +367,8 @@ bool KeeperAI::lookForGold()
     mCooldownLookingForGold = Random::Int(70,120);
 
     // Do we need gold ?
-    int emptyStorage = 0;
-    for(Room* room : mGameMap.getRooms())
-    {
-        if(room->getSeat() != mPlayer.getSeat())
-            continue;
-
-        emptyStorage += (room->getTotalGoldStorage() - room->getTotalGoldStored());
-    }
+    const SeatStats& stats = mPlayer.getSeat()->getStats();
+    int emptyStorage = stats.getGoldStorage() - stats.getGoldStored();
 
     // No need to search for gold
     if(emptyStorage < 100)
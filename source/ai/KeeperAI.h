@@ -19,6 +19,7 @@
 #define KEEPERAI_H
 
 #include "ai/BaseAI.h"
+#include "utils/RandomStream.h"
 
 enum class RoomType;
 
@@ -102,6 +103,8 @@ private:
     int mCooldownSaveWoundedCreaturesMin;
     int mCooldownSaveWoundedCreaturesMax;
     bool mIsFirstUpkeepDone;
+    //! \brief Random stream used by the AI. Seeded from the game seed and the seat id
+    RandomStream mRandomStream;
 };
 
 #endif // KEEPERAI_H
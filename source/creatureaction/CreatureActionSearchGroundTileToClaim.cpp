@@ -27,6 +27,7 @@
 #include "utils/Helper.h"
 #include "utils/LogManager.h"
 #include "utils/MakeUnique.h"
+#include "utils/RandomStream.h"
 
 CreatureActionSearchGroundTileToClaim::CreatureActionSearchGroundTileToClaim(Creature& creature, bool forced) :
     CreatureAction(creature),
@@ -96,8 +97,9 @@ bool CreatureActionSearchGroundTileToClaim::handleSearchGroundTileToClaim(Creatu
     // The tile we are standing on is already claimed or is not currently
     // claimable, find candidates for claiming.
     // Start by checking the neighbor tiles of the one we are already in
-    std::vector<Tile*> neighbors = myTile->getAllNeighbors();
-    std::random_shuffle(neighbors.begin(), neighbors.end());
+    TileNeighbors myNeighbors = myTile->getAllNeighbors();
+    std::vector<Tile*> neighbors(myNeighbors.begin(), myNeighbors.end());
+    std::shuffle(neighbors.begin(), neighbors.end(), RandomStream::getCurrent());
     for(Tile* tile : neighbors)
     {
         // If the current neighbor is claimable, walk into it and skip to the end of this turn
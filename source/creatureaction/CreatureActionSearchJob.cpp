@@ -32,6 +32,7 @@
 #include "utils/LogManager.h"
 #include "utils/MakeUnique.h"
 #include "utils/Random.h"
+#include "utils/RandomStream.h"
 
 std::function<bool()> CreatureActionSearchJob::action()
 {
@@ -156,7 +157,7 @@ bool CreatureActionSearchJob::handleSearchJob(Creature& creature, bool forced)
         // of the good type
         std::vector<Room*> rooms = creature.getGameMap()->getRoomsByTypeAndSeat(affinity.getRoomType(), creature.getSeat());
         rooms = creature.getGameMap()->getReachableRooms(rooms, myTile, &creature);
-        std::random_shuffle(rooms.begin(), rooms.end());
+        std::shuffle(rooms.begin(), rooms.end(), RandomStream::getCurrent());
         for(Room* room : rooms)
         {
             // If efficiency is 0, we just want to wander so no need to check if the room
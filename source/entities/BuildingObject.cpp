@@ -161,14 +161,11 @@ void BuildingObject::fireRefresh()
         if(!seat->getPlayer()->getIsHuman())
             continue;
 
-        const std::string& name = getName();
         ServerNotification *serverNotification = new ServerNotification(
             ServerNotificationType::entitiesRefresh, seat->getPlayer());
         uint32_t nb = 1;
-        GameEntityType entityType = getObjectType();
         serverNotification->mPacket << nb;
-        serverNotification->mPacket << entityType;
-        serverNotification->mPacket << name;
+        serverNotification->mPacket << getId();
         exportToPacketForUpdate(serverNotification->mPacket, seat);
         ODServer::getSingleton().queueServerNotification(serverNotification);
     }
@@ -72,6 +72,7 @@
 #include "utils/LogManager.h"
 #include "utils/MakeUnique.h"
 #include "utils/Random.h"
+#include "utils/TraceRecorder.h"
 
 #include <CEGUI/Event.h>
 #include <CEGUI/System.h>
@@ -117,6 +118,20 @@ enum CreatureMoodEnum
     MoodPrisonFiltersPrisonAllies = KoTemp | InJail
 };
 
+//! Fields of a creature update. Only the fields that changed since the last update sent to a seat are exported
+enum CreatureUpdateField
+{
+    UpdateLevel = 0x0001,
+    UpdateSeatId = 0x0002,
+    UpdateOverlayHealth = 0x0004,
+    UpdateMood = 0x0008,
+    UpdateGroundSpeed = 0x0010,
+    UpdateWaterSpeed = 0x0020,
+    UpdateLavaSpeed = 0x0040,
+    UpdateSpeedModifier = 0x0080,
+    UpdateSeatPrisonId = 0x0100
+};
+
 CreatureParticuleEffect::CreatureParticuleEffect(Creature& creature, const std::string& name, const std::string& script, uint32_t nbTurnsEffect,
         CreatureEffect* effect) :
     EntityParticleEffect(name, script, nbTurnsEffect),
@@ -188,7 +203,11 @@ Creature::Creature(GameMap* gameMap, const CreatureDefinition* definition, Seat*
     mSeatPrison              (nullptr),
     mNbTurnsTorture          (0),
     mNbTurnsPrison           (0),
-    mActiveSlapsCount        (0)
+    mActiveSlapsCount        (0),
+    mVisionPositionTile      (nullptr),
+    mVisionEpoch             (0),
+    mIsVisionChanged         (false),
+    mIsUpkeepSensed          (false)
 
 {
     //TODO: This should be set in initialiser list in parent classes
@@ -266,7 +285,11 @@ Creature::Creature(GameMap* gameMap) :
     mSeatPrison              (nullptr),
     mNbTurnsTorture          (0),
     mNbTurnsPrison           (0),
-    mActiveSlapsCount        (0)
+    mActiveSlapsCount        (0),
+    mVisionPositionTile      (nullptr),
+    mVisionEpoch             (0),
+    mIsVisionChanged         (false),
+    mIsUpkeepSensed          (false)
 {
 }
 
@@ -718,10 +741,69 @@ void Creature::computeVisibleTiles()
     if (!getIsOnMap())
         return;
 
-    // Look at the surrounding area
+    Tile* posTile = getPositionTile();
+    if (posTile == nullptr)
+        return;
+
+    // The tiles in sight are usually already up to date because they are computed by senseUpkeep
+    refreshTilesInSight();
+    if(mIsVisionChanged)
+    {
+        mIsVisionChanged = false;
+        getGameMap()->updateVisionSource(this, getSeat(), mVisibleTiles, false);
+        return;
+    }
+
+    if(!getGameMap()->keepVisionSource(this, getSeat()))
+        getGameMap()->updateVisionSource(this, getSeat(), mVisibleTiles, false);
+}
+
+void Creature::refreshTilesInSight()
+{
+    // Line of sight only changes if the creature moved or if a tile changed
+    Tile* posTile = getPositionTile();
+    uint32_t epoch = getGameMap()->getPassabilityEpoch();
+    if((posTile == mVisionPositionTile) && (epoch == mVisionEpoch))
+        return;
+
     updateTilesInSight();
-    for(Tile* tile : mVisibleTiles)
-        tile->notifyVision(getSeat());
+    mVisionPositionTile = posTile;
+    mVisionEpoch = epoch;
+    mIsVisionChanged = true;
+}
+
+void Creature::senseUpkeep()
+{
+    mIsUpkeepSensed = false;
+
+    // Only the creatures that will act during the upkeep need to sense (see doUpkeep)
+    if(!getIsOnMap() || !isAlive() || isKo() || (mSeatPrison != nullptr))
+        return;
+
+    if(getPositionTile() == nullptr)
+        return;
+
+    refreshTilesInSight();
+
+    mVisibleEnemyObjects         = getVisibleEnemyObjects();
+    mVisibleAlliedObjects        = getVisibleAlliedObjects();
+    mReachableAlliedObjects      = getReachableAttackableObjects(mVisibleAlliedObjects);
+    mIsUpkeepSensed = true;
+}
+
+void Creature::removeStaleSensedObjects()
+{
+    auto isStale = [](GameEntity* entity)
+    {
+        return !entity->getIsOnMap() || (entity->getHP(nullptr) <= 0);
+    };
+
+    mVisibleEnemyObjects.erase(std::remove_if(mVisibleEnemyObjects.begin(),
+        mVisibleEnemyObjects.end(), isStale), mVisibleEnemyObjects.end());
+    mVisibleAlliedObjects.erase(std::remove_if(mVisibleAlliedObjects.begin(),
+        mVisibleAlliedObjects.end(), isStale), mVisibleAlliedObjects.end());
+    mReachableAlliedObjects.erase(std::remove_if(mReachableAlliedObjects.begin(),
+        mReachableAlliedObjects.end(), isStale), mReachableAlliedObjects.end());
 }
 
 void Creature::setLevel(unsigned int level)
@@ -777,6 +859,11 @@ void Creature::dropCarriedEquipment()
 
 void Creature::doUpkeep()
 {
+    if(!mRandomStream.isSeeded())
+        mRandomStream.seed(Random::getStreamSeed(RandomStreamType::creature, getId()));
+
+    RandomStream::Scope randomScope(mRandomStream);
+
     // If the creature is in jail, we check if it is still standing on it (if not picked up). If
     // not, it is free
     if((mSeatPrison != nullptr) &&
@@ -922,9 +1009,19 @@ void Creature::doUpkeep()
         increaseHunger(mDefinition->getHungerGrowthPerTurn());
     }
 
-    mVisibleEnemyObjects         = getVisibleEnemyObjects();
-    mVisibleAlliedObjects        = getVisibleAlliedObjects();
-    mReachableAlliedObjects      = getReachableAttackableObjects(mVisibleAlliedObjects);
+    // The visible objects are usually sensed before the upkeep. In this case, the creatures
+    // processed before this one may have killed or moved some of them
+    if(mIsUpkeepSensed)
+    {
+        mIsUpkeepSensed = false;
+        removeStaleSensedObjects();
+    }
+    else
+    {
+        mVisibleEnemyObjects         = getVisibleEnemyObjects();
+        mVisibleAlliedObjects        = getVisibleAlliedObjects();
+        mReachableAlliedObjects      = getReachableAttackableObjects(mVisibleAlliedObjects);
+    }
 
     // Check if we should compute mood
     if(mMoodCooldownTurns > 0)
@@ -1577,14 +1674,11 @@ void Creature::checkLevelUp()
     setLevel(mLevel + 1);
 }
 
-void Creature::exportToPacketForUpdate(ODPacket& os, const Seat* seat) const
+void Creature::exportToPacketForUpdate(ODPacket& os, Seat* seat) const
 {
     MovableGameEntity::exportToPacketForUpdate(os, seat);
 
     int seatId = getSeat()->getId();
-    os << mLevel;
-    os << seatId;
-    os << mOverlayHealthValue;
 
     // Only allied players should see creature mood (except some states)
     uint32_t moodValue = 0;
@@ -1598,32 +1692,90 @@ void Creature::exportToPacketForUpdate(ODPacket& os, const Seat* seat) const
             moodValue = mOverlayMoodValue & CreatureMoodEnum::MoodPrisonFiltersAllPlayers;
     }
 
-    os << moodValue;
-    os << mGroundSpeed;
-    os << mWaterSpeed;
-    os << mLavaSpeed;
-    os << mSpeedModifier;
-
     int seatPrisonId = -1;
     if(mSeatPrison != nullptr)
         seatPrisonId = mSeatPrison->getId();
 
-    os << seatPrisonId;
+    // We only send the fields that changed since the last update sent to this seat
+    CreatureStateNotified& state = seat->getCreatureStateNotified(getId());
+    bool exportAll = !state.mIsExported;
+    uint16_t fields = 0;
+    if(exportAll || (state.mLevel != mLevel))
+        fields |= CreatureUpdateField::UpdateLevel;
+    if(exportAll || (state.mSeatId != seatId))
+        fields |= CreatureUpdateField::UpdateSeatId;
+    if(exportAll || (state.mOverlayHealthValue != mOverlayHealthValue))
+        fields |= CreatureUpdateField::UpdateOverlayHealth;
+    if(exportAll || (state.mMoodValue != moodValue))
+        fields |= CreatureUpdateField::UpdateMood;
+    if(exportAll || (state.mGroundSpeed != mGroundSpeed))
+        fields |= CreatureUpdateField::UpdateGroundSpeed;
+    if(exportAll || (state.mWaterSpeed != mWaterSpeed))
+        fields |= CreatureUpdateField::UpdateWaterSpeed;
+    if(exportAll || (state.mLavaSpeed != mLavaSpeed))
+        fields |= CreatureUpdateField::UpdateLavaSpeed;
+    if(exportAll || (state.mSpeedModifier != mSpeedModifier))
+        fields |= CreatureUpdateField::UpdateSpeedModifier;
+    if(exportAll || (state.mSeatPrisonId != seatPrisonId))
+        fields |= CreatureUpdateField::UpdateSeatPrisonId;
+
+    os << fields;
+    if((fields & CreatureUpdateField::UpdateLevel) != 0)
+        os << mLevel;
+    if((fields & CreatureUpdateField::UpdateSeatId) != 0)
+        os << seatId;
+    if((fields & CreatureUpdateField::UpdateOverlayHealth) != 0)
+        os << mOverlayHealthValue;
+    if((fields & CreatureUpdateField::UpdateMood) != 0)
+        os << moodValue;
+    if((fields & CreatureUpdateField::UpdateGroundSpeed) != 0)
+        os << mGroundSpeed;
+    if((fields & CreatureUpdateField::UpdateWaterSpeed) != 0)
+        os << mWaterSpeed;
+    if((fields & CreatureUpdateField::UpdateLavaSpeed) != 0)
+        os << mLavaSpeed;
+    if((fields & CreatureUpdateField::UpdateSpeedModifier) != 0)
+        os << mSpeedModifier;
+    if((fields & CreatureUpdateField::UpdateSeatPrisonId) != 0)
+        os << seatPrisonId;
+
+    state.mIsExported = true;
+    state.mLevel = mLevel;
+    state.mSeatId = seatId;
+    state.mOverlayHealthValue = mOverlayHealthValue;
+    state.mMoodValue = moodValue;
+    state.mGroundSpeed = mGroundSpeed;
+    state.mWaterSpeed = mWaterSpeed;
+    state.mLavaSpeed = mLavaSpeed;
+    state.mSpeedModifier = mSpeedModifier;
+    state.mSeatPrisonId = seatPrisonId;
 }
 
 void Creature::updateFromPacket(ODPacket& is)
 {
     MovableGameEntity::updateFromPacket(is);
 
-    int seatId;
-    OD_ASSERT_TRUE(is >> mLevel);
-    OD_ASSERT_TRUE(is >> seatId);
-    OD_ASSERT_TRUE(is >> mOverlayHealthValue);
-    OD_ASSERT_TRUE(is >> mOverlayMoodValue);
-    OD_ASSERT_TRUE(is >> mGroundSpeed);
-    OD_ASSERT_TRUE(is >> mWaterSpeed);
-    OD_ASSERT_TRUE(is >> mLavaSpeed);
-    OD_ASSERT_TRUE(is >> mSpeedModifier);
+    // This function should read parameters as sent by Creature::exportToPacketForUpdate
+    uint16_t fields;
+    OD_ASSERT_TRUE(is >> fields);
+
+    int seatId = getSeat()->getId();
+    if((fields & CreatureUpdateField::UpdateLevel) != 0)
+        OD_ASSERT_TRUE(is >> mLevel);
+    if((fields & CreatureUpdateField::UpdateSeatId) != 0)
+        OD_ASSERT_TRUE(is >> seatId);
+    if((fields & CreatureUpdateField::UpdateOverlayHealth) != 0)
+        OD_ASSERT_TRUE(is >> mOverlayHealthValue);
+    if((fields & CreatureUpdateField::UpdateMood) != 0)
+        OD_ASSERT_TRUE(is >> mOverlayMoodValue);
+    if((fields & CreatureUpdateField::UpdateGroundSpeed) != 0)
+        OD_ASSERT_TRUE(is >> mGroundSpeed);
+    if((fields & CreatureUpdateField::UpdateWaterSpeed) != 0)
+        OD_ASSERT_TRUE(is >> mWaterSpeed);
+    if((fields & CreatureUpdateField::UpdateLavaSpeed) != 0)
+        OD_ASSERT_TRUE(is >> mLavaSpeed);
+    if((fields & CreatureUpdateField::UpdateSpeedModifier) != 0)
+        OD_ASSERT_TRUE(is >> mSpeedModifier);
 
     // We do not scale the creature if it is picked up (because it is already not at its normal size). It will be
     // resized anyway when dropped
@@ -1644,6 +1796,9 @@ void Creature::updateFromPacket(ODPacket& is)
         }
     }
 
+    if((fields & CreatureUpdateField::UpdateSeatPrisonId) == 0)
+        return;
+
     OD_ASSERT_TRUE(is >> seatId);
     if(seatId == -1)
         mSeatPrison = nullptr;
@@ -1663,11 +1818,9 @@ void Creature::updateTilesInSight()
     if (posTile == nullptr)
         return;
 
-    // The tiles with sight radius without constraints
-    mTilesWithinSightRadius = getGameMap()->circularRegion(posTile->getX(), posTile->getY(), mDefinition->getSightRadius());
-
-    // Only the tiles the creature can "see".
-    mVisibleTiles = getGameMap()->visibleTiles(posTile->getX(), posTile->getY(), mDefinition->getSightRadius());
+    // The tiles with sight radius without constraints and only the tiles the creature can "see".
+    getGameMap()->tilesInSight(posTile->getX(), posTile->getY(), mDefinition->getSightRadius(),
+        mTilesWithinSightRadius, mVisibleTiles);
 }
 
 std::vector<GameEntity*> Creature::getVisibleEnemyObjects()
@@ -1741,8 +1894,7 @@ void Creature::computeVisualDebugEntities()
     ServerNotification *serverNotification = new ServerNotification(
         ServerNotificationType::refreshCreatureVisDebug, nullptr);
 
-    const std::string& name = getName();
-    serverNotification->mPacket << name;
+    serverNotification->mPacket << getId();
     serverNotification->mPacket << true;
     if(getIsOnMap())
     {
@@ -1804,8 +1956,7 @@ void Creature::stopComputeVisualDebugEntities()
 
     ServerNotification *serverNotification = new ServerNotification(
         ServerNotificationType::refreshCreatureVisDebug, nullptr);
-    const std::string& name = getName();
-    serverNotification->mPacket << name;
+    serverNotification->mPacket << getId();
     serverNotification->mPacket << false;
     ODServer::getSingleton().queueServerNotification(serverNotification);
 }
@@ -1866,8 +2017,7 @@ void Creature::createStatsWindow()
 
     ClientNotification *clientNotification = new ClientNotification(
         ClientNotificationType::askCreatureInfos);
-    std::string name = getName();
-    clientNotification->mPacket << name << true;
+    clientNotification->mPacket << getId() << true;
     ODClient::getSingleton().queueClientNotification(clientNotification);
 
     CEGUI::WindowManager* wmgr = CEGUI::WindowManager::getSingletonPtr();
@@ -1903,8 +2053,7 @@ void Creature::destroyStatsWindow()
     {
         ClientNotification *clientNotification = new ClientNotification(
             ClientNotificationType::askCreatureInfos);
-        std::string name = getName();
-        clientNotification->mPacket << name << false;
+        clientNotification->mPacket << getId() << false;
         ODClient::getSingleton().queueClientNotification(clientNotification);
 
         mStatsWindow->destroy();
@@ -2105,6 +2254,13 @@ void Creature::pushAction(std::unique_ptr<CreatureAction>&& action)
         mActionTry.push_back(actionType);
     }
 
+    TraceRecorder* traceRecorder = TraceRecorder::getSingletonPtr();
+    if(traceRecorder != nullptr)
+    {
+        traceRecorder->recordCreatureAction(true, getId(), static_cast<uint32_t>(actionType),
+            CreatureAction::toString(actionType));
+    }
+
     mActions.emplace_back(std::move(action));
 }
 
@@ -2116,6 +2272,14 @@ void Creature::popAction()
         return;
     }
 
+    TraceRecorder* traceRecorder = TraceRecorder::getSingletonPtr();
+    if(traceRecorder != nullptr)
+    {
+        CreatureActionType actionType = mActions.back()->getType();
+        traceRecorder->recordCreatureAction(false, getId(), static_cast<uint32_t>(actionType),
+            CreatureAction::toString(actionType));
+    }
+
     mActions.pop_back();
 }
 
@@ -2459,8 +2623,7 @@ void Creature::releaseCarriedEntity()
 
         ServerNotification* serverNotification = new ServerNotification(
             ServerNotificationType::releaseCarriedEntity, seat->getPlayer());
-        serverNotification->mPacket << getName() << carriedEntity->getObjectType();
-        serverNotification->mPacket << carriedEntity->getName();
+        serverNotification->mPacket << getId() << carriedEntity->getId();
         serverNotification->mPacket << mPosition;
         ODServer::getSingleton().queueServerNotification(serverNotification);
     }
@@ -2519,6 +2682,9 @@ void Creature::slap()
 
 void Creature::fireAddEntity(Seat* seat, bool async)
 {
+    // The client gets the whole creature so the next update should not rely on what was sent before
+    seat->clearCreatureStateNotified(getId());
+
     if(async)
     {
         ServerNotification serverNotification(
@@ -2546,33 +2712,30 @@ void Creature::fireAddEntity(Seat* seat, bool async)
 
         serverNotification = new ServerNotification(
             ServerNotificationType::carryEntity, seat->getPlayer());
-        serverNotification->mPacket << getName() << mCarriedEntity->getObjectType();
-        serverNotification->mPacket << mCarriedEntity->getName();
+        serverNotification->mPacket << getId() << mCarriedEntity->getId();
         ODServer::getSingleton().queueServerNotification(serverNotification);
     }
 }
 
 void Creature::fireRemoveEntity(Seat* seat)
 {
+    seat->clearCreatureStateNotified(getId());
+
     // If we are carrying an entity, we release it first, then we can remove it and us
     if(mCarriedEntity != nullptr)
     {
         ServerNotification* serverNotification = new ServerNotification(
             ServerNotificationType::releaseCarriedEntity, seat->getPlayer());
-        serverNotification->mPacket << getName() << mCarriedEntity->getObjectType();
-        serverNotification->mPacket << mCarriedEntity->getName();
+        serverNotification->mPacket << getId() << mCarriedEntity->getId();
         serverNotification->mPacket << mPosition;
         ODServer::getSingleton().queueServerNotification(serverNotification);
 
         mCarriedEntity->removeSeatWithVision(seat);
     }
 
-    const std::string& name = getName();
     ServerNotification *serverNotification = new ServerNotification(
         ServerNotificationType::removeEntity, seat->getPlayer());
-    GameEntityType type = getObjectType();
-    serverNotification->mPacket << type;
-    serverNotification->mPacket << name;
+    serverNotification->mPacket << getId();
     ODServer::getSingleton().queueServerNotification(serverNotification);
 }
 
@@ -2589,13 +2752,11 @@ void Creature::fireCreatureRefreshIfNeeded()
         if(!seat->getPlayer()->getIsHuman())
             continue;
 
-        const std::string& name = getName();
         ServerNotification *serverNotification = new ServerNotification(
             ServerNotificationType::entitiesRefresh, seat->getPlayer());
         uint32_t nbCreature = 1;
         serverNotification->mPacket << nbCreature;
-        serverNotification->mPacket << GameEntityType::creature;
-        serverNotification->mPacket << name;
+        serverNotification->mPacket << getId();
         exportToPacketForUpdate(serverNotification->mPacket, seat);
         ODServer::getSingleton().queueServerNotification(serverNotification);
     }
@@ -2764,6 +2925,9 @@ void Creature::setupDefinition(GameMap& gameMap, const CreatureDefinition& defau
 
         computeCreatureOverlayHealthValue();
     }
+
+    // The definition is known now
+    updateSeatStats();
 }
 
 void Creature::fireCreatureSound(CreatureSound sound)
@@ -2891,6 +3055,9 @@ void Creature::computeCreatureOverlayHealthValue()
     {
         mOverlayHealthValue = value;
         mNeedFireRefresh = true;
+        // The creature is dead if and only if the overlay is the last one. Liveness can only
+        // change when the value changes
+        updateSeatStats();
     }
 }
 
@@ -3219,6 +3386,24 @@ bool Creature::needsToEat(bool forced) const
     return true;
 }
 
+void Creature::setSeat(Seat* seat)
+{
+    Seat* oldSeat = getSeat();
+    GameEntity::setSeat(seat);
+    if((oldSeat == nullptr) || (oldSeat == seat))
+        return;
+
+    // Only the creatures added to the gamemap are indexed
+    if(oldSeat->getStats().removeCreature(this) && (seat != nullptr))
+        seat->getStats().addCreature(this, getAliveDefinition());
+}
+
+void Creature::updateSeatStats()
+{
+    if(getSeat() != nullptr)
+        getSeat()->getStats().updateCreature(this, getAliveDefinition());
+}
+
 void Creature::changeSeat(Seat* newSeat)
 {
     OD_LOG_INF("creature=" + getName() + " changes side from seatId=" + Helper::toString(getSeat()->getId()) + " to seatId=" + Helper::toString(newSeat->getId()));
@@ -22,6 +22,7 @@
 #define CREATURE_H
 
 #include "entities/MovableGameEntity.h"
+#include "utils/RandomStream.h"
 
 #include <OgreVector2.h>
 #include <OgreVector3.h>
@@ -124,6 +125,9 @@ public:
     virtual void addToGameMap();
     virtual void removeFromGameMap() override;
 
+    //! \brief Moves the creature to the new seat stats if it is indexed
+    virtual void setSeat(Seat* seat) override;
+
     bool canDisplayStatsWindow(Seat* seat) override
     { return true; }
     void createStatsWindow();
@@ -141,6 +145,11 @@ public:
 
     bool isAlive() const;
 
+    //! \brief Class the creature is counted in by the seat stats (see SeatStats::getNbCreatures): its
+    //! definition if it is alive, nullptr otherwise
+    inline const CreatureDefinition* getAliveDefinition() const
+    { return isAlive() ? mDefinition : nullptr; }
+
     //! \brief Gets the maximum HP the creature can have currently
     inline double getMaxHp() const
     { return mMaxHP; }
@@ -249,6 +258,11 @@ public:
      */
     void doUpkeep();
 
+    //! \brief Computes what the creature perceives for the next upkeep (the tiles in sight and the
+    //! visible/reachable objects) without modifying the map nor the other entities. GameMap calls
+    //! it for every creature in parallel before the (serial) upkeep.
+    void senseUpkeep();
+
     //! \brief Computes the visible tiles and tags them to know which are visible
     void computeVisibleTiles();
 
@@ -552,7 +566,7 @@ public:
 
     virtual void clientUpkeep() override;
 
-    virtual void exportToPacketForUpdate(ODPacket& os, const Seat* seat) const override;
+    virtual void exportToPacketForUpdate(ODPacket& os, Seat* seat) const override;
     virtual void updateFromPacket(ODPacket& is) override;
 
     //! \brief Called when an angry creature wants to attack a natural enemy
@@ -573,8 +587,12 @@ public:
 
     bool isWarmup() const;
 
+    //! \brief Also tells the seat stats if the creature died (or was revived)
     void computeCreatureOverlayHealthValue();
 
+    //! \brief Tells the seat stats the class the creature is counted in (see getAliveDefinition)
+    void updateSeatStats();
+
     //! \brief Search within listObjects the closest attackable one.
     //! If a target is found and can be attacked, returns true and
     //! attackedEntity, attackedTile will be set to the target closest tile and positionTile will
@@ -767,9 +785,25 @@ private:
     //! \brief Counts the number of active slaps affecting the creature
     uint32_t                        mActiveSlapsCount;
 
+    //! \brief Position tile and map passability epoch when mVisibleTiles was computed. Used
+    //! to know if it needs to be computed again
+    Tile*                           mVisionPositionTile;
+    uint32_t                        mVisionEpoch;
+
+    //! \brief true if mVisibleTiles changed since the vision source was last updated
+    bool                            mIsVisionChanged;
+
+    //! \brief true if mVisibleEnemyObjects, mVisibleAlliedObjects and mReachableAlliedObjects
+    //! were computed by senseUpkeep for the coming upkeep
+    bool                            mIsUpkeepSensed;
+
     //! \brief Skills the creature can use
     std::vector<CreatureSkillData> mSkillData;
 
+    //! \brief Random stream used during the creature upkeep. Seeded from the game seed and
+    //! the creature id so that the creature behaviour does not depend on the other creatures
+    RandomStream                    mRandomStream;
+
     //! \brief A sub-function called by doTurn()
     //! This one checks if there is something prioritary to do (like fighting). If it is the case,
     //! it should empty the action list before adding what to do.
@@ -790,6 +824,14 @@ private:
     void computeMood();
 
     void computeCreatureOverlayMoodValue();
+
+    //! \brief Computes mVisibleTiles again if the creature moved or if the map changed since
+    //! it was last computed
+    void refreshTilesInSight();
+
+    //! \brief Removes from the sensed objects the ones other creatures killed or moved away
+    //! since senseUpkeep
+    void removeStaleSensedObjects();
 };
 
 #endif // CREATURE_H
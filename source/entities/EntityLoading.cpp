@@ -138,7 +138,8 @@ GameEntity* getGameEntityFromPacket(GameMap* gameMap, ODPacket& is)
 {
     GameEntity* entity = nullptr;
     GameEntityType type;
-    OD_ASSERT_TRUE(is >> type);
+    uint32_t id;
+    OD_ASSERT_TRUE(is >> type >> id);
     switch(type)
     {
         case GameEntityType::buildingObject:
@@ -220,6 +221,7 @@ GameEntity* getGameEntityFromPacket(GameMap* gameMap, ODPacket& is)
         return nullptr;
     }
 
+    entity->setId(id);
     return entity;
 }
 } //namespace Entities
@@ -86,6 +86,7 @@ GameEntity::GameEntity(
           ) :
     mPosition          (Ogre::Vector3::ZERO),
     mName              (name),
+    mId                (0),
     mMeshName          (meshName),
     mMeshExists        (false),
     mSeat              (seat),
@@ -153,8 +154,7 @@ void GameEntity::removeEntityFromPositionTile()
 void GameEntity::firePickupEntity(Player* playerPicking)
 {
     int seatId = playerPicking->getSeat()->getId();
-    GameEntityType entityType = getObjectType();
-    const std::string& entityName = getName();
+    uint32_t entityId = getId();
     for(std::vector<Seat*>::iterator it = mSeatsWithVisionNotified.begin(); it != mSeatsWithVisionNotified.end();)
     {
         Seat* seat = *it;
@@ -184,14 +184,14 @@ void GameEntity::firePickupEntity(Player* playerPicking)
         {
             ServerNotification serverNotification(
                 ServerNotificationType::entityPickedUp, seat->getPlayer());
-            serverNotification.mPacket << seatId << entityType << entityName;
+            serverNotification.mPacket << seatId << entityId;
             ODServer::getSingleton().sendAsyncMsg(serverNotification);
         }
         else
         {
             ServerNotification* serverNotification = new ServerNotification(
                 ServerNotificationType::entityPickedUp, seat->getPlayer());
-            serverNotification->mPacket << seatId << entityType << entityName;
+            serverNotification->mPacket << seatId << entityId;
             ODServer::getSingleton().queueServerNotification(serverNotification);
         }
     }
@@ -355,7 +355,7 @@ void GameEntity::exportHeadersToStream(std::ostream& os) const
 
 void GameEntity::exportHeadersToPacket(ODPacket& os) const
 {
-    os << getObjectType();
+    os << getObjectType() << mId;
 }
 
 void GameEntity::exportToPacket(ODPacket& os, const Seat* seat) const
@@ -580,7 +580,7 @@ void GameEntity::destroyMesh()
     destroyMeshLocal();
 }
 
-void GameEntity::exportToPacketForUpdate(ODPacket& os, const Seat* seat) const
+void GameEntity::exportToPacketForUpdate(ODPacket& os, Seat* seat) const
 {
     uint32_t nbCreatureEffect = mEntityParticleEffects.size();
     os << nbCreatureEffect;
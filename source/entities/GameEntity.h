@@ -161,6 +161,11 @@ class GameEntity
     inline const std::string& getName() const
     { return mName; }
 
+    //! \brief Get the numeric id the server gave to this entity. It is used instead of the name
+    //! to reference the entity in network messages. 0 means no id has been given yet
+    inline uint32_t getId() const
+    { return mId; }
+
     //! \brief Get the mesh name of the object
     inline const std::string& getMeshName() const
     { return mMeshName; }
@@ -189,12 +194,18 @@ class GameEntity
     inline void setName(const std::string& name)
     { mName = name; }
 
+    //! \brief Set the numeric id of the entity. On server side, it is given by the gamemap
+    //! when the entity is added. On client side, it is read from the add entity message
+    inline void setId(uint32_t id)
+    { mId = id; }
+
     //! \brief Set the name of the mesh file
     inline void setMeshName(const std::string& meshName)
     { mMeshName = meshName; }
 
-    //! \brief Sets the seat this object belongs to
-    inline void setSeat(Seat* seat)
+    //! \brief Sets the seat this object belongs to. Entities indexed in the seat stats
+    //! (see SeatStats) override it to move from one seat to the other
+    virtual void setSeat(Seat* seat)
     { mSeat = seat; }
 
     //! \brief Set if the mesh exists
@@ -246,8 +257,9 @@ class GameEntity
     //! \brief Exports the entity so that it can be updated on server side. exportToPacketForUpdate should be
     //! called on server side and the packet should be given to the corresponding entity in updateFromPacket
     //! exportToPacketForUpdate and updateFromPacket works like exportToPacket and importFromPacket but for entities
-    //! that already exist on client side and that we only want to update (for example a creature that levels up)
-    virtual void exportToPacketForUpdate(ODPacket& os, const Seat* seat) const;
+    //! that already exist on client side and that we only want to update (for example a creature that levels up).
+    //! The seat is not const because it keeps the state last exported to its player so that only what changed is sent
+    virtual void exportToPacketForUpdate(ODPacket& os, Seat* seat) const;
     virtual void updateFromPacket(ODPacket& is);
 
     //! \brief Get if the object can be attacked or not
@@ -411,6 +423,9 @@ class GameEntity
     //! brief The name of the entity
     std::string mName;
 
+    //! \brief Numeric id used to reference the entity in network messages
+    uint32_t mId;
+
     //! \brief The name of the mesh
     std::string mMeshName;
 
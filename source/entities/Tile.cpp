@@ -51,14 +51,16 @@ Tile::Tile(GameMap* gameMap, int x, int y, TileType type, double fullness) :
     GameEntity(gameMap, "", "", nullptr),
     mX                  (x),
     mY                  (y),
-    mType               (type),
+    mContainer          (nullptr),
+    mLoadingType        (type),
     mTileVisual         (TileVisual::nullTileVisual),
     mSelected           (false),
-    mFullness           (fullness),
+    mLoadingFullness    (fullness),
     mRefundPriceRoom    (0),
     mRefundPriceTrap    (0),
     mCoveringBuilding   (nullptr),
     mClaimedPercentage  (0.0),
+    mSeatClaimedTile    (nullptr),
     mScale              (Ogre::Vector3::ZERO),
     mIsRoom             (false),
     mIsTrap             (false),
@@ -131,13 +133,13 @@ bool Tile::isWallClaimable(Seat* seat)
     if (getFullness() <= 0.0)
         return false;
 
-    if (mType == TileType::lava || mType == TileType::water || mType == TileType::rock || mType == TileType::gold)
+    if (getType() == TileType::lava || getType() == TileType::water || getType() == TileType::rock || getType() == TileType::gold)
         return false;
 
     // Check whether at least one neighbor is a claimed ground tile of the given seat
     // which is a condition to permit claiming the given wall tile.
     bool foundClaimedGroundTile = false;
-    for (Tile* tile : mNeighbors)
+    for (Tile* tile : getAllNeighbors())
     {
         if (tile->getFullness() > 0.0)
             continue;
@@ -167,7 +169,7 @@ bool Tile::isWallClaimable(Seat* seat)
         return true;
 
     foundClaimedGroundTile = false;
-    for (Tile* tile : mNeighbors)
+    for (Tile* tile : getAllNeighbors())
     {
         if (tile->getFullness() > 0.0)
             continue;
@@ -428,20 +430,9 @@ void Tile::removePlayerMarkingTile(const Player *p)
     mPlayersMarkingTile.erase(it);
 }
 
-void Tile::addNeighbor(Tile *n)
+TileNeighbors Tile::getAllNeighbors() const
 {
-    mNeighbors.push_back(n);
-}
-
-Tile* Tile::getNeighbor(unsigned int index)
-{
-    if(index >= mNeighbors.size())
-    {
-        OD_LOG_ERR("tile=" + displayAsString(this) + ", index=" + Helper::toString(index) + ", size=" + Helper::toString(mNeighbors.size()));
-        return nullptr;
-    }
-
-    return mNeighbors[index];
+    return getGameMap()->neighborTiles(mX, mY);
 }
 
 std::string Tile::buildName(int x, int y)
@@ -522,32 +513,39 @@ bool Tile::isSameFloodFill(Seat* seat, FloodFillType type, Tile* tile) const
 
 void Tile::resetFloodFill()
 {
-    for(std::vector<uint32_t>& values : mFloodFillColor)
+    // Only the shared layer is kept. The other ones will be created if needed (see GameMap::getFloodFillLayer)
+    mFloodFillColor.assign(1, std::vector<uint32_t>(static_cast<uint32_t>(FloodFillType::nbValues), NO_FLOODFILL));
+}
+
+void Tile::addFloodFillLayer()
+{
+    if(mFloodFillColor.empty())
     {
-        for(uint32_t& floodFillValue : values)
-        {
-            floodFillValue = NO_FLOODFILL;
-        }
+        OD_LOG_ERR("No floodfill layer to copy tile=" + Tile::displayAsString(this));
+        return;
     }
+
+    mFloodFillColor.push_back(mFloodFillColor[0]);
 }
 
 bool Tile::updateFloodFillFromTile(Seat* seat, FloodFillType type, Tile* tile)
 {
-    if(seat->getTeamIndex() >= mFloodFillColor.size())
+    uint32_t layer = getGameMap()->getFloodFillLayer(seat);
+    if(layer >= mFloodFillColor.size())
     {
         static bool logMsg = false;
         if(!logMsg)
         {
             logMsg = true;
-            OD_LOG_ERR("Wrong floodfill seat index seatId=" + Helper::toString(seat->getId())
+            OD_LOG_ERR("Wrong floodfill layer seatId=" + Helper::toString(seat->getId())
                 + ", tile=" + Tile::displayAsString(this)
-                + ", seatIndex=" + Helper::toString(seat->getTeamIndex()) + ", floodfillsize=" + Helper::toString(static_cast<uint32_t>(mFloodFillColor.size()))
+                + ", layer=" + Helper::toString(layer) + ", floodfillsize=" + Helper::toString(static_cast<uint32_t>(mFloodFillColor.size()))
                 + ", fullness=" + Helper::toString(getFullness()));
         }
         return false;
     }
 
-    std::vector<uint32_t>& values = mFloodFillColor[seat->getTeamIndex()];
+    std::vector<uint32_t>& values = mFloodFillColor[layer];
     uint32_t intType = static_cast<uint32_t>(type);
     if(intType >= values.size())
     {
@@ -574,20 +572,21 @@ bool Tile::updateFloodFillFromTile(Seat* seat, FloodFillType type, Tile* tile)
 
 void Tile::replaceFloodFill(Seat* seat, FloodFillType type, uint32_t newValue)
 {
-    if(seat->getTeamIndex() >= mFloodFillColor.size())
+    uint32_t layer = getGameMap()->getFloodFillLayer(seat);
+    if(layer >= mFloodFillColor.size())
     {
         static bool logMsg = false;
         if(!logMsg)
         {
             logMsg = true;
-            OD_LOG_ERR("Wrong floodfill seat index seatId=" + Helper::toString(seat->getId())
+            OD_LOG_ERR("Wrong floodfill layer seatId=" + Helper::toString(seat->getId())
                 + ", tile=" + Tile::displayAsString(this)
-                + ", seatIndex=" + Helper::toString(seat->getTeamIndex()) + ", floodfillsize=" + Helper::toString(static_cast<uint32_t>(mFloodFillColor.size())));
+                + ", layer=" + Helper::toString(layer) + ", floodfillsize=" + Helper::toString(static_cast<uint32_t>(mFloodFillColor.size())));
         }
         return;
     }
 
-    std::vector<uint32_t>& values = mFloodFillColor[seat->getTeamIndex()];
+    std::vector<uint32_t>& values = mFloodFillColor[layer];
     uint32_t intType = static_cast<uint32_t>(type);
     if(intType >= values.size())
     {
@@ -605,47 +604,19 @@ void Tile::replaceFloodFill(Seat* seat, FloodFillType type, uint32_t newValue)
     values[intType] = newValue;
 }
 
-void Tile::copyFloodFillToOtherSeats(Seat* seatToCopy)
-{
-    if(seatToCopy->getTeamIndex() >= mFloodFillColor.size())
-    {
-        static bool logMsg = false;
-        if(!logMsg)
-        {
-            logMsg = true;
-            OD_LOG_ERR("Wrong floodfill seat index seatId=" + Helper::toString(seatToCopy->getId())
-                + ", tile=" + Tile::displayAsString(this)
-                + ", seatIndex=" + Helper::toString(seatToCopy->getTeamIndex()) + ", floodfillsize=" + Helper::toString(static_cast<uint32_t>(mFloodFillColor.size())));
-        }
-        return;
-    }
-
-    std::vector<uint32_t>& valuesToCopy = mFloodFillColor[seatToCopy->getTeamIndex()];
-    for(uint32_t indexFloodFill = 0; indexFloodFill < mFloodFillColor.size(); ++indexFloodFill)
-    {
-        if(seatToCopy->getTeamIndex() == indexFloodFill)
-            continue;
-
-        std::vector<uint32_t>& values = mFloodFillColor[indexFloodFill];
-        for(uint32_t intType = 0; intType < static_cast<uint32_t>(FloodFillType::nbValues); ++intType)
-            values[intType] = valuesToCopy[intType];
-
-    }
-}
-
 void Tile::logFloodFill() const
 {
     std::string str = "Floodfill : " + Tile::displayAsString(this)
         + " - type=" + Tile::tileVisualToString(getTileVisual())
         + " - fullness=" + Helper::toString(getFullness())
         + " - seatId=" + std::string(getSeat() == nullptr ? "-1" : Helper::toString(getSeat()->getId()));
-    for(const std::vector<uint32_t>& values : mFloodFillColor)
+    for(uint32_t layer = 0; layer < mFloodFillColor.size(); ++layer)
     {
-        int cpt = 0;
-        for(const uint32_t& floodFill : values)
+        const std::vector<uint32_t>& values = mFloodFillColor[layer];
+        for(uint32_t cpt = 0; cpt < values.size(); ++cpt)
         {
+            uint32_t floodFill = getGameMap()->getFloodFillColor(layer, static_cast<FloodFillType>(cpt), values[cpt]);
             str += ", [" + Helper::toString(cpt) + "]=" + Helper::toString(floodFill);
-            ++cpt;
         }
     }
     OD_LOG_INF(str);
@@ -688,22 +659,21 @@ bool Tile::isClaimed() const
     return true;
 }
 
-void Tile::clearVision()
-{
-    mSeatsWithVision.clear();
-}
-
-void Tile::notifyVision(Seat* seat)
+void Tile::notifyVisionGained(Seat* seat)
 {
     if(std::find(mSeatsWithVision.begin(), mSeatsWithVision.end(), seat) != mSeatsWithVision.end())
         return;
 
-    seat->notifyVisionOnTile(this);
     mSeatsWithVision.push_back(seat);
+}
+
+void Tile::notifyVisionLost(Seat* seat)
+{
+    auto it = std::find(mSeatsWithVision.begin(), mSeatsWithVision.end(), seat);
+    if(it == mSeatsWithVision.end())
+        return;
 
-    // We also notify vision for allied seats
-    for(Seat* alliedSeat : seat->getAlliedSeats())
-        notifyVision(alliedSeat);
+    mSeatsWithVision.erase(it);
 }
 
 void Tile::setSeats(const std::vector<Seat*>& seats)
@@ -747,7 +717,7 @@ void Tile::computeTileVisual()
     switch(getType())
     {
         case TileType::dirt:
-            if(mFullness > 0.0)
+            if(getFullness() > 0.0)
             {
                 if(isClaimed())
                     mTileVisual = TileVisual::claimedFull;
@@ -764,14 +734,14 @@ void Tile::computeTileVisual()
             return;
 
         case TileType::rock:
-            if(mFullness > 0.0)
+            if(getFullness() > 0.0)
                 mTileVisual = TileVisual::rockFull;
             else
                 mTileVisual = TileVisual::rockGround;
             return;
 
         case TileType::gold:
-            if(mFullness > 0.0)
+            if(getFullness() > 0.0)
             {
                 if(isClaimed())
                     mTileVisual = TileVisual::claimedFull;
@@ -796,7 +766,7 @@ void Tile::computeTileVisual()
             return;
 
         case TileType::gem:
-            if(mFullness > 0.0)
+            if(getFullness() > 0.0)
                 mTileVisual = TileVisual::gemFull;
             else
                 mTileVisual = TileVisual::gemGround;
@@ -811,21 +781,22 @@ void Tile::computeTileVisual()
 
 uint32_t Tile::getFloodFillValue(Seat* seat, FloodFillType type) const
 {
-    if(seat->getTeamIndex() >= mFloodFillColor.size())
+    uint32_t layer = getGameMap()->getFloodFillLayer(seat);
+    if(layer >= mFloodFillColor.size())
     {
         static bool logMsg = false;
         if(!logMsg)
         {
             logMsg = true;
-            OD_LOG_ERR("Wrong floodfill seat index seatId=" + Helper::toString(seat->getId())
+            OD_LOG_ERR("Wrong floodfill layer seatId=" + Helper::toString(seat->getId())
                 + ", tile=" + Tile::displayAsString(this)
-                + ", seatIndex=" + Helper::toString(seat->getTeamIndex()) + ", floodfillsize=" + Helper::toString(static_cast<uint32_t>(mFloodFillColor.size()))
+                + ", layer=" + Helper::toString(layer) + ", floodfillsize=" + Helper::toString(static_cast<uint32_t>(mFloodFillColor.size()))
                 + ", fullness=" + Helper::toString(getFullness()));
         }
         return NO_FLOODFILL;
     }
 
-    const std::vector<uint32_t>& values = mFloodFillColor[seat->getTeamIndex()];
+    const std::vector<uint32_t>& values = mFloodFillColor[layer];
     uint32_t intType = static_cast<uint32_t>(type);
     if(intType >= values.size())
     {
@@ -840,12 +811,7 @@ uint32_t Tile::getFloodFillValue(Seat* seat, FloodFillType type) const
         return NO_FLOODFILL;
     }
 
-    return values.at(intType);
-}
-
-void Tile::setTeamsNumber(uint32_t nbTeams)
-{
-    mFloodFillColor = std::vector<std::vector<uint32_t>>(nbTeams, std::vector<uint32_t>(static_cast<uint32_t>(FloodFillType::nbValues), NO_FLOODFILL));
+    return getGameMap()->getFloodFillColor(layer, type, values[intType]);
 }
 
 bool Tile::shouldColorTileMesh() const
@@ -866,26 +832,52 @@ void Tile::exportToStream(Tile* tile, std::ostream& os)
     tile->exportToStream(os);
 }
 
+void Tile::setTileVisual(TileVisual tileVisual)
+{
+    mTileVisual = tileVisual;
+    // On client side, the claimed state depends on the visual
+    getGameMap()->updateTileFields(this);
+}
+
+void Tile::setType(TileType t)
+{
+    if(mContainer != nullptr)
+        mContainer->setTileType(getTileIndex(), t);
+    else
+        mLoadingType = t;
+}
+
+void Tile::setFullnessValue(double f)
+{
+    if(mContainer != nullptr)
+        mContainer->setTileFullness(getTileIndex(), f);
+    else
+        mLoadingFullness = f;
+}
+
 void Tile::setFullness(double f)
 {
     double oldFullness = getFullness();
 
-    mFullness = f;
+    setFullnessValue(f);
+
+    if((oldFullness > 0.0) != (f > 0.0))
+        getGameMap()->tilePassabilityChanged(this);
 
     // If the tile was marked for digging and has been dug out, unmark it and set its fullness to 0.
-    if (mFullness == 0.0 && isMarkedForDiggingByAnySeat())
+    if (f == 0.0 && isMarkedForDiggingByAnySeat())
     {
         setMarkedForDiggingForAllPlayersExcept(false, nullptr);
     }
 
-    if ((oldFullness > 0.0) && (mFullness == 0.0))
+    if ((oldFullness > 0.0) && (f == 0.0))
     {
         fireTileSound(TileSound::Digged);
 
         if(!getGameMap()->isInEditorMode())
         {
             // Do a flood fill to update the contiguous region touching the tile.
-            for(Seat* seat : getGameMap()->getSeats())
+            for(Seat* seat : getGameMap()->getFloodFillLayerSeats())
                 getGameMap()->refreshFloodFill(seat, this);
         }
     }
@@ -941,6 +933,10 @@ void Tile::setCoveringBuilding(Building *building)
         }
     }
     mCoveringBuilding = building;
+    getGameMap()->updateTileFields(this);
+    // Bridges and doors change the way creatures can go through the tile
+    getGameMap()->tilePassabilityChanged(this);
+
     mIsRoom = false;
     if(getCoveringRoom() != nullptr)
     {
@@ -968,6 +964,8 @@ void Tile::setCoveringBuilding(Building *building)
         // Set the tile as claimed and of the team color of the building
         setSeat(mCoveringBuilding->getSeat());
         mClaimedPercentage = 1.0;
+        updateSeatClaimedTile();
+        getGameMap()->tileVisionChanged(this);
     }
 }
 
@@ -979,7 +977,7 @@ bool Tile::isGroundClaimable(Seat* seat) const
     if(getCoveringBuilding() != nullptr)
         return getCoveringBuilding()->isClaimable(seat);
 
-    if(mType != TileType::dirt && mType != TileType::gold)
+    if(getType() != TileType::dirt && getType() != TileType::gold)
         return false;
 
     if(isClaimedForSeat(seat))
@@ -988,7 +986,7 @@ bool Tile::isGroundClaimable(Seat* seat) const
     return true;
 }
 
-void Tile::exportToPacketForUpdate(ODPacket& os, const Seat* seat) const
+void Tile::exportToPacketForUpdate(ODPacket& os, Seat* seat) const
 {
     GameEntity::exportToPacketForUpdate(os, seat);
 
@@ -999,27 +997,41 @@ void Tile::updateFromPacket(ODPacket& is)
 {
     GameEntity::updateFromPacket(is);
 
-    // This function should read parameters as sent by Tile::exportToPacketForUpdate
-    int seatId;
-    std::string meshName;
+    // This function should read parameters as sent by Tile::exportToPacketForUpdate. Only
+    // the fields that changed since the last update are sent
+    uint16_t fields;
     std::stringstream ss;
 
-    // We set the seat if there is one
-    OD_ASSERT_TRUE(is >> mIsRoom);
-    OD_ASSERT_TRUE(is >> mIsTrap);
-    OD_ASSERT_TRUE(is >> mRefundPriceRoom);
-    OD_ASSERT_TRUE(is >> mRefundPriceTrap);
+    OD_ASSERT_TRUE(is >> fields);
+    if((fields & TileUpdateField::TileUpdateIsRoom) != 0)
+        OD_ASSERT_TRUE(is >> mIsRoom);
+    if((fields & TileUpdateField::TileUpdateIsTrap) != 0)
+        OD_ASSERT_TRUE(is >> mIsTrap);
+    if((fields & TileUpdateField::TileUpdateRefundPriceRoom) != 0)
+        OD_ASSERT_TRUE(is >> mRefundPriceRoom);
+    if((fields & TileUpdateField::TileUpdateRefundPriceTrap) != 0)
+        OD_ASSERT_TRUE(is >> mRefundPriceTrap);
 
-    OD_ASSERT_TRUE(is >> mDisplayTileMesh);
-    OD_ASSERT_TRUE(is >> mColorCustomMesh);
-    OD_ASSERT_TRUE(is >> mHasBridge);
+    if((fields & TileUpdateField::TileUpdateDisplayTileMesh) != 0)
+        OD_ASSERT_TRUE(is >> mDisplayTileMesh);
+    if((fields & TileUpdateField::TileUpdateColorCustomMesh) != 0)
+        OD_ASSERT_TRUE(is >> mColorCustomMesh);
+    if((fields & TileUpdateField::TileUpdateHasBridge) != 0)
+        OD_ASSERT_TRUE(is >> mHasBridge);
 
-    OD_ASSERT_TRUE(is >> seatId);
+    int seatId = (getSeat() == nullptr) ? -1 : getSeat()->getId();
+    if((fields & TileUpdateField::TileUpdateSeatId) != 0)
+        OD_ASSERT_TRUE(is >> seatId);
 
-    OD_ASSERT_TRUE(is >> meshName);
-    setMeshName(meshName);
+    if((fields & TileUpdateField::TileUpdateMeshName) != 0)
+    {
+        std::string meshName;
+        OD_ASSERT_TRUE(getGameMap()->getLocalPlayer()->getSeat()->importMeshNameFromPacket(is, meshName));
+        setMeshName(meshName);
+    }
 
-    OD_ASSERT_TRUE(is >> mScale);
+    if((fields & TileUpdateField::TileUpdateScale) != 0)
+        OD_ASSERT_TRUE(is >> mScale);
 
     ss.str(std::string());
     ss << TILE_PREFIX;
@@ -1029,7 +1041,8 @@ void Tile::updateFromPacket(ODPacket& is)
 
     setName(ss.str());
 
-    OD_ASSERT_TRUE(is >> mTileVisual);
+    if((fields & TileUpdateField::TileUpdateTileVisual) != 0)
+        OD_ASSERT_TRUE(is >> mTileVisual);
 
     if(seatId == -1)
     {
@@ -1114,6 +1127,7 @@ void Tile::loadFromLine(const std::string& line, Tile *t)
         return;
     t->setSeat(seat);
     t->mClaimedPercentage = 1.0;
+    t->updateSeatClaimedTile();
 }
 
 void Tile::refreshMesh()
@@ -1156,6 +1170,8 @@ bool Tile::addEntity(GameEntity *entity)
     }
 
     mEntitiesInTile.push_back(entity);
+    getGameMap()->updateTileFields(this);
+    getGameMap()->entityAddedOnTile(entity, this);
     return true;
 }
 
@@ -1169,6 +1185,8 @@ void Tile::removeEntity(GameEntity *entity)
     }
 
     mEntitiesInTile.erase(it);
+    getGameMap()->updateTileFields(this);
+    getGameMap()->entityRemovedFromTile(entity, this);
 }
 
 
@@ -1194,6 +1212,8 @@ void Tile::claimForSeat(Seat* seat, double nDanceRate)
     else
     {
         mClaimedPercentage -= nDanceRate;
+        // The tile is not claimed anymore
+        getGameMap()->tileVisionChanged(this);
         if (mClaimedPercentage <= 0.0)
         {
             // We notify the old seat that the tile is lost
@@ -1212,7 +1232,10 @@ void Tile::claimForSeat(Seat* seat, double nDanceRate)
         (getSeat()->isAlliedSeat(seat)))
     {
         claimTile(seat);
+        return;
     }
+
+    updateSeatClaimedTile();
 }
 
 void Tile::claimTile(Seat* seat)
@@ -1221,6 +1244,8 @@ void Tile::claimTile(Seat* seat)
     // We need this because if we are a client, the tile may be from a non allied seat
     setSeat(seat);
     mClaimedPercentage = 1.0;
+    updateSeatClaimedTile();
+    getGameMap()->tileVisionChanged(this);
 
     if(isFullTile())
         fireTileSound(TileSound::ClaimWall);
@@ -1234,7 +1259,7 @@ void Tile::claimTile(Seat* seat)
     setDirtyForAllSeats();
 
     // Force all the neighbors to recheck their meshes as we have updated this tile.
-    for (Tile* tile : mNeighbors)
+    for (Tile* tile : getAllNeighbors())
     {
         // Update potential active spots.
         Building* building = tile->getCoveringBuilding();
@@ -1246,17 +1271,44 @@ void Tile::claimTile(Seat* seat)
     }
 }
 
+void Tile::setSeat(Seat* seat)
+{
+    GameEntity::setSeat(seat);
+    updateSeatClaimedTile();
+}
+
+void Tile::updateSeatClaimedTile()
+{
+    getGameMap()->updateTileFields(this);
+
+    if(!getIsOnServerMap())
+        return;
+
+    Seat* seat = isClaimed() ? getSeat() : nullptr;
+    if(seat == mSeatClaimedTile)
+        return;
+
+    if(mSeatClaimedTile != nullptr)
+        mSeatClaimedTile->getStats().removeClaimedTile();
+    if(seat != nullptr)
+        seat->getStats().addClaimedTile();
+
+    mSeatClaimedTile = seat;
+}
+
 void Tile::unclaimTile()
 {
     // Unclaim the tile.
     setSeat(nullptr);
     mClaimedPercentage = 0.0;
+    updateSeatClaimedTile();
+    getGameMap()->tileVisionChanged(this);
 
     computeTileVisual();
     setDirtyForAllSeats();
 
     // Force all the neighbors to recheck their meshes as we have updated this tile.
-    for (Tile* tile : mNeighbors)
+    for (Tile* tile : getAllNeighbors())
     {
         // Update potential active spots.
         Building* building = tile->getCoveringBuilding();
@@ -1298,21 +1350,22 @@ double Tile::digOut(double digRate)
     if(fullnessLost <= 0.0)
         return digRateScaled;
 
-    if(mFullness <= 0.0)
+    double fullness = getFullness();
+    if(fullness <= 0.0)
     {
-        OD_LOG_ERR("tile=" + Tile::displayAsString(this) + ", mFullness=" + Helper::toString(mFullness));
+        OD_LOG_ERR("tile=" + Tile::displayAsString(this) + ", fullness=" + Helper::toString(fullness));
         return 0.0;
     }
 
-    if(fullnessLost >= mFullness)
+    if(fullnessLost >= fullness)
     {
-        digRateScaled = mFullness;
+        digRateScaled = fullness;
         setFullness(0.0);
 
         computeTileVisual();
         setDirtyForAllSeats();
 
-        for (Tile* tile : mNeighbors)
+        for (Tile* tile : getAllNeighbors())
         {
             // Update potential active spots.
             Building* building = tile->getCoveringBuilding();
@@ -1326,7 +1379,7 @@ double Tile::digOut(double digRate)
     }
 
     digRateScaled = fullnessLost;
-    setFullness(mFullness - fullnessLost);
+    setFullness(fullness - fullnessLost);
     return digRateScaled;
 }
 
@@ -1404,164 +1457,172 @@ void Tile::fillWithEntities(std::vector<GameEntity*>& entities, SelectionEntityW
             continue;
         }
 
-        switch(entityWanted)
+        if(!isEntityWanted(entity, entityWanted, player))
+            continue;
+
+        if (std::find(entities.begin(), entities.end(), entity) != entities.end())
+            continue;
+
+        entities.push_back(entity);
+    }
+}
+
+bool Tile::isEntityWanted(GameEntity* entity, SelectionEntityWanted entityWanted, Player* player)
+{
+    switch(entityWanted)
+    {
+        case SelectionEntityWanted::any:
         {
-            case SelectionEntityWanted::any:
-            {
-                // We accept any entity
-                break;
-            }
-            case SelectionEntityWanted::creatureAliveOwned:
-            {
-                if(entity->getObjectType() != GameEntityType::creature)
-                    continue;
+            // We accept any entity
+            break;
+        }
+        case SelectionEntityWanted::creatureAliveOwned:
+        {
+            if(entity->getObjectType() != GameEntityType::creature)
+                return false;
 
-                if(player->getSeat() != entity->getSeat())
-                    continue;
+            if(player->getSeat() != entity->getSeat())
+                return false;
 
-                Creature* creature = static_cast<Creature*>(entity);
-                if(!creature->isAlive())
-                    continue;
+            Creature* creature = static_cast<Creature*>(entity);
+            if(!creature->isAlive())
+                return false;
 
-                break;
-            }
-            case SelectionEntityWanted::chicken:
-            {
-                if(entity->getObjectType() != GameEntityType::chickenEntity)
-                    continue;
+            break;
+        }
+        case SelectionEntityWanted::chicken:
+        {
+            if(entity->getObjectType() != GameEntityType::chickenEntity)
+                return false;
 
-                break;
-            }
-            case SelectionEntityWanted::treasuryObjects:
-            {
-                if(entity->getObjectType() != GameEntityType::treasuryObject)
-                    continue;
+            break;
+        }
+        case SelectionEntityWanted::treasuryObjects:
+        {
+            if(entity->getObjectType() != GameEntityType::treasuryObject)
+                return false;
 
-                break;
-            }
-            case SelectionEntityWanted::creatureAliveOwnedHurt:
-            {
-                if(entity->getObjectType() != GameEntityType::creature)
-                    continue;
+            break;
+        }
+        case SelectionEntityWanted::creatureAliveOwnedHurt:
+        {
+            if(entity->getObjectType() != GameEntityType::creature)
+                return false;
 
-                if(player->getSeat() != entity->getSeat())
-                    continue;
+            if(player->getSeat() != entity->getSeat())
+                return false;
 
-                Creature* creature = static_cast<Creature*>(entity);
-                if(!creature->isAlive())
-                    continue;
+            Creature* creature = static_cast<Creature*>(entity);
+            if(!creature->isAlive())
+                return false;
 
-                if(!creature->isHurt())
-                    continue;
+            if(!creature->isHurt())
+                return false;
 
-                break;
-            }
-            case SelectionEntityWanted::creatureAliveAllied:
-            {
-                if(entity->getObjectType() != GameEntityType::creature)
-                    continue;
+            break;
+        }
+        case SelectionEntityWanted::creatureAliveAllied:
+        {
+            if(entity->getObjectType() != GameEntityType::creature)
+                return false;
 
-                if(entity->getSeat() == nullptr)
-                    continue;
+            if(entity->getSeat() == nullptr)
+                return false;
 
-                if(!player->getSeat()->isAlliedSeat(entity->getSeat()))
-                    continue;
+            if(!player->getSeat()->isAlliedSeat(entity->getSeat()))
+                return false;
 
-                Creature* creature = static_cast<Creature*>(entity);
-                if(!creature->isAlive())
-                    continue;
+            Creature* creature = static_cast<Creature*>(entity);
+            if(!creature->isAlive())
+                return false;
 
-                break;
-            }
-            case SelectionEntityWanted::creatureAliveEnemy:
-            {
-                if(entity->getObjectType() != GameEntityType::creature)
-                    continue;
+            break;
+        }
+        case SelectionEntityWanted::creatureAliveEnemy:
+        {
+            if(entity->getObjectType() != GameEntityType::creature)
+                return false;
 
-                if(entity->getSeat() == nullptr)
-                    continue;
+            if(entity->getSeat() == nullptr)
+                return false;
 
-                if(player->getSeat()->isAlliedSeat(entity->getSeat()))
-                    continue;
+            if(player->getSeat()->isAlliedSeat(entity->getSeat()))
+                return false;
 
-                Creature* creature = static_cast<Creature*>(entity);
-                if(!creature->isAlive())
-                    continue;
+            Creature* creature = static_cast<Creature*>(entity);
+            if(!creature->isAlive())
+                return false;
 
-                break;
-            }
-            case SelectionEntityWanted::creatureAlive:
-            {
-                if(entity->getObjectType() != GameEntityType::creature)
-                    continue;
+            break;
+        }
+        case SelectionEntityWanted::creatureAlive:
+        {
+            if(entity->getObjectType() != GameEntityType::creature)
+                return false;
 
-                Creature* creature = static_cast<Creature*>(entity);
-                if(!creature->isAlive())
-                    continue;
+            Creature* creature = static_cast<Creature*>(entity);
+            if(!creature->isAlive())
+                return false;
 
-                break;
-            }
-            case SelectionEntityWanted::creatureAliveOrDead:
-            {
-                if(entity->getObjectType() != GameEntityType::creature)
-                    continue;
+            break;
+        }
+        case SelectionEntityWanted::creatureAliveOrDead:
+        {
+            if(entity->getObjectType() != GameEntityType::creature)
+                return false;
 
-                break;
-            }
-            case SelectionEntityWanted::creatureAliveInOwnedPrisonHurt:
-            {
-                if(entity->getObjectType() != GameEntityType::creature)
-                    continue;
+            break;
+        }
+        case SelectionEntityWanted::creatureAliveInOwnedPrisonHurt:
+        {
+            if(entity->getObjectType() != GameEntityType::creature)
+                return false;
 
-                Creature* creature = static_cast<Creature*>(entity);
-                if(!creature->isAlive())
-                    continue;
+            Creature* creature = static_cast<Creature*>(entity);
+            if(!creature->isAlive())
+                return false;
 
-                if(!creature->isInPrison())
-                    continue;
+            if(!creature->isInPrison())
+                return false;
 
-                if(!creature->getSeatPrison()->canOwnedCreatureBePickedUpBy(player->getSeat()))
-                    continue;
+            if(!creature->getSeatPrison()->canOwnedCreatureBePickedUpBy(player->getSeat()))
+                return false;
 
-                break;
-            }
-            case SelectionEntityWanted::creatureAliveEnemyAttackable:
-            {
-                if(entity->getObjectType() != GameEntityType::creature)
-                    continue;
+            break;
+        }
+        case SelectionEntityWanted::creatureAliveEnemyAttackable:
+        {
+            if(entity->getObjectType() != GameEntityType::creature)
+                return false;
 
-                if(entity->getSeat() == nullptr)
-                    continue;
+            if(entity->getSeat() == nullptr)
+                return false;
 
-                if(player->getSeat()->isAlliedSeat(entity->getSeat()))
-                    continue;
+            if(player->getSeat()->isAlliedSeat(entity->getSeat()))
+                return false;
 
-                Creature* creature = static_cast<Creature*>(entity);
-                if(!creature->isAlive())
-                    continue;
+            Creature* creature = static_cast<Creature*>(entity);
+            if(!creature->isAlive())
+                return false;
 
-                if(!creature->isAttackable(this, player->getSeat()))
-                    continue;
+            if(!creature->isAttackable(this, player->getSeat()))
+                return false;
 
-                break;
-            }
-            default:
+            break;
+        }
+        default:
+        {
+            static bool logMsg = false;
+            if(!logMsg)
             {
-                static bool logMsg = false;
-                if(!logMsg)
-                {
-                    logMsg = true;
-                    OD_LOG_ERR("Wrong SelectionEntityWanted int=" + Helper::toString(static_cast<uint32_t>(entityWanted)));
-                }
-                continue;
+                logMsg = true;
+                OD_LOG_ERR("Wrong SelectionEntityWanted int=" + Helper::toString(static_cast<uint32_t>(entityWanted)));
             }
+            return false;
         }
-
-        if (std::find(entities.begin(), entities.end(), entity) != entities.end())
-            continue;
-
-        entities.push_back(entity);
     }
+
+    return true;
 }
 
 bool Tile::addTreasuryObject(TreasuryObject* obj)
@@ -1576,6 +1637,8 @@ bool Tile::addTreasuryObject(TreasuryObject* obj)
     {
         // On client side, we add the entity to tile. Merging is relevant on server side only
         mEntitiesInTile.push_back(obj);
+        getGameMap()->updateTileFields(this);
+        getGameMap()->entityAddedOnTile(obj, this);
         return true;
     }
 
@@ -1599,7 +1662,11 @@ bool Tile::addTreasuryObject(TreasuryObject* obj)
     }
 
     if(!isMerged)
+    {
         mEntitiesInTile.push_back(obj);
+        getGameMap()->updateTileFields(this);
+        getGameMap()->entityAddedOnTile(obj, this);
+    }
 
     return true;
 }
@@ -1646,24 +1713,24 @@ bool Tile::checkCoveringTrapType(TrapType type) const
 
 void Tile::computeVisibleTiles()
 {
+    std::vector<Tile*> tiles;
     if(!getGameMap()->getIsFOWActivated())
     {
         // If the FOW is deactivated, we allow vision for every seat
-        for(Seat* seat : getGameMap()->getSeats())
-            notifyVision(seat);
-
+        tiles.push_back(this);
+        getGameMap()->updateVisionSource(this, nullptr, tiles, true);
         return;
     }
 
-    if(!isClaimed())
-        return;
-
     // A claimed tile can see it self and its neighboors
-    notifyVision(getSeat());
-    for(Tile* tile : mNeighbors)
+    if(isClaimed())
     {
-        tile->notifyVision(getSeat());
+        tiles.push_back(this);
+        TileNeighbors neighbors = getAllNeighbors();
+        tiles.insert(tiles.end(), neighbors.begin(), neighbors.end());
     }
+
+    getGameMap()->updateVisionSource(this, getSeat(), tiles, true);
 }
 
 void Tile::setDirtyForAllSeats()
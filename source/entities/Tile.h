@@ -19,6 +19,8 @@
 #define TILE_H
 
 #include "entities/GameEntity.h"
+#include "gamemap/TileContainer.h"
+#include "gamemap/TileNeighbors.h"
 
 #include <OgreVector3.h>
 
@@ -117,6 +119,7 @@ enum class FloodFillType
  */
 class Tile : public GameEntity
 {
+    friend class TileContainer;
 public:
     Tile(GameMap* gameMap, int x = 0, int y = 0, TileType type = TileType::dirt, double fullness = 100.0);
 
@@ -163,20 +166,18 @@ public:
      * In addition to setting the tile type this function also reloads the new mesh
      * for the tile.
      */
-    inline void setType(TileType t)
-    { mType = t; }
+    void setType(TileType t);
 
     //! \brief Returns the tile type (rock, claimed, etc.).
     inline TileType getType() const
-    { return mType; }
+    { return (mContainer != nullptr) ? mContainer->getTileType(getTileIndex()) : mLoadingType; }
 
     //! \brief Returns the tile type (rock, claimed, etc.).
     inline TileVisual getTileVisual() const
     { return mTileVisual; }
 
     //! \brief Sets the tile type (rock, claimed, etc.).
-    inline void setTileVisual(TileVisual tileVisual)
-    { mTileVisual = tileVisual; }
+    void setTileVisual(TileVisual tileVisual);
 
     //! \brief A mutator to change how "filled in" the tile is.
     //! Additionally this function refreshes floodfill if needed (if a tile becomes walkable)
@@ -184,7 +185,7 @@ public:
 
     //! \brief An accessor which returns the tile's fullness which should range from 0 to 100.
     inline double getFullness() const
-    { return mFullness; }
+    { return (mContainer != nullptr) ? mContainer->getTileFullness(getTileIndex()) : mLoadingFullness; }
 
     //! \brief Tells whether a creature can see through a tile
     bool permitsVision();
@@ -255,14 +256,15 @@ public:
     const std::vector<GameEntity*>& getEntitiesInTile() const
     { return mEntitiesInTile; }
 
-    void addNeighbor(Tile *n);
-    Tile* getNeighbor(unsigned index);
-    const std::vector<Tile*>& getAllNeighbors() const
-    { return mNeighbors; }
+    //! \brief Returns the (up to) 4 tiles sharing a side with this one (see TileContainer::neighborTiles)
+    TileNeighbors getAllNeighbors() const;
 
     void claimForSeat(Seat* seat, double nDanceRate);
     void claimTile(Seat* seat);
     void unclaimTile();
+
+    //! \brief Moves the claimed tile count from the previous seat if needed
+    virtual void setSeat(Seat* seat) override;
     double digOut(double digRate);
 
     inline Building* getCoveringBuilding() const
@@ -357,10 +359,14 @@ public:
     //! Fills the given vector with corresponding entities on this tile.
     void fillWithEntities(std::vector<GameEntity*>& entities, SelectionEntityWanted entityWanted, Player* player);
 
+    //! \brief Returns true if the given entity on this tile matches entityWanted for the given player
+    bool isEntityWanted(GameEntity* entity, SelectionEntityWanted entityWanted, Player* player);
+
     //! \brief Computes the visible tiles and tags them to know which are visible
     void computeVisibleTiles();
-    void clearVision();
-    void notifyVision(Seat* seat);
+    //! \brief Called by the fog of war when the given seat gains/loses vision on this tile
+    void notifyVisionGained(Seat* seat);
+    void notifyVisionLost(Seat* seat);
 
     void setSeats(const std::vector<Seat*>& seats);
     bool hasChangedForSeat(Seat* seat) const;
@@ -384,7 +390,8 @@ public:
     //! Sets the floodfill value corresponding at type to newValue
     void replaceFloodFill(Seat* seat, FloodFillType type, uint32_t newValue);
 
-    void copyFloodFillToOtherSeats(Seat* seatToCopy);
+    //! Adds a floodfill layer initialized with the values of the shared layer (see GameMap::getFloodFillLayer)
+    void addFloodFillLayer();
 
     uint32_t getFloodFillValue(Seat* seat, FloodFillType type) const;
 
@@ -400,9 +407,6 @@ public:
     //! server and client
     bool isFullTile() const;
 
-    //! Sets the number of teams in this gamemap (after seat configuration). This number includes the rogue team.
-    void setTeamsNumber(uint32_t nbTeams);
-
     //! \brief returns true if the mesh from the tileset should be displayed and false otherwise
     inline bool shouldDisplayTileMesh() const
     { return mDisplayTileMesh; }
@@ -445,7 +449,7 @@ public:
 
     static void exportToStream(Tile* tile, std::ostream& os);
 
-    virtual void exportToPacketForUpdate(ODPacket& os, const Seat* seat) const override;
+    virtual void exportToPacketForUpdate(ODPacket& os, Seat* seat) const override;
     virtual void updateFromPacket(ODPacket& is) override;
 
 protected:
@@ -467,8 +471,12 @@ private:
     //! \brief The tile position
     int mX, mY;
 
+    //! \brief The TileContainer storing this tile. nullptr until the tile is added to the gamemap
+    TileContainer* mContainer;
+
     //! \brief The tile type: Dirt, Gold, ...
-    TileType mType;
+    //! Only used until the tile is stored. Then, the container owns the type
+    TileType mLoadingType;
 
     //! \brief The tile visual: Claimed, Dirt, Gold, ...
     //! On client side, we should rely on mTileVisual to know the tile type as claimed percentage
@@ -480,15 +488,14 @@ private:
 
     //! \brief The tile fullness (0.0 - 100.0).
     //! At 0.0, it is a ground tile. Over it is a wall.
-    //! Used on server side only
-    double mFullness;
+    //! Used on server side only. Like mLoadingType, the container owns it once the tile is stored
+    double mLoadingFullness;
 
     //! Used on client side to know how much gold can be retrieved if the room/trap
     //! is sold. Note that it is needed because client are not aware of rooms/traps
     uint32_t mRefundPriceRoom;
     uint32_t mRefundPriceTrap;
 
-    std::vector<Tile*> mNeighbors;
     std::vector<const Player*> mPlayersMarkingTile;
     std::vector<std::pair<Seat*, bool>> mTileChangedForSeats;
     std::vector<Seat*> mSeatsWithVision;
@@ -497,12 +504,16 @@ private:
     std::vector<GameEntity*> mEntitiesInTile;
 
     Building* mCoveringBuilding;
-    //! Floodfill values per seat and per floodfill type
+    //! Floodfill values per floodfill layer and per floodfill type. Layer 0 is shared by the teams
+    //! that do not need their own (see GameMap::getFloodFillLayer)
     std::vector<std::vector<uint32_t>> mFloodFillColor;
 
     //! \brief The tile claiming. Used on server side only
     double mClaimedPercentage;
 
+    //! \brief Seat counting this tile in its claimed tiles (see SeatStats). Used on server side only
+    Seat* mSeatClaimedTile;
+
     Ogre::Vector3 mScale;
 
     //! \brief True if a building is on this tile. False otherwise. It is used on client side because the clients do not know about
@@ -519,12 +530,19 @@ private:
     //! \brief Used on client side. true if the local player has vision, false otherwise.
     bool mLocalPlayerHasVision;
 
+    //! \brief Index of the tile in mContainer
+    inline uint32_t getTileIndex() const
+    { return mContainer->getTileIndex(mX, mY); }
+
     /*! \brief Set the fullness value for the tile.
      *  This only sets the fullness variable. This function is here to change the value
      *  before a map object has been set. setFullness is called once a map is assigned.
      */
-    inline void setFullnessValue(double f)
-    { mFullness = f; }
+    void setFullnessValue(double f);
+
+    //! \brief Should be called when the seat or the claimed percentage changes to keep the
+    //! number of claimed tiles of the seats and the fields copied by the TileContainer up to date
+    void updateSeatClaimedTile();
 
     void setDirtyForAllSeats();
 
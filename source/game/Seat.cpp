@@ -56,13 +56,42 @@ const int32_t Seat::PLAYER_TYPE_INACTIVE_ID = 0;
 const int32_t Seat::PLAYER_ID_HUMAN_MIN = static_cast<int32_t>(KeeperAIType::nbAI) + Seat::PLAYER_TYPE_INACTIVE_ID + 1;
 
 
+TileStateExported::TileStateExported():
+    mIsRoom(false),
+    mIsTrap(false),
+    mRefundPriceRoom(0),
+    mRefundPriceTrap(0),
+    mDisplayTileMesh(true),
+    mColorCustomMesh(false),
+    mHasBridge(false),
+    mSeatId(-1),
+    mScale(Ogre::Vector3::ZERO),
+    mTileVisual(TileVisual::nullTileVisual)
+{
+}
+
 TileStateNotified::TileStateNotified():
     mTileVisual(TileVisual::nullTileVisual),
     mSeatIdOwner(-1),
     mMarkedForDigging(false),
     mVisionTurnLast(false),
     mVisionTurnCurrent(false),
-    mBuilding(nullptr)
+    mBuilding(nullptr),
+    mIsExported(false)
+{
+}
+
+CreatureStateNotified::CreatureStateNotified():
+    mIsExported(false),
+    mLevel(0),
+    mSeatId(-1),
+    mOverlayHealthValue(0),
+    mMoodValue(0),
+    mGroundSpeed(0.0),
+    mWaterSpeed(0.0),
+    mLavaSpeed(0.0),
+    mSpeedModifier(0.0),
+    mSeatPrisonId(-1)
 {
 }
 
@@ -225,24 +254,30 @@ void Seat::addAlliedSeat(Seat* seat)
     mAlliedSeats.push_back(seat);
 }
 
-void Seat::clearTilesWithVision()
+void Seat::notifyVisionOnTile(Tile* tile)
 {
     if(mPlayer == nullptr)
         return;
     if(!mPlayer->getIsHuman())
         return;
 
-    for(std::vector<TileStateNotified>& vec : mTilesStates)
+    if(tile->getX() >= static_cast<int>(mTilesStates.size()))
     {
-        for(TileStateNotified& p : vec)
-        {
-            p.mVisionTurnLast = p.mVisionTurnCurrent;
-            p.mVisionTurnCurrent = false;
-        }
+        OD_LOG_ERR("Tile=" + Tile::displayAsString(tile));
+        return;
+    }
+    if(tile->getY() >= static_cast<int>(mTilesStates[tile->getX()].size()))
+    {
+        OD_LOG_ERR("Tile=" + Tile::displayAsString(tile));
+        return;
     }
+
+    TileStateNotified& tileState = mTilesStates[tile->getX()][tile->getY()];
+    tileState.mVisionTurnCurrent = true;
+    mTilesVisionChanged.push_back(tile);
 }
 
-void Seat::notifyVisionOnTile(Tile* tile)
+void Seat::notifyVisionLostOnTile(Tile* tile)
 {
     if(mPlayer == nullptr)
         return;
@@ -261,7 +296,8 @@ void Seat::notifyVisionOnTile(Tile* tile)
     }
 
     TileStateNotified& tileState = mTilesStates[tile->getX()][tile->getY()];
-    tileState.mVisionTurnCurrent = true;
+    tileState.mVisionTurnCurrent = false;
+    mTilesVisionChanged.push_back(tile);
 }
 
 void Seat::notifyTileClaimedByEnemy(Tile* tile)
@@ -287,7 +323,13 @@ void Seat::notifyTileClaimedByEnemy(Tile* tile)
     // By default, we set the tile like if it was not claimed anymore
     tileState.mSeatIdOwner = -1;
     tileState.mTileVisual = TileVisual::dirtGround;
-    tileState.mVisionTurnCurrent = true;
+    if(tileState.mVisionTurnCurrent)
+        return;
+
+    // If we have no vision on the tile, we send it as lost so that the player
+    // gets its new state
+    tileState.mVisionTurnLast = true;
+    mTilesVisionChanged.push_back(tile);
 }
 
 const std::string Seat::getFactionFromLine(const std::string& line)
@@ -760,29 +802,27 @@ void Seat::sendVisibleTiles()
         ServerNotificationType::refreshVisibleTiles, getPlayer());
     std::vector<Tile*> tilesVisionGained;
     std::vector<Tile*> tilesVisionLost;
-    // Tiles we gained vision
-    int xMax = static_cast<int>(mTilesStates.size());
-    for(int xxx = 0; xxx < xMax; ++xxx)
+    // Only the tiles notified by the fog of war can have changed. A tile can be in
+    // the list more than once but its state will be equal after the first time
+    for(Tile* tile : mTilesVisionChanged)
     {
-        int yMax = static_cast<int>(mTilesStates[xxx].size());
-        for(int yyy = 0; yyy < yMax; ++yyy)
-        {
-            if(mTilesStates[xxx][yyy].mVisionTurnCurrent == mTilesStates[xxx][yyy].mVisionTurnLast)
-                continue;
+        TileStateNotified& tileState = mTilesStates[tile->getX()][tile->getY()];
+        if(tileState.mVisionTurnCurrent == tileState.mVisionTurnLast)
+            continue;
 
-            Tile* tile = mGameMap->getTile(xxx, yyy);
-            if(mTilesStates[xxx][yyy].mVisionTurnCurrent)
-            {
-                // Vision gained
-                tilesVisionGained.push_back(tile);
-            }
-            else
-            {
-                // Vision lost
-                tilesVisionLost.push_back(tile);
-            }
+        tileState.mVisionTurnLast = tileState.mVisionTurnCurrent;
+        if(tileState.mVisionTurnCurrent)
+        {
+            // Vision gained
+            tilesVisionGained.push_back(tile);
+        }
+        else
+        {
+            // Vision lost
+            tilesVisionLost.push_back(tile);
         }
     }
+    mTilesVisionChanged.clear();
 
     // Notify tiles we gained vision
     nbTiles = tilesVisionGained.size();
@@ -806,22 +846,16 @@ void Seat::computeSeatBeginTurn()
 {
     if(mPlayer != nullptr)
     {
-        std::fill(mNbRooms.begin(), mNbRooms.end(), 0);
-        for(Room* room : mGameMap->getRooms())
+        for(uint32_t index = 0; index < mNbRooms.size(); ++index)
         {
-            if(room->getSeat() != this)
-                continue;
-
-            if(room->getHP(nullptr) <= 0.0)
-                continue;
-
-            uint32_t index = static_cast<uint32_t>(room->getType());
-            if(index >= mNbRooms.size())
+            mNbRooms[index] = 0;
+            for(Room* room : mStats.getRooms(static_cast<RoomType>(index)))
             {
-                OD_LOG_ERR("wrong index=" + Helper::toString(index) + ", size=" + Helper::toString(mNbRooms.size()));
-                return;
+                if(room->getHP(nullptr) <= 0.0)
+                    continue;
+
+                ++mNbRooms[index];
             }
-            ++mNbRooms[index];
         }
     }
 }
@@ -1627,7 +1661,7 @@ void Seat::setVisibleBuildingOnTile(Building* building, Tile* tile)
     tileState.mSeatIdOwner = building->getSeat()->getId();
 }
 
-void Seat::exportTileToPacket(ODPacket& os, const Tile* tile) const
+void Seat::exportTileToPacket(ODPacket& os, const Tile* tile)
 {
     if(getPlayer() == nullptr)
     {
@@ -1651,7 +1685,7 @@ void Seat::exportTileToPacket(ODPacket& os, const Tile* tile) const
         return;
     }
 
-    const TileStateNotified& tileState = mTilesStates[tile->getX()][tile->getY()];
+    TileStateNotified& tileState = mTilesStates[tile->getX()][tile->getY()];
 
     int tileSeatId = -1;
     // We only pass the tile seat to the client if the tile is fully claimed
@@ -1715,17 +1749,126 @@ void Seat::exportTileToPacket(ODPacket& os, const Tile* tile) const
                 refundPriceTrap = (TrapManager::costPerTile(trap->getType()) / 2);
         }
     }
-    os << isRoom;
-    os << isTrap;
-    os << refundPriceRoom;
-    os << refundPriceTrap;
-    os << displayTileMesh;
-    os << colorCustomMesh;
-    os << hasBridge;
-    os << tileSeatId;
+
+    // We only send the fields the client does not know yet
+    TileStateExported& exported = tileState.mExported;
+    bool exportAll = !tileState.mIsExported;
+    uint16_t fields = 0;
+    if(exportAll || (exported.mIsRoom != isRoom))
+        fields |= TileUpdateField::TileUpdateIsRoom;
+    if(exportAll || (exported.mIsTrap != isTrap))
+        fields |= TileUpdateField::TileUpdateIsTrap;
+    if(exportAll || (exported.mRefundPriceRoom != refundPriceRoom))
+        fields |= TileUpdateField::TileUpdateRefundPriceRoom;
+    if(exportAll || (exported.mRefundPriceTrap != refundPriceTrap))
+        fields |= TileUpdateField::TileUpdateRefundPriceTrap;
+    if(exportAll || (exported.mDisplayTileMesh != displayTileMesh))
+        fields |= TileUpdateField::TileUpdateDisplayTileMesh;
+    if(exportAll || (exported.mColorCustomMesh != colorCustomMesh))
+        fields |= TileUpdateField::TileUpdateColorCustomMesh;
+    if(exportAll || (exported.mHasBridge != hasBridge))
+        fields |= TileUpdateField::TileUpdateHasBridge;
+    if(exportAll || (exported.mSeatId != tileSeatId))
+        fields |= TileUpdateField::TileUpdateSeatId;
+    if(exportAll || (exported.mMeshName != meshName))
+        fields |= TileUpdateField::TileUpdateMeshName;
+    if(exportAll || (exported.mScale != scale))
+        fields |= TileUpdateField::TileUpdateScale;
+    if(exportAll || (exported.mTileVisual != tileState.mTileVisual))
+        fields |= TileUpdateField::TileUpdateTileVisual;
+
+    os << fields;
+    if((fields & TileUpdateField::TileUpdateIsRoom) != 0)
+        os << isRoom;
+    if((fields & TileUpdateField::TileUpdateIsTrap) != 0)
+        os << isTrap;
+    if((fields & TileUpdateField::TileUpdateRefundPriceRoom) != 0)
+        os << refundPriceRoom;
+    if((fields & TileUpdateField::TileUpdateRefundPriceTrap) != 0)
+        os << refundPriceTrap;
+    if((fields & TileUpdateField::TileUpdateDisplayTileMesh) != 0)
+        os << displayTileMesh;
+    if((fields & TileUpdateField::TileUpdateColorCustomMesh) != 0)
+        os << colorCustomMesh;
+    if((fields & TileUpdateField::TileUpdateHasBridge) != 0)
+        os << hasBridge;
+    if((fields & TileUpdateField::TileUpdateSeatId) != 0)
+        os << tileSeatId;
+    if((fields & TileUpdateField::TileUpdateMeshName) != 0)
+        exportMeshNameToPacket(os, meshName);
+    if((fields & TileUpdateField::TileUpdateScale) != 0)
+        os << scale;
+    if((fields & TileUpdateField::TileUpdateTileVisual) != 0)
+        os << tileState.mTileVisual;
+
+    tileState.mIsExported = true;
+    exported.mIsRoom = isRoom;
+    exported.mIsTrap = isTrap;
+    exported.mRefundPriceRoom = refundPriceRoom;
+    exported.mRefundPriceTrap = refundPriceTrap;
+    exported.mDisplayTileMesh = displayTileMesh;
+    exported.mColorCustomMesh = colorCustomMesh;
+    exported.mHasBridge = hasBridge;
+    exported.mSeatId = tileSeatId;
+    exported.mMeshName = meshName;
+    exported.mScale = scale;
+    exported.mTileVisual = tileState.mTileVisual;
+}
+
+CreatureStateNotified& Seat::getCreatureStateNotified(uint32_t creatureId)
+{
+    return mCreaturesStates[creatureId];
+}
+
+void Seat::clearCreatureStateNotified(uint32_t creatureId)
+{
+    mCreaturesStates.erase(creatureId);
+}
+
+void Seat::exportMeshNameToPacket(ODPacket& os, const std::string& meshName)
+{
+    // If the mesh name was already sent, we only send its index. Otherwise, we send
+    // the new index followed by the name
+    uint32_t index = 0;
+    for(const std::string& name : mMeshNamesNotified)
+    {
+        if(name == meshName)
+        {
+            os << index;
+            return;
+        }
+        ++index;
+    }
+
+    mMeshNamesNotified.push_back(meshName);
+    os << index;
     os << meshName;
-    os << scale;
-    os << tileState.mTileVisual;
+}
+
+bool Seat::importMeshNameFromPacket(ODPacket& is, std::string& meshName)
+{
+    uint32_t index;
+    if(!(is >> index))
+        return false;
+
+    if(index < mMeshNamesNotified.size())
+    {
+        meshName = mMeshNamesNotified[index];
+        return true;
+    }
+
+    // A new name is always sent with the next free index
+    if(index != mMeshNamesNotified.size())
+    {
+        OD_LOG_ERR("SeatId=" + Helper::toString(getId()) + ", wrong mesh index=" + Helper::toString(index));
+        return false;
+    }
+
+    if(!(is >> meshName))
+        return false;
+
+    mMeshNamesNotified.push_back(meshName);
+    return true;
 }
 
 void Seat::notifyBuildingRemovedFromGameMap(Building* building, Tile* tile)
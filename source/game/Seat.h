@@ -19,9 +19,11 @@
 #define SEAT_H
 
 #include "game/SeatData.h"
+#include "game/SeatStats.h"
 
 #include <OgreVector3.h>
 #include <OgreColourValue.h>
+#include <map>
 #include <string>
 #include <vector>
 #include <iosfwd>
@@ -45,6 +47,42 @@ enum class SpellType;
 enum class TileVisual;
 enum class TrapType;
 
+//! Fields of a tile update (see Seat::exportTileToPacket). The update starts with a mask of the fields
+//! written so that only the fields that changed since the last update sent to the seat are exported
+enum TileUpdateField
+{
+    TileUpdateIsRoom = 0x0001,
+    TileUpdateIsTrap = 0x0002,
+    TileUpdateRefundPriceRoom = 0x0004,
+    TileUpdateRefundPriceTrap = 0x0008,
+    TileUpdateDisplayTileMesh = 0x0010,
+    TileUpdateColorCustomMesh = 0x0020,
+    TileUpdateHasBridge = 0x0040,
+    TileUpdateSeatId = 0x0080,
+    TileUpdateMeshName = 0x0100,
+    TileUpdateScale = 0x0200,
+    TileUpdateTileVisual = 0x0400
+};
+
+//! Class used to save the tile values last exported to each seat
+class TileStateExported
+{
+public:
+    TileStateExported();
+
+    bool mIsRoom;
+    bool mIsTrap;
+    uint32_t mRefundPriceRoom;
+    uint32_t mRefundPriceTrap;
+    bool mDisplayTileMesh;
+    bool mColorCustomMesh;
+    bool mHasBridge;
+    int mSeatId;
+    std::string mMeshName;
+    Ogre::Vector3 mScale;
+    TileVisual mTileVisual;
+};
+
 //! Class used to save the last tile state notified to each seat
 class TileStateNotified
 {
@@ -57,6 +95,28 @@ public:
     bool mVisionTurnLast;
     bool mVisionTurnCurrent;
     Building* mBuilding;
+    //! \brief false until the tile has been exported once to the seat. Until then, mExported is meaningless
+    bool mIsExported;
+    TileStateExported mExported;
+};
+
+//! Class used to save the creature values last exported to each seat (see Creature::exportToPacketForUpdate)
+class CreatureStateNotified
+{
+public:
+    CreatureStateNotified();
+
+    //! \brief false until the creature has been updated once since it was added on the client
+    bool mIsExported;
+    unsigned int mLevel;
+    int mSeatId;
+    uint32_t mOverlayHealthValue;
+    uint32_t mMoodValue;
+    double mGroundSpeed;
+    double mWaterSpeed;
+    double mLavaSpeed;
+    double mSpeedModifier;
+    int mSeatPrisonId;
 };
 
 class Seat : public SeatData
@@ -70,6 +130,13 @@ public:
     inline Player* getPlayer() const
     { return mPlayer; }
 
+    //! \brief Aggregates about the creatures, rooms, gold and claimed tiles of this seat
+    inline SeatStats& getStats()
+    { return mStats; }
+
+    inline const SeatStats& getStats() const
+    { return mStats; }
+
     //! \brief Adds a goal to the vector of goals which must be completed by this seat before it can be declared a winner.
     void addGoal(Goal* g);
 
@@ -200,8 +267,9 @@ public:
     bool canOwnedCreatureUseRoomFrom(const Seat* seat) const;
     bool canBuildingBeDestroyedBy(const Seat* seat) const;
 
-    void clearTilesWithVision();
+    //! \brief Called by the fog of war when this seat gains/loses vision on the given tile
     void notifyVisionOnTile(Tile* tile);
+    void notifyVisionLostOnTile(Tile* tile);
     void notifyTileClaimedByEnemy(Tile* tile);
 
     //! \brief Returns true if this seat can see the given tile and false otherwise
@@ -294,9 +362,23 @@ public:
     void setPlayerSettings(bool koCreatures);
 
     /*! \brief Exports the tile data to the packet so that the client associated to the seat have the needed information
-     *         to display the tile correctly
+     *         to display the tile correctly. Only the fields that changed since the last export to this seat are written.
      */
-    void exportTileToPacket(ODPacket& os, const Tile* tile) const;
+    void exportTileToPacket(ODPacket& os, const Tile* tile);
+
+    //! \brief Returns the creature state last exported to the player on this seat. Used on server side only
+    CreatureStateNotified& getCreatureStateNotified(uint32_t creatureId);
+
+    //! \brief Forgets the state exported for the given creature. Called when the creature is added to or removed from
+    //! the client so that the next update sends every field. Used on server side only
+    void clearCreatureStateNotified(uint32_t creatureId);
+
+    //! \brief Writes the given mesh name. The name is only written the first time it is sent to this seat. After that,
+    //! only its index in mMeshNamesNotified is. Used on server side only
+    void exportMeshNameToPacket(ODPacket& os, const std::string& meshName);
+
+    //! \brief Reads a mesh name written by exportMeshNameToPacket. Used on client side only
+    bool importMeshNameFromPacket(ODPacket& is, std::string& meshName);
 
     static bool sortForMapSave(Seat* s1, Seat* s2);
 
@@ -331,6 +413,8 @@ private:
     //! \brief The total amount of gold coins mined by workers under this seat's control.
     int mGoldMined;
 
+    SeatStats mStats;
+
     //! \brief The actual color that this color index translates into.
     Ogre::ColourValue mColorValue;
 
@@ -361,6 +445,16 @@ private:
 
     std::map<std::pair<int, int>, TileStateNotified> mTilesStateLoaded;
 
+    //! \brief Last state exported to this seat for each creature it has vision on (used for human players seats only)
+    std::map<uint32_t, CreatureStateNotified> mCreaturesStates;
+
+    //! \brief Mesh names sent to the player on this seat (server side) or received from the server (client side).
+    //! The index in the vector is the id used in tile updates
+    std::vector<std::string> mMeshNamesNotified;
+
+    //! \brief Tiles where vision may have changed since the last call to sendVisibleTiles
+    std::vector<Tile*> mTilesVisionChanged;
+
     std::vector<Tile*> mVisualDebugEntityTiles;
 
     //! \brief Index of the team in the gamemap (from 0 to N). Must be set when the seat is added to the gamemap
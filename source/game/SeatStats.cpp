@@ -0,0 +1,170 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "game/SeatStats.h"
+
+#include "rooms/RoomType.h"
+#include "utils/Helper.h"
+#include "utils/LogManager.h"
+
+#include <algorithm>
+
+SeatStats::SeatStats() :
+    mRooms(static_cast<uint32_t>(RoomType::nbRooms)),
+    mGoldStored(0),
+    mGoldStorage(0),
+    mNbClaimedTiles(0)
+{
+}
+
+void SeatStats::addCreature(Creature* creature, const CreatureDefinition* countedDefinition)
+{
+    if(!mCreaturesCounted.emplace(creature, countedDefinition).second)
+    {
+        OD_LOG_ERR("creature already indexed");
+        return;
+    }
+
+    mCreatures.push_back(creature);
+    countCreature(countedDefinition, true);
+}
+
+bool SeatStats::removeCreature(Creature* creature)
+{
+    auto itCounted = mCreaturesCounted.find(creature);
+    if(itCounted == mCreaturesCounted.end())
+        return false;
+
+    countCreature(itCounted->second, false);
+    mCreaturesCounted.erase(itCounted);
+
+    // We keep the order so that the creatures are processed the same way after a removal
+    auto it = std::find(mCreatures.begin(), mCreatures.end(), creature);
+    if(it != mCreatures.end())
+        mCreatures.erase(it);
+
+    return true;
+}
+
+void SeatStats::updateCreature(const Creature* creature, const CreatureDefinition* countedDefinition)
+{
+    auto it = mCreaturesCounted.find(creature);
+    if(it == mCreaturesCounted.end())
+        return;
+
+    if(it->second == countedDefinition)
+        return;
+
+    countCreature(it->second, false);
+    countCreature(countedDefinition, true);
+    it->second = countedDefinition;
+}
+
+void SeatStats::countCreature(const CreatureDefinition* definition, bool add)
+{
+    if(definition == nullptr)
+        return;
+
+    if(add)
+    {
+        ++mNbCreaturesByDefinition[definition];
+        return;
+    }
+
+    auto it = mNbCreaturesByDefinition.find(definition);
+    if(it == mNbCreaturesByDefinition.end())
+        return;
+
+    if(--it->second == 0)
+        mNbCreaturesByDefinition.erase(it);
+}
+
+uint32_t SeatStats::getNbCreatures(const CreatureDefinition* definition) const
+{
+    auto it = mNbCreaturesByDefinition.find(definition);
+    if(it == mNbCreaturesByDefinition.end())
+        return 0;
+
+    return it->second;
+}
+
+void SeatStats::addRoom(Room* room, RoomType type, int goldStored, int goldStorage)
+{
+    uint32_t index = static_cast<uint32_t>(type);
+    if(index >= mRooms.size())
+    {
+        OD_LOG_ERR("wrong index=" + Helper::toString(index));
+        return;
+    }
+
+    if(mRoomsGold.count(room) > 0)
+    {
+        OD_LOG_ERR("room already indexed");
+        return;
+    }
+
+    mRooms[index].push_back(room);
+
+    RoomGold& roomGold = mRoomsGold[room];
+    roomGold.mType = type;
+    roomGold.mStored = goldStored;
+    roomGold.mStorage = goldStorage;
+    mGoldStored += goldStored;
+    mGoldStorage += goldStorage;
+}
+
+bool SeatStats::removeRoom(Room* room)
+{
+    auto itGold = mRoomsGold.find(room);
+    if(itGold == mRoomsGold.end())
+        return false;
+
+    std::vector<Room*>& rooms = mRooms[static_cast<uint32_t>(itGold->second.mType)];
+    auto it = std::find(rooms.begin(), rooms.end(), room);
+    if(it != rooms.end())
+        rooms.erase(it);
+
+    mGoldStored -= itGold->second.mStored;
+    mGoldStorage -= itGold->second.mStorage;
+    mRoomsGold.erase(itGold);
+    return true;
+}
+
+const std::vector<Room*>& SeatStats::getRooms(RoomType type) const
+{
+    uint32_t index = static_cast<uint32_t>(type);
+    if(index >= mRooms.size())
+    {
+        OD_LOG_ERR("wrong index=" + Helper::toString(index));
+        index = static_cast<uint32_t>(RoomType::nullRoomType);
+    }
+
+    return mRooms[index];
+}
+
+void SeatStats::updateRoomGold(const Room* room, int goldStored, int goldStorage)
+{
+    auto it = mRoomsGold.find(room);
+    if(it == mRoomsGold.end())
+        return;
+
+    RoomGold& roomGold = it->second;
+    mGoldStored += goldStored - roomGold.mStored;
+    mGoldStorage += goldStorage - roomGold.mStorage;
+    roomGold.mStored = goldStored;
+    roomGold.mStorage = goldStorage;
+}
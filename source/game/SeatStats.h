@@ -0,0 +1,117 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SEATSTATS_H
+#define SEATSTATS_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Creature;
+class CreatureDefinition;
+class Room;
+
+enum class RoomType;
+
+/*! \brief Aggregates about what a seat owns on the gamemap (creatures, rooms, treasury gold
+ * and claimed tiles). They are updated when something changes so that reading them does not
+ * require to look at every entity or tile of the gamemap.
+ *
+ * Creatures and rooms are indexed by GameMap when added/removed and move from one seat to the
+ * other when their seat changes. Creatures report class or liveness changes with updateCreature,
+ * rooms report gold changes with updateRoomGold and tiles report claim changes with
+ * addClaimedTile/removeClaimedTile. The entities are only used as keys so that the aggregates do not
+ * depend on the entity classes. In debug builds, GameMap compares the aggregates with a full computation
+ * each turn (see GameMap::checkSeatStats).
+ */
+class SeatStats
+{
+public:
+    SeatStats();
+
+    //! \brief Indexes the creature. countedDefinition is the class the creature is counted in by
+    //! getNbCreatures (nullptr if it should not be counted, for example if it is dead)
+    void addCreature(Creature* creature, const CreatureDefinition* countedDefinition);
+    //! \brief Returns false if the creature was not indexed
+    bool removeCreature(Creature* creature);
+
+    //! \brief Should be called after the class or the liveness of the given creature changed.
+    //! Nothing is done if the creature is not indexed
+    void updateCreature(const Creature* creature, const CreatureDefinition* countedDefinition);
+
+    //! \brief Creatures of the seat (alive or not) in the order they were indexed
+    inline const std::vector<Creature*>& getCreatures() const
+    { return mCreatures; }
+
+    //! \brief Returns the number of alive creatures of the given class
+    uint32_t getNbCreatures(const CreatureDefinition* definition) const;
+
+    //! \brief Indexes the room and adds the gold it stores
+    void addRoom(Room* room, RoomType type, int goldStored, int goldStorage);
+    //! \brief Returns false if the room was not indexed
+    bool removeRoom(Room* room);
+
+    //! \brief Rooms of the given type (destroyed or not) in the order they were indexed
+    const std::vector<Room*>& getRooms(RoomType type) const;
+
+    //! \brief Should be called after the gold stored in the given room or its storage changed.
+    //! Nothing is done if the room is not indexed
+    void updateRoomGold(const Room* room, int goldStored, int goldStorage);
+
+    inline int getGoldStored() const
+    { return mGoldStored; }
+
+    inline int getGoldStorage() const
+    { return mGoldStorage; }
+
+    inline void addClaimedTile()
+    { ++mNbClaimedTiles; }
+
+    inline void removeClaimedTile()
+    { --mNbClaimedTiles; }
+
+    inline uint32_t getNbClaimedTiles() const
+    { return mNbClaimedTiles; }
+
+private:
+    //! \brief Type and gold counted for an indexed room the last time it was updated
+    struct RoomGold
+    {
+        RoomType mType;
+        int mStored;
+        int mStorage;
+    };
+
+    std::vector<Creature*> mCreatures;
+    //! \brief Class each indexed creature is counted in (nullptr if not counted)
+    std::unordered_map<const Creature*, const CreatureDefinition*> mCreaturesCounted;
+    std::unordered_map<const CreatureDefinition*, uint32_t> mNbCreaturesByDefinition;
+
+    //! \brief Rooms indexed by room type
+    std::vector<std::vector<Room*>> mRooms;
+    std::unordered_map<const Room*, RoomGold> mRoomsGold;
+
+    void countCreature(const CreatureDefinition* definition, bool add);
+
+    int mGoldStored;
+    int mGoldStorage;
+    uint32_t mNbClaimedTiles;
+};
+
+#endif // SEATSTATS_H
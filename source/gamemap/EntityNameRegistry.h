@@ -0,0 +1,69 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ENTITYNAMEREGISTRY_H
+#define ENTITYNAMEREGISTRY_H
+
+#include <string>
+#include <unordered_map>
+
+/*! \brief Hashed index of entities by name. GameMap keeps one for each kind of entity it
+ * stores so that finding an entity by name does not depend on the number of entities.
+ * T must have a getName() function. The name of an entity should not change while it is registered.
+ */
+template <typename T>
+class EntityNameRegistry
+{
+public:
+    //! \brief Registers the given entity. Returns false if another entity is already registered with the same name.
+    //! In this case, the first one is kept.
+    bool add(T* entity)
+    {
+        return mEntities.emplace(entity->getName(), entity).second;
+    }
+
+    //! \brief Unregisters the given entity. Returns false if it was not registered
+    bool remove(T* entity)
+    {
+        auto it = mEntities.find(entity->getName());
+        if((it == mEntities.end()) || (it->second != entity))
+            return false;
+
+        mEntities.erase(it);
+        return true;
+    }
+
+    //! \brief Returns the entity with the given name or nullptr if there is none
+    T* get(const std::string& name) const
+    {
+        auto it = mEntities.find(name);
+        if(it == mEntities.end())
+            return nullptr;
+
+        return it->second;
+    }
+
+    void clear()
+    {
+        mEntities.clear();
+    }
+
+private:
+    std::unordered_map<std::string, T*> mEntities;
+};
+
+#endif // ENTITYNAMEREGISTRY_H
@@ -0,0 +1,181 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/EntitySpatialIndex.h"
+
+#include "entities/GameEntity.h"
+#include "entities/Tile.h"
+#include "utils/LogManager.h"
+
+#include <algorithm>
+
+const int EntitySpatialIndex::BUCKET_SIZE = 8;
+
+static bool sortByTileOrder(const EntitySpatialIndex::TileEntity& entity1, const EntitySpatialIndex::TileEntity& entity2)
+{
+    return entity1.mTileOrder < entity2.mTileOrder;
+}
+
+EntitySpatialIndex::EntitySpatialIndex() :
+    mSizeX(0),
+    mSizeY(0),
+    mNbBucketsX(0),
+    mNbBucketsY(0)
+{
+}
+
+void EntitySpatialIndex::clear(int sizeX, int sizeY)
+{
+    mSizeX = sizeX;
+    mSizeY = sizeY;
+    mNbBucketsX = (sizeX + BUCKET_SIZE - 1) / BUCKET_SIZE;
+    mNbBucketsY = (sizeY + BUCKET_SIZE - 1) / BUCKET_SIZE;
+    mBuckets.clear();
+    mBuckets.resize(static_cast<uint32_t>(mNbBucketsX * mNbBucketsY));
+    mMarks.mTileStamps.assign(static_cast<uint32_t>(sizeX * sizeY), 0);
+    mMarks.mTileOrders.assign(static_cast<uint32_t>(sizeX * sizeY), 0);
+    mMarks.mStamp = 0;
+}
+
+std::vector<EntitySpatialIndex::TileEntity>* EntitySpatialIndex::getBucket(Tile* tile)
+{
+    if((tile->getX() < 0) || (tile->getX() >= mSizeX) ||
+       (tile->getY() < 0) || (tile->getY() >= mSizeY))
+    {
+        return nullptr;
+    }
+
+    int bucketX = tile->getX() / BUCKET_SIZE;
+    int bucketY = tile->getY() / BUCKET_SIZE;
+    return &mBuckets[static_cast<uint32_t>(bucketY * mNbBucketsX + bucketX)];
+}
+
+void EntitySpatialIndex::addEntity(GameEntity* entity, Tile* tile)
+{
+    std::vector<TileEntity>* bucket = getBucket(tile);
+    if(bucket == nullptr)
+    {
+        OD_LOG_ERR("entity=" + entity->getName() + ", tile=" + Tile::displayAsString(tile));
+        return;
+    }
+
+    TileEntity tileEntity;
+    tileEntity.mEntity = entity;
+    tileEntity.mTile = tile;
+    tileEntity.mTileOrder = 0;
+    bucket->push_back(tileEntity);
+}
+
+void EntitySpatialIndex::removeEntity(GameEntity* entity, Tile* tile)
+{
+    std::vector<TileEntity>* bucket = getBucket(tile);
+    if(bucket == nullptr)
+        return;
+
+    for(auto it = bucket->begin(); it != bucket->end(); ++it)
+    {
+        if((it->mEntity != entity) || (it->mTile != tile))
+            continue;
+
+        // We keep the insertion order
+        bucket->erase(it);
+        return;
+    }
+
+    OD_LOG_ERR("entity=" + entity->getName() + ", tile=" + Tile::displayAsString(tile));
+}
+
+void EntitySpatialIndex::fillEntitiesOnTiles(const std::vector<Tile*>& tiles, std::vector<TileEntity>& entities)
+{
+    fillEntitiesOnTiles(tiles, entities, mMarks);
+}
+
+void EntitySpatialIndex::fillEntitiesOnTiles(const std::vector<Tile*>& tiles, std::vector<TileEntity>& entities,
+    TileMarks& marks) const
+{
+    entities.clear();
+    if(tiles.empty() || mBuckets.empty())
+        return;
+
+    uint32_t nbTiles = static_cast<uint32_t>(mSizeX * mSizeY);
+    if(marks.mTileStamps.size() != nbTiles)
+    {
+        marks.mTileStamps.assign(nbTiles, 0);
+        marks.mTileOrders.assign(nbTiles, 0);
+        marks.mStamp = 0;
+    }
+
+    ++marks.mStamp;
+    if(marks.mStamp == 0)
+    {
+        // The stamps wrapped around. We reset them
+        std::fill(marks.mTileStamps.begin(), marks.mTileStamps.end(), 0);
+        marks.mStamp = 1;
+    }
+
+    // We mark the given tiles and compute the buckets covering them
+    int minX = mSizeX;
+    int minY = mSizeY;
+    int maxX = -1;
+    int maxY = -1;
+    uint32_t order = 0;
+    for(Tile* tile : tiles)
+    {
+        if((tile == nullptr) ||
+           (tile->getX() < 0) || (tile->getX() >= mSizeX) ||
+           (tile->getY() < 0) || (tile->getY() >= mSizeY))
+        {
+            ++order;
+            continue;
+        }
+
+        uint32_t index = static_cast<uint32_t>(tile->getY() * mSizeX + tile->getX());
+        // If a tile is given more than once, we keep the first one
+        if(marks.mTileStamps[index] != marks.mStamp)
+        {
+            marks.mTileStamps[index] = marks.mStamp;
+            marks.mTileOrders[index] = order;
+        }
+        ++order;
+        minX = std::min(minX, tile->getX());
+        minY = std::min(minY, tile->getY());
+        maxX = std::max(maxX, tile->getX());
+        maxY = std::max(maxY, tile->getY());
+    }
+
+    if(maxX < 0)
+        return;
+
+    for(int bucketY = minY / BUCKET_SIZE; bucketY <= maxY / BUCKET_SIZE; ++bucketY)
+    {
+        for(int bucketX = minX / BUCKET_SIZE; bucketX <= maxX / BUCKET_SIZE; ++bucketX)
+        {
+            for(const TileEntity& tileEntity : mBuckets[static_cast<uint32_t>(bucketY * mNbBucketsX + bucketX)])
+            {
+                uint32_t index = static_cast<uint32_t>(tileEntity.mTile->getY() * mSizeX + tileEntity.mTile->getX());
+                if(marks.mTileStamps[index] != marks.mStamp)
+                    continue;
+
+                entities.push_back(tileEntity);
+                entities.back().mTileOrder = marks.mTileOrders[index];
+            }
+        }
+    }
+
+    // Entities on the same tile come from the same bucket so the stable sort keeps them in insertion order
+    std::stable_sort(entities.begin(), entities.end(), sortByTileOrder);
+}
@@ -0,0 +1,93 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ENTITYSPATIALINDEX_H
+#define ENTITYSPATIALINDEX_H
+
+#include <cstdint>
+#include <vector>
+
+class GameEntity;
+class Tile;
+
+/*! \brief Keeps the entities added on the tiles in buckets of BUCKET_SIZE x BUCKET_SIZE tiles.
+ *
+ * It allows to find the entities on a set of tiles (like the tiles seen by a creature) by only
+ * looking at the buckets covering these tiles instead of each tile.
+ * Within a bucket, entities are kept in insertion order so that the entities on a given tile
+ * are returned in the same order as Tile::fillWithEntities would.
+ */
+class EntitySpatialIndex
+{
+public:
+    struct TileEntity
+    {
+        GameEntity* mEntity;
+        Tile* mTile;
+        //! \brief Index in the tiles given to fillEntitiesOnTiles of the tile the entity is on
+        uint32_t mTileOrder;
+    };
+
+    //! \brief Marks the tiles given to fillEntitiesOnTiles. A tile is marked if its stamp
+    //! equals mStamp. In this case, mTileOrders contains its index in the given tiles.
+    //! Kept between the calls to avoid allocations
+    struct TileMarks
+    {
+        TileMarks() :
+            mStamp(0)
+        {}
+
+        std::vector<uint32_t> mTileStamps;
+        std::vector<uint32_t> mTileOrders;
+        uint32_t mStamp;
+    };
+
+    EntitySpatialIndex();
+
+    //! \brief Forgets every entity and sets the map size
+    void clear(int sizeX, int sizeY);
+
+    //! \brief Should be called when an entity is added/removed on a tile
+    void addEntity(GameEntity* entity, Tile* tile);
+    void removeEntity(GameEntity* entity, Tile* tile);
+
+    //! \brief Fills entities with the entities on the given tiles. They are sorted like the
+    //! given tiles. entities is cleared first.
+    void fillEntitiesOnTiles(const std::vector<Tile*>& tiles, std::vector<TileEntity>& entities);
+
+    //! \brief Same as above but uses the given marks instead of the index ones. As long as
+    //! no entity is added/removed, it can be called from several threads with different marks
+    void fillEntitiesOnTiles(const std::vector<Tile*>& tiles, std::vector<TileEntity>& entities,
+        TileMarks& marks) const;
+
+private:
+    static const int BUCKET_SIZE;
+
+    int mSizeX;
+    int mSizeY;
+    int mNbBucketsX;
+    int mNbBucketsY;
+
+    std::vector<std::vector<TileEntity>> mBuckets;
+
+    //! \brief Marks used by fillEntitiesOnTiles when none is given
+    TileMarks mMarks;
+
+    std::vector<TileEntity>* getBucket(Tile* tile);
+};
+
+#endif // ENTITYSPATIALINDEX_H
@@ -0,0 +1,250 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/FogOfWar.h"
+
+#include "entities/Tile.h"
+#include "game/Seat.h"
+#include "gamemap/GameMap.h"
+#include "utils/LogManager.h"
+
+#include <algorithm>
+
+FogOfWar::FogOfWar(GameMap& gameMap) :
+    mGameMap(gameMap),
+    mSizeX(0),
+    mSizeY(0)
+{
+}
+
+void FogOfWar::clear(int sizeX, int sizeY)
+{
+    mSizeX = sizeX;
+    mSizeY = sizeY;
+    mSources.clear();
+    mSeats.clear();
+    mVisionCounts.clear();
+    mDirtyTiles.clear();
+    mIsTileDirty.assign(static_cast<uint32_t>(sizeX * sizeY), false);
+}
+
+void FogOfWar::removeAllSources()
+{
+    for(std::pair<const GameEntity* const, Source>& p : mSources)
+    {
+        fillSeatIndexes(p.second.mSeat);
+        removeVision(p.second.mTiles);
+    }
+    mSources.clear();
+}
+
+void FogOfWar::setSourceVision(const GameEntity* source, Seat* seat, const std::vector<Tile*>& tiles, bool persistent)
+{
+    auto it = mSources.find(source);
+    if(it == mSources.end())
+    {
+        if(tiles.empty())
+            return;
+
+        Source& newSource = mSources[source];
+        newSource.mSeat = seat;
+        newSource.mTiles = tiles;
+        newSource.mPersistent = persistent;
+        newSource.mRefreshed = true;
+        fillSeatIndexes(seat);
+        addVision(tiles);
+        return;
+    }
+
+    // We add the new vision before removing the old one so that tiles seen by both are not lost
+    Source& oldSource = it->second;
+    fillSeatIndexes(seat);
+    addVision(tiles);
+    fillSeatIndexes(oldSource.mSeat);
+    removeVision(oldSource.mTiles);
+
+    if(tiles.empty())
+    {
+        mSources.erase(it);
+        return;
+    }
+
+    oldSource.mSeat = seat;
+    oldSource.mTiles = tiles;
+    oldSource.mPersistent = persistent;
+    oldSource.mRefreshed = true;
+}
+
+bool FogOfWar::keepSourceVision(const GameEntity* source, Seat* seat)
+{
+    auto it = mSources.find(source);
+    if(it == mSources.end())
+        return false;
+
+    if(it->second.mSeat != seat)
+        return false;
+
+    it->second.mRefreshed = true;
+    return true;
+}
+
+void FogOfWar::removeSource(const GameEntity* source)
+{
+    auto it = mSources.find(source);
+    if(it == mSources.end())
+        return;
+
+    fillSeatIndexes(it->second.mSeat);
+    removeVision(it->second.mTiles);
+    mSources.erase(it);
+}
+
+void FogOfWar::markTileDirty(Tile* tile)
+{
+    uint32_t index = static_cast<uint32_t>(tile->getY() * mSizeX + tile->getX());
+    if(index >= mIsTileDirty.size())
+        return;
+
+    if(mIsTileDirty[index])
+        return;
+
+    mIsTileDirty[index] = true;
+    mDirtyTiles.push_back(tile);
+}
+
+void FogOfWar::markAllTilesDirty()
+{
+    for(int yy = 0; yy < mSizeY; ++yy)
+    {
+        for(int xx = 0; xx < mSizeX; ++xx)
+            markTileDirty(mGameMap.getTile(xx, yy));
+    }
+}
+
+void FogOfWar::getDirtyTiles(std::vector<Tile*>& tiles)
+{
+    tiles.swap(mDirtyTiles);
+    mDirtyTiles.clear();
+    for(Tile* tile : tiles)
+        mIsTileDirty[static_cast<uint32_t>(tile->getY() * mSizeX + tile->getX())] = false;
+}
+
+void FogOfWar::startTurn()
+{
+    for(std::pair<const GameEntity* const, Source>& p : mSources)
+        p.second.mRefreshed = false;
+}
+
+void FogOfWar::endTurn()
+{
+    for(auto it = mSources.begin(); it != mSources.end();)
+    {
+        Source& source = it->second;
+        if(source.mPersistent || source.mRefreshed)
+        {
+            ++it;
+            continue;
+        }
+
+        fillSeatIndexes(source.mSeat);
+        removeVision(source.mTiles);
+        it = mSources.erase(it);
+    }
+}
+
+uint32_t FogOfWar::getSeatIndex(Seat* seat)
+{
+    auto it = std::find(mSeats.begin(), mSeats.end(), seat);
+    if(it != mSeats.end())
+        return static_cast<uint32_t>(it - mSeats.begin());
+
+    mSeats.push_back(seat);
+    mVisionCounts.emplace_back(static_cast<uint32_t>(mSizeX * mSizeY), 0);
+    return static_cast<uint32_t>(mSeats.size() - 1);
+}
+
+void FogOfWar::fillSeatIndexes(Seat* seat)
+{
+    mSeatIndexes.clear();
+    if(seat == nullptr)
+    {
+        for(Seat* s : mGameMap.getSeats())
+            mSeatIndexes.push_back(getSeatIndex(s));
+
+        return;
+    }
+
+    mSeatIndexes.push_back(getSeatIndex(seat));
+    for(Seat* alliedSeat : seat->getAlliedSeats())
+    {
+        uint32_t index = getSeatIndex(alliedSeat);
+        if(std::find(mSeatIndexes.begin(), mSeatIndexes.end(), index) != mSeatIndexes.end())
+            continue;
+
+        mSeatIndexes.push_back(index);
+    }
+}
+
+void FogOfWar::addVision(const std::vector<Tile*>& tiles)
+{
+    for(uint32_t seatIndex : mSeatIndexes)
+    {
+        Seat* seat = mSeats[seatIndex];
+        std::vector<uint16_t>& counts = mVisionCounts[seatIndex];
+        for(Tile* tile : tiles)
+        {
+            uint32_t index = static_cast<uint32_t>(tile->getY() * mSizeX + tile->getX());
+            if(index >= counts.size())
+            {
+                OD_LOG_ERR("Tile=" + Tile::displayAsString(tile));
+                continue;
+            }
+
+            ++counts[index];
+            if(counts[index] != 1)
+                continue;
+
+            tile->notifyVisionGained(seat);
+            seat->notifyVisionOnTile(tile);
+        }
+    }
+}
+
+void FogOfWar::removeVision(const std::vector<Tile*>& tiles)
+{
+    for(uint32_t seatIndex : mSeatIndexes)
+    {
+        Seat* seat = mSeats[seatIndex];
+        std::vector<uint16_t>& counts = mVisionCounts[seatIndex];
+        for(Tile* tile : tiles)
+        {
+            uint32_t index = static_cast<uint32_t>(tile->getY() * mSizeX + tile->getX());
+            if((index >= counts.size()) || (counts[index] == 0))
+            {
+                OD_LOG_ERR("Tile=" + Tile::displayAsString(tile));
+                continue;
+            }
+
+            --counts[index];
+            if(counts[index] != 0)
+                continue;
+
+            tile->notifyVisionLost(seat);
+            seat->notifyVisionLostOnTile(tile);
+        }
+    }
+}
@@ -0,0 +1,112 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FOGOFWAR_H
+#define FOGOFWAR_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class GameEntity;
+class GameMap;
+class Seat;
+class Tile;
+
+/*! \brief Keeps track of the tiles each seat has vision on.
+ *
+ * Every vision source (claimed tile, creature, spell, ...) registers the tiles it gives vision on. For
+ * each seat and each tile, the number of sources giving vision is counted. When a count goes from 0 to 1,
+ * the tile and the seat are notified that vision is gained. When it goes back to 0, that vision is lost.
+ * That way, only the sources that changed cost something.
+ *
+ * A source gives vision to its seat and the allied seats. A source with no seat gives vision to every seat.
+ * Persistent sources (tiles) keep their vision until they are set again. The other ones (creatures, spells)
+ * must be refreshed each turn between startTurn and endTurn or they will be removed.
+ * The sources are only used as keys and never dereferenced. Thus, deleted entities are not a problem.
+ */
+class FogOfWar
+{
+public:
+    FogOfWar(GameMap& gameMap);
+
+    //! \brief Forgets everything without notifying. Called when the map is resized or cleared.
+    void clear(int sizeX, int sizeY);
+
+    //! \brief Removes every source. Vision lost is notified for every tile seen.
+    void removeAllSources();
+
+    //! \brief Sets the tiles the given source gives vision on.
+    void setSourceVision(const GameEntity* source, Seat* seat, const std::vector<Tile*>& tiles, bool persistent);
+
+    //! \brief Marks the given source as refreshed for this turn without changing its tiles. Returns false if the
+    //! source is unknown or was set for another seat. In this case, setSourceVision should be called.
+    bool keepSourceVision(const GameEntity* source, Seat* seat);
+
+    //! \brief Removes the given source
+    void removeSource(const GameEntity* source);
+
+    //! \brief Flags the given tile to be processed by getDirtyTiles
+    void markTileDirty(Tile* tile);
+    void markAllTilesDirty();
+
+    //! \brief Returns the tiles marked dirty since last call and clears the list
+    void getDirtyTiles(std::vector<Tile*>& tiles);
+
+    void startTurn();
+
+    //! \brief Removes the not persistent sources that were not refreshed since startTurn
+    void endTurn();
+
+private:
+    struct Source
+    {
+        Seat* mSeat;
+        std::vector<Tile*> mTiles;
+        bool mPersistent;
+        bool mRefreshed;
+    };
+
+    GameMap& mGameMap;
+
+    int mSizeX;
+    int mSizeY;
+
+    std::unordered_map<const GameEntity*, Source> mSources;
+
+    //! \brief Seats known. The index of a seat in this vector is used in mVisionCounts
+    std::vector<Seat*> mSeats;
+
+    //! \brief Number of sources giving vision per seat index and per tile index
+    std::vector<std::vector<uint16_t>> mVisionCounts;
+
+    std::vector<Tile*> mDirtyTiles;
+    std::vector<bool> mIsTileDirty;
+
+    //! \brief Buffer used to compute the seats a source gives vision to
+    std::vector<uint32_t> mSeatIndexes;
+
+    uint32_t getSeatIndex(Seat* seat);
+
+    //! \brief Fills mSeatIndexes with the indexes of the seats seat gives vision to
+    void fillSeatIndexes(Seat* seat);
+
+    void addVision(const std::vector<Tile*>& tiles);
+    void removeVision(const std::vector<Tile*>& tiles);
+};
+
+#endif // FOGOFWAR_H
@@ -59,7 +59,10 @@
 #include "utils/ConfigManager.h"
 #include "utils/Helper.h"
 #include "utils/LogManager.h"
+#include "utils/MakeUnique.h"
 #include "utils/ResourceManager.h"
+#include "utils/ThreadPool.h"
+#include "utils/TraceRecorder.h"
 
 #include <OgreTimer.h>
 
@@ -73,74 +76,12 @@
 
 const std::string DEFAULT_NICK = "You";
 
-using namespace std;
-
-/*! \brief A helper class for the A* search in the GameMap::path function.
-*
-* This class stores the requisite information about a tile which is placed in
-* the search queue for the A-star, or A*, algorithm which is used to
-* calculate paths in the path function.
-*
-* The A* description can be found here:
-* http://en.wikipedia.org/wiki/A*_search_algorithm
-*/
-class AstarEntry
-{
-public:
-    AstarEntry() :
-        tile    (nullptr),
-        parent  (nullptr),
-        g       (0.0),
-        h       (0.0)
-    {}
-
-    AstarEntry(Tile* tile, int x1, int y1, int x2, int y2) :
-        tile    (tile),
-        parent  (nullptr),
-        g       (0.0),
-        h       (0.0)
-    {
-        h = computeHeuristic(x1, y1, x2, y2);
-    }
-
-    static double computeHeuristic(const int& x1, const int& y1, const int& x2, const int& y2)
-    {
-        return fabs(static_cast<double>(x2 - x1)) + fabs(static_cast<double>(y2 - y1));
-    }
-
-    void setHeuristic(const int& x1, const int& y1, const int& x2, const int& y2)
-    {
-        h = fabs(static_cast<double>(x2 - x1)) + fabs(static_cast<double>(y2 - y1));
-    }
-
-    inline double fCost() const
-    { return g + h; }
-
-    inline Tile* getTile() const
-    { return tile; }
-
-    inline void setTile(Tile* newTile)
-    { tile = newTile; }
-
-    inline AstarEntry* getParent() const
-    { return parent; }
-
-    inline void setParent(AstarEntry* newParent)
-    { parent = newParent; }
-
-    inline const double& getG() const
-    { return g; }
-
-    inline void setG(const double& newG)
-    { g = newG; }
-
-private:
-    Tile*       tile;
-    AstarEntry* parent;
-    double      g;
-    double      h;
-};
+//! \brief Paths with a manhattan distance longer than this are computed with the abstraction graph
+const int HIERARCHICAL_PATH_MIN_DISTANCE = 2 * HierarchicalPathfinding::CLUSTER_SIZE;
+//! \brief Below this number of creatures per thread, sensing them is cheaper than waking the workers
+const uint32_t MIN_CREATURES_SENSED_PER_THREAD = 16;
 
+using namespace std;
 
 GameMap::GameMap(bool isServerGameMap) :
         TileContainer(isServerGameMap ? 15 : 0),
@@ -148,11 +89,22 @@ GameMap::GameMap(bool isServerGameMap) :
         mLocalPlayer(nullptr),
         mLocalPlayerNick(DEFAULT_NICK),
         mTurnNumber(-1),
+        mNbFloodFillLayers(1),
         mIsPaused(false),
         mTimePayDay(0),
         mFloodFillEnabled(false),
         mIsFOWActivated(true),
         mNumCallsTo_path(0),
+        mNumPathCacheHits(0),
+        mNumPathCacheMisses(0),
+        mSenseUpkeepTime(0),
+        mVisionUpkeepTime(0),
+        mActiveObjectsUpkeepTime(0),
+        mPassabilityEpoch(0),
+        mHierarchicalPathfinding(static_cast<uint32_t>(FloodFillType::nbValues),
+            [this](int x, int y, uint32_t type) { return isHierarchicalPathPassable(x, y, type); }),
+        mFogOfWar(*this),
+        mFogOfWarComputedActivated(true),
         mAiManager(*this),
         mTileSet(nullptr)
 {
@@ -218,6 +170,8 @@ bool GameMap::createNewMap(int sizeX, int sizeY)
     if (!allocateMapMemory(sizeX, sizeY))
         return false;
 
+    mEntitySpatialIndex.clear(sizeX, sizeY);
+
     for (int jj = 0; jj < mMapSizeY; ++jj)
     {
         for (int ii = 0; ii < mMapSizeX; ++ii)
@@ -234,7 +188,7 @@ bool GameMap::createNewMap(int sizeX, int sizeY)
     return true;
 }
 
-void GameMap::setAllFullnessAndNeighbors()
+void GameMap::setAllFullness()
 {
     for (int ii = 0; ii < mMapSizeX; ++ii)
     {
@@ -242,13 +196,20 @@ void GameMap::setAllFullnessAndNeighbors()
         {
             Tile* tile = getTile(ii, jj);
             tile->setFullness(tile->getFullness());
-            setTileNeighbors(tile);
         }
     }
+
+    if(mIsServerGameMap)
+    {
+        mHierarchicalPathfinding.reset(getMapSizeX(), getMapSizeY());
+        mFogOfWar.clear(getMapSizeX(), getMapSizeY());
+        mFogOfWar.markAllTilesDirty();
+    }
 }
 
 void GameMap::clearAll()
 {
+    mFogOfWar.clear(0, 0);
     clearCreatures();
     clearClasses();
     clearWeapons();
@@ -264,6 +225,8 @@ void GameMap::clearAll()
     processDeletionQueues();
 
     clearTiles();
+    mEntitySpatialIndex.clear(0, 0);
+    mEntitiesById.clear();
     processActiveObjectsChanges();
     processDeletionQueues();
 
@@ -316,6 +279,7 @@ void GameMap::clearAll()
             OD_LOG_ERR("entity not removed=" + entity->getName());
         }
         mAnimatedObjects.clear();
+        mAnimatedObjectsByName.clear();
     }
     if(!mEntitiesToDelete.empty())
     {
@@ -348,6 +312,7 @@ void GameMap::clearCreatures()
     }
 
     mCreatures.clear();
+    mCreaturesByName.clear();
 }
 
 void GameMap::clearAiManager()
@@ -394,6 +359,7 @@ void GameMap::clearRenderedMovableEntities()
     }
 
     mRenderedMovableEntities.clear();
+    mRenderedMovableEntitiesByName.clear();
 }
 
 void GameMap::clearPlayers()
@@ -413,6 +379,82 @@ void GameMap::resetUniqueNumbers()
     mUniqueNumberTrap = 0;
     mUniqueNumberMapLight = 0;
     mUniqueFloodFillValue = 0;
+    mUniqueEntityId = 0;
+    mFloodFillColorSets.clear();
+}
+
+void GameMap::registerEntityId(MovableGameEntity* entity)
+{
+    if(isServerGameMap() && (entity->getId() == 0))
+        entity->setId(++mUniqueEntityId);
+
+    // On client side, entities created locally (for example, in the editor) have no id and
+    // cannot be referenced by the server
+    if(entity->getId() == 0)
+        return;
+
+    if(!mEntitiesById.emplace(entity->getId(), entity).second)
+        OD_LOG_ERR("Entity id already used=" + Helper::toString(entity->getId()) + ", name=" + entity->getName());
+}
+
+void GameMap::unregisterEntityId(MovableGameEntity* entity)
+{
+    if(entity->getId() == 0)
+        return;
+
+    auto it = mEntitiesById.find(entity->getId());
+    if((it == mEntitiesById.end()) || (it->second != entity))
+        return;
+
+    mEntitiesById.erase(it);
+}
+
+MovableGameEntity* GameMap::getEntityById(uint32_t id) const
+{
+    auto it = mEntitiesById.find(id);
+    if(it == mEntitiesById.end())
+        return nullptr;
+
+    return it->second;
+}
+
+Creature* GameMap::getCreatureById(uint32_t id) const
+{
+    MovableGameEntity* entity = getEntityById(id);
+    if(entity == nullptr)
+        return nullptr;
+
+    // The name registry tells us if the entity is a creature without having to cast
+    Creature* creature = mCreaturesByName.get(entity->getName());
+    if(creature != entity)
+        return nullptr;
+
+    return creature;
+}
+
+MovableGameEntity* GameMap::getAnimatedObjectById(uint32_t id) const
+{
+    MovableGameEntity* entity = getEntityById(id);
+    if(entity == nullptr)
+        return nullptr;
+
+    if(mAnimatedObjectsByName.get(entity->getName()) != entity)
+        return nullptr;
+
+    return entity;
+}
+
+RenderedMovableEntity* GameMap::getRenderedMovableEntityById(uint32_t id) const
+{
+    MovableGameEntity* entity = getEntityById(id);
+    if(entity == nullptr)
+        return nullptr;
+
+    RenderedMovableEntity* obj = mRenderedMovableEntitiesByName.get(entity->getName());
+    if(obj != entity)
+        return nullptr;
+
+    return obj;
 }
 
 void GameMap::addClassDescription(const CreatureDefinition *c)
@@ -502,6 +544,11 @@ void GameMap::addCreature(Creature *cc)
         + ", seatId=" + (cc->getSeat() != nullptr ? Helper::toString(cc->getSeat()->getId()) : std::string("null")));
 
     mCreatures.push_back(cc);
+    if(!mCreaturesByName.add(cc))
+        OD_LOG_ERR("Creature name already used=" + cc->getName());
+    registerEntityId(cc);
+    if(cc->getSeat() != nullptr)
+        cc->getSeat()->getStats().addCreature(cc, cc->getAliveDefinition());
 }
 
 void GameMap::removeCreature(Creature *c)
@@ -516,6 +563,10 @@ void GameMap::removeCreature(Creature *c)
     }
 
     mCreatures.erase(it);
+    mCreaturesByName.remove(c);
+    unregisterEntityId(c);
+    if(c->getSeat() != nullptr)
+        c->getSeat()->getStats().removeCreature(c);
 }
 
 void GameMap::queueEntityForDeletion(GameEntity *ge)
@@ -578,11 +629,13 @@ std::vector<Creature*> GameMap::getCreaturesByAlliedSeat(const Seat* seat) const
 std::vector<Creature*> GameMap::getCreaturesBySeat(const Seat* seat) const
 {
     std::vector<Creature*> tempVector;
+    if(seat == nullptr)
+        return tempVector;
 
-    // Loop over all the creatures in the GameMap and add them to the temp vector if their seat matches the one in parameter.
-    for (Creature* creature : mCreatures)
+    // The seat stats know the creatures of the seat
+    for (Creature* creature : seat->getStats().getCreatures())
     {
-        if (creature->getSeat() == seat && creature->isAlive())
+        if (creature->isAlive())
             tempVector.push_back(creature);
     }
 
@@ -818,6 +871,7 @@ Creature* GameMap::getFighterToPickupBySeat(Seat* seat)
 void GameMap::addAnimatedObject(MovableGameEntity *a)
 {
     mAnimatedObjects.push_back(a);
+    mAnimatedObjectsByName.add(a);
 }
 
 void GameMap::removeAnimatedObject(MovableGameEntity *a)
@@ -827,17 +881,12 @@ void GameMap::removeAnimatedObject(MovableGameEntity *a)
         return;
 
     mAnimatedObjects.erase(it);
+    mAnimatedObjectsByName.remove(a);
 }
 
 MovableGameEntity* GameMap::getAnimatedObject(const std::string& name) const
 {
-    for (MovableGameEntity* mge : mAnimatedObjects)
-    {
-        if (mge->getName().compare(name) == 0)
-            return mge;
-    }
-
-    return nullptr;
+    return mAnimatedObjectsByName.get(name);
 }
 
 void GameMap::addRenderedMovableEntity(RenderedMovableEntity *obj)
@@ -845,6 +894,9 @@ void GameMap::addRenderedMovableEntity(RenderedMovableEntity *obj)
     OD_LOG_INF(serverStr() + "Adding rendered object " + obj->getName()
         + ",MeshName=" + obj->getMeshName());
     mRenderedMovableEntities.push_back(obj);
+    if(!mRenderedMovableEntitiesByName.add(obj))
+        OD_LOG_ERR("Rendered object name already used=" + obj->getName());
+    registerEntityId(obj);
 }
 
 void GameMap::removeRenderedMovableEntity(RenderedMovableEntity *obj)
@@ -859,16 +911,13 @@ void GameMap::removeRenderedMovableEntity(RenderedMovableEntity *obj)
     }
 
     mRenderedMovableEntities.erase(it);
+    mRenderedMovableEntitiesByName.remove(obj);
+    unregisterEntityId(obj);
 }
 
 RenderedMovableEntity* GameMap::getRenderedMovableEntity(const std::string& name)
 {
-    for(RenderedMovableEntity* renderedMovableEntity : mRenderedMovableEntities)
-    {
-        if(name.compare(renderedMovableEntity->getName()) == 0)
-            return renderedMovableEntity;
-    }
-    return nullptr;
+    return mRenderedMovableEntitiesByName.get(name);
 }
 
 void GameMap::addActiveObject(GameEntity *a)
@@ -1079,21 +1128,24 @@ void GameMap::destroyAllEntities()
 
 Creature* GameMap::getCreature(const std::string& cName) const
 {
-    for (Creature* creature : mCreatures)
-    {
-        if (creature->getName().compare(cName) == 0)
-            return creature;
-    }
-    return nullptr;
+    return mCreaturesByName.get(cName);
 }
 
 void GameMap::doTurn(double timeSinceLastTurn)
 {
     OD_LOG_INF("Computing turn " + Helper::toString(mTurnNumber) + ", timeSinceLastTurn=" + Helper::toString(timeSinceLastTurn));
     unsigned int numCallsTo_path_atStart = mNumCallsTo_path;
+    unsigned int numPathCacheHits_atStart = mNumPathCacheHits;
+    unsigned int numPathCacheMisses_atStart = mNumPathCacheMisses;
+
+    // Paths are only kept during one turn
+    mPathCache.clear();
 
+    TraceRecorder::PhaseScope tracePhaseMiscUpkeep(TracePhase::miscUpkeep);
     uint32_t miscUpkeepTime = doMiscUpkeep(timeSinceLastTurn);
+    tracePhaseMiscUpkeep.end();
 
+    TraceRecorder::PhaseScope tracePhasePlayersUpkeep(TracePhase::playersUpkeep);
     for (Seat* seat : mSeats)
     {
         if(seat->getPlayer() == nullptr)
@@ -1101,9 +1153,94 @@ void GameMap::doTurn(double timeSinceLastTurn)
 
         seat->getPlayer()->upkeepPlayer(timeSinceLastTurn);
     }
+    tracePhasePlayersUpkeep.end();
 
     OD_LOG_INF("During this turn there were " + Helper::toString(mNumCallsTo_path - numCallsTo_path_atStart)
-        + " calls to GameMap::path(), miscUpkeepTime=" + Helper::toString(miscUpkeepTime));
+        + " calls to GameMap::path() (cache hits=" + Helper::toString(mNumPathCacheHits - numPathCacheHits_atStart)
+        + ", misses=" + Helper::toString(mNumPathCacheMisses - numPathCacheMisses_atStart)
+        + "), miscUpkeepTime=" + Helper::toString(miscUpkeepTime));
+}
+
+void GameMap::senseCreaturesUpkeep()
+{
+    TraceRecorder::PhaseScope tracePhase(TracePhase::creaturesSense);
+
+    if(mThreadPool == nullptr)
+        mThreadPool = Utils::make_unique<ThreadPool>(ThreadPool::getDefaultNbWorkers());
+
+    // The creatures compute their line of sight concurrently so the tile distances have to be ready
+    int maxSightRadius = 0;
+    for(Creature* creature : mCreatures)
+        maxSightRadius = std::max(maxSightRadius, creature->getDefinition()->getSightRadius());
+
+    reserveSightRadius(maxSightRadius);
+
+    mThreadPool->parallelFor(static_cast<uint32_t>(mCreatures.size()), [this](uint32_t index)
+    {
+        mCreatures[index]->senseUpkeep();
+    }, MIN_CREATURES_SENSED_PER_THREAD);
+}
+
+void GameMap::visionUpkeep()
+{
+    TraceRecorder::PhaseScope tracePhase(TracePhase::vision);
+
+    // At each upkeep, we re-compute vision for the sources that may have changed. We need to
+    // compute every seats including AI because a human can be allied with an AI and they would share vision
+    if(mFogOfWarComputedActivated != mIsFOWActivated)
+    {
+        mFogOfWarComputedActivated = mIsFOWActivated;
+        mFogOfWar.removeAllSources();
+        mFogOfWar.markAllTilesDirty();
+    }
+
+    mFogOfWar.startTurn();
+
+    // Claimed tiles only change when claimed/unclaimed
+    mFogOfWar.getDirtyTiles(mVisionDirtyTiles);
+    for(Tile* tile : mVisionDirtyTiles)
+        tile->computeVisibleTiles();
+
+    for (Creature* creature : mCreatures)
+    {
+        creature->computeVisibleTiles();
+    }
+
+    for (Spell* spell : mSpells)
+    {
+        spell->computeVisibleTiles();
+    }
+
+    // Creatures and spells that did not refresh their vision (removed from the map, dead, ...) lose it
+    mFogOfWar.endTurn();
+
+    for (Seat* seat : mSeats)
+    {
+        if(!seat->getIsDebuggingVision())
+            continue;
+
+        seat->refreshSeatVisualDebug();
+    }
+
+    // We send to each seat the list of tiles he has vision on
+    for (Seat* seat : mSeats)
+        seat->sendVisibleTiles();
+}
+
+void GameMap::activeObjectsUpkeep()
+{
+    TraceRecorder::PhaseScope tracePhase(TracePhase::activeObjectsUpkeep);
+
+    // Carry out the upkeep round of all the active objects in the game.
+    unsigned int activeObjectCount = 0;
+    unsigned int nbActiveObjectCount = mActiveObjects.size();
+    while (activeObjectCount < nbActiveObjectCount)
+    {
+        GameEntity* ge = mActiveObjects[activeObjectCount];
+        ge->doUpkeep();
+
+        ++activeObjectCount;
+    }
 }
 
 void GameMap::doPlayerAITurn(double timeSinceLastTurn)
@@ -1113,7 +1250,6 @@ void GameMap::doPlayerAITurn(double timeSinceLastTurn)
 
 unsigned long int GameMap::doMiscUpkeep(double timeSinceLastTurn)
 {
-    Tile *tempTile;
     Ogre::Timer stopwatch;
     unsigned long int timeTaken;
 
@@ -1199,60 +1335,19 @@ unsigned long int GameMap::doMiscUpkeep(double timeSinceLastTurn)
             ++(tempSeat->mNumCreaturesFighters);
     }
 
-    // At each upkeep, we re-compute tiles with vision
-    for (Seat* seat : mSeats)
-        seat->clearTilesWithVision();
-
-    for (int jj = 0; jj < getMapSizeY(); ++jj)
-    {
-        for (int ii = 0; ii < getMapSizeX(); ++ii)
-        {
-            getTile(ii,jj)->clearVision();
-        }
-    }
-
-    // Compute vision. We need to compute every seats including AI because
-    // a human can be allied with an AI and they would share vision
-    for (int jj = 0; jj < getMapSizeY(); ++jj)
-    {
-        for (int ii = 0; ii < getMapSizeX(); ++ii)
-        {
-            getTile(ii,jj)->computeVisibleTiles();
-        }
-    }
-
-    for (Creature* creature : mCreatures)
-    {
-        creature->computeVisibleTiles();
-    }
+    // The creatures compute what they perceive before anything moves so that the order they are processed in
+    // does not matter. It also computes their line of sight that is used by the vision
+    Ogre::Timer phaseStopwatch;
+    senseCreaturesUpkeep();
+    mSenseUpkeepTime = phaseStopwatch.getMicroseconds();
 
-    for (Spell* spell : mSpells)
-    {
-        spell->computeVisibleTiles();
-    }
+    phaseStopwatch.reset();
+    visionUpkeep();
+    mVisionUpkeepTime = phaseStopwatch.getMicroseconds();
 
-    for (Seat* seat : mSeats)
-    {
-        if(!seat->getIsDebuggingVision())
-            continue;
-
-        seat->refreshSeatVisualDebug();
-    }
-
-    // We send to each seat the list of tiles he has vision on
-    for (Seat* seat : mSeats)
-        seat->sendVisibleTiles();
-
-    // Carry out the upkeep round of all the active objects in the game.
-    unsigned int activeObjectCount = 0;
-    unsigned int nbActiveObjectCount = mActiveObjects.size();
-    while (activeObjectCount < nbActiveObjectCount)
-    {
-        GameEntity* ge = mActiveObjects[activeObjectCount];
-        ge->doUpkeep();
-
-        ++activeObjectCount;
-    }
+    phaseStopwatch.reset();
+    activeObjectsUpkeep();
+    mActiveObjectsUpkeepTime = phaseStopwatch.getMicroseconds();
 
     // Carry out the upkeep round for each seat. This means recomputing how much gold is
     // available in their treasuries, how much mana they gain/lose during this turn, etc.
@@ -1278,43 +1373,106 @@ unsigned long int GameMap::doMiscUpkeep(double timeSinceLastTurn)
                 seat->mMana = maxMana;
         }
 
-        // Update the count on how much gold is available in all of the treasuries claimed by the given seat.
-        seat->mGold = 0;
-        seat->mGoldMax = 0;
-        for (Room* room : getRooms())
-        {
-            if(room->getSeat() != seat)
-                continue;
-
-            seat->mGold += room->getTotalGoldStored();
-            seat->mGoldMax += room->getTotalGoldStorage();
-        }
+        // The treasuries report their gold changes to the seat stats
+        seat->mGold = seat->getStats().getGoldStored();
+        seat->mGoldMax = seat->getStats().getGoldStorage();
     }
 
-    // Determine the number of tiles claimed by each seat.
-    // Begin by setting the number of claimed tiles for each seat to 0.
+    // Tiles report their claim changes to the seat stats
     for (Seat* seat : mSeats)
-        seat->setNumClaimedTiles(0);
+        seat->setNumClaimedTiles(seat->getStats().getNbClaimedTiles());
 
-    // Now loop over all of the tiles, if the tile is claimed increment the given seats count.
-    for (int jj = 0; jj < getMapSizeY(); ++jj)
+#ifdef OD_DEBUG
+    checkSeatStats();
+#endif
+
+    timeTaken = stopwatch.getMicroseconds();
+    return timeTaken;
+}
+
+#ifdef OD_DEBUG
+void GameMap::checkSeatStats()
+{
+    for (Seat* seat : mSeats)
     {
-        for (int ii = 0; ii < getMapSizeX(); ++ii)
+        const SeatStats& stats = seat->getStats();
+
+        std::vector<Creature*> creatures;
+        std::map<const CreatureDefinition*, uint32_t> nbCreaturesByDefinition;
+        for (Creature* creature : mCreatures)
+        {
+            if(creature->getSeat() != seat)
+                continue;
+
+            creatures.push_back(creature);
+            if(creature->getAliveDefinition() != nullptr)
+                ++nbCreaturesByDefinition[creature->getAliveDefinition()];
+        }
+        for (const std::pair<const CreatureDefinition* const, uint32_t>& nbCreatures : nbCreaturesByDefinition)
+        {
+            if(nbCreatures.second != stats.getNbCreatures(nbCreatures.first))
+            {
+                OD_LOG_ERR("seatId=" + Helper::toString(seat->getId()) + ", class=" + nbCreatures.first->getClassName()
+                    + ", nbCreatures=" + Helper::toString(nbCreatures.second)
+                    + ", stats nbCreatures=" + Helper::toString(stats.getNbCreatures(nbCreatures.first)));
+            }
+        }
+        std::vector<Creature*> statsCreatures = stats.getCreatures();
+        std::sort(creatures.begin(), creatures.end());
+        std::sort(statsCreatures.begin(), statsCreatures.end());
+        if(creatures != statsCreatures)
         {
-            tempTile = getTile(ii,jj);
+            OD_LOG_ERR("seatId=" + Helper::toString(seat->getId()) + ", nbCreatures=" + Helper::toString(creatures.size())
+                + ", stats nbCreatures=" + Helper::toString(statsCreatures.size()));
+        }
+
+        int goldStored = 0;
+        int goldStorage = 0;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(RoomType::nbRooms); ++i)
+        {
+            RoomType type = static_cast<RoomType>(i);
+            std::vector<Room*> rooms;
+            for (Room* room : mRooms)
+            {
+                if((room->getSeat() != seat) || (room->getType() != type))
+                    continue;
 
-            // Check to see if the current tile is claimed by anyone.
-            if (tempTile->isClaimed())
+                rooms.push_back(room);
+                goldStored += room->getTotalGoldStored();
+                goldStorage += room->getTotalGoldStorage();
+            }
+            std::vector<Room*> statsRooms = stats.getRooms(type);
+            std::sort(rooms.begin(), rooms.end());
+            std::sort(statsRooms.begin(), statsRooms.end());
+            if(rooms != statsRooms)
             {
-                // Increment the count of the seat who owns the tile.
-                tempTile->getSeat()->incrementNumClaimedTiles();
+                OD_LOG_ERR("seatId=" + Helper::toString(seat->getId()) + ", roomType=" + RoomManager::getRoomNameFromRoomType(type)
+                    + ", nbRooms=" + Helper::toString(rooms.size()) + ", stats nbRooms=" + Helper::toString(statsRooms.size()));
             }
         }
-    }
 
-    timeTaken = stopwatch.getMicroseconds();
-    return timeTaken;
+        if((goldStored != stats.getGoldStored()) || (goldStorage != stats.getGoldStorage()))
+        {
+            OD_LOG_ERR("seatId=" + Helper::toString(seat->getId()) + ", gold=" + Helper::toString(goldStored)
+                + ", stats gold=" + Helper::toString(stats.getGoldStored()) + ", goldMax=" + Helper::toString(goldStorage)
+                + ", stats goldMax=" + Helper::toString(stats.getGoldStorage()));
+        }
+
+        // The claimed state and seat are read from the tile fields stored by the container
+        uint32_t nbClaimedTiles = 0;
+        for (uint32_t tileIndex = 0; tileIndex < getNbTiles(); ++tileIndex)
+        {
+            if(isTileClaimed(tileIndex) && (getTileSeat(tileIndex) == seat))
+                ++nbClaimedTiles;
+        }
+        if(nbClaimedTiles != stats.getNbClaimedTiles())
+        {
+            OD_LOG_ERR("seatId=" + Helper::toString(seat->getId()) + ", nbClaimedTiles=" + Helper::toString(nbClaimedTiles)
+                + ", stats nbClaimedTiles=" + Helper::toString(stats.getNbClaimedTiles()));
+        }
+    }
 }
+#endif // OD_DEBUG
 
 void GameMap::updateAnimations(Ogre::Real timeSinceLastFrame)
 {
@@ -1358,7 +1516,7 @@ void GameMap::playerIsFighting(Player* player, Tile* tile)
     }
 }
 
-std::list<Tile*> GameMap::findBestPath(const Creature* creature, Tile* tileStart, const std::vector<Tile*> possibleDests,
+std::list<Tile*> GameMap::findBestPath(const Creature* creature, Tile* tileStart, const std::vector<Tile*>& possibleDests,
     Tile*& chosenTile)
 {
     chosenTile = nullptr;
@@ -1399,12 +1557,29 @@ std::list<Tile*> GameMap::findBestPath(const Creature* creature, Tile* tileStart
         {
             // The path is shorter
             chosenTile = tile;
-            returnList = pathTmp;
+            returnList.swap(pathTmp);
         }
     }
     return returnList;
 }
 
+FloodFillType GameMap::getFloodFillTypeForCreature(const Creature* creature) const
+{
+    if(creature->getMoveSpeedGround() <= 0.0)
+        return FloodFillType::ground;
+
+    bool canGoThroughWater = (creature->getMoveSpeedWater() > 0.0);
+    bool canGoThroughLava = (creature->getMoveSpeedLava() > 0.0);
+    if(canGoThroughWater && canGoThroughLava)
+        return FloodFillType::groundWaterLava;
+    if(canGoThroughWater)
+        return FloodFillType::groundWater;
+    if(canGoThroughLava)
+        return FloodFillType::groundLava;
+
+    return FloodFillType::ground;
+}
+
 bool GameMap::pathExists(const Creature* creature, Tile* tileStart, Tile* tileEnd)
 {
     // If floodfill is not enabled, we cannot check if the path exists so we return true
@@ -1416,29 +1591,13 @@ bool GameMap::pathExists(const Creature* creature, Tile* tileStart, Tile* tileEn
     if(creature == nullptr)
         return false;
 
-    FloodFillType floodFill = FloodFillType::ground;
-    if((creature->getMoveSpeedGround() > 0.0) &&
-        (creature->getMoveSpeedWater() > 0.0) &&
-        (creature->getMoveSpeedLava() > 0.0))
-    {
-        floodFill = FloodFillType::groundWaterLava;
-    }
-    if((creature->getMoveSpeedGround() > 0.0) &&
-        (creature->getMoveSpeedWater() > 0.0))
-    {
-        floodFill = FloodFillType::groundWater;
-    }
-    if((creature->getMoveSpeedGround() > 0.0) &&
-        (creature->getMoveSpeedLava() > 0.0))
-    {
-        floodFill = FloodFillType::groundLava;
-    }
+    FloodFillType floodFill = getFloodFillTypeForCreature(creature);
 
     if(creature->getDefinition()->isWorker())
     {
         // Workers can go on a tile if and only if the path is open for any creature. If it is closed, that
         // means that a door is closed
-        for(Seat* seat : mSeats)
+        for(Seat* seat : mFloodFillLayerSeats)
         {
             if(tileStart->isSameFloodFill(seat, floodFill, tileEnd))
                 continue;
@@ -1457,6 +1616,20 @@ bool GameMap::pathExists(const Creature* creature, Tile* tileStart, Tile* tileEn
 }
 
 std::list<Tile*> GameMap::path(int x1, int y1, int x2, int y2, const Creature* creature, Seat* seat, bool throughDiggableTiles)
+{
+    TraceRecorder* traceRecorder = TraceRecorder::getSingletonPtr();
+    if(traceRecorder == nullptr)
+        return computePath(x1, y1, x2, y2, creature, seat, throughDiggableTiles);
+
+    uint64_t startTime = traceRecorder->getTime();
+    unsigned int numPathCacheHits = mNumPathCacheHits;
+    std::list<Tile*> returnList = computePath(x1, y1, x2, y2, creature, seat, throughDiggableTiles);
+    traceRecorder->recordPathRequest(x1, y1, x2, y2, static_cast<uint32_t>(returnList.size()),
+        mNumPathCacheHits != numPathCacheHits, startTime, traceRecorder->getTime() - startTime);
+    return returnList;
+}
+
+std::list<Tile*> GameMap::computePath(int x1, int y1, int x2, int y2, const Creature* creature, Seat* seat, bool throughDiggableTiles)
 {
     ++mNumCallsTo_path;
     std::list<Tile*> returnList;
@@ -1478,39 +1651,151 @@ std::list<Tile*> GameMap::path(int x1, int y1, int x2, int y2, const Creature* c
     if (!throughDiggableTiles && !pathExists(creature, start, destination))
         return returnList;
 
-    AstarEntry *currentEntry = new AstarEntry(start, x1, y1, x2, y2);
-    AstarEntry neighbor;
+    // Many creatures ask for the same paths during a turn (to the same treasury, hatchery, ...). Diggable tiles
+    // depend on the seat and are not cached
+    PathCache::Key cacheKey;
+    bool useCache = !throughDiggableTiles && getPathCacheKey(start, destination, creature, cacheKey);
+    if(useCache)
+    {
+        const std::list<Tile*>* cachedPath = mPathCache.find(cacheKey, mPassabilityEpoch);
+        if(cachedPath != nullptr)
+        {
+            ++mNumPathCacheHits;
+            return *cachedPath;
+        }
+        ++mNumPathCacheMisses;
+    }
+
+    // For long paths, we use the abstraction graph
+    bool pathFound = false;
+    if (!throughDiggableTiles && mIsServerGameMap && !isInEditorMode() &&
+        (std::abs(x2 - x1) + std::abs(y2 - y1) > HIERARCHICAL_PATH_MIN_DISTANCE))
+    {
+        pathFound = pathHierarchical(start, destination, creature, seat, returnList);
+    }
+
+    if(!pathFound)
+        pathTiles(start, destination, creature, seat, throughDiggableTiles, returnList);
+
+    if(useCache)
+        mPathCache.store(cacheKey, returnList, mPassabilityEpoch);
+
+    return returnList;
+}
+
+bool GameMap::getPathCacheKey(Tile* start, Tile* destination, const Creature* creature, PathCache::Key& key) const
+{
+    if(!mIsServerGameMap || isInEditorMode())
+        return false;
+
+    if(creature->getSeat() == nullptr)
+        return false;
+
+    key.mStart = static_cast<uint32_t>(start->getY() * getMapSizeX() + start->getX());
+    key.mDest = static_cast<uint32_t>(destination->getY() * getMapSizeX() + destination->getX());
+    key.mFloodFillType = static_cast<uint32_t>(getFloodFillTypeForCreature(creature));
+    key.mSeatId = creature->getSeat()->getId();
+    key.mBlockedByEnemyDoors = creature->isActionInList(CreatureActionType::fight) ||
+        creature->isActionInList(CreatureActionType::flee);
+    key.mSpeedGround = creature->getMoveSpeedGround();
+    key.mSpeedWater = creature->getMoveSpeedWater();
+    key.mSpeedLava = creature->getMoveSpeedLava();
+    return true;
+}
+
+bool GameMap::pathHierarchical(Tile* start, Tile* destination, const Creature* creature, Seat* seat, std::list<Tile*>& returnList)
+{
+    if(!mHierarchicalPathfinding.findAbstractPath(start->getX(), start->getY(), destination->getX(), destination->getY(),
+            static_cast<uint32_t>(getFloodFillTypeForCreature(creature)), mPathWaypoints))
+    {
+        return false;
+    }
+
+    // We refine each leg of the abstract path. The abstraction graph does not know about seat dependent passability
+    // (like locked doors). If a leg cannot be refined, the caller will compute the path at tile level
+    mPathWaypoints.push_back(getTileIndex(destination->getX(), destination->getY()));
+    Tile* legStart = start;
+    std::list<Tile*> leg;
+    for(uint32_t waypointIndex : mPathWaypoints)
+    {
+        Tile* waypoint = getTileByIndex(waypointIndex);
+        if(!pathTiles(legStart, waypoint, creature, seat, false, leg))
+        {
+            returnList.clear();
+            return false;
+        }
+
+        // The first tile of a leg is the last tile of the previous one
+        if(!returnList.empty())
+            leg.pop_front();
+
+        returnList.splice(returnList.end(), leg);
+        legStart = waypoint;
+    }
+
+    return true;
+}
+
+bool GameMap::isHierarchicalPathPassable(int x, int y, uint32_t type) const
+{
+    Tile* tile = getTile(x, y);
+    if(tile == nullptr)
+        return false;
+
+    if(tile->isFullTile())
+        return false;
+
+    // Bridges can be used by every creature
+    Room* room = tile->getCoveringRoom();
+    if((room != nullptr) && room->isBridge())
+        return true;
+
+    FloodFillType floodFillType = static_cast<FloodFillType>(type);
+    switch(tile->getType())
+    {
+        case TileType::dirt:
+        case TileType::gold:
+        case TileType::rock:
+            return true;
+        case TileType::water:
+            return (floodFillType == FloodFillType::groundWater) ||
+                (floodFillType == FloodFillType::groundWaterLava);
+        case TileType::lava:
+            return (floodFillType == FloodFillType::groundLava) ||
+                (floodFillType == FloodFillType::groundWaterLava);
+        default:
+            return false;
+    }
+}
 
-    std::vector<AstarEntry*> openList;
-    openList.push_back(currentEntry);
+bool GameMap::pathTiles(Tile* start, Tile* destination, const Creature* creature, Seat* seat, bool throughDiggableTiles, std::list<Tile*>& returnList)
+{
+    int x2 = destination->getX();
+    int y2 = destination->getY();
+    mPathfindingEngine.setMapSize(getMapSizeX(), getMapSizeY());
+    mPathfindingEngine.startSearch(start->getX(), start->getY(), x2, y2);
 
-    std::vector<AstarEntry*> closedList;
-    AstarEntry* destinationEntry = nullptr;
-    while (true)
+    bool destinationFound = false;
+    int currentX;
+    int currentY;
+    while (mPathfindingEngine.popLowestCost(currentX, currentY))
     {
-        // if the openList is empty we failed to find a path
-        if (openList.empty())
-            break;
-
-        // Get the lowest fScore from the openList and move it to the closed list
-        std::vector<AstarEntry*>::iterator smallestAstar = openList.begin();
-        for (std::vector<AstarEntry*>::iterator itr = openList.begin(); itr != openList.end(); ++itr)
-        {
-            if ((*itr)->fCost() < (*smallestAstar)->fCost())
-                smallestAstar = itr;
-        }
-
-        currentEntry = *smallestAstar;
-        openList.erase(smallestAstar);
-        closedList.push_back(currentEntry);
-
         // We found the path, break out of the search loop
-        if (currentEntry->getTile() == destination)
+        if ((currentX == x2) && (currentY == y2))
         {
-            destinationEntry = currentEntry;
+            destinationFound = true;
             break;
         }
 
+        Tile* currentTile = getTile(currentX, currentY);
+
+        // The cost to leave the current tile only depends on the current tile
+        double currentTileSpeed;
+        if(currentTile->getFullness() == 0)
+            currentTileSpeed = creature->getMoveSpeed(currentTile);
+        else
+            currentTileSpeed = creature->getMoveSpeedGround();
+
         // Check the tiles surrounding the current square
         bool areTilesPassable[4] = {false, false, false, false};
         // Note : to disable diagonals, process tiles from 0 to 3. To allow them, process tiles from 0 to 7
@@ -1521,34 +1806,34 @@ std::list<Tile*> GameMap::path(int x1, int y1, int x2, int y2, const Creature* c
             {
                 // We process the 4 adjacent tiles
                 case 0:
-                    neighborTile = getTile(currentEntry->getTile()->getX() - 1, currentEntry->getTile()->getY());
+                    neighborTile = getTile(currentX - 1, currentY);
                     break;
                 case 1:
-                    neighborTile = getTile(currentEntry->getTile()->getX() + 1, currentEntry->getTile()->getY());
+                    neighborTile = getTile(currentX + 1, currentY);
                     break;
                 case 2:
-                    neighborTile = getTile(currentEntry->getTile()->getX(), currentEntry->getTile()->getY() - 1);
+                    neighborTile = getTile(currentX, currentY - 1);
                     break;
                 case 3:
-                    neighborTile = getTile(currentEntry->getTile()->getX(), currentEntry->getTile()->getY() + 1);
+                    neighborTile = getTile(currentX, currentY + 1);
                     break;
                 // We process the 4 diagonal tiles. We only process a diagonal tile if the 2 tiles adjacent to the original one are
                 // passable.
                 case 4:
                     if(areTilesPassable[0] && areTilesPassable[2])
-                        neighborTile = getTile(currentEntry->getTile()->getX() - 1, currentEntry->getTile()->getY() - 1);
+                        neighborTile = getTile(currentX - 1, currentY - 1);
                     break;
                 case 5:
                     if(areTilesPassable[0] && areTilesPassable[3])
-                        neighborTile = getTile(currentEntry->getTile()->getX() - 1, currentEntry->getTile()->getY() + 1);
+                        neighborTile = getTile(currentX - 1, currentY + 1);
                     break;
                 case 6:
                     if(areTilesPassable[1] && areTilesPassable[2])
-                        neighborTile = getTile(currentEntry->getTile()->getX() + 1, currentEntry->getTile()->getY() - 1);
+                        neighborTile = getTile(currentX + 1, currentY - 1);
                     break;
                 case 7:
                     if(areTilesPassable[1] && areTilesPassable[3])
-                        neighborTile = getTile(currentEntry->getTile()->getX() + 1, currentEntry->getTile()->getY() + 1);
+                        neighborTile = getTile(currentX + 1, currentY + 1);
                     break;
                 default:
                     break;
@@ -1556,112 +1841,48 @@ std::list<Tile*> GameMap::path(int x1, int y1, int x2, int y2, const Creature* c
             if(neighborTile == nullptr)
                 continue;
 
-            neighbor.setTile(neighborTile);
-
             bool processNeighbor = false;
             // We process the tile if the creature can go through. But if it is the first tile that is
             // not passable, we also process it. That happens if a door is closed
-            if((creature->canGoThroughTile(neighbor.getTile())) ||
-               (neighbor.getTile() == start))
+            if((creature->canGoThroughTile(neighborTile)) ||
+               (neighborTile == start))
             {
                 processNeighbor = true;
                 // We set passability for the 4 adjacent tiles only
                 if(i < 4)
                     areTilesPassable[i] = true;
              }
-            else if(throughDiggableTiles && neighbor.getTile()->isDiggable(seat))
+            else if(throughDiggableTiles && neighborTile->isDiggable(seat))
                 processNeighbor = true;
 
             if (!processNeighbor)
                 continue;
 
-            // See if the neighbor is in the closed list
-            AstarEntry* neighborEntry = nullptr;
-            for(std::vector<AstarEntry*>::iterator itr = closedList.begin(); itr != closedList.end(); ++itr)
-            {
-                if (neighbor.getTile() == (*itr)->getTile())
-                {
-                    neighborEntry = *itr;
-                    break;
-                }
-            }
-
             // Ignore the neighbor if it is on the closed list
-            if (neighborEntry != nullptr)
+            if (mPathfindingEngine.isClosed(neighborTile->getX(), neighborTile->getY()))
                 continue;
 
-            // See if the neighbor is in the open list
-            for(std::vector<AstarEntry*>::iterator itr = openList.begin(); itr != openList.end(); ++itr)
-            {
-                if (neighbor.getTile() == (*itr)->getTile())
-                {
-                    neighborEntry = *itr;
-                    break;
-                }
-            }
-
-            // If the neighbor is not in the open list
-            if (neighborEntry == nullptr)
-            {
-                double weightToParent = AstarEntry::computeHeuristic(neighbor.getTile()->getX(), neighbor.getTile()->getY(),
-                    currentEntry->getTile()->getX(), currentEntry->getTile()->getY());
-
-                if(currentEntry->getTile()->getFullness() == 0)
-                    weightToParent /= creature->getMoveSpeed(currentEntry->getTile());
-                else
-                    weightToParent /= creature->getMoveSpeedGround();
-                neighbor.setG(currentEntry->getG() + weightToParent);
-
-                // Use the manhattan distance for the heuristic
-                neighbor.setHeuristic(neighbor.getTile()->getX(), neighbor.getTile()->getY(), x2, y2);
-                neighbor.setParent(currentEntry);
-
-                openList.push_back(new AstarEntry(neighbor));
-            }
-            else
-            {
-                // If this path to the given neighbor tile is a shorter path than the
-                // one already given, make this the new parent.
-                double weightToParent = AstarEntry::computeHeuristic(neighbor.getTile()->getX(), neighbor.getTile()->getY(),
-                    currentEntry->getTile()->getX(), currentEntry->getTile()->getY());
-
-                if(currentEntry->getTile()->getFullness() == 0)
-                    weightToParent /= creature->getMoveSpeed(currentEntry->getTile());
-                else
-                    weightToParent /= creature->getMoveSpeedGround();
+            double weightToParent = PathfindingEngine::computeHeuristic(neighborTile->getX(), neighborTile->getY(),
+                currentX, currentY);
+            weightToParent /= currentTileSpeed;
 
-                if (currentEntry->getG() + weightToParent < neighborEntry->getG())
-                {
-                    neighborEntry->setG(currentEntry->getG() + weightToParent);
-                    neighborEntry->setParent(currentEntry);
-                }
-            }
+            // If the neighbor is already in the open list, it will be updated only if this path is shorter
+            mPathfindingEngine.pushOrDecrease(neighborTile->getX(), neighborTile->getY(),
+                mPathfindingEngine.getG(currentX, currentY) + weightToParent, currentX, currentY);
         }
     }
 
-    if (destinationEntry != nullptr)
-    {
-        // Follow the parent chain back the the starting tile
-        AstarEntry* curEntry = destinationEntry;
-        do
-        {
-            if (curEntry->getTile() != nullptr)
-            {
-                returnList.push_front(curEntry->getTile());
-                curEntry = curEntry->getParent();
-            }
-
-        } while (curEntry != nullptr);
-    }
-
-    // Clean up the memory we allocated by deleting the astarEntries in the open and closed lists
-    for (std::vector<AstarEntry*>::iterator itr = openList.begin(); itr != openList.end(); ++itr)
-        delete *itr;
+    if (!destinationFound)
+        return false;
 
-    for (std::vector<AstarEntry*>::iterator itr = closedList.begin(); itr != closedList.end(); ++itr)
-        delete *itr;
+    // Follow the parent chain back the the starting tile
+    int pathX = x2;
+    int pathY = y2;
+    returnList.push_front(destination);
+    while (mPathfindingEngine.getParent(pathX, pathY, pathX, pathY))
+        returnList.push_front(getTile(pathX, pathY));
 
-    return returnList;
+    return true;
 }
 
 bool GameMap::addPlayer(Player* player)
@@ -1720,39 +1941,58 @@ Player* GameMap::getPlayerBySeat(Seat* seat) const
 std::vector<GameEntity*> GameMap::getVisibleForce(const std::vector<Tile*>& visibleTiles, Seat* seat, bool enemyForce)
 {
     std::vector<GameEntity*> returnList;
+    std::vector<Building*> buildings;
+    SelectionEntityWanted entityWanted = enemyForce ? SelectionEntityWanted::creatureAliveEnemyAttackable :
+        SelectionEntityWanted::creatureAliveAllied;
+
+    // Creatures call this from the sense phase workers. Each thread has its own buffers
+    static thread_local std::vector<EntitySpatialIndex::TileEntity> tileEntities;
+    static thread_local EntitySpatialIndex::TileMarks tileMarks;
+    mEntitySpatialIndex.fillEntitiesOnTiles(visibleTiles, tileEntities, tileMarks);
+    auto itTileEntity = tileEntities.begin();
 
     // Loop over the visible tiles
-    for (Tile* tile : visibleTiles)
+    for (uint32_t order = 0; order < visibleTiles.size(); ++order)
     {
+        Tile* tile = visibleTiles[order];
         if(tile == nullptr)
         {
             OD_LOG_ERR("unexpected null tile");
             continue;
         }
 
+        // The entities are sorted like visibleTiles
+        for(; (itTileEntity != tileEntities.end()) && (itTileEntity->mTileOrder == order); ++itTileEntity)
+        {
+            if(!tile->isEntityWanted(itTileEntity->mEntity, entityWanted, seat->getPlayer()))
+                continue;
+
+            returnList.push_back(itTileEntity->mEntity);
+        }
+
+        Building* building = tile->getCoveringBuilding();
+        if(building == nullptr)
+            continue;
+
+        // Buildings usually cover many tiles. We only check the ones we have already found
+        if(std::find(buildings.begin(), buildings.end(), building) != buildings.end())
+            continue;
+
         if(enemyForce)
         {
-            tile->fillWithEntities(returnList, SelectionEntityWanted::creatureAliveEnemyAttackable, seat->getPlayer());
-            Building* building = tile->getCoveringBuilding();
-            if((building != nullptr) &&
-               (!building->getSeat()->isAlliedSeat(seat)) &&
-               (building->isAttackable(tile, seat)) &&
-               (std::find(returnList.begin(), returnList.end(), building) == returnList.end()))
-            {
-                returnList.push_back(building);
-            }
+            if(building->getSeat()->isAlliedSeat(seat))
+                continue;
+            if(!building->isAttackable(tile, seat))
+                continue;
         }
         else
         {
-            tile->fillWithEntities(returnList, SelectionEntityWanted::creatureAliveAllied, seat->getPlayer());
-            Building* building = tile->getCoveringBuilding();
-            if((building != nullptr) &&
-               (building->getSeat()->isAlliedSeat(seat)) &&
-               (std::find(returnList.begin(), returnList.end(), building) == returnList.end()))
-            {
-                returnList.push_back(building);
-            }
+            if(!building->getSeat()->isAlliedSeat(seat))
+                continue;
         }
+
+        buildings.push_back(building);
+        returnList.push_back(building);
     }
 
     return returnList;
@@ -1761,24 +2001,16 @@ std::vector<GameEntity*> GameMap::getVisibleForce(const std::vector<Tile*>& visi
 std::vector<GameEntity*> GameMap::getVisibleCreatures(const std::vector<Tile*>& visibleTiles, Seat* seat, bool enemyCreatures)
 {
     std::vector<GameEntity*> returnList;
+    SelectionEntityWanted entityWanted = enemyCreatures ? SelectionEntityWanted::creatureAliveEnemyAttackable :
+        SelectionEntityWanted::creatureAliveAllied;
 
-    // Loop over the visible tiles
-    for (Tile* tile : visibleTiles)
+    mEntitySpatialIndex.fillEntitiesOnTiles(visibleTiles, mTileEntities);
+    for(const EntitySpatialIndex::TileEntity& tileEntity : mTileEntities)
     {
-        if(tile == nullptr)
-        {
-            OD_LOG_ERR("unexpected null tile");
+        if(!tileEntity.mTile->isEntityWanted(tileEntity.mEntity, entityWanted, seat->getPlayer()))
             continue;
-        }
 
-        if(enemyCreatures)
-        {
-            tile->fillWithEntities(returnList, SelectionEntityWanted::creatureAliveEnemyAttackable, seat->getPlayer());
-        }
-        else
-        {
-            tile->fillWithEntities(returnList, SelectionEntityWanted::creatureAliveAllied, seat->getPlayer());
-        }
+        returnList.push_back(tileEntity.mEntity);
     }
 
     return returnList;
@@ -1788,16 +2020,24 @@ std::vector<GameEntity*> GameMap::getCarryableEntities(Creature* carrier, const
 {
     std::vector<GameEntity*> returnList;
 
-    // Loop over the visible tiles
-    for (Tile* tile : tiles)
+    mEntitySpatialIndex.fillEntitiesOnTiles(tiles, mTileEntities);
+    for(const EntitySpatialIndex::TileEntity& tileEntity : mTileEntities)
     {
-        if(tile == nullptr)
+        GameEntity* entity = tileEntity.mEntity;
+        if(entity == nullptr)
         {
-            OD_LOG_ERR("unexpected null tile");
+            OD_LOG_ERR("unexpected null entity in tile=" + Tile::displayAsString(tileEntity.mTile));
             continue;
         }
 
-        tile->fillWithCarryableEntities(carrier, returnList);
+        // We check if the entity is already being handled by another creature
+        if(entity->getCarryLock(*carrier))
+            continue;
+
+        if(entity->getEntityCarryType(carrier) == EntityCarryType::notCarryable)
+            continue;
+
+        returnList.push_back(entity);
     }
 
     return returnList;
@@ -1814,6 +2054,7 @@ void GameMap::clearRooms()
     }
 
     mRooms.clear();
+    mRoomsByName.clear();
 }
 
 void GameMap::addRoom(Room *r)
@@ -1827,6 +2068,9 @@ void GameMap::addRoom(Room *r)
     }
 
     mRooms.push_back(r);
+    if(!mRoomsByName.add(r))
+        OD_LOG_ERR("Room name already used=" + r->getName());
+    r->getSeat()->getStats().addRoom(r, r->getType(), r->getTotalGoldStored(), r->getTotalGoldStorage());
 }
 
 void GameMap::removeRoom(Room *r)
@@ -1842,6 +2086,8 @@ void GameMap::removeRoom(Room *r)
     }
 
     mRooms.erase(it);
+    mRoomsByName.remove(r);
+    r->getSeat()->getStats().removeRoom(r);
 }
 
 std::vector<Room*> GameMap::getRoomsByType(RoomType type) const
@@ -1859,9 +2105,12 @@ std::vector<Room*> GameMap::getRoomsByType(RoomType type) const
 std::vector<Room*> GameMap::getRoomsByTypeAndSeat(RoomType type, const Seat* seat)
 {
     std::vector<Room*> returnList;
-    for (Room* room : mRooms)
+    if(seat == nullptr)
+        return returnList;
+
+    for (Room* room : seat->getStats().getRooms(type))
     {
-        if (room->getType() == type && room->getSeat() == seat && room->getHP(nullptr) > 0.0)
+        if (room->getHP(nullptr) > 0.0)
             returnList.push_back(room);
     }
 
@@ -1871,9 +2120,12 @@ std::vector<Room*> GameMap::getRoomsByTypeAndSeat(RoomType type, const Seat* sea
 std::vector<const Room*> GameMap::getRoomsByTypeAndSeat(RoomType type, const Seat* seat) const
 {
     std::vector<const Room*> returnList;
-    for (const Room* room : mRooms)
+    if(seat == nullptr)
+        return returnList;
+
+    for (const Room* room : seat->getStats().getRooms(type))
     {
-        if (room->getType() == type && room->getSeat() == seat && room->getHP(nullptr) > 0.0)
+        if (room->getHP(nullptr) > 0.0)
             returnList.push_back(room);
     }
 
@@ -1947,24 +2199,12 @@ std::vector<Building*> GameMap::getReachableBuildingsPerSeat(Seat* seat,
 
 Room* GameMap::getRoomByName(const std::string& name)
 {
-    for (Room* room : mRooms)
-    {
-        if(room->getName().compare(name) == 0)
-            return room;
-    }
-
-    return nullptr;
+    return mRoomsByName.get(name);
 }
 
 Trap* GameMap::getTrapByName(const std::string& name)
 {
-    for (Trap* trap : mTraps)
-    {
-        if(trap->getName().compare(name) == 0)
-            return trap;
-    }
-
-    return nullptr;
+    return mTrapsByName.get(name);
 }
 
 void GameMap::clearTraps()
@@ -1978,6 +2218,7 @@ void GameMap::clearTraps()
     }
 
     mTraps.clear();
+    mTrapsByName.clear();
 }
 
 void GameMap::addTrap(Trap *trap)
@@ -1987,6 +2228,8 @@ void GameMap::addTrap(Trap *trap)
         + Helper::toString(nbTiles) + ", seatId=" + Helper::toString(trap->getSeat()->getId()));
 
     mTraps.push_back(trap);
+    if(!mTrapsByName.add(trap))
+        OD_LOG_ERR("Trap name already used=" + trap->getName());
 }
 
 void GameMap::removeTrap(Trap *t)
@@ -2000,6 +2243,7 @@ void GameMap::removeTrap(Trap *t)
     }
 
     mTraps.erase(it);
+    mTrapsByName.remove(t);
 }
 
 bool GameMap::withdrawFromTreasuries(int gold, Seat* seat)
@@ -2035,12 +2279,16 @@ void GameMap::clearMapLights()
     }
 
     mMapLights.clear();
+    mMapLightsByName.clear();
 }
 
 void GameMap::addMapLight(MapLight *m)
 {
     OD_LOG_INF(serverStr() + "Adding MapLight " + m->getName());
     mMapLights.push_back(m);
+    if(!mMapLightsByName.add(m))
+        OD_LOG_ERR("MapLight name already used=" + m->getName());
+    registerEntityId(m);
 }
 
 void GameMap::removeMapLight(MapLight *m)
@@ -2055,17 +2303,13 @@ void GameMap::removeMapLight(MapLight *m)
     }
 
     mMapLights.erase(it);
+    mMapLightsByName.remove(m);
+    unregisterEntityId(m);
 }
 
 MapLight* GameMap::getMapLight(const std::string& name) const
 {
-    for (MapLight* mapLight : mMapLights)
-    {
-        if (mapLight->getName() == name)
-            return mapLight;
-    }
-
-    return nullptr;
+    return mMapLightsByName.get(name);
 }
 
 void GameMap::clearSeats()
@@ -2167,66 +2411,93 @@ void GameMap::clearGoalsForAllSeats()
     mGoalsForAllSeats.clear();
 }
 
-bool GameMap::doFloodFill(Seat* seat, Tile* tile)
+void GameMap::replaceFloodFill(Seat* seat, FloodFillType floodFillType, uint32_t colorOld, uint32_t colorNew)
 {
-    if (!mFloodFillEnabled)
-        return false;
+    if((colorOld == Tile::NO_FLOODFILL) || (colorNew == Tile::NO_FLOODFILL))
+    {
+        OD_LOG_ERR("Unexpected floodfill replacement seatId=" + Helper::toString(seat->getId()) + ", colorOld="
+            + Helper::toString(colorOld) + ", colorNew=" + Helper::toString(colorNew));
+        return;
+    }
 
-    if(tile->isFloodFillFilled(seat))
-        return false;
+    // Tiles are not changed: they keep their color and getFloodFillColor will return colorNew for them
+    getFloodFillColorSet(getFloodFillLayer(seat), floodFillType).mergeInto(colorOld, colorNew);
+}
 
-    bool hasChanged = false;
-    // If a neigboor is colored with the same colors, we color the tile
-    for(Tile* neigh : tile->getAllNeighbors())
+uint32_t GameMap::getFloodFillColor(uint32_t layer, FloodFillType floodFillType, uint32_t color) const
+{
+    if(color == Tile::NO_FLOODFILL)
+        return color;
+
+    uint32_t index = layer * static_cast<uint32_t>(FloodFillType::nbValues) + static_cast<uint32_t>(floodFillType);
+    if(index >= mFloodFillColorSets.size())
+        return color;
+
+    // Called by the creatures sensing in parallel (see senseCreaturesUpkeep) so the sets must not be modified
+    return mFloodFillColorSets[index].findReadOnly(color);
+}
+
+DisjointSet& GameMap::getFloodFillColorSet(uint32_t layer, FloodFillType floodFillType)
+{
+    uint32_t index = layer * static_cast<uint32_t>(FloodFillType::nbValues) + static_cast<uint32_t>(floodFillType);
+    if(index >= mFloodFillColorSets.size())
+        mFloodFillColorSets.resize(index + 1);
+
+    return mFloodFillColorSets[index];
+}
+
+uint32_t GameMap::getFloodFillLayer(const Seat* seat) const
+{
+    if(seat->getTeamIndex() >= mFloodFillTeamLayers.size())
+        return 0;
+
+    return mFloodFillTeamLayers[seat->getTeamIndex()];
+}
+
+void GameMap::detachFloodFillLayer(const Seat* seat)
+{
+    if(seat->getTeamIndex() >= mFloodFillTeamLayers.size())
     {
-        switch(tile->getType())
-        {
-            case TileType::dirt:
-            case TileType::gold:
-            case TileType::rock:
-            {
-                hasChanged |= tile->updateFloodFillFromTile(seat, FloodFillType::ground, neigh);
-                hasChanged |= tile->updateFloodFillFromTile(seat, FloodFillType::groundWater, neigh);
-                hasChanged |= tile->updateFloodFillFromTile(seat, FloodFillType::groundLava, neigh);
-                hasChanged |= tile->updateFloodFillFromTile(seat, FloodFillType::groundWaterLava, neigh);
-                break;
-            }
-            case TileType::water:
-            {
-                hasChanged |= tile->updateFloodFillFromTile(seat, FloodFillType::groundWater, neigh);
-                hasChanged |= tile->updateFloodFillFromTile(seat, FloodFillType::groundWaterLava, neigh);
-                break;
-            }
-            case TileType::lava:
-            {
-                hasChanged |= tile->updateFloodFillFromTile(seat, FloodFillType::groundLava, neigh);
-                hasChanged |= tile->updateFloodFillFromTile(seat, FloodFillType::groundWaterLava, neigh);
-                break;
-            }
-            default:
-                continue;
-        }
+        OD_LOG_ERR("Wrong team index seatId=" + Helper::toString(seat->getId()) + ", teamIndex=" + Helper::toString(seat->getTeamIndex()));
+        return;
+    }
 
-        // If the tile is fully filled, no need to continue
-        if(tile->isFloodFillFilled(seat))
-            return true;
+    if(mFloodFillTeamLayers[seat->getTeamIndex()] != 0)
+        return;
+
+    // The team gets a copy of the shared layer
+    uint32_t layer = mNbFloodFillLayers;
+    ++mNbFloodFillLayers;
+    for(int yy = 0; yy < getMapSizeY(); ++yy)
+    {
+        for(int xx = 0; xx < getMapSizeX(); ++xx)
+            getTile(xx, yy)->addFloodFillLayer();
+    }
+
+    for(uint32_t i = 0; i < static_cast<uint32_t>(FloodFillType::nbValues); ++i)
+    {
+        FloodFillType type = static_cast<FloodFillType>(i);
+        DisjointSet sharedColors = getFloodFillColorSet(0, type);
+        getFloodFillColorSet(layer, type) = sharedColors;
     }
 
-    return hasChanged;
+    mFloodFillTeamLayers[seat->getTeamIndex()] = layer;
+    OD_LOG_INF("Floodfill layer " + Helper::toString(layer) + " created for team index " + Helper::toString(seat->getTeamIndex()));
+    updateFloodFillLayerSeats();
 }
 
-void GameMap::replaceFloodFill(Seat* seat, FloodFillType floodFillType, uint32_t colorOld, uint32_t colorNew)
+void GameMap::updateFloodFillLayerSeats()
 {
-    for (int jj = 0; jj < getMapSizeY(); ++jj)
+    mFloodFillLayerSeats.clear();
+    std::vector<bool> layersFound(mNbFloodFillLayers, false);
+    for(Seat* seat : mSeats)
     {
-        for (int ii = 0; ii < getMapSizeX(); ++ii)
-        {
-            Tile* tile = getTile(ii,jj);
-            if(tile->getFloodFillValue(seat, floodFillType) != colorOld)
-                continue;
+        uint32_t layer = getFloodFillLayer(seat);
+        if(layersFound[layer])
+            continue;
 
-            tile->replaceFloodFill(seat, floodFillType, colorNew);
-        }
+        layersFound[layer] = true;
+        mFloodFillLayerSeats.push_back(seat);
     }
 }
 
@@ -2255,6 +2526,33 @@ void GameMap::refreshFloodFill(Seat* seat, Tile* tile)
     }
 }
 
+bool GameMap::isFloodFillPassable(Tile* tile, FloodFillType floodFillType)
+{
+    return isFloodFillPassable(tile->getType(), tile->getFullness(), floodFillType);
+}
+
+bool GameMap::isFloodFillPassable(TileType tileType, double fullness, FloodFillType floodFillType)
+{
+    if(fullness > 0.0)
+        return false;
+
+    switch(tileType)
+    {
+        case TileType::dirt:
+        case TileType::gold:
+        case TileType::rock:
+            return true;
+        case TileType::water:
+            return (floodFillType == FloodFillType::groundWater) ||
+                (floodFillType == FloodFillType::groundWaterLava);
+        case TileType::lava:
+            return (floodFillType == FloodFillType::groundLava) ||
+                (floodFillType == FloodFillType::groundWaterLava);
+        default:
+            return false;
+    }
+}
+
 void GameMap::enableFloodFill()
 {
     // Carry out a flood fill of the whole level to make sure everything is good.
@@ -2266,6 +2564,10 @@ void GameMap::enableFloodFill()
             getTile(ii,jj)->resetFloodFill();
         }
     }
+    mFloodFillColorSets.clear();
+    mFloodFillTeamLayers.assign(mTeamIds.size(), 0);
+    mNbFloodFillLayers = 1;
+    updateFloodFillLayerSeats();
 
     // The algorithm used to find a path is efficient when the path exists but not if it doesn't.
     // To improve path finding, we tag the contiguous tiles to know if a path exists between 2 tiles or not.
@@ -2273,151 +2575,51 @@ void GameMap::enableFloodFill()
     // Note : when a tile is digged, floodfill will have to be refreshed.
     mFloodFillEnabled = true;
 
-    // To optimize floodfilling, we start by tagging the dirt tiles with fullness = 0
-    // because they are walkable for most creatures. When we will have tagged all
-    // thoses, we will deal with water/lava remaining (there can be some left if
-    // surrounded by not passable tiles).
-    FloodFillType currentType = FloodFillType::ground;
-    // We do the floodfill for the rogue seat. Then, once it is done, we copy for the other seats.
-    // If there are locked doors, floodfill will be refreshed when they are added
+    // For each floodfill type, we merge every passable tile with its passable neighbors. Then, each set
+    // of connected tiles gets its own color.
+    // Every team uses the shared layer. When a team locks a door, it will get its own copy (see doorLock)
+    // Passability is read from the tile fields stored by the container so that only the passable
+    // tiles are dereferenced when setting their color.
     Seat* rogueSeat = getSeatRogue();
-    while(true)
+    uint32_t nbTiles = getNbTiles();
+    DisjointSet connectedTiles;
+    std::vector<uint32_t> setColors(nbTiles, Tile::NO_FLOODFILL);
+    std::vector<bool> passableTiles(nbTiles, false);
+    for(uint32_t i = 0; i < static_cast<uint32_t>(FloodFillType::nbValues); ++i)
     {
-        int yy = 0;
+        FloodFillType type = static_cast<FloodFillType>(i);
+        for(uint32_t tileIndex = 0; tileIndex < nbTiles; ++tileIndex)
+            passableTiles[tileIndex] = isFloodFillPassable(getTileType(tileIndex), getTileFullness(tileIndex), type);
 
-        bool isTileFound;
-        isTileFound = false;
-        while(!isTileFound && (yy < getMapSizeY()))
+        // Merging each tile with its left and bottom neighbors is enough to connect every neighbor
+        connectedTiles.clear();
+        for(int yy = 0; yy < getMapSizeY(); ++yy)
         {
             for(int xx = 0; xx < getMapSizeX(); ++xx)
             {
-                Tile* tile = getTile(xx, yy);
-                if(tile->getFullness() > 0.0)
+                uint32_t tileIndex = getTileIndex(xx, yy);
+                if(!passableTiles[tileIndex])
                     continue;
 
-                if(currentType == FloodFillType::ground)
-                {
-                    if(((tile->getType() == TileType::dirt) ||
-                        (tile->getType() == TileType::gold) ||
-                        (tile->getType() == TileType::rock)) &&
-                       (tile->getFloodFillValue(rogueSeat, FloodFillType::ground) == Tile::NO_FLOODFILL))
-                    {
-                        isTileFound = true;
-                        if(tile->getFloodFillValue(rogueSeat, FloodFillType::ground) == Tile::NO_FLOODFILL)
-                            tile->replaceFloodFill(rogueSeat, FloodFillType::ground, nextUniqueFloodFillValue());
-                        if(tile->getFloodFillValue(rogueSeat, FloodFillType::groundWater) == Tile::NO_FLOODFILL)
-                            tile->replaceFloodFill(rogueSeat, FloodFillType::groundWater, nextUniqueFloodFillValue());
-                        if(tile->getFloodFillValue(rogueSeat, FloodFillType::groundLava) == Tile::NO_FLOODFILL)
-                            tile->replaceFloodFill(rogueSeat, FloodFillType::groundLava, nextUniqueFloodFillValue());
-                        if(tile->getFloodFillValue(rogueSeat, FloodFillType::groundWaterLava) == Tile::NO_FLOODFILL)
-                            tile->replaceFloodFill(rogueSeat, FloodFillType::groundWaterLava, nextUniqueFloodFillValue());
-                        break;
-                    }
-                }
-                else if(currentType == FloodFillType::groundWater)
-                {
-                    if((tile->getType() == TileType::water) &&
-                       (tile->getFloodFillValue(rogueSeat, FloodFillType::groundWater) == Tile::NO_FLOODFILL))
-                    {
-                        isTileFound = true;
-                        if(tile->getFloodFillValue(rogueSeat, FloodFillType::groundWater) == Tile::NO_FLOODFILL)
-                            tile->replaceFloodFill(rogueSeat, FloodFillType::groundWater, nextUniqueFloodFillValue());
-                        if(tile->getFloodFillValue(rogueSeat, FloodFillType::groundWaterLava) == Tile::NO_FLOODFILL)
-                            tile->replaceFloodFill(rogueSeat, FloodFillType::groundWaterLava, nextUniqueFloodFillValue());
-                        break;
-                    }
-                }
-                else if(currentType == FloodFillType::groundLava)
-                {
-                    if((tile->getType() == TileType::lava) &&
-                       (tile->getFloodFillValue(rogueSeat, FloodFillType::groundLava) == Tile::NO_FLOODFILL))
-                    {
-                        isTileFound = true;
-                        if(tile->getFloodFillValue(rogueSeat, FloodFillType::groundLava) == Tile::NO_FLOODFILL)
-                            tile->replaceFloodFill(rogueSeat, FloodFillType::groundLava, nextUniqueFloodFillValue());
-                        if(tile->getFloodFillValue(rogueSeat, FloodFillType::groundWaterLava) == Tile::NO_FLOODFILL)
-                            tile->replaceFloodFill(rogueSeat, FloodFillType::groundWaterLava, nextUniqueFloodFillValue());
-                        break;
-                    }
-                }
-            }
-
-            if(!isTileFound)
-                ++yy;
-        }
-
-        // If there are no more walkable tiles, we go for water. Then, for lava. After that, floodfill should be complete
-        if(!isTileFound)
-        {
-            switch(currentType)
-            {
-                case FloodFillType::ground:
-                {
-                    // There are no more ground tiles. We go for water tiles
-                    currentType = FloodFillType::groundWater;
-                    isTileFound = true;
-                    break;
-                }
-                case FloodFillType::groundWater:
-                {
-                    // There are no more ground tiles. We go for water tiles
-                    currentType = FloodFillType::groundLava;
-                    isTileFound = true;
-                    break;
-                }
-                case FloodFillType::groundLava:
-                {
-                    // There are no more tiles. We can stop
-                    break;
-                }
-                default:
-                    OD_LOG_ERR("Unexpected enum value=" + Tile::toString(currentType));
-                    break;
-            }
-        }
-
-        if(!isTileFound)
-            break;
-
-        while(yy < getMapSizeY())
-        {
-            int nbTiles = 0;
-            for(int xx = 0; xx < getMapSizeX(); ++xx)
-            {
-                Tile* tile = getTile(xx, yy);
-                if(doFloodFill(rogueSeat, tile))
-                    ++nbTiles;
-            }
+                if((xx > 0) && passableTiles[tileIndex - 1])
+                    connectedTiles.mergeInto(tileIndex - 1, tileIndex);
 
-            // For optimization purposes, if a tile has changed, we go on the other side
-            if(nbTiles > 0)
-            {
-                for(int xx = getMapSizeX() - 1; xx >= 0; --xx)
-                {
-                    Tile* tile = getTile(xx, yy);
-                    if(doFloodFill(rogueSeat, tile))
-                        ++nbTiles;
-                }
+                if((yy > 0) && passableTiles[tileIndex - getMapSizeX()])
+                    connectedTiles.mergeInto(tileIndex - getMapSizeX(), tileIndex);
             }
-
-            // If at least one tile as been changed, we go back to the previous line
-            if((nbTiles > 0) && (yy > 0))
-                --yy;
-            else
-                ++yy;
         }
-    }
 
-    // We copy floodfill for all seats
-    for(int xx = 0; xx < getMapSizeX(); ++xx)
-    {
-        for(int yy = 0; yy < getMapSizeY(); ++yy)
+        std::fill(setColors.begin(), setColors.end(), Tile::NO_FLOODFILL);
+        for(uint32_t tileIndex = 0; tileIndex < nbTiles; ++tileIndex)
         {
-            Tile* tile = getTile(xx, yy);
-            if(tile == nullptr)
+            if(!passableTiles[tileIndex])
                 continue;
 
-            tile->copyFloodFillToOtherSeats(rogueSeat);
+            uint32_t set = connectedTiles.find(tileIndex);
+            if(setColors[set] == Tile::NO_FLOODFILL)
+                setColors[set] = nextUniqueFloodFillValue();
+
+            getTileByIndex(tileIndex)->replaceFloodFill(rogueSeat, type, setColors[set]);
         }
     }
 }
@@ -2800,14 +3002,14 @@ Creature* GameMap::getWorkerForPathFinding(Seat* seat)
 
 void GameMap::updateVisibleEntities()
 {
-    // Notify what happened to entities on visible tiles
-    for (int jj = 0; jj < getMapSizeY(); ++jj)
+    // Notify what happened to entities on visible tiles. Tiles are stored row-major so
+    // this is done in the same order as looping over y then x
+    for (uint32_t tileIndex = 0; tileIndex < getNbTiles(); ++tileIndex)
     {
-        for (int ii = 0; ii < getMapSizeX(); ++ii)
-        {
-            Tile* tile = getTile(ii,jj);
-            tile->notifyEntitiesSeatsWithVision();
-        }
+        if(getTileNbEntities(tileIndex) == 0)
+            continue;
+
+        getTileByIndex(tileIndex)->notifyEntitiesSeatsWithVision();
     }
 
     // Notify changes on visible tiles
@@ -2825,6 +3027,9 @@ void GameMap::addSpell(Spell *spell)
     OD_LOG_INF(serverStr() + "Adding spell " + spell->getName()
         + ",MeshName=" + spell->getMeshName());
     mSpells.push_back(spell);
+    if(!mSpellsByName.add(spell))
+        OD_LOG_ERR("Spell name already used=" + spell->getName());
+    registerEntityId(spell);
 }
 
 void GameMap::removeSpell(Spell *spell)
@@ -2839,16 +3044,13 @@ void GameMap::removeSpell(Spell *spell)
     }
 
     mSpells.erase(it);
+    mSpellsByName.remove(spell);
+    unregisterEntityId(spell);
 }
 
 Spell* GameMap::getSpell(const std::string& name) const
 {
-    for(Spell* spell : mSpells)
-    {
-        if(name.compare(spell->getName()) == 0)
-            return spell;
-    }
-    return nullptr;
+    return mSpellsByName.get(name);
 }
 
 void GameMap::clearSpells()
@@ -2862,6 +3064,7 @@ void GameMap::clearSpells()
     }
 
     mSpells.clear();
+    mSpellsByName.clear();
 }
 
 std::vector<Spell*> GameMap::getSpellsBySeatAndType(Seat* seat, SpellType type) const
@@ -3055,8 +3258,50 @@ void GameMap::clientUpKeep(int64_t turnNumber)
     }
 }
 
+void GameMap::tilePassabilityChanged(Tile* tile)
+{
+    ++mPassabilityEpoch;
+    mHierarchicalPathfinding.invalidateTile(tile->getX(), tile->getY());
+}
+
+void GameMap::updateVisionSource(const GameEntity* source, Seat* seat, const std::vector<Tile*>& tiles, bool persistent)
+{
+    if(!mIsServerGameMap)
+        return;
+
+    mFogOfWar.setSourceVision(source, seat, tiles, persistent);
+}
+
+bool GameMap::keepVisionSource(const GameEntity* source, Seat* seat)
+{
+    if(!mIsServerGameMap)
+        return false;
+
+    return mFogOfWar.keepSourceVision(source, seat);
+}
+
+void GameMap::tileVisionChanged(Tile* tile)
+{
+    if(!mIsServerGameMap)
+        return;
+
+    mFogOfWar.markTileDirty(tile);
+}
+
+void GameMap::entityAddedOnTile(GameEntity* entity, Tile* tile)
+{
+    mEntitySpatialIndex.addEntity(entity, tile);
+}
+
+void GameMap::entityRemovedFromTile(GameEntity* entity, Tile* tile)
+{
+    mEntitySpatialIndex.removeEntity(entity, tile);
+}
+
 void GameMap::doorLock(Tile* tileDoor, Seat* seat, bool locked)
 {
+    tilePassabilityChanged(tileDoor);
+
     if(!locked)
     {
         // When a door is unlocked, we check all its neighboors to find a floodfill value for each possible
@@ -3092,6 +3337,9 @@ void GameMap::doorLock(Tile* tileDoor, Seat* seat, bool locked)
         return;
     }
 
+    // Locked doors make the floodfill depend on the team. If the door team was still using the shared layer, it gets its own
+    detachFloodFillLayer(seat);
+
     // We save the list of the creatures that are on the same floodfill as the door tile. Then, we will check if the path
     // is still valid
     std::vector<Creature*> creatures;
@@ -3232,19 +3480,7 @@ void GameMap::notifySeatsConfigured()
         seat->setTeamIndex(teamIndex);
     }
 
-    uint32_t nbTeams = mTeamIds.size();
-    for(int xxx = 0; xxx < getMapSizeX(); ++xxx)
-    {
-        for(int yyy = 0; yyy < getMapSizeY(); ++yyy)
-        {
-            Tile* tile = getTile(xxx, yyy);
-            if(tile == nullptr)
-                continue;
-
-            tile->setTeamsNumber(nbTeams);
-        }
-    }
-    // Now that team ids are set and tiles are configured, we can compute floodfill
+    // Now that team ids are set, we can compute floodfill
     enableFloodFill();
 }
 
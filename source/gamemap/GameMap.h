@@ -18,9 +18,16 @@
 #ifndef GAMEMAP_H
 #define GAMEMAP_H
 
+#include "gamemap/EntityNameRegistry.h"
+#include "gamemap/EntitySpatialIndex.h"
+#include "gamemap/FogOfWar.h"
+#include "gamemap/HierarchicalPathfinding.h"
+#include "gamemap/PathCache.h"
+#include "gamemap/PathfindingEngine.h"
 #include "gamemap/TileContainer.h"
 
 #include "ai/AIManager.h"
+#include "utils/DisjointSet.h"
 
 #ifdef __MINGW32__
 #ifndef mode_t
@@ -32,6 +39,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 #include <OgreVector3.h>
 
@@ -53,6 +61,7 @@ class Room;
 class Spell;
 class TileSet;
 class TileSetValue;
+class ThreadPool;
 
 enum class GameEntityType;
 enum class FloodFillType;
@@ -122,9 +131,9 @@ public:
     //! \returns whether the map could be created.
     bool createNewMap(int sizeX, int sizeY);
 
-    //! \brief Set every tiles fullness and neighbors list
+    //! \brief Set every tiles fullness
     //! Used when loading a map to setup the initial tile state.
-    void setAllFullnessAndNeighbors();
+    void setAllFullness();
 
     //! \brief Creates meshes for all the tiles, creatures, rooms, traps and lights stored in this GameMap.
     void createAllEntities();
@@ -346,6 +355,32 @@ public:
     //! \brief Tells whether a path exists between two tiles for the given creature.
     bool pathExists(const Creature* creature, Tile* tileStart, Tile* tileEnd);
 
+    //! \brief Returns the floodfill type matching the tiles the given creature can walk on.
+    FloodFillType getFloodFillTypeForCreature(const Creature* creature) const;
+
+    //! \brief Should be called when something that could change the passability of the given tile happens
+    //! (tile dug, building added/removed, door locked/unlocked, ...).
+    void tilePassabilityChanged(Tile* tile);
+
+    inline uint32_t getPassabilityEpoch() const
+    { return mPassabilityEpoch; }
+
+    //! \brief Sets the tiles the given entity gives vision on to the given seat (and its allies). If seat
+    //! is nullptr, vision is given to every seat. Not persistent sources have to be refreshed each turn
+    //! with updateVisionSource or keepVisionSource or they will lose their vision. Server side only.
+    void updateVisionSource(const GameEntity* source, Seat* seat, const std::vector<Tile*>& tiles, bool persistent);
+
+    //! \brief Keeps the vision given by source last time. Returns false if the vision has to be computed again
+    bool keepVisionSource(const GameEntity* source, Seat* seat);
+
+    //! \brief Should be called when something that could change the vision given by the tile itself happens
+    //! (tile claimed, unclaimed, ...). The vision will be computed at next upkeep.
+    void tileVisionChanged(Tile* tile);
+
+    //! \brief Called by the tiles when an entity is added/removed to keep the entity spatial index up to date
+    void entityAddedOnTile(GameEntity* entity, Tile* tile);
+    void entityRemovedFromTile(GameEntity* entity, Tile* tile);
+
     /*! \brief Calculates the walkable path between tileStart and one of the possibleDests. This function
      * will choose the closest tile in possibleDests and return the path between tileStart and it.
      * If a path is found, it is returned and chosenTile is set to the chosen tile. If no path is found,
@@ -353,7 +388,7 @@ public:
      * Note that this function will use some magic numbers to avoid computing paths that are likely to be
      * further
      */
-    std::list<Tile*> findBestPath(const Creature* creature, Tile* tileStart, const std::vector<Tile*> possibleDests,
+    std::list<Tile*> findBestPath(const Creature* creature, Tile* tileStart, const std::vector<Tile*>& possibleDests,
         Tile*& chosenTile);
 
     /*! \brief Calculates the walkable path between tiles (x1, y1) and (x2, y2).
@@ -374,24 +409,40 @@ public:
     //! \note Returns a path for the given creature to the given destination.
     std::list<Tile*> path(const Creature* creature, Tile* destination, bool throughDiggableTiles = false);
 
-    //! \brief Loops over the visibleTiles and returns any creature/room/trap in those tiles allied with the given seat
-    //! (or if enemyForce is true, is not allied)
+    //! \brief Returns any creature/room/trap in the visibleTiles allied with the given seat
+    //! (or if enemyForce is true, is not allied). Creatures are found with the entity spatial index.
+    //! It does not modify the map and can be called from several threads as long as nothing is added/removed
     std::vector<GameEntity*> getVisibleForce(const std::vector<Tile*>& visibleTiles, Seat* seat, bool enemyForce);
 
-    //! \brief Loops over the visibleTiles and returns any creature in those tiles allied with the given seat.
+    //! \brief Returns any creature in the visibleTiles allied with the given seat.
     //! (or if enemyCreatures is true, is not allied)
     std::vector<GameEntity*> getVisibleCreatures(const std::vector<Tile*>& visibleTiles, Seat* seat, bool enemyCreatures);
 
-    //! \brief Loops over the given tiles and returns any carryable entity in those tiles
+    //! \brief Returns any carryable entity in the given tiles
     std::vector<GameEntity*> getCarryableEntities(Creature* carrier, const std::vector<Tile*>& tiles);
 
-    //! \brief Checks the neighboor tiles to see if the floodfill can be used. Floodfill consists on tagging all contiguous tiles
-    //! to be able to know before computing it if a path exists between 2 tiles. We do that to avoid computing paths when we
-    //! already know that no path exists.
-    bool doFloodFill(Seat* seat, Tile* tile);
+    //! \brief Floodfill consists on tagging all contiguous tiles to be able to know before computing it if a path exists
+    //! between 2 tiles. We do that to avoid computing paths when we already know that no path exists.
+    //! refreshFloodFill should be called when a tile becomes passable to merge the areas it connects.
     void refreshFloodFill(Seat* seat, Tile* tile);
+
+    //! \brief Every tile colored with colorOld for the given seat and type will be considered as colored with colorNew.
+    //! Colors are merged in a disjoint set so the tiles are not changed and the merge costs almost nothing.
     void replaceFloodFill(Seat* seat, FloodFillType floodFillType, uint32_t colorOld, uint32_t colorNew);
 
+    //! \brief Returns the color a tile colored with the given color belongs to (after the merges done
+    //! with replaceFloodFill). Used by Tile::getFloodFillValue. Can be called from several threads
+    uint32_t getFloodFillColor(uint32_t layer, FloodFillType floodFillType, uint32_t color) const;
+
+    //! \brief Returns the floodfill layer used by the given seat team. Every team uses the shared layer (0) until
+    //! it locks a door. Then, it gets its own copy.
+    uint32_t getFloodFillLayer(const Seat* seat) const;
+
+    //! \brief Returns one seat for each floodfill layer in use. Computations done on floodfill for every seat
+    //! (when a tile is dug, a bridge built, ...) only need to be done for these.
+    inline const std::vector<Seat*>& getFloodFillLayerSeats() const
+    { return mFloodFillLayerSeats; }
+
     //! \brief Temporarily disables the flood fill computations on this game map.
     void disableFloodFill()
     { mFloodFillEnabled = false; }
@@ -425,6 +476,25 @@ public:
     inline void setTurnNumber(int64_t turnNumber)
     { mTurnNumber = turnNumber; }
 
+    //! \brief Number of calls to path() since the gamemap was created
+    inline unsigned int getNumCallsToPath() const
+    { return mNumCallsTo_path; }
+
+    //! \brief Number of calls to path() answered by the path cache since the gamemap was created
+    inline unsigned int getNumPathCacheHits() const
+    { return mNumPathCacheHits; }
+
+    //! \brief Time spent during the last doTurn (in microseconds) by the creatures sense, the vision
+    //! and the active objects upkeep. They are part of doMiscUpkeep
+    inline unsigned long int getSenseUpkeepTime() const
+    { return mSenseUpkeepTime; }
+
+    inline unsigned long int getVisionUpkeepTime() const
+    { return mVisionUpkeepTime; }
+
+    inline unsigned long int getActiveObjectsUpkeepTime() const
+    { return mActiveObjectsUpkeepTime; }
+
     inline bool isServerGameMap() const
     { return mIsServerGameMap; }
 
@@ -473,6 +543,15 @@ public:
     GameEntity* getEntityFromTypeAndName(GameEntityType entityType,
         const std::string& entityName);
 
+    //! \brief Returns the entity with the given network id or nullptr if there is none.
+    //! Ids are given by the server when the entity is added to the gamemap and sent to the
+    //! clients with the entity. Network messages reference entities by id instead of name.
+    //! The typed versions return nullptr if the entity is not of the expected kind
+    MovableGameEntity* getEntityById(uint32_t id) const;
+    Creature* getCreatureById(uint32_t id) const;
+    MovableGameEntity* getAnimatedObjectById(uint32_t id) const;
+    RenderedMovableEntity* getRenderedMovableEntityById(uint32_t id) const;
+
     //! brief Functions to add/remove/get Spells
     inline const std::vector<Spell*>& getSpells() const
     { return mSpells; }
@@ -563,6 +642,17 @@ private:
     int mUniqueNumberTrap;
     int mUniqueNumberMapLight;
     uint32_t mUniqueFloodFillValue;
+    uint32_t mUniqueEntityId;
+
+    //! \brief Merged floodfill colors. One set per floodfill layer and floodfill type
+    std::vector<DisjointSet> mFloodFillColorSets;
+
+    //! \brief Floodfill layer used by each team index
+    std::vector<uint32_t> mFloodFillTeamLayers;
+    uint32_t mNbFloodFillLayers;
+
+    //! \brief One seat per floodfill layer in use
+    std::vector<Seat*> mFloodFillLayerSeats;
 
     //! \brief When paused, the GameMap is not updated.
     bool mIsPaused;
@@ -595,6 +685,18 @@ private:
     std::vector<Trap*> mTraps;
     std::vector<MapLight*> mMapLights;
 
+    //! \brief Entities indexed by name for the getter functions (getCreature, getRoomByName, ...)
+    EntityNameRegistry<Creature> mCreaturesByName;
+    EntityNameRegistry<MovableGameEntity> mAnimatedObjectsByName;
+    EntityNameRegistry<Room> mRoomsByName;
+    EntityNameRegistry<Trap> mTrapsByName;
+    EntityNameRegistry<MapLight> mMapLightsByName;
+    EntityNameRegistry<RenderedMovableEntity> mRenderedMovableEntitiesByName;
+    EntityNameRegistry<Spell> mSpellsByName;
+
+    //! \brief Entities sent to the clients indexed by network id (see getEntityById)
+    std::unordered_map<uint32_t, MovableGameEntity*> mEntitiesById;
+
     //! \brief Players and available game player slots (Seats)
     std::vector<Player*> mPlayers;
     std::vector<Seat*> mSeats;
@@ -626,6 +728,45 @@ private:
     //! \brief Debug member used to know how many call to pathfinding has been made within the same turn.
     unsigned int mNumCallsTo_path;
 
+    //! \brief Debug members used to know how many calls to path() have been answered by the path cache
+    unsigned int mNumPathCacheHits;
+    unsigned int mNumPathCacheMisses;
+
+    //! \brief Durations of the doMiscUpkeep phases during the last turn, in microseconds
+    unsigned long int mSenseUpkeepTime;
+    unsigned long int mVisionUpkeepTime;
+    unsigned long int mActiveObjectsUpkeepTime;
+
+    //! \brief Incremented each time the passability of a tile changes. Used to invalidate the path cache
+    uint32_t mPassabilityEpoch;
+
+    //! \brief Paths computed by path() during the current turn
+    PathCache mPathCache;
+
+    //! \brief Nodes and open list used by path(). Reused from one call to another to avoid allocations.
+    PathfindingEngine mPathfindingEngine;
+
+    //! \brief Abstraction graph used by path() for long paths
+    HierarchicalPathfinding mHierarchicalPathfinding;
+
+    //! \brief Waypoints (tile indexes) of the last abstract path. Kept to avoid allocations
+    std::vector<uint32_t> mPathWaypoints;
+
+    //! \brief Vision of each seat. Updated during upkeep with the sources that changed only
+    FogOfWar mFogOfWar;
+
+    //! \brief Value of mIsFOWActivated when the tiles vision was computed
+    bool mFogOfWarComputedActivated;
+
+    //! \brief Tiles which vision has to be computed again. Kept to avoid allocations
+    std::vector<Tile*> mVisionDirtyTiles;
+
+    //! \brief Entities on the tiles sorted by area. Used to find the entities on a set of tiles without looking at each tile
+    EntitySpatialIndex mEntitySpatialIndex;
+
+    //! \brief Result of the last query to mEntitySpatialIndex. Kept to avoid allocations
+    std::vector<EntitySpatialIndex::TileEntity> mTileEntities;
+
     std::vector<RenderedMovableEntity*> mRenderedMovableEntities;
 
     std::vector<Spell*> mSpells;
@@ -639,12 +780,64 @@ private:
     const TileSet* mTileSet;
     std::string mTileSetName;
 
+    //! \brief Workers used for the creatures sense phase. Created on the first server upkeep
+    std::unique_ptr<ThreadPool> mThreadPool;
+
     //! \brief Updates different entities states.
     //! Updates active objects (creatures, rooms, ...), goals, count each team Workers, gold, mana and claimed tiles.
     unsigned long int doMiscUpkeep(double timeSinceLastTurn);
 
+    //! \brief Calls Creature::senseUpkeep for every creature in parallel. Nothing should be added to or
+    //! removed from the map while it runs
+    void senseCreaturesUpkeep();
+
+    //! \brief Recomputes the vision of the sources that may have changed and sends the visible
+    //! tiles to the seats
+    void visionUpkeep();
+
+    //! \brief Calls doUpkeep on every active object
+    void activeObjectsUpkeep();
+
+#ifdef OD_DEBUG
+    //! \brief Compares the seat stats with a full computation over the gamemap and logs the differences
+    void checkSeatStats();
+#endif
+
+    //! \brief On server side, gives the next network id to the entity if it has none. On both
+    //! sides, registers it so that it can be found by getEntityById
+    void registerEntityId(MovableGameEntity* entity);
+    void unregisterEntityId(MovableGameEntity* entity);
+
     //! \brief Resets the unique numbers
     void resetUniqueNumbers();
+
+    DisjointSet& getFloodFillColorSet(uint32_t layer, FloodFillType floodFillType);
+
+    //! \brief Gives its own floodfill layer to the given seat team if it uses the shared one
+    void detachFloodFillLayer(const Seat* seat);
+    void updateFloodFillLayerSeats();
+
+    //! \brief Tells whether the given tile is walkable for the given floodfill type (without taking into account buildings)
+    static bool isFloodFillPassable(Tile* tile, FloodFillType floodFillType);
+    static bool isFloodFillPassable(TileType tileType, double fullness, FloodFillType floodFillType);
+
+    //! \brief Fills the path cache key matching the given creature. Returns false if the path should not be cached
+    bool getPathCacheKey(Tile* start, Tile* destination, const Creature* creature, PathCache::Key& key) const;
+
+    //! \brief Computes the path requested by path(). path() only adds the trace recording
+    std::list<Tile*> computePath(int x1, int y1, int x2, int y2, const Creature* creature, Seat* seat, bool throughDiggableTiles);
+
+    //! \brief Computes the path between start and destination using the abstraction graph. Returns true
+    //! if a path could be found. If false is returned, the path should be computed at tile level
+    bool pathHierarchical(Tile* start, Tile* destination, const Creature* creature, Seat* seat, std::list<Tile*>& returnList);
+
+    //! \brief Passability used by the abstraction graph. Only the tile types are taken into account
+    bool isHierarchicalPathPassable(int x, int y, uint32_t type) const;
+
+    //! \brief Computes the path between start and destination at tile level. Fills returnList and returns true if a path
+    //! could be found
+    bool pathTiles(Tile* start, Tile* destination, const Creature* creature, Seat* seat, bool throughDiggableTiles,
+        std::list<Tile*>& returnList);
 };
 
 #endif // GAMEMAP_H
@@ -0,0 +1,400 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/HierarchicalPathfinding.h"
+
+#include <algorithm>
+#include <limits>
+
+const int HierarchicalPathfinding::CLUSTER_SIZE = 16;
+
+namespace
+{
+    const uint32_t UNREACHABLE = std::numeric_limits<uint32_t>::max();
+
+    //! \brief Runs of crossable tiles longer than this get a portal at each end instead of one in the middle
+    const int LONG_ENTRANCE_LENGTH = 6;
+
+    enum BorderDirection
+    {
+        borderEast = 0x01,
+        borderSouth = 0x02,
+        borderWest = 0x04,
+        borderNorth = 0x08
+    };
+
+    const uint8_t BORDERS[4] = { borderEast, borderSouth, borderWest, borderNorth };
+    const int BORDERS_DIR_X[4] = { 1, 0, -1, 0 };
+    const int BORDERS_DIR_Y[4] = { 0, 1, 0, -1 };
+}
+
+HierarchicalPathfinding::HierarchicalPathfinding(uint32_t nbTypes, const PassableFunction& isPassable) :
+    mNbTypes(nbTypes),
+    mIsPassable(isPassable),
+    mSizeX(0),
+    mSizeY(0),
+    mNbClustersX(0),
+    mNbClustersY(0)
+{
+}
+
+void HierarchicalPathfinding::reset(int sizeX, int sizeY)
+{
+    mSizeX = sizeX;
+    mSizeY = sizeY;
+    mNbClustersX = (sizeX + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+    mNbClustersY = (sizeY + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+
+    Cluster cluster;
+    cluster.mDirty = true;
+    cluster.mLayers.resize(mNbTypes);
+    mClusters.assign(static_cast<uint32_t>(mNbClustersX * mNbClustersY), cluster);
+    mDirtyClusters.clear();
+    for(uint32_t clusterIndex = 0; clusterIndex < mClusters.size(); ++clusterIndex)
+        mDirtyClusters.push_back(clusterIndex);
+
+    mPortalIndex.assign(mNbTypes, std::vector<int16_t>(static_cast<uint32_t>(sizeX * sizeY), -1));
+    mEngine.setMapSize(sizeX, sizeY);
+
+    uint32_t clusterTiles = static_cast<uint32_t>(CLUSTER_SIZE * CLUSTER_SIZE);
+    mLocalQueue.reserve(clusterTiles);
+    mLocalDistances.resize(clusterTiles);
+    mStartDistances.resize(clusterTiles);
+    mDestDistances.resize(clusterTiles);
+    mLocalPassable.resize(clusterTiles);
+}
+
+void HierarchicalPathfinding::invalidateTile(int x, int y)
+{
+    if((x < 0) || (y < 0) || (x >= mSizeX) || (y >= mSizeY))
+        return;
+
+    int clusterX = x / CLUSTER_SIZE;
+    int clusterY = y / CLUSTER_SIZE;
+    // If the tile is on a border, the portals of the neighbor cluster may change too
+    for(int k = 0; k < 5; ++k)
+    {
+        int cx = clusterX;
+        int cy = clusterY;
+        if(k > 0)
+        {
+            cx = (x + BORDERS_DIR_X[k - 1]) / CLUSTER_SIZE;
+            cy = (y + BORDERS_DIR_Y[k - 1]) / CLUSTER_SIZE;
+            if((x + BORDERS_DIR_X[k - 1] < 0) || (y + BORDERS_DIR_Y[k - 1] < 0))
+                continue;
+            if((cx >= mNbClustersX) || (cy >= mNbClustersY))
+                continue;
+            if((cx == clusterX) && (cy == clusterY))
+                continue;
+        }
+
+        uint32_t clusterIndex = static_cast<uint32_t>(cy * mNbClustersX + cx);
+        Cluster& cluster = mClusters[clusterIndex];
+        if(cluster.mDirty)
+            continue;
+
+        cluster.mDirty = true;
+        mDirtyClusters.push_back(clusterIndex);
+    }
+}
+
+void HierarchicalPathfinding::getClusterBounds(uint32_t clusterIndex, int& x0, int& y0, int& x1, int& y1) const
+{
+    x0 = (static_cast<int>(clusterIndex) % mNbClustersX) * CLUSTER_SIZE;
+    y0 = (static_cast<int>(clusterIndex) / mNbClustersX) * CLUSTER_SIZE;
+    x1 = std::min(x0 + CLUSTER_SIZE, mSizeX);
+    y1 = std::min(y0 + CLUSTER_SIZE, mSizeY);
+}
+
+void HierarchicalPathfinding::rebuildDirtyClusters()
+{
+    for(uint32_t clusterIndex : mDirtyClusters)
+    {
+        for(uint32_t type = 0; type < mNbTypes; ++type)
+            rebuildCluster(clusterIndex, type);
+
+        mClusters[clusterIndex].mDirty = false;
+    }
+    mDirtyClusters.clear();
+}
+
+void HierarchicalPathfinding::rebuildCluster(uint32_t clusterIndex, uint32_t type)
+{
+    ClusterLayer& layer = mClusters[clusterIndex].mLayers[type];
+    std::vector<int16_t>& portalIndex = mPortalIndex[type];
+    for(uint32_t portal : layer.mPortals)
+        portalIndex[portal] = -1;
+
+    layer.mPortals.clear();
+    layer.mPortalBorders.clear();
+    layer.mDistances.clear();
+
+    int x0, y0, x1, y1;
+    getClusterBounds(clusterIndex, x0, y0, x1, y1);
+
+    // Portals are computed with the same order on both sides of a border so that
+    // both clusters agree on where they are
+    if(x1 < mSizeX)
+        addBorderPortals(layer, type, x1 - 1, y0, 0, 1, y1 - y0, 1, 0, borderEast);
+    if(y1 < mSizeY)
+        addBorderPortals(layer, type, x0, y1 - 1, 1, 0, x1 - x0, 0, 1, borderSouth);
+    if(x0 > 0)
+        addBorderPortals(layer, type, x0, y0, 0, 1, y1 - y0, -1, 0, borderWest);
+    if(y0 > 0)
+        addBorderPortals(layer, type, x0, y0, 1, 0, x1 - x0, 0, -1, borderNorth);
+
+    uint32_t nbPortals = static_cast<uint32_t>(layer.mPortals.size());
+    for(uint32_t i = 0; i < nbPortals; ++i)
+        portalIndex[layer.mPortals[i]] = static_cast<int16_t>(i);
+
+    if(nbPortals == 0)
+        return;
+
+    // We compute the distances between every portal
+    fillLocalPassable(clusterIndex, type);
+    layer.mDistances.assign(nbPortals * nbPortals, UNREACHABLE);
+    int width = x1 - x0;
+    for(uint32_t i = 0; i < nbPortals; ++i)
+    {
+        int px = static_cast<int>(layer.mPortals[i] % static_cast<uint32_t>(mSizeX));
+        int py = static_cast<int>(layer.mPortals[i] / static_cast<uint32_t>(mSizeX));
+        computeLocalDistances(clusterIndex, px, py, mLocalDistances);
+        for(uint32_t j = 0; j < nbPortals; ++j)
+        {
+            int qx = static_cast<int>(layer.mPortals[j] % static_cast<uint32_t>(mSizeX));
+            int qy = static_cast<int>(layer.mPortals[j] / static_cast<uint32_t>(mSizeX));
+            layer.mDistances[i * nbPortals + j] = mLocalDistances[(qy - y0) * width + (qx - x0)];
+        }
+    }
+}
+
+void HierarchicalPathfinding::addBorderPortals(ClusterLayer& layer, uint32_t type, int xStart, int yStart, int stepX, int stepY,
+    int length, int dirX, int dirY, uint8_t border)
+{
+    int runStart = -1;
+    for(int i = 0; i <= length; ++i)
+    {
+        bool crossable = false;
+        if(i < length)
+        {
+            int x = xStart + i * stepX;
+            int y = yStart + i * stepY;
+            crossable = isPassable(x, y, type) && isPassable(x + dirX, y + dirY, type);
+        }
+
+        if(crossable)
+        {
+            if(runStart < 0)
+                runStart = i;
+
+            continue;
+        }
+
+        if(runStart < 0)
+            continue;
+
+        // The run [runStart, i) is crossable. We add its portals
+        int runLength = i - runStart;
+        int positions[2] = { runStart + runLength / 2, -1 };
+        if(runLength >= LONG_ENTRANCE_LENGTH)
+        {
+            positions[0] = runStart;
+            positions[1] = i - 1;
+        }
+        for(int position : positions)
+        {
+            if(position < 0)
+                continue;
+
+            uint32_t tileIndex = toIndex(xStart + position * stepX, yStart + position * stepY);
+            // A corner tile can be a portal for 2 borders
+            std::vector<uint32_t>::iterator it = std::find(layer.mPortals.begin(), layer.mPortals.end(), tileIndex);
+            if(it != layer.mPortals.end())
+            {
+                layer.mPortalBorders[it - layer.mPortals.begin()] |= border;
+                continue;
+            }
+
+            layer.mPortals.push_back(tileIndex);
+            layer.mPortalBorders.push_back(border);
+        }
+
+        runStart = -1;
+    }
+}
+
+void HierarchicalPathfinding::fillLocalPassable(uint32_t clusterIndex, uint32_t type)
+{
+    int x0, y0, x1, y1;
+    getClusterBounds(clusterIndex, x0, y0, x1, y1);
+    int width = x1 - x0;
+    for(int y = y0; y < y1; ++y)
+    {
+        for(int x = x0; x < x1; ++x)
+            mLocalPassable[(y - y0) * width + (x - x0)] = isPassable(x, y, type);
+    }
+}
+
+void HierarchicalPathfinding::computeLocalDistances(uint32_t clusterIndex, int sourceX, int sourceY, std::vector<uint32_t>& distances)
+{
+    int x0, y0, x1, y1;
+    getClusterBounds(clusterIndex, x0, y0, x1, y1);
+    int width = x1 - x0;
+    int height = y1 - y0;
+    std::fill(distances.begin(), distances.begin() + width * height, UNREACHABLE);
+
+    // Moving in diagonal costs as much as 2 straight moves in GameMap::path. A breadth first search
+    // on the 4 adjacent tiles gives the same distances
+    mLocalQueue.clear();
+    uint32_t source = static_cast<uint32_t>((sourceY - y0) * width + (sourceX - x0));
+    distances[source] = 0;
+    mLocalQueue.push_back(source);
+    for(uint32_t queueIndex = 0; queueIndex < mLocalQueue.size(); ++queueIndex)
+    {
+        uint32_t local = mLocalQueue[queueIndex];
+        int lx = static_cast<int>(local % static_cast<uint32_t>(width));
+        int ly = static_cast<int>(local / static_cast<uint32_t>(width));
+        for(int k = 0; k < 4; ++k)
+        {
+            int nx = lx + BORDERS_DIR_X[k];
+            int ny = ly + BORDERS_DIR_Y[k];
+            if((nx < 0) || (ny < 0) || (nx >= width) || (ny >= height))
+                continue;
+
+            uint32_t neighbor = static_cast<uint32_t>(ny * width + nx);
+            if(!mLocalPassable[neighbor])
+                continue;
+            if(distances[neighbor] != UNREACHABLE)
+                continue;
+
+            distances[neighbor] = distances[local] + 1;
+            mLocalQueue.push_back(neighbor);
+        }
+    }
+}
+
+bool HierarchicalPathfinding::findAbstractPath(int startX, int startY, int destX, int destY, uint32_t type,
+    std::vector<uint32_t>& waypoints)
+{
+    waypoints.clear();
+    if(mClusters.empty())
+        return false;
+
+    rebuildDirtyClusters();
+
+    uint32_t startCluster = getClusterIndex(startX, startY);
+    uint32_t destCluster = getClusterIndex(destX, destY);
+    if(startCluster == destCluster)
+        return false;
+
+    int startX0, startY0, startX1, startY1;
+    getClusterBounds(startCluster, startX0, startY0, startX1, startY1);
+    int startWidth = startX1 - startX0;
+    fillLocalPassable(startCluster, type);
+    computeLocalDistances(startCluster, startX, startY, mStartDistances);
+
+    int destX0, destY0, destX1, destY1;
+    getClusterBounds(destCluster, destX0, destY0, destX1, destY1);
+    int destWidth = destX1 - destX0;
+    fillLocalPassable(destCluster, type);
+    computeLocalDistances(destCluster, destX, destY, mDestDistances);
+
+    const ClusterLayer& startLayer = mClusters[startCluster].mLayers[type];
+    const std::vector<int16_t>& portalIndexes = mPortalIndex[type];
+    uint32_t startIndex = toIndex(startX, startY);
+    uint32_t destIndex = toIndex(destX, destY);
+
+    bool found = false;
+    int x;
+    int y;
+    mEngine.startSearch(startX, startY, destX, destY);
+    while(mEngine.popLowestCost(x, y))
+    {
+        uint32_t index = toIndex(x, y);
+        if(index == destIndex)
+        {
+            found = true;
+            break;
+        }
+
+        double g = mEngine.getG(x, y);
+        if(index == startIndex)
+        {
+            for(uint32_t portal : startLayer.mPortals)
+            {
+                int px = static_cast<int>(portal % static_cast<uint32_t>(mSizeX));
+                int py = static_cast<int>(portal / static_cast<uint32_t>(mSizeX));
+                uint32_t dist = mStartDistances[(py - startY0) * startWidth + (px - startX0)];
+                if(dist == UNREACHABLE)
+                    continue;
+
+                mEngine.pushOrDecrease(px, py, g + dist, x, y);
+            }
+        }
+
+        uint32_t clusterIndex = getClusterIndex(x, y);
+        int16_t portalIndex = portalIndexes[index];
+        if(portalIndex >= 0)
+        {
+            const ClusterLayer& layer = mClusters[clusterIndex].mLayers[type];
+            uint32_t nbPortals = static_cast<uint32_t>(layer.mPortals.size());
+            uint32_t i = static_cast<uint32_t>(portalIndex);
+            // Portals within the same cluster
+            for(uint32_t j = 0; j < nbPortals; ++j)
+            {
+                uint32_t dist = layer.mDistances[i * nbPortals + j];
+                if((j == i) || (dist == UNREACHABLE))
+                    continue;
+
+                int px = static_cast<int>(layer.mPortals[j] % static_cast<uint32_t>(mSizeX));
+                int py = static_cast<int>(layer.mPortals[j] / static_cast<uint32_t>(mSizeX));
+                mEngine.pushOrDecrease(px, py, g + dist, x, y);
+            }
+
+            // Portals in the neighbor clusters
+            for(int k = 0; k < 4; ++k)
+            {
+                if((layer.mPortalBorders[i] & BORDERS[k]) == 0)
+                    continue;
+
+                mEngine.pushOrDecrease(x + BORDERS_DIR_X[k], y + BORDERS_DIR_Y[k], g + 1.0, x, y);
+            }
+        }
+
+        if(clusterIndex == destCluster)
+        {
+            uint32_t dist = mDestDistances[(y - destY0) * destWidth + (x - destX0)];
+            if(dist != UNREACHABLE)
+                mEngine.pushOrDecrease(destX, destY, g + dist, x, y);
+        }
+    }
+
+    if(!found)
+        return false;
+
+    int pathX = destX;
+    int pathY = destY;
+    while(mEngine.getParent(pathX, pathY, pathX, pathY))
+    {
+        if((pathX == startX) && (pathY == startY))
+            break;
+
+        waypoints.push_back(toIndex(pathX, pathY));
+    }
+    std::reverse(waypoints.begin(), waypoints.end());
+    return true;
+}
@@ -0,0 +1,134 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HIERARCHICALPATHFINDING_H
+#define HIERARCHICALPATHFINDING_H
+
+#include "gamemap/PathfindingEngine.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/*! \brief Abstraction graph used to compute long paths (HPA*).
+ *
+ * The map is split in square clusters of CLUSTER_SIZE tiles. For each floodfill type (ground,
+ * groundWater, ...), the tiles where 2 neighbor clusters can be crossed are linked together (portals)
+ * and the distance between the portals of the same cluster is precomputed. A long path can then be
+ * searched on this graph which is much smaller than the tile graph.
+ * Like PathfindingEngine, the graph knows nothing about tiles. The passability of each position for each
+ * floodfill type is given by the callback given to the constructor (GameMap only takes into account the tile
+ * types). Seat dependent passability (like locked doors) and the creature speeds are handled by GameMap::path
+ * when the abstract path is refined to tiles.
+ *
+ * When the passability of a tile changes, invalidateTile should be called. The cluster (and the neighbor one
+ * if the tile is on a border) will be rebuilt the next time an abstract path is asked.
+ */
+class HierarchicalPathfinding
+{
+public:
+    //! \brief Tells whether creatures moving on the given floodfill type can go through the given position
+    typedef std::function<bool(int x, int y, uint32_t type)> PassableFunction;
+
+    HierarchicalPathfinding(uint32_t nbTypes, const PassableFunction& isPassable);
+
+    //! \brief Sizes the clusters to the given map size. Every cluster is marked to be rebuilt.
+    void reset(int sizeX, int sizeY);
+
+    //! \brief Marks the clusters containing the given tile to be rebuilt.
+    void invalidateTile(int x, int y);
+
+    /*! \brief Computes the abstract path between start and destination for the given floodfill type.
+     * If a path is found, waypoints is filled with the indexes (y * sizeX + x) of the portal tiles the path
+     * goes through (start and destination are not included) and true is returned.
+     * Returns false if no path could be found or if start and destination are within the same cluster.
+     * In this case, the caller should compute the path at tile level.
+     */
+    bool findAbstractPath(int startX, int startY, int destX, int destY, uint32_t type, std::vector<uint32_t>& waypoints);
+
+    //! \brief Size (in tiles) of the side of a cluster
+    static const int CLUSTER_SIZE;
+
+private:
+    struct ClusterLayer
+    {
+        //! \brief Indexes of the portal tiles of the cluster
+        std::vector<uint32_t> mPortals;
+        //! \brief Bitmask of the borders (see BorderDirection) through which each portal can be crossed
+        std::vector<uint8_t> mPortalBorders;
+        //! \brief Distances between the portals (mPortals.size() * mPortals.size()).
+        std::vector<uint32_t> mDistances;
+    };
+
+    struct Cluster
+    {
+        bool mDirty;
+        //! \brief One layer per floodfill type
+        std::vector<ClusterLayer> mLayers;
+    };
+
+    uint32_t mNbTypes;
+    PassableFunction mIsPassable;
+
+    int mSizeX;
+    int mSizeY;
+    int mNbClustersX;
+    int mNbClustersY;
+
+    std::vector<Cluster> mClusters;
+
+    //! \brief Clusters that need to be rebuilt
+    std::vector<uint32_t> mDirtyClusters;
+
+    //! \brief For each floodfill type and each tile, the index of the tile in the portals of its cluster (or -1)
+    std::vector<std::vector<int16_t>> mPortalIndex;
+
+    //! \brief Used for the abstract searches
+    PathfindingEngine mEngine;
+
+    //! \brief Buffers reused for the searches within a cluster
+    std::vector<uint32_t> mLocalQueue;
+    std::vector<uint32_t> mLocalDistances;
+    std::vector<uint32_t> mStartDistances;
+    std::vector<uint32_t> mDestDistances;
+    std::vector<bool> mLocalPassable;
+
+    inline uint32_t toIndex(int x, int y) const
+    { return static_cast<uint32_t>(y * mSizeX + x); }
+
+    inline uint32_t getClusterIndex(int x, int y) const
+    { return static_cast<uint32_t>((y / CLUSTER_SIZE) * mNbClustersX + (x / CLUSTER_SIZE)); }
+
+    inline bool isPassable(int x, int y, uint32_t type) const
+    { return mIsPassable(x, y, type); }
+
+    void rebuildDirtyClusters();
+    void rebuildCluster(uint32_t clusterIndex, uint32_t type);
+
+    //! \brief Adds to the given layer the portals along one border of the cluster
+    void addBorderPortals(ClusterLayer& layer, uint32_t type, int xStart, int yStart, int stepX, int stepY,
+        int length, int dirX, int dirY, uint8_t border);
+
+    //! \brief Computes the distances from the source tile to every tile of the cluster. The cluster passability
+    //! should have been filled in mLocalPassable. The source tile is always considered as passable.
+    void computeLocalDistances(uint32_t clusterIndex, int sourceX, int sourceY, std::vector<uint32_t>& distances);
+
+    void fillLocalPassable(uint32_t clusterIndex, uint32_t type);
+    void getClusterBounds(uint32_t clusterIndex, int& x0, int& y0, int& x1, int& y1) const;
+};
+
+#endif // HIERARCHICALPATHFINDING_H
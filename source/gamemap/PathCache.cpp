@@ -0,0 +1,84 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/PathCache.h"
+
+#include <functional>
+
+const size_t PathCache::MAX_ENTRIES = 4096;
+
+bool PathCache::Key::operator==(const Key& other) const
+{
+    return (mStart == other.mStart) &&
+        (mDest == other.mDest) &&
+        (mFloodFillType == other.mFloodFillType) &&
+        (mSeatId == other.mSeatId) &&
+        (mBlockedByEnemyDoors == other.mBlockedByEnemyDoors) &&
+        (mSpeedGround == other.mSpeedGround) &&
+        (mSpeedWater == other.mSpeedWater) &&
+        (mSpeedLava == other.mSpeedLava);
+}
+
+size_t PathCache::KeyHash::operator()(const Key& key) const
+{
+    size_t hash = std::hash<uint32_t>()(key.mStart);
+    hash = hash * 31 + std::hash<uint32_t>()(key.mDest);
+    hash = hash * 31 + std::hash<uint32_t>()(key.mFloodFillType);
+    hash = hash * 31 + std::hash<int32_t>()(key.mSeatId);
+    hash = hash * 31 + std::hash<bool>()(key.mBlockedByEnemyDoors);
+    hash = hash * 31 + std::hash<double>()(key.mSpeedGround);
+    hash = hash * 31 + std::hash<double>()(key.mSpeedWater);
+    hash = hash * 31 + std::hash<double>()(key.mSpeedLava);
+    return hash;
+}
+
+PathCache::PathCache() :
+    mEpoch(0)
+{
+}
+
+const std::list<Tile*>* PathCache::find(const Key& key, uint32_t epoch)
+{
+    if(epoch != mEpoch)
+    {
+        mPaths.clear();
+        mEpoch = epoch;
+        return nullptr;
+    }
+
+    auto it = mPaths.find(key);
+    if(it == mPaths.end())
+        return nullptr;
+
+    return &it->second;
+}
+
+void PathCache::store(const Key& key, const std::list<Tile*>& path, uint32_t epoch)
+{
+    if((epoch != mEpoch) || (mPaths.size() >= MAX_ENTRIES))
+    {
+        mPaths.clear();
+        mEpoch = epoch;
+    }
+
+    mPaths[key] = path;
+}
+
+void PathCache::clear()
+{
+    mPaths.clear();
+}
@@ -0,0 +1,88 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATHCACHE_H
+#define PATHCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+class Tile;
+
+/*! \brief Memoizes the paths computed by GameMap::path.
+ *
+ * Paths are stored for a given passability epoch. The epoch is a counter incremented by the
+ * game map each time the passability of a tile changes (tile dug, building placed, door locked, ...).
+ * When the cache is used with an epoch different from the one its entries were computed for,
+ * every entry is dropped.
+ * The key contains everything that can change the path found by GameMap::path: the floodfill type,
+ * the creature speeds (used to weight the tiles) and what is needed to know if the creature can go
+ * through doors.
+ */
+class PathCache
+{
+public:
+    struct Key
+    {
+        uint32_t mStart;
+        uint32_t mDest;
+        uint32_t mFloodFillType;
+        //! \brief Id of the creature seat. Doors are locked only for some seats
+        int32_t mSeatId;
+        //! \brief True if enemy locked doors block the creature (when fighting or fleeing)
+        bool mBlockedByEnemyDoors;
+        double mSpeedGround;
+        double mSpeedWater;
+        double mSpeedLava;
+
+        bool operator==(const Key& other) const;
+    };
+
+    PathCache();
+
+    /*! \brief Returns the cached path for the given key or nullptr if there is none. If the given epoch
+     * differs from the one of the cached paths, the cache is cleared.
+     * Note that an empty path means that no path could be found.
+     */
+    const std::list<Tile*>* find(const Key& key, uint32_t epoch);
+
+    //! \brief Stores the path computed for the given key and epoch
+    void store(const Key& key, const std::list<Tile*>& path, uint32_t epoch);
+
+    void clear();
+
+    inline size_t getNbEntries() const
+    { return mPaths.size(); }
+
+    //! \brief Maximum number of paths kept. When reached, the cache is cleared
+    static const size_t MAX_ENTRIES;
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+    //! \brief Epoch the cached paths were computed for
+    uint32_t mEpoch;
+
+    std::unordered_map<Key, std::list<Tile*>, KeyHash> mPaths;
+};
+
+#endif // PATHCACHE_H
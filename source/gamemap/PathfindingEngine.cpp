@@ -0,0 +1,199 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/PathfindingEngine.h"
+
+#include <cmath>
+#include <utility>
+
+const int32_t PathfindingEngine::CLOSED = -1;
+const int32_t PathfindingEngine::NO_PARENT = -1;
+
+PathfindingEngine::PathfindingEngine() :
+    mSizeX(0),
+    mSizeY(0),
+    mDestX(0),
+    mDestY(0),
+    mGeneration(0),
+    mNbNodesClosed(0)
+{
+}
+
+void PathfindingEngine::setMapSize(int sizeX, int sizeY)
+{
+    if((sizeX == mSizeX) && (sizeY == mSizeY))
+        return;
+
+    mSizeX = sizeX;
+    mSizeY = sizeY;
+    Node node;
+    node.mGeneration = 0;
+    node.mHeapIndex = CLOSED;
+    node.mParent = NO_PARENT;
+    node.mG = 0.0;
+    node.mF = 0.0;
+    mNodes.assign(static_cast<uint32_t>(sizeX * sizeY), node);
+    mHeap.clear();
+    mHeap.reserve(mNodes.size());
+    mGeneration = 0;
+}
+
+double PathfindingEngine::computeHeuristic(int x1, int y1, int x2, int y2)
+{
+    return std::fabs(static_cast<double>(x2 - x1)) + std::fabs(static_cast<double>(y2 - y1));
+}
+
+void PathfindingEngine::startSearch(int startX, int startY, int destX, int destY)
+{
+    ++mGeneration;
+    // When the generation wraps, old stamps could be taken for current ones. We reset them
+    if(mGeneration == 0)
+    {
+        for(Node& node : mNodes)
+            node.mGeneration = 0;
+
+        mGeneration = 1;
+    }
+
+    mDestX = destX;
+    mDestY = destY;
+    mNbNodesClosed = 0;
+    mHeap.clear();
+
+    uint32_t index = toIndex(startX, startY);
+    Node& node = mNodes[index];
+    node.mGeneration = mGeneration;
+    node.mParent = NO_PARENT;
+    node.mG = 0.0;
+    node.mF = computeHeuristic(startX, startY, destX, destY);
+    node.mHeapIndex = 0;
+    mHeap.push_back(index);
+}
+
+bool PathfindingEngine::popLowestCost(int& x, int& y)
+{
+    if(mHeap.empty())
+        return false;
+
+    uint32_t index = mHeap.front();
+    heapSwap(0, static_cast<int32_t>(mHeap.size()) - 1);
+    mHeap.pop_back();
+    if(!mHeap.empty())
+        heapSiftDown(0);
+
+    mNodes[index].mHeapIndex = CLOSED;
+    ++mNbNodesClosed;
+    x = static_cast<int>(index % static_cast<uint32_t>(mSizeX));
+    y = static_cast<int>(index / static_cast<uint32_t>(mSizeX));
+    return true;
+}
+
+bool PathfindingEngine::isClosed(int x, int y) const
+{
+    uint32_t index = toIndex(x, y);
+    return isVisited(index) && (mNodes[index].mHeapIndex == CLOSED);
+}
+
+void PathfindingEngine::pushOrDecrease(int x, int y, double g, int parentX, int parentY)
+{
+    uint32_t index = toIndex(x, y);
+    Node& node = mNodes[index];
+    if(!isVisited(index))
+    {
+        node.mGeneration = mGeneration;
+        node.mParent = static_cast<int32_t>(toIndex(parentX, parentY));
+        node.mG = g;
+        node.mF = g + computeHeuristic(x, y, mDestX, mDestY);
+        node.mHeapIndex = static_cast<int32_t>(mHeap.size());
+        mHeap.push_back(index);
+        heapSiftUp(node.mHeapIndex);
+        return;
+    }
+
+    if(node.mHeapIndex == CLOSED)
+        return;
+
+    if(g >= node.mG)
+        return;
+
+    // The heuristic does not change so we can shift f by the g difference
+    node.mF -= node.mG - g;
+    node.mG = g;
+    node.mParent = static_cast<int32_t>(toIndex(parentX, parentY));
+    heapSiftUp(node.mHeapIndex);
+}
+
+double PathfindingEngine::getG(int x, int y) const
+{
+    return mNodes[toIndex(x, y)].mG;
+}
+
+bool PathfindingEngine::getParent(int x, int y, int& parentX, int& parentY) const
+{
+    uint32_t index = toIndex(x, y);
+    if(!isVisited(index))
+        return false;
+
+    int32_t parent = mNodes[index].mParent;
+    if(parent == NO_PARENT)
+        return false;
+
+    parentX = parent % mSizeX;
+    parentY = parent / mSizeX;
+    return true;
+}
+
+void PathfindingEngine::heapSiftUp(int32_t heapIndex)
+{
+    while(heapIndex > 0)
+    {
+        int32_t parentIndex = (heapIndex - 1) / 2;
+        if(mNodes[mHeap[parentIndex]].mF <= mNodes[mHeap[heapIndex]].mF)
+            break;
+
+        heapSwap(heapIndex, parentIndex);
+        heapIndex = parentIndex;
+    }
+}
+
+void PathfindingEngine::heapSiftDown(int32_t heapIndex)
+{
+    int32_t heapSize = static_cast<int32_t>(mHeap.size());
+    while(true)
+    {
+        int32_t smallest = heapIndex;
+        int32_t left = 2 * heapIndex + 1;
+        int32_t right = left + 1;
+        if((left < heapSize) && (mNodes[mHeap[left]].mF < mNodes[mHeap[smallest]].mF))
+            smallest = left;
+        if((right < heapSize) && (mNodes[mHeap[right]].mF < mNodes[mHeap[smallest]].mF))
+            smallest = right;
+
+        if(smallest == heapIndex)
+            break;
+
+        heapSwap(heapIndex, smallest);
+        heapIndex = smallest;
+    }
+}
+
+void PathfindingEngine::heapSwap(int32_t heapIndex1, int32_t heapIndex2)
+{
+    std::swap(mHeap[heapIndex1], mHeap[heapIndex2]);
+    mNodes[mHeap[heapIndex1]].mHeapIndex = heapIndex1;
+    mNodes[mHeap[heapIndex2]].mHeapIndex = heapIndex2;
+}
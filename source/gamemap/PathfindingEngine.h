@@ -0,0 +1,117 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATHFINDINGENGINE_H
+#define PATHFINDINGENGINE_H
+
+#include <cstdint>
+#include <vector>
+
+/*! \brief Storage and open list used by the A* search in GameMap::path.
+ *
+ * The engine holds one node per tile of the map. Nodes are never cleared between
+ * searches: each node is stamped with the search generation that last touched it and
+ * a node whose stamp differs from the current generation is considered as unvisited.
+ * That way, starting a new search is O(1) and no memory is allocated once the arrays
+ * have been sized to the map.
+ * The open list is an indexed binary heap ordered by f-cost. Each node knows its position
+ * in the heap so that its cost can be decreased in O(log n) when a shorter way is found.
+ *
+ * The engine knows nothing about tiles or creatures. The caller decides which neighbors
+ * are processed and how much it costs to go to them.
+ */
+class PathfindingEngine
+{
+public:
+    PathfindingEngine();
+
+    //! \brief Sizes the node array to the given map size. Does nothing if the size did not change.
+    void setMapSize(int sizeX, int sizeY);
+
+    //! \brief Starts a new search. The start node is pushed in the open list.
+    //! The destination is used to compute the heuristic.
+    void startSearch(int startX, int startY, int destX, int destY);
+
+    //! \brief Removes the node with the lowest f-cost from the open list and closes it.
+    //! \returns false if the open list is empty (no path exists).
+    bool popLowestCost(int& x, int& y);
+
+    //! \brief Returns true if the given node has already been removed from the open list
+    //! during the current search.
+    bool isClosed(int x, int y) const;
+
+    //! \brief Adds the given node to the open list with the given cost and parent. If the node is already
+    //! in the open list, its cost and parent are updated only if the given cost is lower.
+    //! Closed nodes are ignored.
+    void pushOrDecrease(int x, int y, double g, int parentX, int parentY);
+
+    //! \brief Returns the cost from the start node to the given node during the current search.
+    double getG(int x, int y) const;
+
+    //! \brief Sets parentX/parentY to the parent of the given node.
+    //! \returns false if the node has no parent (it is the start node or has not been visited).
+    bool getParent(int x, int y, int& parentX, int& parentY) const;
+
+    //! \brief Number of nodes closed during the current search.
+    inline uint32_t getNbNodesClosed() const
+    { return mNbNodesClosed; }
+
+    //! \brief The heuristic used by the search (manhattan distance).
+    static double computeHeuristic(int x1, int y1, int x2, int y2);
+
+private:
+    //! \brief Value of mHeapIndex for nodes that have been removed from the open list
+    static const int32_t CLOSED;
+    //! \brief Value of mParent for nodes without parent
+    static const int32_t NO_PARENT;
+
+    struct Node
+    {
+        uint32_t mGeneration;
+        int32_t mHeapIndex;
+        int32_t mParent;
+        double mG;
+        double mF;
+    };
+
+    inline uint32_t toIndex(int x, int y) const
+    { return static_cast<uint32_t>(y * mSizeX + x); }
+
+    inline bool isVisited(uint32_t index) const
+    { return mNodes[index].mGeneration == mGeneration; }
+
+    void heapSiftUp(int32_t heapIndex);
+    void heapSiftDown(int32_t heapIndex);
+    void heapSwap(int32_t heapIndex1, int32_t heapIndex2);
+
+    int mSizeX;
+    int mSizeY;
+    int mDestX;
+    int mDestY;
+
+    //! \brief Current search generation. Nodes stamped with another value are unvisited.
+    uint32_t mGeneration;
+
+    uint32_t mNbNodesClosed;
+
+    std::vector<Node> mNodes;
+
+    //! \brief The open list. Contains node indexes ordered as a binary heap on Node::mF
+    std::vector<uint32_t> mHeap;
+};
+
+#endif // PATHFINDINGENGINE_H
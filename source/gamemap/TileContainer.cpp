@@ -17,13 +17,14 @@
 
 #include "gamemap/TileContainer.h"
 
+#include "entities/Building.h"
 #include "entities/Tile.h"
 
 #include "network/ODPacket.h"
 #include "utils/Helper.h"
 #include "utils/LogManager.h"
 
-const std::vector<Tile*> EMPTY_TILES;
+#include <algorithm>
 
 class TileDistance
 {
@@ -262,67 +263,6 @@ private:
     std::vector<std::pair<uint32_t, double>> mHiddenTilesSouth;
 };
 
-class TileDistanceProcess
-{
-public:
-    TileDistanceProcess(const TileDistance& tileDistance, Tile* tile):
-        mTileDistance(tileDistance),
-        mTile(tile),
-        mHiddenValueNorth(0.0),
-        mHiddenValueSouth(0.0)
-    {
-    }
-
-    inline const TileDistance& getTileDistance() const
-    {
-        return mTileDistance;
-    }
-
-    void addHiddenValueNorth(double val)
-    {
-        // We only add the highest value
-        if(val <= mHiddenValueNorth)
-            return;
-
-        mHiddenValueNorth = val;
-    }
-
-    void addHiddenValueSouth(double val)
-    {
-        // We only add the highest value
-        if(val <= mHiddenValueSouth)
-            return;
-
-        mHiddenValueSouth = val;
-    }
-
-    inline bool isTileVisible() const
-    {
-        return (mHiddenValueNorth + mHiddenValueSouth) <= 0.5;
-    }
-
-    inline double getHiddenValueNorth() const
-    {
-        return mHiddenValueNorth;
-    }
-
-    inline double getHiddenValueSouth() const
-    {
-        return mHiddenValueSouth;
-    }
-
-    inline Tile* getTile() const
-    {
-        return mTile;
-    }
-
-private:
-    const TileDistance& mTileDistance;
-    Tile* mTile;
-    double mHiddenValueNorth;
-    double mHiddenValueSouth;
-};
-
 bool sortByDistSquared(const TileDistance& tileDist1, const TileDistance& tileDist2)
 {
     return tileDist1.getDistSquared() < tileDist2.getDistSquared();
@@ -332,7 +272,6 @@ TileContainer::TileContainer(int initTileDistance):
     mMapSizeX(0),
     mMapSizeY(0),
     mRr(0),
-    mTiles(nullptr),
     mTileDistanceComputed(0)
 {
     buildTileDistance(initTileDistance);
@@ -345,24 +284,32 @@ TileContainer::~TileContainer()
 
 void TileContainer::clearTiles()
 {
-    if (mTiles)
-    {
-        for (int ii = 0; ii < mMapSizeX; ++ii)
-        {
-            for (int jj = 0; jj < mMapSizeY; ++jj)
-            {
-                mTiles[ii][jj]->destroyMesh();
-                delete mTiles[ii][jj];
-            }
-            delete[] mTiles[ii];
-        }
-        delete[] mTiles;
-        mTiles = nullptr;
-    }
+    deleteTiles(true);
     mMapSizeX = 0;
     mMapSizeY = 0;
 }
 
+void TileContainer::deleteTiles(bool destroyMeshes)
+{
+    for(Tile* tile : mTiles)
+    {
+        if(tile == nullptr)
+            continue;
+
+        if(destroyMeshes)
+            tile->destroyMesh();
+
+        delete tile;
+    }
+    mTiles.clear();
+    mTileTypes.clear();
+    mTileFullness.clear();
+    mTileNbEntities.clear();
+    mTileSeats.clear();
+    mTileClaimed.clear();
+    mTileCoveringBuildings.clear();
+}
+
 bool TileContainer::addTile(Tile* t)
 {
     int x = t->getX();
@@ -370,46 +317,48 @@ bool TileContainer::addTile(Tile* t)
 
     if (x < getMapSizeX() && y < getMapSizeY() && x >= 0 && y >= 0)
     {
-        if(mTiles[x][y] != nullptr)
+        uint32_t index = getTileIndex(x, y);
+        if(mTiles[index] != nullptr)
         {
-            mTiles[x][y]->destroyMesh();
-            delete mTiles[x][y];
+            mTiles[index]->destroyMesh();
+            delete mTiles[index];
         }
-        mTiles[x][y] = t;
+        // From now on, the type and fullness are stored here
+        mTiles[index] = t;
+        mTileTypes[index] = t->getType();
+        mTileFullness[index] = t->getFullness();
+        t->mContainer = this;
+        updateTileFields(t);
         return true;
     }
 
     return false;
 }
 
-void TileContainer::setTileNeighbors(Tile *t)
+void TileContainer::updateTileFields(const Tile* tile)
 {
-    for (unsigned int i = 0; i < 2; ++i)
-    {
-        int tempX = t->getX(), tempY = t->getY();
-        switch (i)
-        {
-        case 0:
-            --tempX;
-            break;
-        case 1:
-            --tempY;
-            break;
+    int x = tile->getX();
+    int y = tile->getY();
+    if(getTile(x, y) != tile)
+        return;
 
-        default:
-            OD_LOG_ERR("Unknown neighbor index=" + Helper::toString(i));
-            continue;
-        }
+    uint32_t index = getTileIndex(x, y);
+    mTileNbEntities[index] = tile->numEntitiesInTile();
+    mTileSeats[index] = tile->getSeat();
+    mTileClaimed[index] = tile->isClaimed();
+    mTileCoveringBuildings[index] = tile->getCoveringBuilding();
+}
 
-        // If the current neigbor tile exists, add the current tile as one of its
-        // neighbors and add it as one of the current tile's neighbors.
-        if (tempX >= 0 && tempY >= 0)
-        {
-            Tile *tempTile = getTile(tempX, tempY);
-            tempTile->addNeighbor(t);
-            t->addNeighbor(tempTile);
-        }
-    }
+bool TileContainer::tilePermitsVision(uint32_t index) const
+{
+    if(mTileFullness[index] > 0.0)
+        return false;
+
+    Building* building = mTileCoveringBuildings[index];
+    if((building != nullptr) && !building->permitsVision(mTiles[index]))
+        return false;
+
+    return true;
 }
 
 void TileContainer::tileToPacket(ODPacket& packet, Tile* tile) const
@@ -441,37 +390,20 @@ bool TileContainer::allocateMapMemory(int xSize, int ySize)
     }
 
     // Clear memory usage first
-    if (mTiles)
-    {
-        for(int ii = 0; ii < mMapSizeX; ++ii)
-        {
-            for(int jj = 0; jj < mMapSizeY; ++jj)
-            {
-                delete  mTiles[ii][jj];
-            }
-            delete [] mTiles[ii];
-        }
-        delete [] mTiles;
-    }
+    deleteTiles(false);
 
     // Set map size
     mMapSizeX = xSize;
     mMapSizeY = ySize;
 
-    mTiles = new Tile **[mMapSizeX];
-    if(!mTiles)
-    {
-        OD_LOG_ERR("Failed to allocate map memory");
-        return false;
-    }
-    for(int ii = 0; ii < mMapSizeX; ++ii)
-    {
-        mTiles[ii] = new Tile *[mMapSizeY];
-        for(int jj = 0; jj < mMapSizeY; ++jj)
-        {
-            mTiles[ii][jj] = nullptr;
-        }
-    }
+    uint32_t nbTiles = static_cast<uint32_t>(mMapSizeX * mMapSizeY);
+    mTiles.assign(nbTiles, nullptr);
+    mTileTypes.assign(nbTiles, TileType::nullTileType);
+    mTileFullness.assign(nbTiles, 0.0);
+    mTileNbEntities.assign(nbTiles, 0);
+    mTileSeats.assign(nbTiles, nullptr);
+    mTileClaimed.assign(nbTiles, false);
+    mTileCoveringBuildings.assign(nbTiles, nullptr);
 
     return true;
 }
@@ -502,108 +434,106 @@ std::vector<Tile*> TileContainer::rectangularRegion(int x1, int y1, int x2, int
 
 std::vector<Tile*> TileContainer::circularRegion(int x, int y, int radius)
 {
-    // To compute the tiles within this region, we use the symmetry of the square. That's why we mix tile x/y coordinate
-    // with tileDist diffX/diffY. More explanation can be found in the buildTileDistance function
     std::vector<Tile*> returnList;
+    tilesInRadius(x, y, radius, &returnList, nullptr);
+    return returnList;
+}
 
-    if(radius > mTileDistanceComputed)
-        buildTileDistance(radius);
+void TileContainer::circularRegion(int x, int y, int radius, std::vector<Tile*>& tiles)
+{
+    tilesInRadius(x, y, radius, &tiles, nullptr);
+}
 
-    int radiusSquared = radius * radius;
-    for(const TileDistance& tileDist : mTileDistance)
+void TileContainer::addCircularTiles(int x, int y, const TileDistance& tileDist, std::vector<Tile*>& tiles) const
+{
+    // To compute the tiles within this region, we use the symmetry of the square. That's why we mix tile x/y coordinate
+    // with tileDist diffX/diffY. More explanation can be found in the buildTileDistance function
+    switch(tileDist.getType())
     {
-        if(tileDist.getDistSquared() > radiusSquared)
-            break;
-
-        switch(tileDist.getType())
+        case TileDistance::TileDistanceType::Horizontal:
         {
-            case TileDistance::TileDistanceType::Horizontal:
+            // We take the 4 tiles at this distance
+            if(tileDist.getDiffX() == 0)
             {
-                // We take the 4 tiles at this distance
-                if(tileDist.getDiffX() == 0)
-                {
-                    // We only add the current tile
-                    Tile* tile = getTile(x, y);
-                    if(tile != nullptr)
-                        returnList.push_back(tile);
-
-                    continue;
-                }
-
-                // We add the 4 tiles
-                Tile* tile;
-                tile = getTile(x + tileDist.getDiffX(), y);
-                if(tile != nullptr)
-                    returnList.push_back(tile);
-                tile = getTile(x - tileDist.getDiffX(), y);
-                if(tile != nullptr)
-                    returnList.push_back(tile);
-                tile = getTile(x, y + tileDist.getDiffX());
-                if(tile != nullptr)
-                    returnList.push_back(tile);
-                tile = getTile(x, y - tileDist.getDiffX());
+                // We only add the current tile
+                Tile* tile = getTile(x, y);
                 if(tile != nullptr)
-                    returnList.push_back(tile);
+                    tiles.push_back(tile);
 
-                break;
+                return;
             }
 
-            case TileDistance::TileDistanceType::Diagonal:
-            {
-                // We add the 4 tiles
-                Tile* tile;
-                tile = getTile(x + tileDist.getDiffX(), y + tileDist.getDiffY());
-                if(tile != nullptr)
-                    returnList.push_back(tile);
-                tile = getTile(x + tileDist.getDiffX(), y - tileDist.getDiffY());
-                if(tile != nullptr)
-                    returnList.push_back(tile);
-                tile = getTile(x - tileDist.getDiffX(), y + tileDist.getDiffY());
-                if(tile != nullptr)
-                    returnList.push_back(tile);
-                tile = getTile(x - tileDist.getDiffX(), y - tileDist.getDiffY());
-                if(tile != nullptr)
-                    returnList.push_back(tile);
+            // We add the 4 tiles
+            Tile* tile;
+            tile = getTile(x + tileDist.getDiffX(), y);
+            if(tile != nullptr)
+                tiles.push_back(tile);
+            tile = getTile(x - tileDist.getDiffX(), y);
+            if(tile != nullptr)
+                tiles.push_back(tile);
+            tile = getTile(x, y + tileDist.getDiffX());
+            if(tile != nullptr)
+                tiles.push_back(tile);
+            tile = getTile(x, y - tileDist.getDiffX());
+            if(tile != nullptr)
+                tiles.push_back(tile);
 
-                break;
-            }
+            break;
+        }
 
-            case TileDistance::TileDistanceType::Other:
-            default:
-            {
-                // We add the 8 tiles
-                Tile* tile;
-                tile = getTile(x + tileDist.getDiffX(), y + tileDist.getDiffY());
-                if(tile != nullptr)
-                    returnList.push_back(tile);
-                tile = getTile(x + tileDist.getDiffX(), y - tileDist.getDiffY());
-                if(tile != nullptr)
-                    returnList.push_back(tile);
-                tile = getTile(x - tileDist.getDiffX(), y + tileDist.getDiffY());
-                if(tile != nullptr)
-                    returnList.push_back(tile);
-                tile = getTile(x - tileDist.getDiffX(), y - tileDist.getDiffY());
-                if(tile != nullptr)
-                    returnList.push_back(tile);
-                tile = getTile(x + tileDist.getDiffY(), y + tileDist.getDiffX());
-                if(tile != nullptr)
-                    returnList.push_back(tile);
-                tile = getTile(x + tileDist.getDiffY(), y - tileDist.getDiffX());
-                if(tile != nullptr)
-                    returnList.push_back(tile);
-                tile = getTile(x - tileDist.getDiffY(), y + tileDist.getDiffX());
-                if(tile != nullptr)
-                    returnList.push_back(tile);
-                tile = getTile(x - tileDist.getDiffY(), y - tileDist.getDiffX());
-                if(tile != nullptr)
-                    returnList.push_back(tile);
+        case TileDistance::TileDistanceType::Diagonal:
+        {
+            // We add the 4 tiles
+            Tile* tile;
+            tile = getTile(x + tileDist.getDiffX(), y + tileDist.getDiffY());
+            if(tile != nullptr)
+                tiles.push_back(tile);
+            tile = getTile(x + tileDist.getDiffX(), y - tileDist.getDiffY());
+            if(tile != nullptr)
+                tiles.push_back(tile);
+            tile = getTile(x - tileDist.getDiffX(), y + tileDist.getDiffY());
+            if(tile != nullptr)
+                tiles.push_back(tile);
+            tile = getTile(x - tileDist.getDiffX(), y - tileDist.getDiffY());
+            if(tile != nullptr)
+                tiles.push_back(tile);
 
-                break;
-            }
+            break;
         }
-    }
 
-    return returnList;
+        case TileDistance::TileDistanceType::Other:
+        default:
+        {
+            // We add the 8 tiles
+            Tile* tile;
+            tile = getTile(x + tileDist.getDiffX(), y + tileDist.getDiffY());
+            if(tile != nullptr)
+                tiles.push_back(tile);
+            tile = getTile(x + tileDist.getDiffX(), y - tileDist.getDiffY());
+            if(tile != nullptr)
+                tiles.push_back(tile);
+            tile = getTile(x - tileDist.getDiffX(), y + tileDist.getDiffY());
+            if(tile != nullptr)
+                tiles.push_back(tile);
+            tile = getTile(x - tileDist.getDiffX(), y - tileDist.getDiffY());
+            if(tile != nullptr)
+                tiles.push_back(tile);
+            tile = getTile(x + tileDist.getDiffY(), y + tileDist.getDiffX());
+            if(tile != nullptr)
+                tiles.push_back(tile);
+            tile = getTile(x + tileDist.getDiffY(), y - tileDist.getDiffX());
+            if(tile != nullptr)
+                tiles.push_back(tile);
+            tile = getTile(x - tileDist.getDiffY(), y + tileDist.getDiffX());
+            if(tile != nullptr)
+                tiles.push_back(tile);
+            tile = getTile(x - tileDist.getDiffY(), y - tileDist.getDiffX());
+            if(tile != nullptr)
+                tiles.push_back(tile);
+
+            break;
+        }
+    }
 }
 
 std::vector<Tile*> TileContainer::tilesBorderedByRegion(const std::vector<Tile*> &region)
@@ -620,7 +550,7 @@ std::vector<Tile*> TileContainer::tilesBorderedByRegion(const std::vector<Tile*>
         }
 
         // Get the tiles bordering the current tile and loop over them.
-        for (Tile* t2 : t1->getAllNeighbors())
+        for (Tile* t2 : neighborTiles(t1->getX(), t1->getY()))
         {
             if(tilesToRefresh[t2->getX()][t2->getY()])
                 continue;
@@ -633,13 +563,27 @@ std::vector<Tile*> TileContainer::tilesBorderedByRegion(const std::vector<Tile*>
     return returnList;
 }
 
-const std::vector<Tile*>& TileContainer::neighborTiles(int x, int y) const
+TileNeighbors TileContainer::neighborTiles(int x, int y) const
 {
-    Tile *tempTile = getTile(x, y);
-    if (tempTile == nullptr)
-        return EMPTY_TILES;
+    TileNeighbors neighbors;
+    if (getTile(x, y) == nullptr)
+        return neighbors;
 
-    return tempTile->getAllNeighbors();
+    // The order matters: creatures pick the first suitable neighbor in several actions
+    Tile* tile = getTile(x - 1, y);
+    if(tile != nullptr)
+        neighbors.add(tile);
+    tile = getTile(x, y - 1);
+    if(tile != nullptr)
+        neighbors.add(tile);
+    tile = getTile(x, y + 1);
+    if(tile != nullptr)
+        neighbors.add(tile);
+    tile = getTile(x + 1, y);
+    if(tile != nullptr)
+        neighbors.add(tile);
+
+    return neighbors;
 }
 
 void TileContainer::buildTileDistance(int distance)
@@ -715,6 +659,14 @@ void TileContainer::buildTileDistance(int distance)
         }
     }
 
+    // Number of tile distances to process for each radius
+    mTileDistanceRadiusCount.assign(distance + 1, 0);
+    for(const TileDistance& tileDistance : mTileDistance)
+    {
+        for(int radius = distance; (radius >= 0) && (radius * radius >= tileDistance.getDistSquared()); --radius)
+            ++mTileDistanceRadiusCount[radius];
+    }
+
     mTileDistanceComputed = distance;
 }
 
@@ -810,162 +762,139 @@ std::list<Tile*> TileContainer::tilesBetween(int x1, int y1, int x2, int y2) con
 
 std::vector<Tile*> TileContainer::visibleTiles(int x, int y, int radius)
 {
-    // To compute the tiles within this region, we use the symmetry of the square. That's why we mix tile x/y coordinate
-    // with tileDist diffX/diffY. More explanation can be found in the buildTileDistance function
     std::vector<Tile*> returnList;
+    tilesInRadius(x, y, radius, nullptr, &returnList);
+    return returnList;
+}
+
+void TileContainer::tilesInSight(int x, int y, int radius, std::vector<Tile*>& circularTiles, std::vector<Tile*>& visibleTiles)
+{
+    tilesInRadius(x, y, radius, &circularTiles, &visibleTiles);
+}
+
+void TileContainer::reserveSightRadius(int radius)
+{
+    if(radius < 0)
+        radius = -radius;
 
     if(radius > mTileDistanceComputed)
         buildTileDistance(radius);
+}
 
-    int radiusSquared = radius * radius;
-
-    // To have all the tiles around, we process mTileDistance 8 times.
-    // We will process in, this order (c being the starting tile):
+void TileContainer::tilesInRadius(int x, int y, int radius, std::vector<Tile*>* circularTiles, std::vector<Tile*>* visibleTiles)
+{
+    // To have all the tiles around, we process mTileDistance 8 times (one per octant) with the same
+    // precomputed shadows. We will process in, this order (c being the starting tile):
     // 514
     // 2c0
     // 637
     // Then, we will have to merge diagonal/horizontal tiles
-    // Because we want the index to be correct, we will add tiles even when null in tilesProcess
-    std::vector<TileDistanceProcess> tilesProcess[8];
-    for(uint32_t k = 0; k < 8; ++k)
-    {
-        for(const TileDistance& tileDist : mTileDistance)
-        {
-            if(tileDist.getDistSquared() > radiusSquared)
-                break;
+    static const int OCTANT_XX[8] = { 1,  0, -1,  0,  0,  1,  0, -1 };
+    static const int OCTANT_XY[8] = { 0,  1,  0, -1,  1,  0, -1,  0 };
+    static const int OCTANT_YX[8] = { 0, -1,  0,  1,  1,  0, -1,  0 };
+    static const int OCTANT_YY[8] = { 1,  0, -1,  0,  0, -1,  0,  1 };
+    // How much each tile is hidden by the north/south. Indexed by octant * number of processed tiles + index
+    // in mTileDistance. Kept to avoid allocations. They are per thread because creatures compute their line of
+    // sight in parallel (see GameMap::doMiscUpkeep)
+    static thread_local std::vector<double> hiddenValuesNorth;
+    static thread_local std::vector<double> hiddenValuesSouth;
+
+    if(circularTiles != nullptr)
+        circularTiles->clear();
+    if(visibleTiles != nullptr)
+        visibleTiles->clear();
+
+    if(radius < 0)
+        radius = -radius;
 
-            switch(k)
-            {
-                case 0:
-                {
-                    Tile* tile = getTile(x + tileDist.getDiffX(), y + tileDist.getDiffY());
-                    tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
-                    break;
-                }
-                case 1:
-                {
-                    Tile* tile = getTile(x + tileDist.getDiffY(), y - tileDist.getDiffX());
-                    tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
-                    break;
-                }
-                case 2:
-                {
-                    Tile* tile = getTile(x - tileDist.getDiffX(), y - tileDist.getDiffY());
-                    tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
-                    break;
-                }
-                case 3:
-                {
-                    Tile* tile = getTile(x - tileDist.getDiffY(), y + tileDist.getDiffX());
-                    tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
-                    break;
-                }
-                case 4:
-                {
-                    Tile* tile = getTile(x + tileDist.getDiffY(), y + tileDist.getDiffX());
-                    tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
-                    break;
-                }
-                case 5:
-                {
-                    Tile* tile = getTile(x + tileDist.getDiffX(), y - tileDist.getDiffY());
-                    tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
-                    break;
-                }
-                case 6:
-                {
-                    Tile* tile = getTile(x - tileDist.getDiffY(), y - tileDist.getDiffX());
-                    tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
-                    break;
-                }
-                case 7:
-                {
-                    Tile* tile = getTile(x - tileDist.getDiffX(), y + tileDist.getDiffY());
-                    tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
-                    break;
-                }
-                default:
-                    break;
-            }
-        }
+    if(radius > mTileDistanceComputed)
+        buildTileDistance(radius);
+
+    // If no tile distance has been computed, there is nothing to process
+    if(static_cast<uint32_t>(radius) >= mTileDistanceRadiusCount.size())
+        return;
+
+    uint32_t nbTileDistances = mTileDistanceRadiusCount[radius];
+    if(visibleTiles != nullptr)
+    {
+        hiddenValuesNorth.assign(8 * nbTileDistances, 0.0);
+        hiddenValuesSouth.assign(8 * nbTileDistances, 0.0);
     }
 
-    // The array of tiles is filled. Now, we apply the visibility.
-    for(uint32_t k = 0; k < 8; ++k)
+    // A tile can only hide tiles farther than itself. Thus, when we process a tile, every tile that
+    // could hide it has already been processed and we can compute both regions in one pass
+    Tile* tiles[8];
+    uint32_t tileIndexes[8] = {};
+    for(uint32_t i = 0; i < nbTileDistances; ++i)
     {
-        for(TileDistanceProcess& tileDistanceProcess : tilesProcess[k])
+        const TileDistance& tileDist = mTileDistance[i];
+        if(circularTiles != nullptr)
+            addCircularTiles(x, y, tileDist, *circularTiles);
+
+        if(visibleTiles == nullptr)
+            continue;
+
+        for(uint32_t k = 0; k < 8; ++k)
         {
-            if(tileDistanceProcess.getTile() == nullptr)
-                continue;
+            int xx = x + OCTANT_XX[k] * tileDist.getDiffX() + OCTANT_XY[k] * tileDist.getDiffY();
+            int yy = y + OCTANT_YX[k] * tileDist.getDiffX() + OCTANT_YY[k] * tileDist.getDiffY();
+            tiles[k] = getTile(xx, yy);
+            if(tiles[k] != nullptr)
+                tileIndexes[k] = getTileIndex(xx, yy);
+        }
 
-            if(tileDistanceProcess.getTile()->permitsVision())
+        for(uint32_t k = 0; k < 8; ++k)
+        {
+            Tile* tile = tiles[k];
+            if(tile == nullptr)
                 continue;
 
-            // The tile hides vision. We process tiles it hides
-            for(const std::pair<uint32_t, double>& p : tileDistanceProcess.getTileDistance().getHiddenTilesNorth())
+            // The tile hides vision. We process tiles it hides. The hidden tiles are sorted by index
+            if(!tilePermitsVision(tileIndexes[k]))
             {
-                // mTileDistance might be bigger than the actual vector because it can include tiles
-                // farther than the ones currently computed (for example if sight < computedSight)
-                if(p.first >= tilesProcess[k].size())
-                    continue;
+                uint32_t offset = k * nbTileDistances;
+                for(const std::pair<uint32_t, double>& p : tileDist.getHiddenTilesNorth())
+                {
+                    // mTileDistance might be bigger than the processed tiles because it can include tiles
+                    // farther than the ones currently computed (for example if sight < computedSight)
+                    if(p.first >= nbTileDistances)
+                        break;
 
-                tilesProcess[k][p.first].addHiddenValueNorth(p.second);
-            }
-            for(const std::pair<uint32_t, double>& p : tileDistanceProcess.getTileDistance().getHiddenTilesSouth())
-            {
-                // mTileDistance might be bigger than the actual vector because it can include tiles
-                // farther than the ones currently computed (for example if sight < computedSight)
-                if(p.first >= tilesProcess[k].size())
-                    continue;
+                    double& hiddenValue = hiddenValuesNorth[offset + p.first];
+                    hiddenValue = std::max(hiddenValue, p.second);
+                }
+                for(const std::pair<uint32_t, double>& p : tileDist.getHiddenTilesSouth())
+                {
+                    if(p.first >= nbTileDistances)
+                        break;
 
-                tilesProcess[k][p.first].addHiddenValueSouth(p.second);
+                    double& hiddenValue = hiddenValuesSouth[offset + p.first];
+                    hiddenValue = std::max(hiddenValue, p.second);
+                }
             }
-        }
-    }
-
-    // Now, we process all the tiles. Note that horizontal tiles are common for 2 consecutive
-    // vectors in tilesProcess and that diagonal tiles should be merged.
-    // The 8 vectors have the same size
-    for(uint32_t i = 0; i < tilesProcess[0].size(); ++i)
-    {
-        for(uint32_t k = 0; k < 8; ++k)
-        {
-            TileDistanceProcess& tileDistanceProcess = tilesProcess[k][i];
-            if(tileDistanceProcess.getTile() == nullptr)
-                continue;
 
             // We avoid adding several times the center tile
-            if((k > 0) && (tileDistanceProcess.getTileDistance().getDistSquared() == 0))
-                continue;
-
-            // Because horizontal tiles are common, we don't process them for the 4 last vectors
-            if((tileDistanceProcess.getTileDistance().getType() == TileDistance::TileDistanceType::Horizontal) &&
-               (k > 3))
-            {
+            if((k > 0) && (tileDist.getDistSquared() == 0))
                 continue;
-            }
 
-            // Diagonal tiles need to be merged (because south hiding and north hiding are not
-            // computed within the same array). They will be processed for k < 4
-            if((tileDistanceProcess.getTileDistance().getType() == TileDistance::TileDistanceType::Diagonal) &&
-               (k > 3))
-            {
+            // Horizontal tiles are common for 2 consecutive octants and diagonal tiles should
+            // be merged. We only process them for the 4 first octants
+            if((k > 3) && (tileDist.getType() != TileDistance::TileDistanceType::Other))
                 continue;
-            }
 
-            if(tileDistanceProcess.getTileDistance().getType() == TileDistance::TileDistanceType::Diagonal)
+            double hiddenNorth = hiddenValuesNorth[k * nbTileDistances + i];
+            double hiddenSouth = hiddenValuesSouth[k * nbTileDistances + i];
+            if(tileDist.getType() == TileDistance::TileDistanceType::Diagonal)
             {
                 // We merge diagonal tiles. Because they are inverted, south hidden value becomes north and vice-versa
-                TileDistanceProcess& tileDistanceProcess2 = tilesProcess[k + 4][i];
-                tileDistanceProcess.addHiddenValueNorth(tileDistanceProcess2.getHiddenValueSouth());
-                tileDistanceProcess.addHiddenValueSouth(tileDistanceProcess2.getHiddenValueNorth());
+                hiddenNorth = std::max(hiddenNorth, hiddenValuesSouth[(k + 4) * nbTileDistances + i]);
+                hiddenSouth = std::max(hiddenSouth, hiddenValuesNorth[(k + 4) * nbTileDistances + i]);
             }
 
-            if(!tileDistanceProcess.isTileVisible())
+            if((hiddenNorth + hiddenSouth) > 0.5)
                 continue;
 
-            returnList.push_back(tileDistanceProcess.getTile());
+            visibleTiles->push_back(tile);
         }
     }
-    return returnList;
 }
@@ -18,18 +18,32 @@
 #ifndef TILECONTAINER_H
 #define TILECONTAINER_H
 
+#include "gamemap/TileNeighbors.h"
+
 #include <cassert>
+#include <cstdint>
 #include <list>
 #include <vector>
 
+class Building;
 class ODPacket;
+class Seat;
 class TileDistance;
 class Tile;
 
 enum class TileType;
 
+/*! \brief Stores the tiles of a map row-major (see getTileIndex).
+ *
+ * The fields read by full map sweeps are stored by tile index in contiguous arrays. That way, a
+ * sweep only dereferences the tiles it really needs. Once a tile is stored, the container owns its
+ * type and fullness (Tile::getType and Tile::getFullness read them from here). The other fields
+ * (seat, claimed state, covering building and number of entities) are copied from the tile, which
+ * keeps them up to date by calling updateTileFields.
+ */
 class TileContainer
 {
+    friend class Tile;
 public:
     TileContainer(int initTileDistance);
     virtual ~TileContainer();
@@ -41,22 +55,56 @@ public:
     //! \returns true if added.
     bool addTile(Tile* t);
 
-    //! \brief Adds the address of a new tile to be stored in this TileContainer.
-    void setTileNeighbors(Tile *t);
-
     //! \brief Returns a pointer to the tile at location (x, y) (const version).
     inline Tile* getTile(int xx, int yy) const
     {
-        assert(mTiles != nullptr);
-
         if (xx < getMapSizeX() && yy < getMapSizeY() && xx >= 0 && yy >= 0)
-            return mTiles[xx][yy];
+            return mTiles[getTileIndex(xx, yy)];
         else
         {
             return nullptr;
         }
     }
 
+    //! \brief Returns the index of the tile at (xx, yy). The coordinates must be valid. Tiles are stored
+    //! row-major so iterating over the indexes is like iterating over y, then x
+    inline uint32_t getTileIndex(int xx, int yy) const
+    { return static_cast<uint32_t>(yy * mMapSizeX + xx); }
+
+    inline uint32_t getNbTiles() const
+    { return static_cast<uint32_t>(mTiles.size()); }
+
+    inline Tile* getTileByIndex(uint32_t index) const
+    { return mTiles[index]; }
+
+    //! \brief Fields of the tile at the given index. See the corresponding Tile functions
+    inline TileType getTileType(uint32_t index) const
+    { return mTileTypes[index]; }
+
+    inline double getTileFullness(uint32_t index) const
+    { return mTileFullness[index]; }
+
+    inline uint32_t getTileNbEntities(uint32_t index) const
+    { return mTileNbEntities[index]; }
+
+    inline Seat* getTileSeat(uint32_t index) const
+    { return mTileSeats[index]; }
+
+    inline bool isTileClaimed(uint32_t index) const
+    { return mTileClaimed[index]; }
+
+    inline Building* getTileCoveringBuilding(uint32_t index) const
+    { return mTileCoveringBuildings[index]; }
+
+    //! \brief Same as Tile::permitsVision but only dereferences the covering building (if any).
+    //! Relies on the fullness so it is only relevant on server side
+    bool tilePermitsVision(uint32_t index) const;
+
+    //! \brief Should be called when a field copied by the container (see getTileSeat, isTileClaimed,
+    //! getTileCoveringBuilding and getTileNbEntities) changes in the given tile. Nothing is done if the
+    //! tile is not stored in this container (for example, if it is still being loaded)
+    void updateTileFields(const Tile* tile);
+
     //! \brief This functions exports the needed to retrieve a tile for networking.
     //! The tile informations are not embedded, only the needed to identify the tile
     void tileToPacket(ODPacket& packet, Tile* tile) const;
@@ -68,14 +116,17 @@ public:
     //! \brief Returns all the valid tiles in the curcular region
     //! surrounding the given point and extending outward to the specified radius.
     std::vector<Tile*> circularRegion(int x, int y, int radius);
+    //! \brief Same as above but fills the given vector (which is cleared first) to avoid allocations
+    void circularRegion(int x, int y, int radius, std::vector<Tile*>& tiles);
 
     //! \brief Returns a vector of all the valid tiles which are a neighbor
     //! to one or more tiles in the specified region,
     //! i.e. the "perimeter" of the region extended out one tile.
     std::vector<Tile*> tilesBorderedByRegion(const std::vector<Tile*> &region);
 
-    //! \brief Returns the (up to) 4 nearest neighbor tiles of the tile located at (x, y).
-    const std::vector<Tile*>& neighborTiles(int x, int y) const;
+    //! \brief Returns the (up to) 4 nearest neighbor tiles of the tile located at (x, y). They are
+    //! ordered left, bottom, top, right.
+    TileNeighbors neighborTiles(int x, int y) const;
 
     //! \brief Gets the map size
     int getMapSizeX() const
@@ -97,6 +148,14 @@ public:
     //! the furthest
     std::vector<Tile*> visibleTiles(int x, int y, int radius);
 
+    //! \brief Fills circularTiles like circularRegion and visibleTiles like visibleTiles within
+    //! the same pass. The given vectors are cleared first.
+    void tilesInSight(int x, int y, int radius, std::vector<Tile*>& circularTiles, std::vector<Tile*>& visibleTiles);
+
+    //! \brief Makes sure tilesInSight can be called with a radius up to the given one without
+    //! modifying the container. Once done, tilesInSight can be called from several threads
+    void reserveSightRadius(int radius);
+
 protected:
     //! \brief The map size
     int mMapSizeX;
@@ -107,7 +166,27 @@ protected:
     //! \brief Set the map size and memory
     bool allocateMapMemory(int xSize, int ySize);
 private:
-    Tile*** mTiles;
+    //! \brief Tiles indexed by getTileIndex
+    std::vector<Tile*> mTiles;
+
+    //! \brief Fields of the tiles indexed like mTiles. The type and fullness are set through the tiles
+    //! (see Tile::setType and Tile::setFullness). The others are copied by updateTileFields
+    std::vector<TileType> mTileTypes;
+    std::vector<double> mTileFullness;
+    std::vector<uint32_t> mTileNbEntities;
+    std::vector<Seat*> mTileSeats;
+    std::vector<bool> mTileClaimed;
+    std::vector<Building*> mTileCoveringBuildings;
+
+    //! \brief Called by Tile::setType and Tile::setFullness once the tile is stored
+    inline void setTileType(uint32_t index, TileType type)
+    { mTileTypes[index] = type; }
+
+    inline void setTileFullness(uint32_t index, double fullness)
+    { mTileFullness[index] = fullness; }
+
+    //! \brief Deletes the stored tiles
+    void deleteTiles(bool destroyMeshes);
 
     //! \brief Fills mTileDistance that will help to compute a vector with sorted Tiles more efficiently
     void buildTileDistance(int distance);
@@ -118,6 +197,16 @@ private:
     //! \brief Stores the highest distance computed. If a bigger distance is asked, mTileDistance will have to be updated by
     //! calling buildTileDistance with the higher distance
     int mTileDistanceComputed;
+
+    //! \brief Number of elements in mTileDistance within each radius (up to mTileDistanceComputed)
+    std::vector<uint32_t> mTileDistanceRadiusCount;
+
+    //! \brief Adds the tiles at the given distance in the 8 octants from (x, y) in the same order as circularRegion
+    void addCircularTiles(int x, int y, const TileDistance& tileDist, std::vector<Tile*>& tiles) const;
+
+    //! \brief Computes the tiles within radius (if circularTiles is not nullptr) and the visible
+    //! ones (if visibleTiles is not nullptr) with one pass over mTileDistance
+    void tilesInRadius(int x, int y, int radius, std::vector<Tile*>* circularTiles, std::vector<Tile*>* visibleTiles);
 };
 
 #endif //TILECONTAINER_H
@@ -0,0 +1,74 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TILENEIGHBORS_H
+#define TILENEIGHBORS_H
+
+#include <cassert>
+#include <cstdint>
+
+class Tile;
+
+/*! \brief The (up to) 4 tiles sharing a side with a tile. They are computed from the tile
+ * coordinates by TileContainer::neighborTiles so that tiles do not have to store them.
+ * Can be iterated like a vector.
+ */
+class TileNeighbors
+{
+public:
+    static const uint32_t MAX_NEIGHBORS = 4;
+
+    TileNeighbors() :
+        mNbTiles(0)
+    {}
+
+    inline void add(Tile* tile)
+    {
+        assert(mNbTiles < MAX_NEIGHBORS);
+        mTiles[mNbTiles++] = tile;
+    }
+
+    inline Tile* const* begin() const
+    { return mTiles; }
+
+    inline Tile* const* end() const
+    { return mTiles + mNbTiles; }
+
+    inline uint32_t size() const
+    { return mNbTiles; }
+
+    inline bool empty() const
+    { return mNbTiles == 0; }
+
+    inline Tile* operator[](uint32_t index) const
+    {
+        assert(index < mNbTiles);
+        return mTiles[index];
+    }
+
+    inline Tile* back() const
+    {
+        assert(mNbTiles > 0);
+        return mTiles[mNbTiles - 1];
+    }
+
+private:
+    Tile* mTiles[MAX_NEIGHBORS];
+    uint32_t mNbTiles;
+};
+
+#endif // TILENEIGHBORS_H
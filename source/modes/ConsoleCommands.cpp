@@ -55,7 +55,8 @@ const std::string HELPMESSAGE =
         "\n\tcatmullspline - Triggers the catmullspline camera movement type."
         "\n\tcirclearound - Triggers the circle camera movement type."
         "\n\tsetcamerafovy - Sets the camera vertical field of view aspect ratio value."
-        "\n\tlogfloodfill - Displays the FloodFillValues of all the Tiles in the GameMap.";
+        "\n\tlogfloodfill - Displays the FloodFillValues of all the Tiles in the GameMap."
+        "\n\tlogturnlag - Logs how many turns each client is late regarding the server.";
 
 //! \brief Template function to get/set a variable from the ODFrameListener object
 template<typename ValType, typename Getter, typename Setter>
@@ -406,6 +407,12 @@ Command::Result cSrvLogFloodFill(const Command::ArgumentList_t&, ConsoleInterfac
     return Command::Result::SUCCESS;
 }
 
+Command::Result cSrvLogTurnLag(const Command::ArgumentList_t&, ConsoleInterface&, GameMap&)
+{
+    ODServer::getSingleton().logClientsTurnLag();
+    return Command::Result::SUCCESS;
+}
+
 Command::Result cSetCameraFOVy(const Command::ArgumentList_t& args, ConsoleInterface& c, AbstractModeManager&)
 {
     Ogre::Camera* cam = ODFrameListener::getSingleton().getCameraManager()->getActiveCamera();
@@ -617,6 +624,12 @@ void addConsoleCommands(ConsoleInterface& cl)
                    cSrvLogFloodFill,
                    {AbstractModeManager::ModeType::GAME},
                    {});
+    cl.addCommand("logturnlag",
+                   "'logturnlag' logs how many turns each client is late regarding the server.",
+                   cSendCmdToServer,
+                   cSrvLogTurnLag,
+                   {AbstractModeManager::ModeType::GAME},
+                   {});
     cl.addCommand("listmeshanims",
                    "'listmeshanims' lists all the animations for the given mesh.",
                    cListMeshAnims,
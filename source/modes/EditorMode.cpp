@@ -493,8 +493,7 @@ bool EditorMode::mousePressed(const OIS::MouseEvent &arg, OIS::MouseButtonID id)
             if(closestEntity != nullptr)
             {
                 ODClient::getSingleton().queueClientNotification(ClientNotificationType::askSlapEntity,
-                     closestEntity->getObjectType(),
-                     closestEntity->getName());
+                     closestEntity->getId());
                 return true;
             }
         }
@@ -546,8 +545,7 @@ bool EditorMode::mousePressed(const OIS::MouseEvent &arg, OIS::MouseButtonID id)
     if(closestEntity != nullptr)
     {
         ODClient::getSingleton().queueClientNotification(ClientNotificationType::askEntityPickUp,
-            closestEntity->getObjectType(),
-            closestEntity->getName());
+            closestEntity->getId());
         return true;
     }
 
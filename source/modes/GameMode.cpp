@@ -652,8 +652,7 @@ bool GameMode::mousePressed(const OIS::MouseEvent& arg, OIS::MouseButtonID id)
             if(closestEntity != nullptr)
             {
                 ODClient::getSingleton().queueClientNotification(ClientNotificationType::askSlapEntity,
-                     closestEntity->getObjectType(),
-                     closestEntity->getName());
+                     closestEntity->getId());
                 return true;
             }
         }
@@ -700,8 +699,7 @@ bool GameMode::mousePressed(const OIS::MouseEvent& arg, OIS::MouseButtonID id)
         if(closestEntity != nullptr)
         {
             ODClient::getSingleton().queueClientNotification(ClientNotificationType::askEntityPickUp,
-                closestEntity->getObjectType(),
-                closestEntity->getName());
+                closestEntity->getId());
             return true;
         }
     }
@@ -16,6 +16,7 @@
  */
 
 #include "ClientNotification.h"
+#include "network/NotificationPool.h"
 #include "utils/LogManager.h"
 #include "utils/Helper.h"
 
@@ -25,6 +26,21 @@ ClientNotification::ClientNotification(ClientNotificationType type):
     mPacket << type;
 }
 
+void* ClientNotification::operator new(std::size_t size)
+{
+    return NotificationPool::getPool<ClientNotification>().allocate(size);
+}
+
+void ClientNotification::operator delete(void* block, std::size_t size)
+{
+    NotificationPool::getPool<ClientNotification>().release(block, size);
+}
+
+std::string ClientNotification::getPoolStats()
+{
+    return NotificationPool::getPool<ClientNotification>().getStatsString();
+}
+
 std::string ClientNotification::typeString(ClientNotificationType type)
 {
     switch(type)
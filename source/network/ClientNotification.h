@@ -20,12 +20,13 @@
 
 #include "network/ODPacket.h"
 
+#include <cstddef>
 #include <deque>
 
 enum class ClientNotificationType
 {
     // Communication with server
-    hello,
+    hello, // + version string + best ODPacketCompression supported
     levelOK, // Tells the server the level loading was ok.
     setNick,
     readyForSeatConfiguration,
@@ -82,10 +83,18 @@ public:
     virtual ~ClientNotification()
     {}
 
+    //! \brief Notifications are allocated from a pool (see NotificationPool) because
+    //! a lot of them are created and destroyed each turn
+    static void* operator new(std::size_t size);
+    static void operator delete(void* block, std::size_t size);
+
     ODPacket mPacket;
 
     static std::string typeString(ClientNotificationType type);
 
+    //! \brief Returns the counters of the notification pool (for logging)
+    static std::string getPoolStats();
+
 private:
     ClientNotificationType mType;
 };
@@ -0,0 +1,128 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "network/NotificationPool.h"
+
+#include <boost/lexical_cast.hpp>
+
+#include <new>
+
+const std::size_t NotificationPool::MAX_FREE_NOTIFICATIONS = 4096;
+
+NotificationPool::NotificationPool(std::size_t blockSize, std::size_t maxFreeBlocks) :
+    mBlockSize(blockSize < sizeof(FreeBlock) ? sizeof(FreeBlock) : blockSize),
+    mMaxFreeBlocks(maxFreeBlocks),
+    mFreeBlocks(nullptr),
+    mNbFreeBlocks(0),
+    mNbAllocations(0),
+    mNbRecycled(0),
+    mNbUsed(0)
+{
+}
+
+NotificationPool::~NotificationPool()
+{
+    while(mFreeBlocks != nullptr)
+    {
+        FreeBlock* block = mFreeBlocks;
+        mFreeBlocks = block->mNext;
+        ::operator delete(block);
+    }
+}
+
+void* NotificationPool::allocate(std::size_t size)
+{
+    if(size > mBlockSize)
+        return ::operator new(size);
+
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        ++mNbUsed;
+        if(mFreeBlocks != nullptr)
+        {
+            FreeBlock* block = mFreeBlocks;
+            mFreeBlocks = block->mNext;
+            --mNbFreeBlocks;
+            ++mNbRecycled;
+            return block;
+        }
+        ++mNbAllocations;
+    }
+
+    return ::operator new(mBlockSize);
+}
+
+void NotificationPool::release(void* block, std::size_t size)
+{
+    if(block == nullptr)
+        return;
+
+    if(size > mBlockSize)
+    {
+        ::operator delete(block);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        --mNbUsed;
+        if(mNbFreeBlocks < mMaxFreeBlocks)
+        {
+            FreeBlock* freeBlock = new(block) FreeBlock;
+            freeBlock->mNext = mFreeBlocks;
+            mFreeBlocks = freeBlock;
+            ++mNbFreeBlocks;
+            return;
+        }
+    }
+
+    ::operator delete(block);
+}
+
+uint64_t NotificationPool::getNbAllocations() const
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    return mNbAllocations;
+}
+
+uint64_t NotificationPool::getNbRecycled() const
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    return mNbRecycled;
+}
+
+uint64_t NotificationPool::getNbUsed() const
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    return mNbUsed;
+}
+
+uint64_t NotificationPool::getNbRequests() const
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    return mNbAllocations + mNbRecycled;
+}
+
+std::string NotificationPool::getStatsString() const
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    return "allocations=" + boost::lexical_cast<std::string>(mNbAllocations)
+        + " recycled=" + boost::lexical_cast<std::string>(mNbRecycled)
+        + " used=" + boost::lexical_cast<std::string>(mNbUsed)
+        + " free=" + boost::lexical_cast<std::string>(mNbFreeBlocks);
+}
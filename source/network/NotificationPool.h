@@ -0,0 +1,93 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef NOTIFICATIONPOOL_H
+#define NOTIFICATIONPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+//! \brief Recycles the memory blocks used by the notifications (ServerNotification/ClientNotification).
+//! Many notifications are created and destroyed each turn. Instead of going through the allocator each
+//! time, released blocks are kept in an intrusive free list (the link to the next free block is
+//! stored in the block itself) and reused by the next allocation.
+//! Notifications are created by both the game and the network threads so the pool is protected by a mutex.
+class NotificationPool
+{
+public:
+    //! \brief Creates a pool handling blocks of blockSize bytes. At most maxFreeBlocks released
+    //! blocks are kept, the others are freed.
+    NotificationPool(std::size_t blockSize, std::size_t maxFreeBlocks);
+    ~NotificationPool();
+
+    //! \brief Returns a block of size bytes. If size is not the pool block size (for example,
+    //! for a derived class), the block is allocated from the heap
+    void* allocate(std::size_t size);
+
+    //! \brief Gives back a block returned by allocate. size should be the one given to allocate
+    void release(void* block, std::size_t size);
+
+    //! \brief Number of blocks that had to be allocated from the heap
+    uint64_t getNbAllocations() const;
+
+    //! \brief Number of allocations served from the free list
+    uint64_t getNbRecycled() const;
+
+    //! \brief Number of blocks currently used
+    uint64_t getNbUsed() const;
+
+    //! \brief Number of blocks given by allocate (from the heap or recycled)
+    uint64_t getNbRequests() const;
+
+    //! \brief Returns a short string with the pool counters (for logging)
+    std::string getStatsString() const;
+
+    //! \brief Returns the pool shared by the instances of Notification. Its blocks are sizeof(Notification)
+    //! bytes and at most MAX_FREE_NOTIFICATIONS released blocks are kept
+    template<typename Notification>
+    static NotificationPool& getPool()
+    {
+        static NotificationPool pool(sizeof(Notification), MAX_FREE_NOTIFICATIONS);
+        return pool;
+    }
+
+    //! \brief Max number of released notifications kept for reuse by the pools returned by getPool
+    static const std::size_t MAX_FREE_NOTIFICATIONS;
+
+private:
+    //! \brief Header written in the released blocks to chain them
+    struct FreeBlock
+    {
+        FreeBlock* mNext;
+    };
+
+    const std::size_t mBlockSize;
+    const std::size_t mMaxFreeBlocks;
+
+    mutable std::mutex mLock;
+    FreeBlock* mFreeBlocks;
+    std::size_t mNbFreeBlocks;
+
+    uint64_t mNbAllocations;
+    uint64_t mNbRecycled;
+    uint64_t mNbUsed;
+};
+
+#endif // NOTIFICATIONPOOL_H
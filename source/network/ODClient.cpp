@@ -82,6 +82,14 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
     OD_LOG_DBG("processMessage type=" + ServerNotification::typeString(cmd));
     switch(cmd)
     {
+        case ServerNotificationType::compressionMode:
+        {
+            ODPacketCompression compression;
+            OD_ASSERT_TRUE(packetReceived >> compression);
+            setRecvCompression(compression);
+            break;
+        }
+
         case ServerNotificationType::loadLevel:
         {
             std::string odVersion;
@@ -175,7 +183,7 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
                 tile->setType(TileType::gem);
                 tile->setTileVisual(TileVisual::gemFull);
             }
-            gameMap->setAllFullnessAndNeighbors();
+            gameMap->setAllFullness();
 
             ODPacket packSend;
             packSend << ClientNotificationType::levelOK;
@@ -433,13 +441,12 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
 
         case ServerNotificationType::removeEntity:
         {
-            GameEntityType entityType;
-            std::string entityName;
-            OD_ASSERT_TRUE(packetReceived >> entityType >> entityName);
-            GameEntity* entity = gameMap->getEntityFromTypeAndName(entityType, entityName);
+            uint32_t entityId;
+            OD_ASSERT_TRUE(packetReceived >> entityId);
+            GameEntity* entity = gameMap->getEntityById(entityId);
             if(entity == nullptr)
             {
-                OD_LOG_ERR("entityType=" + Helper::toString(static_cast<int32_t>(entityType)) + ", entityName=" + entityName);
+                OD_LOG_ERR("entityId=" + Helper::toString(entityId));
                 break;
             }
 
@@ -454,7 +461,8 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
             int64_t turnNum;
             OD_ASSERT_TRUE(packetReceived >> turnNum);
             OD_LOG_INF("Client (" + getPlayer()->getNick() + ") received turnStarted="
-                + boost::lexical_cast<std::string>(turnNum));
+                + boost::lexical_cast<std::string>(turnNum)
+                + " notifications: " + ClientNotification::getPoolStats());
 
             gameMap->clientUpKeep(turnNum);
             // We acknowledge the new turn to the server so that he knows we are
@@ -473,19 +481,19 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
 
         case ServerNotificationType::animatedObjectSetWalkPath:
         {
-            std::string objName;
+            uint32_t objId;
             std::string walkAnim;
             std::string endAnim;
             bool loopEndAnim;
             bool playIdleWhenAnimationEnds;
             uint32_t nbDest;
-            OD_ASSERT_TRUE(packetReceived >> objName >> walkAnim >> endAnim);
+            OD_ASSERT_TRUE(packetReceived >> objId >> walkAnim >> endAnim);
             OD_ASSERT_TRUE(packetReceived >> loopEndAnim >> playIdleWhenAnimationEnds >> nbDest);
 
-            MovableGameEntity *tempAnimatedObject = gameMap->getAnimatedObject(objName);
+            MovableGameEntity *tempAnimatedObject = gameMap->getAnimatedObjectById(objId);
             if(tempAnimatedObject == nullptr)
             {
-                OD_LOG_ERR("objName=" + objName);
+                OD_LOG_ERR("objId=" + Helper::toString(objId));
                 break;
             }
 
@@ -505,9 +513,8 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
         case ServerNotificationType::entityPickedUp:
         {
             int seatId;
-            GameEntityType entityType;
-            std::string entityName;
-            OD_ASSERT_TRUE(packetReceived >> seatId >> entityType >> entityName);
+            uint32_t entityId;
+            OD_ASSERT_TRUE(packetReceived >> seatId >> entityId);
             Player *tempPlayer = gameMap->getPlayerBySeatId(seatId);
             if(tempPlayer == nullptr)
             {
@@ -515,10 +522,10 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
                 break;
             }
 
-            GameEntity* entity = gameMap->getEntityFromTypeAndName(entityType, entityName);
+            GameEntity* entity = gameMap->getEntityById(entityId);
             if(entity == nullptr)
             {
-                OD_LOG_ERR("entityType=" + Helper::toString(static_cast<int32_t>(entityType)) + ", entityName=" + entityName);
+                OD_LOG_ERR("entityId=" + Helper::toString(entityId));
                 break;
             }
 
@@ -552,17 +559,17 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
 
         case ServerNotificationType::setObjectAnimationState:
         {
-            std::string objName;
+            uint32_t objId;
             std::string animState;
             bool loop;
             bool playIdleWhenAnimationEnds;
             bool shouldSetWalkDirection;
-            OD_ASSERT_TRUE(packetReceived >> objName >> animState
+            OD_ASSERT_TRUE(packetReceived >> objId >> animState
                 >> loop >> playIdleWhenAnimationEnds >> shouldSetWalkDirection);
-            MovableGameEntity *obj = gameMap->getAnimatedObject(objName);
+            MovableGameEntity *obj = gameMap->getAnimatedObjectById(objId);
             if (obj == nullptr)
             {
-                OD_LOG_ERR("objName=" + objName + ", state=" + animState);
+                OD_LOG_ERR("objId=" + Helper::toString(objId) + ", state=" + animState);
                 break;
             }
 
@@ -590,18 +597,16 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
         case ServerNotificationType::entitiesRefresh:
         {
             uint32_t nbEntities;
-            GameEntityType entityType;
-            std::string entityName;
+            uint32_t entityId;
             OD_ASSERT_TRUE(packetReceived >> nbEntities);
             while(nbEntities > 0)
             {
                 --nbEntities;
-                OD_ASSERT_TRUE(packetReceived >> entityType);
-                OD_ASSERT_TRUE(packetReceived >> entityName);
-                GameEntity* entity = gameMap->getEntityFromTypeAndName(entityType, entityName);
+                OD_ASSERT_TRUE(packetReceived >> entityId);
+                GameEntity* entity = gameMap->getEntityById(entityId);
                 if(entity == nullptr)
                 {
-                    OD_LOG_ERR("entityType=" + Helper::toString(static_cast<int32_t>(entityType)) + ", entityName=" + entityName);
+                    OD_LOG_ERR("entityId=" + Helper::toString(entityId));
                     break;
                 }
 
@@ -638,14 +643,14 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
 
         case ServerNotificationType::setEntityOpacity:
         {
-            std::string entityName;
+            uint32_t entityId;
             float opacity;
-            OD_ASSERT_TRUE(packetReceived >> entityName >> opacity);
+            OD_ASSERT_TRUE(packetReceived >> entityId >> opacity);
 
-            RenderedMovableEntity* entity = gameMap->getRenderedMovableEntity(entityName);
+            RenderedMovableEntity* entity = gameMap->getRenderedMovableEntityById(entityId);
             if(entity == nullptr)
             {
-                OD_LOG_ERR("entityName=" + entityName);
+                OD_LOG_ERR("entityId=" + Helper::toString(entityId));
                 break;
             }
 
@@ -673,13 +678,13 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
 
         case ServerNotificationType::notifyCreatureInfo:
         {
-            std::string name;
+            uint32_t creatureId;
             std::string infos;
-            OD_ASSERT_TRUE(packetReceived >> name >> infos);
-            Creature* creature = gameMap->getCreature(name);
+            OD_ASSERT_TRUE(packetReceived >> creatureId >> infos);
+            Creature* creature = gameMap->getCreatureById(creatureId);
             if(creature == nullptr)
             {
-                OD_LOG_ERR("name=" + name);
+                OD_LOG_ERR("creatureId=" + Helper::toString(creatureId));
                 break;
             }
 
@@ -689,13 +694,13 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
 
         case ServerNotificationType::refreshCreatureVisDebug:
         {
-            std::string name;
+            uint32_t creatureId;
             bool isDebugVisibleTilesActive;
-            OD_ASSERT_TRUE(packetReceived >> name >> isDebugVisibleTilesActive);
-            Creature* creature = gameMap->getCreature(name);
+            OD_ASSERT_TRUE(packetReceived >> creatureId >> isDebugVisibleTilesActive);
+            Creature* creature = gameMap->getCreatureById(creatureId);
             if(creature == nullptr)
             {
-                OD_LOG_ERR("name=" + name);
+                OD_LOG_ERR("creatureId=" + Helper::toString(creatureId));
                 break;
             }
 
@@ -828,21 +833,20 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
 
         case ServerNotificationType::carryEntity:
         {
-            std::string carrierName;
-            GameEntityType entityType;
-            std::string carriedName;
-            OD_ASSERT_TRUE(packetReceived >> carrierName >> entityType >> carriedName);
-            Creature* carrier = gameMap->getCreature(carrierName);
+            uint32_t carrierId;
+            uint32_t carriedId;
+            OD_ASSERT_TRUE(packetReceived >> carrierId >> carriedId);
+            Creature* carrier = gameMap->getCreatureById(carrierId);
             if(carrier == nullptr)
             {
-                OD_LOG_ERR("carrierName=" + carrierName);
+                OD_LOG_ERR("carrierId=" + Helper::toString(carrierId));
                 break;
             }
 
-            GameEntity* carried = gameMap->getEntityFromTypeAndName(entityType, carriedName);
+            GameEntity* carried = gameMap->getEntityById(carriedId);
             if(carried == nullptr)
             {
-                OD_LOG_ERR("entityType=" + Helper::toString(static_cast<int32_t>(entityType)) + ", carriedName=" + carriedName);
+                OD_LOG_ERR("carriedId=" + Helper::toString(carriedId));
                 break;
             }
 
@@ -854,22 +858,21 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
 
         case ServerNotificationType::releaseCarriedEntity:
         {
-            std::string carrierName;
-            GameEntityType entityType;
-            std::string carriedName;
+            uint32_t carrierId;
+            uint32_t carriedId;
             Ogre::Vector3 pos;
-            OD_ASSERT_TRUE(packetReceived >> carrierName >> entityType >> carriedName >> pos);
-            Creature* carrier = gameMap->getCreature(carrierName);
+            OD_ASSERT_TRUE(packetReceived >> carrierId >> carriedId >> pos);
+            Creature* carrier = gameMap->getCreatureById(carrierId);
             if(carrier == nullptr)
             {
-                OD_LOG_ERR("carrierName=" + carrierName);
+                OD_LOG_ERR("carrierId=" + Helper::toString(carrierId));
                 break;
             }
 
-            GameEntity* carried = gameMap->getEntityFromTypeAndName(entityType, carriedName);
+            GameEntity* carried = gameMap->getEntityById(carriedId);
             if(carried == nullptr)
             {
-                OD_LOG_ERR("entityType=" + Helper::toString(static_cast<int32_t>(entityType)) + ", carriedName=" + carriedName);
+                OD_LOG_ERR("carriedId=" + Helper::toString(carriedId));
                 break;
             }
 
@@ -1032,7 +1035,8 @@ bool ODClient::connect(const std::string& host, const int port, uint32_t timeout
     // Send a hello request to start the conversation with the server
     ODPacket packSend;
     packSend << ClientNotificationType::hello
-        << std::string("OpenDungeons V ") + ODApplication::VERSION;
+        << std::string("OpenDungeons V ") + ODApplication::VERSION
+        << ODPacket::getBestCompression();
     send(packSend);
 
     return true;
@@ -17,239 +17,600 @@
 
 #include "network/ODPacket.h"
 
-#define OD_INT64TOINT32H(valInt64)              (static_cast<int32_t>(valInt64 >> 32))
-#define OD_INT64TOINT32L(valInt64)              (static_cast<int32_t>(valInt64))
-#define OD_INT32TOINT64(valInt32h,valInt32l)    ((((static_cast<int64_t>(valInt32h)) << 32) & static_cast<int64_t>(0xFFFFFFFF00000000)) + ((static_cast<int64_t>(valInt32l)) & static_cast<int64_t>(0x00000000FFFFFFFF)))
+#ifdef OD_USE_LZ4
+#include <lz4.h>
+#endif
+
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <type_traits>
+
+const std::size_t ODPacket::HEADER_SIZE = sizeof(uint32_t);
+
+const uint32_t ODPacket::COMPRESSION_THRESHOLD = 256;
+
+// Big enough for the biggest levels sent when a game starts
+const uint32_t ODPacket::MAX_PACKET_SIZE = 64 * 1024 * 1024;
+
+namespace
+{
+// Capacity of the buffers allocated when the pool is empty
+const std::size_t DEFAULT_BUFFER_CAPACITY = 256;
+// Buffers bigger than that are freed instead of being kept in the pool. That avoids keeping
+// forever the memory used by big packets (like the level)
+const std::size_t MAX_POOLED_BUFFER_CAPACITY = 64 * 1024;
+// Max number of buffers kept in the pool
+const std::size_t MAX_POOLED_BUFFERS = 256;
+#ifdef OD_USE_LZ4
+// Highest ratio between uncompressed and compressed sizes LZ4 can reach
+const std::size_t LZ4_MAX_RATIO = 255;
+#endif
+
+//! \brief Buffers released by the destroyed packets. They are reused by the new ones. Packets are used
+//! by both the game and the network threads so the pool is protected by a mutex
+class PacketBufferPool
+{
+public:
+    PacketBufferPool()
+    {
+        mBuffers.reserve(MAX_POOLED_BUFFERS);
+    }
+
+    std::vector<char> acquire()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mBuffersLock);
+            if(!mBuffers.empty())
+            {
+                std::vector<char> buffer = std::move(mBuffers.back());
+                mBuffers.pop_back();
+                return buffer;
+            }
+        }
+
+        std::vector<char> buffer;
+        buffer.reserve(DEFAULT_BUFFER_CAPACITY);
+        return buffer;
+    }
+
+    void release(std::vector<char>& buffer)
+    {
+        if((buffer.capacity() == 0) || (buffer.capacity() > MAX_POOLED_BUFFER_CAPACITY))
+            return;
+
+        buffer.clear();
+        std::lock_guard<std::mutex> lock(mBuffersLock);
+        if(mBuffers.size() >= MAX_POOLED_BUFFERS)
+            return;
+
+        mBuffers.push_back(std::move(buffer));
+    }
+
+private:
+    std::vector<std::vector<char>> mBuffers;
+    std::mutex mBuffersLock;
+};
+
+PacketBufferPool& getBufferPool()
+{
+    static PacketBufferPool pool;
+    return pool;
+}
+}
+
+ODPacket::ODPacket() :
+    mReadPos(HEADER_SIZE),
+    mIsValid(true)
+{
+    // The buffer is taken from the pool when the first data is written
+}
+
+ODPacket::~ODPacket()
+{
+    getBufferPool().release(mData);
+}
+
+ODPacket::ODPacket(ODPacket&& packet) :
+    mData(std::move(packet.mData)),
+    mReadPos(packet.mReadPos),
+    mIsValid(packet.mIsValid)
+{
+    packet.mData.clear();
+    packet.mReadPos = HEADER_SIZE;
+    packet.mIsValid = true;
+}
+
+ODPacket& ODPacket::operator=(ODPacket&& packet)
+{
+    if(this == &packet)
+        return *this;
+
+    getBufferPool().release(mData);
+    mData = std::move(packet.mData);
+    mReadPos = packet.mReadPos;
+    mIsValid = packet.mIsValid;
+    packet.mData.clear();
+    packet.mReadPos = HEADER_SIZE;
+    packet.mIsValid = true;
+    return *this;
+}
+
+char* ODPacket::reserveData(std::size_t size)
+{
+    if(mData.empty())
+    {
+        mData = getBufferPool().acquire();
+        mData.resize(HEADER_SIZE);
+    }
+
+    std::size_t pos = mData.size();
+    mData.resize(pos + size);
+    return mData.data() + pos;
+}
 
-// The max buffer size when reading packets.
-const int32_t BUFFER_SIZE = 1024;
+const char* ODPacket::readData(std::size_t size)
+{
+    if(!mIsValid || (mReadPos + size > mData.size()))
+    {
+        mIsValid = false;
+        return nullptr;
+    }
+
+    const char* data = mData.data() + mReadPos;
+    mReadPos += size;
+    return data;
+}
+
+void ODPacket::appendData(const char* data, std::size_t size)
+{
+    if(size == 0)
+        return;
+
+    std::memcpy(reserveData(size), data, size);
+}
+
+template<typename T>
+void ODPacket::writeInteger(T data)
+{
+    // Integers are written in little endian whatever the platform
+    typedef typename std::make_unsigned<T>::type UnsignedType;
+    UnsignedType value = static_cast<UnsignedType>(data);
+    char* buffer = reserveData(sizeof(T));
+    for(std::size_t i = 0; i < sizeof(T); ++i)
+        buffer[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+}
+
+template<typename T>
+void ODPacket::readInteger(T& data)
+{
+    typedef typename std::make_unsigned<T>::type UnsignedType;
+    const char* buffer = readData(sizeof(T));
+    if(buffer == nullptr)
+        return;
+
+    UnsignedType value = 0;
+    for(std::size_t i = 0; i < sizeof(T); ++i)
+        value |= static_cast<UnsignedType>(static_cast<UnsignedType>(static_cast<unsigned char>(buffer[i])) << (8 * i));
+
+    data = static_cast<T>(value);
+}
 
 ODPacket& ODPacket::operator >>(bool& data)
 {
-    mPacket>>data;
+    uint8_t value = 0;
+    readInteger(value);
+    if(mIsValid)
+        data = (value != 0);
+
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(int8_t& data)
 {
-    mPacket>>data;
+    readInteger(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(uint8_t& data)
 {
-    mPacket>>data;
+    readInteger(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(int16_t& data)
 {
-    mPacket>>data;
+    readInteger(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(uint16_t& data)
 {
-    mPacket>>data;
+    readInteger(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(int32_t& data)
 {
-    mPacket>>data;
+    readInteger(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(uint32_t& data)
 {
-    mPacket>>data;
+    readInteger(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(int64_t& data)
 {
-    // Note: currently, SFML 2.1 do not handle int64. We do it ourselves
-    int32_t dataH;
-    int32_t dataL;
-    mPacket>>dataH;
-    mPacket>>dataL;
-    data = OD_INT32TOINT64(dataH,dataL);
+    readInteger(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(uint64_t& data)
 {
-    // Note: currently, SFML 2.1 do not handle int64. We do it ourselves
-    uint32_t dataH;
-    uint32_t dataL;
-    mPacket>>dataH;
-    mPacket>>dataL;
-    data = OD_INT32TOINT64(dataH,dataL);
+    readInteger(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(float& data)
 {
-    mPacket>>data;
+    static_assert(sizeof(float) == sizeof(uint32_t), "float should be 32 bits");
+    // If the read fails, data is not changed
+    uint32_t value;
+    std::memcpy(&value, &data, sizeof(value));
+    readInteger(value);
+    std::memcpy(&data, &value, sizeof(value));
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(double& data)
 {
-    mPacket>>data;
+    static_assert(sizeof(double) == sizeof(uint64_t), "double should be 64 bits");
+    uint64_t value;
+    std::memcpy(&value, &data, sizeof(value));
+    readInteger(value);
+    std::memcpy(&data, &value, sizeof(value));
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(char* data)
 {
-    mPacket>>data;
+    const char* str;
+    uint32_t size;
+    if(!readString(str, size))
+        return *this;
+
+    std::memcpy(data, str, size);
+    data[size] = '\0';
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(std::string& data)
 {
-    mPacket>>data;
+    const char* str;
+    uint32_t size;
+    if(!readString(str, size))
+        return *this;
+
+    data.assign(str, size);
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(wchar_t* data)
 {
-    mPacket>>data;
+    uint32_t size = 0;
+    readInteger(size);
+    if(!mIsValid || (mReadPos + size * sizeof(uint32_t) > mData.size()))
+    {
+        mIsValid = false;
+        return *this;
+    }
+
+    for(uint32_t i = 0; i < size; ++i)
+    {
+        uint32_t character = 0;
+        readInteger(character);
+        data[i] = static_cast<wchar_t>(character);
+    }
+    data[size] = L'\0';
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(std::wstring& data)
 {
-    mPacket>>data;
+    uint32_t size = 0;
+    readInteger(size);
+    if(!mIsValid || (mReadPos + size * sizeof(uint32_t) > mData.size()))
+    {
+        mIsValid = false;
+        return *this;
+    }
+
+    data.clear();
+    data.reserve(size);
+    for(uint32_t i = 0; i < size; ++i)
+    {
+        uint32_t character = 0;
+        readInteger(character);
+        data += static_cast<wchar_t>(character);
+    }
     return *this;
 }
 
 ODPacket& ODPacket::operator >>(Ogre::Vector3& data)
 {
-    mPacket >> data.x >> data.y >> data.z;
+    *this >> data.x >> data.y >> data.z;
     return *this;
 }
+
 ODPacket& ODPacket::operator <<(bool data)
 {
-    mPacket<<data;
+    writeInteger(static_cast<uint8_t>(data ? 1 : 0));
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(int8_t data)
 {
-    mPacket<<data;
+    writeInteger(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(uint8_t data)
 {
-    mPacket<<data;
+    writeInteger(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(int16_t data)
 {
-    mPacket<<data;
+    writeInteger(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(uint16_t data)
 {
-    mPacket<<data;
+    writeInteger(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(int32_t data)
 {
-    mPacket<<data;
+    writeInteger(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(uint32_t data)
 {
-    mPacket<<data;
+    writeInteger(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(int64_t data)
 {
-    // Note: currently, SFML 2.1 do not handle int64. We do it ourselves
-    int32_t dataH = OD_INT64TOINT32H(data);
-    int32_t dataL = OD_INT64TOINT32L(data);
-    mPacket<<dataH;
-    mPacket<<dataL;
+    writeInteger(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(uint64_t data)
 {
-    // Note: currently, SFML 2.1 do not handle int64. We do it ourselves
-    int32_t dataH = OD_INT64TOINT32H(data);
-    int32_t dataL = OD_INT64TOINT32L(data);
-    mPacket<<dataH;
-    mPacket<<dataL;
+    writeInteger(data);
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(float data)
 {
-    mPacket<<data;
+    uint32_t value;
+    std::memcpy(&value, &data, sizeof(value));
+    writeInteger(value);
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(double data)
 {
-    mPacket<<data;
+    uint64_t value;
+    std::memcpy(&value, &data, sizeof(value));
+    writeInteger(value);
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(const char* data)
 {
-    mPacket<<data;
+    uint32_t size = static_cast<uint32_t>(std::strlen(data));
+    writeInteger(size);
+    appendData(data, size);
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(const std::string& data)
 {
-    mPacket<<data;
+    uint32_t size = static_cast<uint32_t>(data.size());
+    writeInteger(size);
+    appendData(data.data(), size);
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(const wchar_t* data)
 {
-    mPacket<<data;
+    uint32_t size = static_cast<uint32_t>(std::wcslen(data));
+    writeInteger(size);
+    for(uint32_t i = 0; i < size; ++i)
+        writeInteger(static_cast<uint32_t>(data[i]));
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(const std::wstring& data)
 {
-    mPacket<<data;
+    uint32_t size = static_cast<uint32_t>(data.size());
+    writeInteger(size);
+    for(wchar_t character : data)
+        writeInteger(static_cast<uint32_t>(character));
     return *this;
 }
 
 ODPacket& ODPacket::operator <<(const Ogre::Vector3&   data)
 {
-    mPacket << data.x << data.y << data.z;
+    *this << data.x << data.y << data.z;
     return *this;
 }
 
 ODPacket::operator bool() const
 {
-    return mPacket;
+    return mIsValid;
 }
 
 void ODPacket::clear()
 {
-    mPacket.clear();
+    // We keep the buffer to avoid allocating it again
+    if(!mData.empty())
+        mData.resize(HEADER_SIZE);
+    mReadPos = HEADER_SIZE;
+    mIsValid = true;
+}
+
+void ODPacket::copyTo(ODPacket& packet) const
+{
+    packet.clear();
+    packet.appendData(getData(), getDataSize());
+    packet.mReadPos = mReadPos;
+    packet.mIsValid = mIsValid;
+}
+
+bool ODPacket::readString(const char*& data, uint32_t& size)
+{
+    uint32_t length = 0;
+    readInteger(length);
+    const char* str = readData(length);
+    if(str == nullptr)
+        return false;
+
+    data = str;
+    size = length;
+    return true;
+}
+
+void ODPacket::appendPacket(const ODPacket& packet)
+{
+    // The packet data is written like a string. That way, it is prefixed by its size
+    uint32_t size = static_cast<uint32_t>(packet.getDataSize());
+    writeInteger(size);
+    appendData(packet.getData(), size);
+}
+
+bool ODPacket::extractPacket(ODPacket& packet)
+{
+    const char* data;
+    uint32_t size;
+    if(!readString(data, size))
+        return false;
+
+    packet.clear();
+    packet.appendData(data, size);
+    return true;
+}
+
+void ODPacket::compressTo(ODPacket& packet, ODPacketCompression compression) const
+{
+    packet.clear();
+    std::size_t dataSize = getDataSize();
+#ifdef OD_USE_LZ4
+    if((compression == ODPacketCompression::lz4) && (dataSize >= COMPRESSION_THRESHOLD))
+    {
+        // We compress directly in the destination packet
+        packet << ODPacketCompression::lz4 << static_cast<uint32_t>(dataSize);
+        std::size_t headerSize = packet.mData.size();
+        int maxSize = LZ4_compressBound(static_cast<int>(dataSize));
+        char* buffer = packet.reserveData(maxSize);
+        int compressedSize = LZ4_compress_default(getData(), buffer, static_cast<int>(dataSize), maxSize);
+        // If the data could not be compressed, we send it as it is
+        if((compressedSize > 0) && (static_cast<std::size_t>(compressedSize) < dataSize))
+        {
+            packet.mData.resize(headerSize + compressedSize);
+            return;
+        }
+        packet.clear();
+    }
+#endif
+    packet << ODPacketCompression::none;
+    packet.appendData(getData(), dataSize);
+}
+
+bool ODPacket::uncompressTo(ODPacket& packet) const
+{
+    packet.clear();
+    std::size_t dataSize = getDataSize();
+    const char* data = getData();
+    if(dataSize < 1)
+        return false;
+
+    // We read the header from the raw data to not change the read position of this packet
+    ODPacketCompression compression = static_cast<ODPacketCompression>(static_cast<uint8_t>(data[0]));
+    switch(compression)
+    {
+        case ODPacketCompression::none:
+        {
+            packet.appendData(data + 1, dataSize - 1);
+            return true;
+        }
+        case ODPacketCompression::lz4:
+        {
+#ifdef OD_USE_LZ4
+            // The uncompressed size follows the mode (in little endian)
+            if(dataSize < 5)
+                return false;
+
+            const unsigned char* sizeData = reinterpret_cast<const unsigned char*>(data + 1);
+            uint32_t uncompressedSize = static_cast<uint32_t>(sizeData[0]) | (static_cast<uint32_t>(sizeData[1]) << 8) |
+                (static_cast<uint32_t>(sizeData[2]) << 16) | (static_cast<uint32_t>(sizeData[3]) << 24);
+            // The size comes from the peer. LZ4 cannot compress more than 255 times so a bigger size
+            // is invalid and should not be allocated
+            if((uncompressedSize > MAX_PACKET_SIZE) ||
+               (uncompressedSize > (dataSize - 5) * LZ4_MAX_RATIO))
+            {
+                return false;
+            }
+
+            char* buffer = packet.reserveData(uncompressedSize);
+            int size = LZ4_decompress_safe(data + 5, buffer, static_cast<int>(dataSize - 5), static_cast<int>(uncompressedSize));
+            if((size < 0) || (static_cast<uint32_t>(size) != uncompressedSize))
+            {
+                packet.clear();
+                return false;
+            }
+
+            return true;
+#else
+            return false;
+#endif
+        }
+        default:
+            return false;
+    }
+}
+
+ODPacketCompression ODPacket::getBestCompression()
+{
+#ifdef OD_USE_LZ4
+    return ODPacketCompression::lz4;
+#else
+    return ODPacketCompression::none;
+#endif
 }
 
 void ODPacket::writePacket(int32_t timestamp, std::ofstream& os)
 {
-    int32_t bufferSize = mPacket.getDataSize();
-    const char* buffer = static_cast<const char*>(mPacket.getData());
+    // Compressing is not free. There is no need to do it if nothing is recorded
+    if(!os.is_open())
+        return;
+
+    // Replays of long games can be big. We compress them as much as we can
+    ODPacket packet;
+    compressTo(packet, getBestCompression());
+    int32_t bufferSize = static_cast<int32_t>(packet.getDataSize());
     os.write(reinterpret_cast<const char*>(&timestamp), sizeof(int32_t));
     os.write(reinterpret_cast<const char*>(&bufferSize), sizeof(int32_t));
-    os.write(buffer, bufferSize);
+    os.write(packet.getData(), bufferSize);
 }
 
 int32_t ODPacket::readPacket(std::ifstream& is)
@@ -262,18 +623,31 @@ int32_t ODPacket::readPacket(std::ifstream& is)
         return -1;
 
     is.read(reinterpret_cast<char*>(&packetSize), sizeof(int32_t));
-    if(is.eof())
+    if(is.eof() || (packetSize < 0) || (static_cast<uint32_t>(packetSize) > MAX_PACKET_SIZE))
         return -1;
 
-    mPacket.clear();
-    char buffer[BUFFER_SIZE];
-    while(packetSize > 0)
-    {
-        int32_t sizeToRead = std::min(packetSize, BUFFER_SIZE);
-        is.read(buffer, sizeToRead);
-        mPacket.append(buffer, sizeToRead);
-        packetSize -= sizeToRead;
-    }
+    // We read the data directly in the packet buffer
+    ODPacket packet;
+    is.read(packet.reserveData(packetSize), packetSize);
+    if(!is)
+        return -1;
+
+    if(!packet.uncompressTo(*this))
+        return -1;
 
     return timestamp;
 }
+
+ODPacket& operator<<(ODPacket& os, const ODPacketCompression& compression)
+{
+    os << static_cast<uint8_t>(compression);
+    return os;
+}
+
+ODPacket& operator>>(ODPacket& is, ODPacketCompression& compression)
+{
+    uint8_t tmp;
+    is >> tmp;
+    compression = static_cast<ODPacketCompression>(tmp);
+    return is;
+}
@@ -19,10 +19,18 @@
 #define ODPACKET_H
 
 #include <OgreVector3.h>
-#include <SFML/Network.hpp>
 
 #include <string>
 #include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+//! \brief Compression modes that can be used for packets sent through the network or written in replays
+enum class ODPacketCompression : uint8_t
+{
+    none = 0,
+    lz4 = 1
+};
 
 /*! \brief This class is an utility class to transfer data through ODSocketClient.
  * It should also override operators << and >> for each standard types.
@@ -62,16 +70,26 @@
  * Emission : packet << creature->mHp;
  * Reception : packet >> creature->mHp;
  * This way, if mHp changes (from float to double for example), it will still work.
+ *
+ * Data is written in little endian in a buffer taken from a pool shared by all the packets, so
+ * that no allocation is needed once enough buffers have been used. The buffer starts with the
+ * size header used by ODSocketClient to send the packet, which allows to write it to the socket
+ * without copying it. As copying a packet means copying its buffer, packets can only be moved.
+ * If a copy is really needed, copyTo should be used.
  */
 class ODPacket
 {
     friend class ODSocketClient;
 
     public:
-        ODPacket()
-        {}
-        ~ODPacket()
-        {}
+        ODPacket();
+        ~ODPacket();
+
+        ODPacket(ODPacket&& packet);
+        ODPacket& operator=(ODPacket&& packet);
+
+        ODPacket(const ODPacket&) = delete;
+        ODPacket& operator=(const ODPacket&) = delete;
 
         /*! \brief Export data operators.
          * The behaviour is the same as standard C++ streams
@@ -125,13 +143,46 @@ class ODPacket
          */
         void clear();
 
-        /*! \brief Writes the packet content to the given ofstream.
+        //! \brief Replaces the content of the given packet by a copy of this one
+        void copyTo(ODPacket& packet) const;
+
+        /*! \brief Reads a string without copying it. data points to the string in the packet buffer and
+         *         is only valid until the packet is modified or destroyed. Note that the string is not
+         *         null terminated. Returns false if no string could be read.
+         */
+        bool readString(const char*& data, uint32_t& size);
+
+        /*! \brief Appends the content of the given packet at the end of this one. It can be read
+         *         back with extractPacket. This allows to send several packets in one network message.
+         */
+        void appendPacket(const ODPacket& packet);
+
+        /*! \brief Reads a packet written by appendPacket. Returns false if no packet could be read.
+         */
+        bool extractPacket(ODPacket& packet);
+
+        /*! \brief Writes in packet the content of this packet compressed with the given mode. The mode
+         *         used is written first so that uncompressTo can read it back. Packets smaller than
+         *         COMPRESSION_THRESHOLD or that cannot be compressed are written uncompressed.
+         */
+        void compressTo(ODPacket& packet, ODPacketCompression compression) const;
+
+        /*! \brief Reads a packet written by compressTo. Returns false if the data is invalid or if
+         *         it was compressed with a mode this build does not support.
+         */
+        bool uncompressTo(ODPacket& packet) const;
+
+        //! \brief Returns the best compression mode supported by this build (none if built without LZ4)
+        static ODPacketCompression getBestCompression();
+
+        /*! \brief Writes the packet content to the given ofstream. The content is compressed
+         *         with the best compression mode available.
          */
         void writePacket(int32_t timestamp, std::ofstream& os);
 
         /*! \brief Reads the packet content from the given ifstream.
          *         Returns the timestamp at which the packet has been sent.
-         *         If EOF has been reached, returns -1
+         *         If EOF has been reached or if the packet could not be read, returns -1
          */
         int32_t readPacket(std::ifstream& is);
 
@@ -150,10 +201,50 @@ class ODPacket
             packet << arg;
         }
 
+        //! \brief Packets smaller than this size (in bytes) are not worth compressing
+        static const uint32_t COMPRESSION_THRESHOLD;
+
+        //! \brief Biggest packet data (in bytes) accepted from the network. The size is sent by the
+        //! peer so it should not be trusted to allocate memory
+        static const uint32_t MAX_PACKET_SIZE;
+
     private:
-        sf::Packet mPacket;
+        //! \brief Size of the header at the beginning of mData. It contains the size of the data
+        //! and is filled by ODSocketClient when the packet is sent
+        static const std::size_t HEADER_SIZE;
+
+        //! \brief Header followed by the packet data
+        std::vector<char> mData;
 
+        //! \brief Position of the next data to read in mData
+        std::size_t mReadPos;
+
+        //! \brief false if a read failed (same behaviour as standard C++ streams)
+        bool mIsValid;
+
+        //! \brief Returns a pointer to size bytes added at the end of the packet
+        char* reserveData(std::size_t size);
+
+        //! \brief Returns a pointer to the next size bytes to read and moves the read position after them.
+        //! Returns nullptr and invalidates the packet if there are not enough data left
+        const char* readData(std::size_t size);
+
+        void appendData(const char* data, std::size_t size);
+
+        //! \brief Returns the data (without the header). mData is empty until something is written
+        const char* getData() const
+        { return mData.empty() ? nullptr : mData.data() + HEADER_SIZE; }
+        std::size_t getDataSize() const
+        { return mData.empty() ? 0 : mData.size() - HEADER_SIZE; }
+
+        template<typename T>
+        void writeInteger(T data);
+        template<typename T>
+        void readInteger(T& data);
 };
 
+ODPacket& operator<<(ODPacket& os, const ODPacketCompression& compression);
+ODPacket& operator>>(ODPacket& is, ODPacketCompression& compression);
+
 #endif // ODPACKET_H
 
@@ -47,6 +47,7 @@
 #include "utils/LogManager.h"
 #include "utils/MasterServer.h"
 #include "utils/ResourceManager.h"
+#include "utils/TraceRecorder.h"
 #include "ODApplication.h"
 
 #include <SFML/Network.hpp>
@@ -247,13 +248,18 @@ void ODServer::sendAsyncMsg(ServerNotification& notif)
     sendMsg(notif.mConcernedPlayer, notif.mPacket);
 }
 
-void ODServer::sendMsg(Player* player, ODPacket& packet)
+void ODServer::sendMsg(Player* player, ODPacket& packet, bool batched)
 {
     if(player == nullptr)
     {
         // If player is nullptr, we send the message to every connected player
         for (ODSocketClient* client : mSockClients)
-            client->send(packet);
+        {
+            if(batched)
+                client->sendBatched(packet);
+            else
+                client->send(packet);
+        }
 
         return;
     }
@@ -269,10 +275,21 @@ void ODServer::sendMsg(Player* player, ODPacket& packet)
         return;
     }
 
-    if(client != nullptr)
+    if(client == nullptr)
+        return;
+
+    if(batched)
+        client->sendBatched(packet);
+    else
         client->send(packet);
 }
 
+void ODServer::flushBatches()
+{
+    for (ODSocketClient* client : mSockClients)
+        client->flushBatch();
+}
+
 void ODServer::handleConsoleCommand(Player* player, GameMap* gameMap, const std::vector<std::string>& args)
 {
     if(args.empty())
@@ -301,21 +318,42 @@ void ODServer::handleConsoleCommand(Player* player, GameMap* gameMap, const std:
     ODServer::getSingleton().queueServerNotification(serverNotification);
 }
 
+void ODServer::logClientsTurnLag()
+{
+    int64_t turn = mGameMap->getTurnNumber();
+    for (ODSocketClient* client : mSockClients)
+    {
+        std::string nick = client->getPlayer() != nullptr ? client->getPlayer()->getNick() : std::string();
+        OD_LOG_INF("Client " + nick + " lastTurnAck=" + Helper::toString(client->getLastTurnAck())
+            + ", turnLag=" + Helper::toString(turn - client->getLastTurnAck()));
+    }
+}
+
 void ODServer::startNewTurn(double timeSinceLastTurn)
 {
     GameMap* gameMap = mGameMap;
     int64_t turn = gameMap->getTurnNumber();
 
-    // We wait until every client acknowledge the turn to start the next one. This way, we ensure
-    // synchronisation is not too bad
+    // The server can be a few turns ahead of the clients. That way, a client with a slow connection or
+    // a slow frame does not stop the game for everybody. It will receive the missed turns at once. If a client
+    // is later than that, we wait for it. We also wait for every client to acknowledge the first turn
+    // because it is the one initializing the gamemap
+    int64_t maxTurnsAhead = static_cast<int64_t>(ConfigManager::getSingleton().getMaxTurnsAheadOfClients());
     for (ODSocketClient* client : mSockClients)
     {
-        if(client->getLastTurnAck() != turn)
+        int64_t lastTurnAck = client->getLastTurnAck();
+        if((lastTurnAck < 0) || (turn - lastTurnAck > maxTurnsAhead))
             return;
     }
 
     gameMap->setTurnNumber(++turn);
 
+    TraceRecorder* traceRecorder = TraceRecorder::getSingletonPtr();
+    if(traceRecorder != nullptr)
+        traceRecorder->recordTurnStarted(turn);
+
+    TraceRecorder::PhaseScope tracePhaseTurn(TracePhase::serverTurn);
+
     ServerNotification* serverNotification = new ServerNotification(
         ServerNotificationType::turnStarted, nullptr);
     serverNotification->mPacket << turn;
@@ -324,9 +362,13 @@ void ODServer::startNewTurn(double timeSinceLastTurn)
     if(mServerMode == ServerMode::ModeEditor)
         gameMap->updateVisibleEntities();
 
-    gameMap->updateAnimations(timeSinceLastTurn);
+    {
+        TraceRecorder::PhaseScope tracePhase(TracePhase::updateAnimations);
+        gameMap->updateAnimations(timeSinceLastTurn);
+    }
 
     // We notify the clients about what they got
+    TraceRecorder::PhaseScope tracePhaseRefreshSeats(TracePhase::refreshSeats);
     for (ODSocketClient* sock : mSockClients)
     {
         Player* player = sock->getPlayer();
@@ -342,12 +384,12 @@ void ODServer::startNewTurn(double timeSinceLastTurn)
 
         // Here, the creature list is pulled. It could be possible that the creature dies before the stat window is
         // closed. So, if we cannot find the creature, we just erase it.
-        std::vector<std::string>& creatures = mCreaturesInfoWanted[sock];
-        std::vector<std::string>::iterator itCreatures = creatures.begin();
+        std::vector<uint32_t>& creatures = mCreaturesInfoWanted[sock];
+        std::vector<uint32_t>::iterator itCreatures = creatures.begin();
         while(itCreatures != creatures.end())
         {
-            std::string& name = *itCreatures;
-            Creature* creature = gameMap->getCreature(name);
+            uint32_t creatureId = *itCreatures;
+            Creature* creature = gameMap->getCreatureById(creatureId);
             if(creature == nullptr)
                 itCreatures = creatures.erase(itCreatures);
             else
@@ -356,13 +398,14 @@ void ODServer::startNewTurn(double timeSinceLastTurn)
 
                 ServerNotification *serverNotification = new ServerNotification(
                     ServerNotificationType::notifyCreatureInfo, player);
-                serverNotification->mPacket << name << creatureInfos;
+                serverNotification->mPacket << creatureId << creatureInfos;
                 ODServer::getSingleton().queueServerNotification(serverNotification);
 
                 ++itCreatures;
             }
         }
     }
+    tracePhaseRefreshSeats.end();
 
     switch(mServerMode)
     {
@@ -370,8 +413,14 @@ void ODServer::startNewTurn(double timeSinceLastTurn)
         case ServerMode::ModeGameMultiPlayer:
         case ServerMode::ModeGameLoaded:
         {
-            gameMap->doTurn(timeSinceLastTurn);
-            gameMap->doPlayerAITurn(timeSinceLastTurn);
+            {
+                TraceRecorder::PhaseScope tracePhase(TracePhase::gameMapTurn);
+                gameMap->doTurn(timeSinceLastTurn);
+            }
+            {
+                TraceRecorder::PhaseScope tracePhase(TracePhase::playerAI);
+                gameMap->doPlayerAITurn(timeSinceLastTurn);
+            }
             break;
         }
         case ServerMode::ModeEditor:
@@ -385,9 +434,18 @@ void ODServer::startNewTurn(double timeSinceLastTurn)
             break;
     }
 
-    gameMap->updateVisibleEntities();
-    gameMap->processActiveObjectsChanges();
-    gameMap->processDeletionQueues();
+    {
+        TraceRecorder::PhaseScope tracePhase(TracePhase::updateVisibleEntities);
+        gameMap->updateVisibleEntities();
+    }
+    {
+        TraceRecorder::PhaseScope tracePhase(TracePhase::activeObjectsChanges);
+        gameMap->processActiveObjectsChanges();
+    }
+    {
+        TraceRecorder::PhaseScope tracePhase(TracePhase::deletionQueues);
+        gameMap->processDeletionQueues();
+    }
 }
 
 void ODServer::serverThread()
@@ -460,18 +518,17 @@ void ODServer::serverThread()
                 // In editor mode, we give vision on all the gamemap tiles
                 if(mServerMode == ServerMode::ModeEditor)
                 {
-                    for (Seat* seat : gameMap->getSeats())
+                    for (int jj = 0; jj < gameMap->getMapSizeY(); ++jj)
                     {
-                        for (int jj = 0; jj < gameMap->getMapSizeY(); ++jj)
+                        for (int ii = 0; ii < gameMap->getMapSizeX(); ++ii)
                         {
-                            for (int ii = 0; ii < gameMap->getMapSizeX(); ++ii)
-                            {
-                                gameMap->getTile(ii,jj)->notifyVision(seat);
-                            }
+                            Tile* tile = gameMap->getTile(ii,jj);
+                            gameMap->updateVisionSource(tile, nullptr, std::vector<Tile*>(1, tile), true);
                         }
+                    }
 
+                    for (Seat* seat : gameMap->getSeats())
                         seat->sendVisibleTiles();
-                    }
                 }
 
                 gameMap->createAllEntities();
@@ -525,6 +582,7 @@ void ODServer::serverThread()
 void ODServer::processServerNotifications()
 {
     GameMap* gameMap = mGameMap;
+    TraceRecorder::PhaseScope tracePhase(TracePhase::serverNotifications);
 
     bool running = true;
 
@@ -549,54 +607,55 @@ void ODServer::processServerNotifications()
         {
             case ServerNotificationType::turnStarted:
                 OD_LOG_INF("Server sends newturn="
-                    + boost::lexical_cast<std::string>(gameMap->getTurnNumber()));
-                sendMsg(event->mConcernedPlayer, event->mPacket);
+                    + boost::lexical_cast<std::string>(gameMap->getTurnNumber())
+                    + " notifications: " + ServerNotification::getPoolStats());
+                sendMsg(event->mConcernedPlayer, event->mPacket, true);
                 break;
 
             case ServerNotificationType::entityPickedUp:
                 // This message should not be sent by human players (they are notified asynchronously)
                 OD_ASSERT_TRUE_MSG(event->mConcernedPlayer->getIsHuman(), "nick=" + event->mConcernedPlayer->getNick());
-                sendMsg(event->mConcernedPlayer, event->mPacket);
+                sendMsg(event->mConcernedPlayer, event->mPacket, true);
                 break;
 
             case ServerNotificationType::entityDropped:
                 // This message should not be sent by human players (they are notified asynchronously)
                 OD_ASSERT_TRUE_MSG(event->mConcernedPlayer->getIsHuman(), "nick=" + event->mConcernedPlayer->getNick());
-                sendMsg(event->mConcernedPlayer, event->mPacket);
+                sendMsg(event->mConcernedPlayer, event->mPacket, true);
                 break;
 
             case ServerNotificationType::entitySlapped:
                 // This message should not be sent by human players (they are notified asynchronously)
                 OD_ASSERT_TRUE_MSG(!event->mConcernedPlayer->getIsHuman(), "nick=" + event->mConcernedPlayer->getNick());
-                sendMsg(event->mConcernedPlayer, event->mPacket);
+                sendMsg(event->mConcernedPlayer, event->mPacket, true);
                 break;
 
             case ServerNotificationType::exit:
                 running = false;
+                flushBatches();
                 stopServer();
                 break;
 
             default:
-                sendMsg(event->mConcernedPlayer, event->mPacket);
+                sendMsg(event->mConcernedPlayer, event->mPacket, true);
                 break;
         }
 
         delete event;
         event = nullptr;
     }
+
+    // Every message of the turn is sent to each client in one network message
+    flushBatches();
 }
 
-bool ODServer::processClientNotifications(ODSocketClient* clientSocket)
+bool ODServer::processClientNotifications(ODSocketClient* clientSocket, ODPacket& packetReceived, ODSocketClient::ODComStatus status)
 {
     if (!clientSocket)
         return false;
 
     GameMap* gameMap = mGameMap;
 
-    ODPacket packetReceived;
-
-    ODSocketClient::ODComStatus status = clientSocket->recv(packetReceived);
-
     // If the client closed the connection
     if (status != ODSocketClient::ODComStatus::OK)
     {
@@ -667,6 +726,20 @@ bool ODServer::processClientNotifications(ODSocketClient* clientSocket)
                 return false;
             }
 
+            // Clients supporting compression send the best mode they know. If we support it
+            // too, the next packets (including the level) will be compressed
+            ODPacketCompression compression = ODPacketCompression::none;
+            if(!(packetReceived >> compression) || (compression != ODPacket::getBestCompression()))
+                compression = ODPacketCompression::none;
+
+            if(compression != ODPacketCompression::none)
+            {
+                ODPacket packet;
+                packet << ServerNotificationType::compressionMode << compression;
+                clientSocket->send(packet);
+                clientSocket->setSendCompression(compression);
+            }
+
             // Tell the client to load the given map
             OD_LOG_INF("Level sent to client: " + gameMap->getLevelName());
             clientSocket->setState("loadLevel");
@@ -1145,24 +1218,21 @@ bool ODServer::processClientNotifications(ODSocketClient* clientSocket)
 
         case ClientNotificationType::askEntityPickUp:
         {
-            std::string entityName;
-            GameEntityType entityType;
-            OD_ASSERT_TRUE(packetReceived >> entityType >> entityName);
+            uint32_t entityId;
+            OD_ASSERT_TRUE(packetReceived >> entityId);
 
             Player *player = clientSocket->getPlayer();
-            GameEntity* entity = gameMap->getEntityFromTypeAndName(entityType, entityName);
+            GameEntity* entity = gameMap->getEntityById(entityId);
             if(entity == nullptr)
             {
-                OD_LOG_ERR("entityType=" + Helper::toString(static_cast<int32_t>(entityType)) + ", entityName=" + entityName);
+                OD_LOG_ERR("entityId=" + Helper::toString(entityId));
                 break;
             }
             bool allowPickup = entity->tryPickup(player->getSeat());
             if(!allowPickup)
             {
                 OD_LOG_INF("player=" + player->getNick()
-                        + " could not pickup entity entityType="
-                        + Helper::toString(static_cast<int32_t>(entityType))
-                        + ", entityName=" + entityName);
+                        + " could not pickup entity entityName=" + entity->getName());
                 break;
             }
 
@@ -1228,23 +1298,20 @@ bool ODServer::processClientNotifications(ODSocketClient* clientSocket)
 
         case ClientNotificationType::askSlapEntity:
         {
-            GameEntityType entityType;
-            std::string entityName;
+            uint32_t entityId;
             Player* player = clientSocket->getPlayer();
-            OD_ASSERT_TRUE(packetReceived >> entityType >> entityName);
-            GameEntity* entity = gameMap->getEntityFromTypeAndName(entityType, entityName);
+            OD_ASSERT_TRUE(packetReceived >> entityId);
+            GameEntity* entity = gameMap->getEntityById(entityId);
             if(entity == nullptr)
             {
-                OD_LOG_WRN("entityType=" + Helper::toString(static_cast<int32_t>(entityType)) + ", entityName=" + entityName);
+                OD_LOG_WRN("entityId=" + Helper::toString(entityId));
                 break;
             }
 
             if(!entity->canSlap(player->getSeat()))
             {
                 OD_LOG_INF("player seatId=" + Helper::toString(player->getSeat()->getId())
-                    + " could not slap entity entityType="
-                    + Helper::toString(static_cast<int32_t>(entityType))
-                    + ", entityName=" + entityName);
+                    + " could not slap entity entityName=" + entity->getName());
                 break;
             }
 
@@ -1420,15 +1487,15 @@ bool ODServer::processClientNotifications(ODSocketClient* clientSocket)
 
         case ClientNotificationType::askCreatureInfos:
         {
-            std::string name;
+            uint32_t creatureId;
             bool refreshEachTurn;
-            OD_ASSERT_TRUE(packetReceived >> name >> refreshEachTurn);
-            std::vector<std::string>& creatures = mCreaturesInfoWanted[clientSocket];
+            OD_ASSERT_TRUE(packetReceived >> creatureId >> refreshEachTurn);
+            std::vector<uint32_t>& creatures = mCreaturesInfoWanted[clientSocket];
 
-            std::vector<std::string>::iterator it = std::find(creatures.begin(), creatures.end(), name);
+            std::vector<uint32_t>::iterator it = std::find(creatures.begin(), creatures.end(), creatureId);
             if(refreshEachTurn && (it == creatures.end()))
             {
-                creatures.push_back(name);
+                creatures.push_back(creatureId);
             }
             else if(!refreshEachTurn && (it != creatures.end()))
                 creatures.erase(it);
@@ -1824,50 +1891,38 @@ bool ODServer::processClientNotifications(ODSocketClient* clientSocket)
     return true;
 }
 
-ODSocketClient* ODServer::notifyNewConnection(sf::TcpListener& sockListener)
+bool ODServer::notifyNewConnection(ODSocketClient* newClient)
 {
-    ODSocketClient* newClient = new ODSocketClient;
-    sf::Socket::Status status = sockListener.accept(newClient->getSockClient());
-    if (status != sf::Socket::Done)
-    {
-        OD_LOG_ERR("Error while listening to socket status=" + Helper::toString(static_cast<uint32_t>(status)));
-        delete newClient;
-        return nullptr;
-    }
-
     switch(mServerState)
     {
         case ServerState::StateNone:
         {
             // It is not normal to receive new connexions while not connected. We are in an unexpected state
             OD_LOG_ERR("Unexpected none server mode");
-            delete newClient;
-            return nullptr;
+            return false;
         }
         case ServerState::StateConfiguration:
         {
             newClient->setState("connected");
-            return newClient;
+            return true;
         }
         case ServerState::StateGame:
         {
             // TODO : handle re-connexion if a client was disconnected and tries to reconnect
             OD_LOG_WRN("Received a reconnexion from a client while in game state");
-            delete newClient;
-            return nullptr;
+            return false;
         }
         default:
             OD_LOG_ERR("Unexpected server state=" + Helper::toString(static_cast<uint32_t>(mServerState)));
             break;
     }
 
-    delete newClient;
-    return nullptr;
+    return false;
 }
 
-bool ODServer::notifyClientMessage(ODSocketClient *clientSocket)
+bool ODServer::notifyClientMessage(ODSocketClient *clientSocket, ODPacket& packetReceived, ODSocketClient::ODComStatus status)
 {
-    bool ret = processClientNotifications(clientSocket);
+    bool ret = processClientNotifications(clientSocket, packetReceived, status);
     if(!ret)
     {
         std::string nick = clientSocket->getPlayer() ? clientSocket->getPlayer()->getNick() : std::string();
@@ -95,9 +95,13 @@ class ODServer: public Ogre::Singleton<ODServer>,
 
     int32_t getNetworkPort() const;
 
+    //! \brief Logs how many turns each client is late regarding the server. Should be called
+    //! from the server thread
+    void logClientsTurnLag();
+
 protected:
-    ODSocketClient* notifyNewConnection(sf::TcpListener& sockListener) override;
-    bool notifyClientMessage(ODSocketClient *sock) override;
+    bool notifyNewConnection(ODSocketClient* newClient) override;
+    bool notifyClientMessage(ODSocketClient *sock, ODPacket& packetReceived, ODSocketClient::ODComStatus status) override;
     void serverThread() override;
 
 private:
@@ -112,7 +116,7 @@ private:
 
     std::deque<ServerNotification*> mServerNotificationQueue;
 
-    std::map<ODSocketClient*, std::vector<std::string>> mCreaturesInfoWanted;
+    std::map<ODSocketClient*, std::vector<uint32_t>> mCreaturesInfoWanted;
 
     ConsoleInterface mConsoleInterface;
 
@@ -143,10 +147,16 @@ private:
      * results.
      * \returns false When the client has disconnected.
      */
-    bool processClientNotifications(ODSocketClient* clientSocket);
+    bool processClientNotifications(ODSocketClient* clientSocket, ODPacket& packetReceived, ODSocketClient::ODComStatus status);
+
+    //! \brief Sends the packet to the given player. If player is nullptr, the packet is sent to every connected player.
+    //! If batched is true, the packet is queued on the client socket and will be sent with the other
+    //! batched packets when flushBatches is called
+    void sendMsg(Player* player, ODPacket& packet, bool batched = false);
 
-    //! \brief Sends the packet to the given player. If player is nullptr, the packet is sent to every connected player
-    void sendMsg(Player* player, ODPacket& packet);
+    //! \brief Sends the batched packets of every connected client. Each client receives all its
+    //! packets in one network message
+    void flushBatches();
 
     void fireSeatConfigurationRefresh();
 
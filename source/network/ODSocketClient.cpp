@@ -16,20 +16,29 @@
  */
 
 #include "ODSocketClient.h"
+#include "game/Player.h"
 #include "network/ODPacket.h"
 #include "network/ServerNotification.h"
 
 #include "utils/Helper.h"
 #include "utils/LogManager.h"
+#include "utils/TraceRecorder.h"
 
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+
+namespace
+{
+// Max number of bytes the receive buffer grows by before they are received
+const std::size_t RECEIVE_CHUNK_SIZE = 64 * 1024;
+}
+
 bool ODSocketClient::connect(const std::string& host, const int port, uint32_t timeout, const std::string& outputReplayFilename)
 {
     mSource = ODSource::none;
 
-    // As we use selector, there is no need to set the socket as not-blocking
     sf::Socket::Status status = mSockClient.connect(host, port, sf::milliseconds(timeout));
     if (status != sf::Socket::Done)
     {
@@ -38,7 +47,9 @@ bool ODSocketClient::connect(const std::string& host, const int port, uint32_t t
         mSockClient.disconnect();
         return false;
     }
-    mSockSelector.add(mSockClient);
+    // The socket is polled from the rendering loop. We set it non blocking so that checking
+    // for new messages returns immediately when nothing has been received
+    mSockClient.setBlocking(false);
     OD_LOG_INF("Connected to server successfully");
 
     mOutputReplayFilename = outputReplayFilename;
@@ -61,6 +72,20 @@ bool ODSocketClient::replay(const std::string& filename)
 void ODSocketClient::disconnect(bool keepReplay)
 {
     mPendingTimestamp = -1;
+    mSendCompression = ODPacketCompression::none;
+    mRecvCompression = ODPacketCompression::none;
+    mBatch.clear();
+    mBatchNbPackets = 0;
+    mReceivedBatch.clear();
+    mReceivedBatchNbPackets = 0;
+    mReceivingPacket.clear();
+    mReceivingSize = 0;
+    {
+        std::lock_guard<std::mutex> lock(mQueuedPacketsLock);
+        mQueuedPackets.clear();
+    }
+    mSendingPackets.clear();
+    mSendingSize = 0;
     ODSource src = mSource;
     mSource = ODSource::none;
     switch(src)
@@ -72,9 +97,6 @@ void ODSocketClient::disconnect(bool keepReplay)
         }
         case ODSource::network:
         {
-            // Remove any remaining client sockets from the socket selector,
-            // if there is any left.
-            mSockSelector.clear();
             mSockClient.disconnect();
             break;
         }
@@ -105,11 +127,9 @@ bool ODSocketClient::isDataAvailable()
         }
         case ODSource::network:
         {
-            // There is only 1 socket in the selector so it should be ready if
-            // wait returns true but it doesn't hurt to return isReady...
-            if(!mSockSelector.wait(sf::milliseconds(5)))
-                return false;
-            return mSockSelector.isReady(mSockClient);
+            // The socket is not blocking. We will know if something was received
+            // when calling recv
+            return true;
         }
         case ODSource::file:
         {
@@ -140,15 +160,142 @@ ODSocketClient::ODComStatus ODSocketClient::send(ODPacket& s)
     if(mSource != ODSource::network)
         return ODComStatus::OK;
 
-    sf::Socket::Status status = mSockClient.send(s.mPacket);
+    // Once compression is enabled, every packet starts with the compression mode (even the ones
+    // too small to be compressed)
+    ODPacket compressedPacket;
+    ODPacket* packet = &s;
+    if(mSendCompression != ODPacketCompression::none)
+    {
+        s.compressTo(compressedPacket, mSendCompression);
+        packet = &compressedPacket;
+    }
+
+    if(mIsSendQueued)
+    {
+        // The caller keeps its packet so we have to copy it (if not already done by the compression)
+        ODPacket queuedPacket;
+        if(packet == &compressedPacket)
+            queuedPacket = std::move(compressedPacket);
+        else
+            s.copyTo(queuedPacket);
+
+        std::lock_guard<std::mutex> lock(mQueuedPacketsLock);
+        mQueuedPackets.push_back(std::move(queuedPacket));
+        return ODComStatus::OK;
+    }
+
+    return sendToSocket(*packet);
+}
+
+ODSocketClient::ODComStatus ODSocketClient::sendQueuedPackets()
+{
+    {
+        std::lock_guard<std::mutex> lock(mQueuedPacketsLock);
+        for(ODPacket& packet : mQueuedPackets)
+            mSendingPackets.push_back(std::move(packet));
+        mQueuedPackets.clear();
+    }
+
+    // The socket may not be blocking. In this case, we write what it accepts and keep the
+    // remaining data for next call so that a slow client does not stall the caller
+    while(!mSendingPackets.empty())
+    {
+        ODPacket& packet = mSendingPackets.front();
+        if(mSendingSize == 0)
+            fillPacketHeader(packet);
+
+        std::size_t sent = 0;
+        sf::Socket::Status status = mSockClient.send(packet.mData.data() + mSendingSize,
+            packet.mData.size() - mSendingSize, sent);
+        mSendingSize += sent;
+        switch(status)
+        {
+            case sf::Socket::Done:
+            {
+                TraceRecorder* traceRecorder = TraceRecorder::getSingletonPtr();
+                if(traceRecorder != nullptr)
+                    traceRecorder->recordPacketSent(mPlayer != nullptr ? mPlayer->getId() : -1,
+                        static_cast<uint32_t>(packet.getDataSize()));
+
+                mSendingPackets.pop_front();
+                mSendingSize = 0;
+                break;
+            }
+            case sf::Socket::Partial:
+            case sf::Socket::NotReady:
+                return ODComStatus::OK;
+            default:
+                OD_LOG_ERR("Could not send data from client status="
+                    + Helper::toString(status));
+                return ODComStatus::Error;
+        }
+    }
+
+    return ODComStatus::OK;
+}
+
+void ODSocketClient::fillPacketHeader(ODPacket& s)
+{
+    // The packet buffer starts with space reserved for the size. We fill it so that the
+    // whole buffer can be sent at once
+    if(s.mData.empty())
+        s.reserveData(0);
+
+    uint32_t size = static_cast<uint32_t>(s.getDataSize());
+    for(std::size_t i = 0; i < ODPacket::HEADER_SIZE; ++i)
+        s.mData[i] = static_cast<char>((size >> (8 * i)) & 0xFF);
+}
+
+ODSocketClient::ODComStatus ODSocketClient::sendToSocket(ODPacket& s)
+{
+    // If the socket is not blocking, a packet could be partially sent. Since we do not want
+    // to handle that, we send it in blocking mode
+    bool isBlocking = mSockClient.isBlocking();
+    if(!isBlocking)
+        mSockClient.setBlocking(true);
+
+    fillPacketHeader(s);
+    sf::Socket::Status status = mSockClient.send(s.mData.data(), s.mData.size());
+
+    if(!isBlocking)
+        mSockClient.setBlocking(false);
+
     if (status == sf::Socket::Done)
+    {
+        TraceRecorder* traceRecorder = TraceRecorder::getSingletonPtr();
+        if(traceRecorder != nullptr)
+            traceRecorder->recordPacketSent(mPlayer != nullptr ? mPlayer->getId() : -1, static_cast<uint32_t>(s.getDataSize()));
+
         return ODComStatus::OK;
+    }
 
     OD_LOG_ERR("Could not send data from client status="
         + Helper::toString(status));
     return ODComStatus::Error;
 }
 
+void ODSocketClient::sendBatched(ODPacket& s)
+{
+    if(mSource != ODSource::network)
+        return;
+
+    mBatch.appendPacket(s);
+    ++mBatchNbPackets;
+}
+
+ODSocketClient::ODComStatus ODSocketClient::flushBatch()
+{
+    if(mBatchNbPackets == 0)
+        return ODComStatus::OK;
+
+    ODPacket packet;
+    packet << ServerNotificationType::packetsBatch << mBatchNbPackets;
+    packet.appendData(mBatch.getData(), mBatch.getDataSize());
+    mBatch.clear();
+    mBatchNbPackets = 0;
+    return send(packet);
+}
+
 ODSocketClient::ODComStatus ODSocketClient::recv(ODPacket& s)
 {
     switch(mSource)
@@ -161,9 +308,21 @@ ODSocketClient::ODComStatus ODSocketClient::recv(ODPacket& s)
         }
         case ODSource::network:
         {
-            sf::Socket::Status status = mSockClient.receive(s.mPacket);
+            sf::Socket::Status status = receiveFromSocket();
             if (status == sf::Socket::Done)
             {
+                if(mRecvCompression == ODPacketCompression::none)
+                {
+                    s = std::move(mReceivingPacket);
+                }
+                else if(!mReceivingPacket.uncompressTo(s))
+                {
+                    OD_LOG_ERR("Could not uncompress received packet size="
+                        + Helper::toString(static_cast<uint32_t>(mReceivingPacket.getDataSize())));
+                    return ODComStatus::Error;
+                }
+                mReceivingPacket.clear();
+
                 s.writePacket(mGameClock.getElapsedTime().asMilliseconds(),
                     mReplayOutputStream);
                 return ODComStatus::OK;
@@ -186,7 +345,7 @@ ODSocketClient::ODComStatus ODSocketClient::recv(ODPacket& s)
         case ODSource::file:
         {
             OD_ASSERT_TRUE(mPendingPacket != 0);
-            s = mPendingPacket;
+            s = std::move(mPendingPacket);
             mPendingTimestamp = -1;
             return ODComStatus::OK;
         }
@@ -196,6 +355,53 @@ ODSocketClient::ODComStatus ODSocketClient::recv(ODPacket& s)
     return ODComStatus::Error;
 }
 
+sf::Socket::Status ODSocketClient::receiveFromSocket()
+{
+    // We read the size of the packet, then its data. As the socket can be non blocking, the packet
+    // may be received in several calls. What was received is kept in mReceivingPacket
+    std::vector<char>& data = mReceivingPacket.mData;
+    if(data.empty())
+        mReceivingPacket.reserveData(0);
+
+    while(true)
+    {
+        std::size_t sizeExpected = ODPacket::HEADER_SIZE;
+        if(mReceivingSize >= ODPacket::HEADER_SIZE)
+        {
+            uint32_t size = 0;
+            for(std::size_t i = 0; i < ODPacket::HEADER_SIZE; ++i)
+                size |= static_cast<uint32_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+
+            if(size > ODPacket::MAX_PACKET_SIZE)
+            {
+                OD_LOG_ERR("Packet too big size=" + Helper::toString(size));
+                mReceivingSize = 0;
+                return sf::Socket::Error;
+            }
+
+            sizeExpected += size;
+            if(mReceivingSize == sizeExpected)
+            {
+                mReceivingSize = 0;
+                return sf::Socket::Done;
+            }
+        }
+
+        // The buffer grows with the data actually received so that a peer announcing a big packet
+        // does not make us allocate memory for data it never sends
+        std::size_t sizeToReceive = std::min(sizeExpected, mReceivingSize + RECEIVE_CHUNK_SIZE);
+        if(data.size() < sizeToReceive)
+            data.resize(sizeToReceive);
+
+        std::size_t received = 0;
+        sf::Socket::Status status = mSockClient.receive(data.data() + mReceivingSize,
+            sizeToReceive - mReceivingSize, received);
+        mReceivingSize += received;
+        if(status != sf::Socket::Done)
+            return status;
+    }
+}
+
 bool ODSocketClient::isConnected()
 {
     return mSource != ODSource::none;
@@ -211,6 +417,11 @@ void ODSocketClient::processClientSocketMessages()
 
 bool ODSocketClient::processOneClientSocketMessage()
 {
+    // If there are remaining packets from the last batch, they should be processed before
+    // reading new data
+    if(mReceivedBatchNbPackets > 0)
+        return processOneBatchedMessage();
+
     if(!isDataAvailable())
         return false;
 
@@ -218,6 +429,9 @@ bool ODSocketClient::processOneClientSocketMessage()
 
     // Check if data available
     ODComStatus comStatus = recv(packetReceived);
+    if(comStatus == ODComStatus::NotReady)
+        return false;
+
     if(comStatus != ODComStatus::OK)
     {
         playerDisconnected();
@@ -227,5 +441,34 @@ bool ODSocketClient::processOneClientSocketMessage()
     ServerNotificationType serverCommand;
     OD_ASSERT_TRUE(packetReceived >> serverCommand);
 
+    if(serverCommand == ServerNotificationType::packetsBatch)
+    {
+        // Note that the batch has already been written in the replay by recv
+        OD_ASSERT_TRUE(packetReceived >> mReceivedBatchNbPackets);
+        mReceivedBatch = std::move(packetReceived);
+        if(mReceivedBatchNbPackets == 0)
+            return true;
+
+        return processOneBatchedMessage();
+    }
+
     return processMessage(serverCommand, packetReceived);
 }
+
+bool ODSocketClient::processOneBatchedMessage()
+{
+    --mReceivedBatchNbPackets;
+    ODPacket packet;
+    if(!mReceivedBatch.extractPacket(packet))
+    {
+        OD_LOG_ERR("Could not read packet from batch remaining=" + Helper::toString(mReceivedBatchNbPackets));
+        mReceivedBatch.clear();
+        mReceivedBatchNbPackets = 0;
+        return false;
+    }
+
+    ServerNotificationType serverCommand;
+    OD_ASSERT_TRUE(packet >> serverCommand);
+
+    return processMessage(serverCommand, packet);
+}
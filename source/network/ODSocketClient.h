@@ -24,7 +24,10 @@
 
 #include <string>
 #include <cstdint>
+#include <deque>
 #include <fstream>
+#include <mutex>
+#include <vector>
 
 class Player;
 
@@ -49,7 +52,14 @@ class ODSocketClient
             mSource(ODSource::none),
             mPlayer(nullptr),
             mLastTurnAck(-1),
-            mPendingTimestamp(-1)
+            mPendingTimestamp(-1),
+            mReceivingSize(0),
+            mBatchNbPackets(0),
+            mReceivedBatchNbPackets(0),
+            mIsSendQueued(false),
+            mSendingSize(0),
+            mSendCompression(ODPacketCompression::none),
+            mRecvCompression(ODPacketCompression::none)
         {}
 
         virtual ~ODSocketClient()
@@ -90,6 +100,37 @@ class ODSocketClient
          */
         ODComStatus send(ODPacket& s);
 
+        /*! \brief Queues a packet to be sent with the next call to flushBatch. All the packets
+         * queued are sent in one network message and demultiplexed by the receiving ODSocketClient
+         * so that the processMessage calls are the same as if they were sent one by one.
+         */
+        void sendBatched(ODPacket& s);
+
+        //! \brief Sends the packets queued with sendBatched (if any)
+        ODComStatus flushBatch();
+
+        /*! \brief If sendQueued is true, send will not write to the socket but queue the packet. Then,
+         * sendQueuedPackets should be called to actually send them. It is used by the server to send
+         * the packets from its network thread.
+         */
+        void setSendQueued(bool sendQueued)
+        { mIsSendQueued = sendQueued; }
+
+        /*! \brief Sends the packets queued by send. It is thread safe regarding send. If the socket is
+         * not blocking, it returns as soon as the socket cannot take more data. What was not written
+         * is kept and sent with the next calls.
+         */
+        ODComStatus sendQueuedPackets();
+
+        /*! \brief Sets the compression used for the packets sent (or received) from now on. Both sides
+         * of the connection have to agree on the mode before it is used (see ClientNotificationType::hello
+         * and ServerNotificationType::compressionMode).
+         */
+        void setSendCompression(ODPacketCompression compression)
+        { mSendCompression = compression; }
+        void setRecvCompression(ODPacketCompression compression)
+        { mRecvCompression = compression; }
+
         /*! \brief Receives a packet through the network
          * ODPacket should preserve integrity. That means that if an ODSocketClient
          * sends an ODPacket, the server should receive exactly 1 similar ODPacket (same data,
@@ -111,8 +152,10 @@ class ODSocketClient
     private :
         bool processOneClientSocketMessage();
 
+        //! \brief Processes the next packet from mReceivedBatch
+        bool processOneBatchedMessage();
+
         ODSource mSource;
-        sf::SocketSelector mSockSelector;
         sf::TcpSocket mSockClient;
         Player* mPlayer;
         int64_t mLastTurnAck;
@@ -124,6 +167,45 @@ class ODSocketClient
         ODPacket mPendingPacket;
         int32_t mPendingTimestamp;
 
+        //! \brief Packet being received from the network and number of bytes already received (size
+        //! header included). As the socket can be non blocking, it may take several calls to recv
+        ODPacket mReceivingPacket;
+        std::size_t mReceivingSize;
+
+        //! \brief Packets queued by sendBatched and not sent yet
+        ODPacket mBatch;
+        uint32_t mBatchNbPackets;
+
+        //! \brief Last batch received. As processMessage can ask to stop processing messages,
+        //! the remaining packets are kept until next call to processClientSocketMessages
+        ODPacket mReceivedBatch;
+        uint32_t mReceivedBatchNbPackets;
+
+        //! \brief Packets sent while mIsSendQueued is true and not yet written to the socket
+        bool mIsSendQueued;
+        std::vector<ODPacket> mQueuedPackets;
+        std::mutex mQueuedPacketsLock;
+
+        //! \brief Packets taken from mQueuedPackets by sendQueuedPackets and not fully written yet. Only the
+        //! first one can be partially written (mSendingSize bytes already sent)
+        std::deque<ODPacket> mSendingPackets;
+        std::size_t mSendingSize;
+
+        //! \brief Writes the size of the packet in its header
+        static void fillPacketHeader(ODPacket& s);
+
+        //! \brief Writes the packet to the socket
+        ODComStatus sendToSocket(ODPacket& s);
+
+        //! \brief Reads data from the socket to mReceivingPacket. Returns sf::Socket::Done when the
+        //! whole packet has been received
+        sf::Socket::Status receiveFromSocket();
+
+        //! \brief Compression of the packets sent and received through the network. Packets
+        //! read from a replay are already uncompressed
+        ODPacketCompression mSendCompression;
+        ODPacketCompression mRecvCompression;
+
         //! \brief the replay filename being written. Used to later optionally delete it
         //! if asked to.
         std::string mOutputReplayFilename;
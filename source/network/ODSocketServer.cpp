@@ -24,9 +24,21 @@
 
 #include <SFML/System.hpp>
 
+#include <algorithm>
+#include <chrono>
+
+//! \brief Maximum number of received messages waiting for the server thread. When reached, the
+//! network thread stops reading the sockets until the server thread catches up
+static const uint32_t MAX_RECEIVED_MESSAGES = 1024;
+
+//! \brief Maximum time the network thread waits for socket events. It bounds the delay
+//! before the packets queued by the server thread are sent
+static const int32_t NETWORK_THREAD_WAIT_MS = 5;
+
 ODSocketServer::ODSocketServer():
     mThread(nullptr),
-    mIsConnected(false)
+    mIsConnected(false),
+    mNetworkThread(nullptr)
 {
 }
 
@@ -40,7 +52,6 @@ bool ODSocketServer::createServer(int listeningPort)
 {
     mIsConnected = false;
 
-    // As we use selector, there is no need to set the socket as not-blocking
     sf::Socket::Status status = mSockListener.listen(listeningPort);
     if (status != sf::Socket::Done)
     {
@@ -49,9 +60,10 @@ bool ODSocketServer::createServer(int listeningPort)
         return false;
     }
 
-    mSockSelector.add(mSockListener);
     mIsConnected = true;
     OD_LOG_INF("Server connected and listening");
+    mNetworkThread = new sf::Thread(&ODSocketServer::networkThread, this);
+    mNetworkThread->launch();
     mThread = new sf::Thread(&ODSocketServer::serverThread, this);
     mThread->launch();
 
@@ -63,63 +75,190 @@ bool ODSocketServer::isConnected()
     return mIsConnected;
 }
 
-void ODSocketServer::doTask(int timeoutMs)
+void ODSocketServer::networkThread()
 {
-    mClockMainTask.restart();
-    while((timeoutMs == 0) ||
-          (timeoutMs > mClockMainTask.getElapsedTime().asMilliseconds()))
+    while(mIsConnected)
     {
-        bool isSockReady;
-        if(timeoutMs != 0)
-        {
-            // We adapt the timeout so that the function returns after timeoutMs
-            // even if events occurred
-            int timeoutMsAdjusted = std::max(1, timeoutMs - mClockMainTask.getElapsedTime().asMilliseconds());
-            isSockReady = mSockSelector.wait(sf::milliseconds(timeoutMsAdjusted));
-        }
-        else
+        // If the queue is full, we let the data in the sockets until the server thread catches up.
+        // In this case, the client sockets are not watched. Otherwise, the selector would return
+        // immediately as long as they have data and we would loop without waiting
+        bool isQueueFull = isReceivedMessagesFull();
+
+        // The selector is only used by the network thread. We fill it each time because the
+        // client list can be changed by the server thread
         {
-            isSockReady = mSockSelector.wait(sf::Time::Zero);
+            std::lock_guard<std::mutex> lock(mNetworkClientsLock);
+            mSockSelector.clear();
+            mSockSelector.add(mSockListener);
+            if(!isQueueFull)
+            {
+                for(ODSocketClient* client : mNetworkClients)
+                    mSockSelector.add(client->getSockClient());
+            }
         }
 
-        // Check if a client tries to connect or to communicate
-        if(!isSockReady)
-            continue;
+        bool isSockReady = mSockSelector.wait(sf::milliseconds(NETWORK_THREAD_WAIT_MS));
 
-        if(mSockSelector.isReady(mSockListener))
+        if(isSockReady && mSockSelector.isReady(mSockListener))
         {
-            // New connection
-            ODSocketClient* newClient = notifyNewConnection(mSockListener);
-            if (newClient != nullptr)
+            ODSocketClient* newClient = new ODSocketClient;
+            sf::Socket::Status status = mSockListener.accept(newClient->getSockClient());
+            if (status != sf::Socket::Done)
+            {
+                OD_LOG_ERR("Error while listening to socket status=" + Helper::toString(static_cast<uint32_t>(status)));
+                delete newClient;
+            }
+            else
             {
-                // New connection
-                OD_LOG_INF("New client connected.");
-                // The server wants to keep the client
+                // The server thread will decide if the client is kept
                 newClient->setSource(ODSocketClient::ODSource::network);
-                mSockSelector.add(newClient->getSockClient());
-                mSockClients.push_back(newClient);
+                newClient->setSendQueued(true);
+                newClient->getSockClient().setBlocking(false);
+                pushReceivedMessage(newClient, true, ODPacket(), ODSocketClient::ODComStatus::OK);
             }
         }
-        else
-        {
 
-            for(std::vector<ODSocketClient*>::iterator it = mSockClients.begin(); it != mSockClients.end();)
+        // The client sockets are not blocking so sending the queued packets does not wait
+        // for slow clients. What they cannot take yet is sent in the next iterations
+        std::lock_guard<std::mutex> lock(mNetworkClientsLock);
+        for(std::vector<ODSocketClient*>::iterator it = mNetworkClients.begin(); it != mNetworkClients.end();)
+        {
+            ODSocketClient* client = *it;
+            ODSocketClient::ODComStatus status = client->sendQueuedPackets();
+            if((status == ODSocketClient::ODComStatus::OK) &&
+               isSockReady &&
+               !isQueueFull &&
+               mSockSelector.isReady(client->getSockClient()))
             {
-                ODSocketClient* client = *it;
-                if((mSockSelector.isReady(client->getSockClient())) &&
-                    (!notifyClientMessage(client)))
-                {
-                    // The server wants to remove the client
-                    it = mSockClients.erase(it);
-                    mSockSelector.remove(client->getSockClient());
-                    client->disconnect();
-                    delete client;
-                }
-                else
+                // We check again as we may have filled the queue with the previous clients
+                isQueueFull = isReceivedMessagesFull();
+                if(!isQueueFull)
                 {
-                    ++it;
+                    ODPacket packet;
+                    status = client->recv(packet);
+                    if(status == ODSocketClient::ODComStatus::OK)
+                        pushReceivedMessage(client, false, std::move(packet), status);
+                    else if(status == ODSocketClient::ODComStatus::NotReady)
+                        status = ODSocketClient::ODComStatus::OK;
                 }
             }
+
+            if(status == ODSocketClient::ODComStatus::OK)
+            {
+                ++it;
+                continue;
+            }
+
+            // The client is not handled anymore by the network thread. The server thread will
+            // remove it when processing the error
+            it = mNetworkClients.erase(it);
+            pushReceivedMessage(client, false, ODPacket(), status);
+        }
+    }
+
+    // We send what the server thread queued before stopping. As we are stopping, we can
+    // wait for the data to be written
+    std::lock_guard<std::mutex> lock(mNetworkClientsLock);
+    for(ODSocketClient* client : mNetworkClients)
+    {
+        client->getSockClient().setBlocking(true);
+        client->sendQueuedPackets();
+    }
+}
+
+bool ODSocketServer::isReceivedMessagesFull()
+{
+    std::lock_guard<std::mutex> lock(mReceivedMessagesLock);
+    return mReceivedMessages.size() >= MAX_RECEIVED_MESSAGES;
+}
+
+void ODSocketServer::pushReceivedMessage(ODSocketClient* client, bool isNewConnection, ODPacket&& packet,
+    ODSocketClient::ODComStatus status)
+{
+    {
+        std::lock_guard<std::mutex> lock(mReceivedMessagesLock);
+        mReceivedMessages.push_back(ReceivedMessage());
+        ReceivedMessage& message = mReceivedMessages.back();
+        message.mClient = client;
+        message.mIsNewConnection = isNewConnection;
+        message.mPacket = std::move(packet);
+        message.mStatus = status;
+    }
+    mReceivedMessagesCondition.notify_one();
+}
+
+bool ODSocketServer::popReceivedMessage(ReceivedMessage& message, int32_t timeoutMs)
+{
+    std::unique_lock<std::mutex> lock(mReceivedMessagesLock);
+    if(!mReceivedMessagesCondition.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+        [this]() { return !mReceivedMessages.empty(); }))
+    {
+        return false;
+    }
+
+    message = std::move(mReceivedMessages.front());
+    mReceivedMessages.pop_front();
+    return true;
+}
+
+void ODSocketServer::removeClient(ODSocketClient* client)
+{
+    {
+        std::lock_guard<std::mutex> lock(mNetworkClientsLock);
+        std::vector<ODSocketClient*>::iterator it = std::find(mNetworkClients.begin(), mNetworkClients.end(), client);
+        if(it != mNetworkClients.end())
+            mNetworkClients.erase(it);
+    }
+
+    // We remove the messages from this client that are not processed yet
+    {
+        std::lock_guard<std::mutex> lock(mReceivedMessagesLock);
+        mReceivedMessages.erase(std::remove_if(mReceivedMessages.begin(), mReceivedMessages.end(),
+            [client](const ReceivedMessage& message) { return message.mClient == client; }),
+            mReceivedMessages.end());
+    }
+
+    mSockClients.erase(std::remove(mSockClients.begin(), mSockClients.end(), client), mSockClients.end());
+    client->disconnect();
+    delete client;
+}
+
+void ODSocketServer::doTask(int timeoutMs)
+{
+    mClockMainTask.restart();
+    while((timeoutMs == 0) ||
+          (timeoutMs > mClockMainTask.getElapsedTime().asMilliseconds()))
+    {
+        // We adapt the timeout so that the function returns after timeoutMs
+        // even if events occurred
+        int32_t timeoutMsAdjusted = NETWORK_THREAD_WAIT_MS;
+        if(timeoutMs != 0)
+            timeoutMsAdjusted = std::max(1, timeoutMs - mClockMainTask.getElapsedTime().asMilliseconds());
+
+        ReceivedMessage message;
+        if(!popReceivedMessage(message, timeoutMsAdjusted))
+            continue;
+
+        if(message.mIsNewConnection)
+        {
+            if(!notifyNewConnection(message.mClient))
+            {
+                message.mClient->disconnect();
+                delete message.mClient;
+                continue;
+            }
+
+            OD_LOG_INF("New client connected.");
+            mSockClients.push_back(message.mClient);
+            std::lock_guard<std::mutex> lock(mNetworkClientsLock);
+            mNetworkClients.push_back(message.mClient);
+            continue;
+        }
+
+        if(!notifyClientMessage(message.mClient, message.mPacket, message.mStatus))
+        {
+            // The server wants to remove the client
+            removeClient(message.mClient);
         }
     }
 }
@@ -127,11 +266,27 @@ void ODSocketServer::doTask(int timeoutMs)
 void ODSocketServer::stopServer()
 {
     mIsConnected = false;
+    if(mNetworkThread != nullptr)
+        delete mNetworkThread; // Delete waits for the thread to finish
+    mNetworkThread = nullptr;
     if(mThread != nullptr)
         delete mThread; // Delete waits for the thread to finish
     mThread = nullptr;
     mSockSelector.clear();
     mSockListener.close();
+    mNetworkClients.clear();
+
+    // New clients not processed yet by the server thread are not in mSockClients
+    for(ReceivedMessage& message : mReceivedMessages)
+    {
+        if(!message.mIsNewConnection)
+            continue;
+
+        message.mClient->disconnect();
+        delete message.mClient;
+    }
+    mReceivedMessages.clear();
+
     for (std::vector<ODSocketClient*>::iterator it = mSockClients.begin(); it != mSockClients.end(); ++it)
     {
         ODSocketClient* client = *it;
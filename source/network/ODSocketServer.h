@@ -19,13 +19,23 @@
 #define ODSOCKETSERVER_H
 
 #include "ODSocketClient.h"
+#include "network/ODPacket.h"
 
 #include <SFML/Network.hpp>
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <vector>
 
-class ODPacket;
-
+/*! \brief Socket server. The sockets are handled by a dedicated network thread which accepts
+ * new connections, receives packets and sends the packets queued by the server thread. What is
+ * received is handed to the server thread through a bounded queue that is consumed by doTask. That
+ * way, the time spent by the server thread does not depend on the number of clients nor on their
+ * network speed.
+ */
 class ODSocketServer
 {
     public:
@@ -39,10 +49,10 @@ class ODSocketServer
         virtual void stopServer();
 
     protected:
-        /*! \brief Function called when a new client connects. If the server returns an ODSocketClient,
-         *! it will be added to the client list
+        /*! \brief Function called from the server thread when a new client connects. The client socket is already
+         * accepted. If the server returns true, it will be added to the client list. If not, it will be deleted.
          */
-        virtual ODSocketClient* notifyNewConnection(sf::TcpListener& sockListener) = 0;
+        virtual bool notifyNewConnection(ODSocketClient* newClient) = 0;
 
         /*! \brief Function called when a client sends a message. As this function is called
          * from the doTask context, it shall return as soon as possible (we should not send
@@ -52,14 +62,15 @@ class ODSocketServer
          * 3 - Save somewhere if we are waiting for something from the client
          * 4 - Return from the function. When new data will be available, notifyClientMessage
          *     will be called again
+         * status is not OK if the client got disconnected. In this case, packetReceived is empty.
          * If the function returns false, the client will be removed from the list and properly deleted
          */
-        virtual bool notifyClientMessage(ODSocketClient *sock) = 0;
+        virtual bool notifyClientMessage(ODSocketClient *sock, ODPacket& packetReceived, ODSocketClient::ODComStatus status) = 0;
 
-        /*! \brief Main function task. Checks if a new client connects. If so, notifyNewConnection
-         * will be called with the client socket. If it returns true, the client is saved in the
-         * client list. If not, the client is discarded. doTask also checks if a connected client sent
-         * a message. If so, calls notifyClientMessage with the client socket.
+        /*! \brief Main function task. Processes the new connections and the messages received by the
+         * network thread. For each new client, notifyNewConnection is called. If it returns true, the
+         * client is saved in the client list. If not, the client is discarded. For each message received,
+         * notifyClientMessage is called with the client socket.
          * If timeoutMs = 0, this function will never return. Otherwise, it will always return after
          * timeoutMs milliseconds, even if new clients connected or clients are sending messages.
          */
@@ -69,11 +80,50 @@ class ODSocketServer
         sf::Thread* mThread;
 
     private:
+        //! \brief Something the network thread received that should be processed by the server thread
+        struct ReceivedMessage
+        {
+            ODSocketClient* mClient;
+            //! \brief true if mClient has just been accepted. false if it sent something
+            bool mIsNewConnection;
+            ODPacket mPacket;
+            ODSocketClient::ODComStatus mStatus;
+        };
+
+        //! \brief Loop of the network thread
+        void networkThread();
+
+        //! \brief Called from the network thread to hand something to the server thread
+        void pushReceivedMessage(ODSocketClient* client, bool isNewConnection, ODPacket&& packet,
+            ODSocketClient::ODComStatus status);
+
+        //! \brief Returns true if the network thread should stop receiving until the server thread
+        //! processes what is waiting
+        bool isReceivedMessagesFull();
+
+        //! \brief Waits at most timeoutMs for something received by the network thread. Returns
+        //! false if nothing was received
+        bool popReceivedMessage(ReceivedMessage& message, int32_t timeoutMs);
+
+        //! \brief Removes the client from the network thread and deletes it
+        void removeClient(ODSocketClient* client);
+
         sf::TcpListener mSockListener;
         sf::SocketSelector mSockSelector;
         sf::Clock mClockMainTask;
-        bool mIsConnected;
+        std::atomic<bool> mIsConnected;
+
+        sf::Thread* mNetworkThread;
+
+        //! \brief Clients handled by the network thread. Protected by mNetworkClientsLock
+        std::vector<ODSocketClient*> mNetworkClients;
+        std::mutex mNetworkClientsLock;
+
+        //! \brief Messages waiting to be processed by the server thread. The network thread stops
+        //! receiving (which slows down the clients through TCP) when it is full
+        std::deque<ReceivedMessage> mReceivedMessages;
+        std::mutex mReceivedMessagesLock;
+        std::condition_variable mReceivedMessagesCondition;
 };
 
 #endif // ODSOCKETSERVER_H
-
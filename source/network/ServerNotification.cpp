@@ -17,6 +17,8 @@
 
 #include "network/ServerNotification.h"
 
+#include "network/NotificationPool.h"
+
 #include "utils/Helper.h"
 #include "utils/LogManager.h"
 
@@ -28,10 +30,32 @@ ServerNotification::ServerNotification(ServerNotificationType type,
     mPacket << type;
 }
 
+void* ServerNotification::operator new(std::size_t size)
+{
+    return NotificationPool::getPool<ServerNotification>().allocate(size);
+}
+
+void ServerNotification::operator delete(void* block, std::size_t size)
+{
+    NotificationPool::getPool<ServerNotification>().release(block, size);
+}
+
+std::string ServerNotification::getPoolStats()
+{
+    return NotificationPool::getPool<ServerNotification>().getStatsString();
+}
+
+uint64_t ServerNotification::getNbCreated()
+{
+    return NotificationPool::getPool<ServerNotification>().getNbRequests();
+}
+
 std::string ServerNotification::typeString(ServerNotificationType type)
 {
     switch(type)
     {
+        case ServerNotificationType::compressionMode:
+            return "compressionMode";
         case ServerNotificationType::loadLevel:
             return "loadLevel";
         case ServerNotificationType::pickNick:
@@ -60,6 +84,8 @@ std::string ServerNotification::typeString(ServerNotificationType type)
             return "chatServer";
         case ServerNotificationType::turnStarted:
             return "turnStarted";
+        case ServerNotificationType::packetsBatch:
+            return "packetsBatch";
         case ServerNotificationType::animatedObjectSetWalkPath:
             return "animatedObjectSetWalkPath";
         case ServerNotificationType::setObjectAnimationState:
@@ -20,6 +20,7 @@
 
 #include "network/ODPacket.h"
 
+#include <cstddef>
 #include <deque>
 #include <string>
 #include <OgreVector3.h>
@@ -32,6 +33,7 @@ class Player;
 enum class ServerNotificationType
 {
     // Negotiation for multiplayer
+    compressionMode, // Tells the client how the next packets are compressed: + ODPacketCompression
     loadLevel, // Tells the client to load the level: + string LevelFilename
     pickNick,
     addPlayers,
@@ -50,6 +52,8 @@ enum class ServerNotificationType
 
     turnStarted,
 
+    packetsBatch, // Contains several messages sent at once (see ODSocketClient::sendBatched)
+
     animatedObjectSetWalkPath,
     setObjectAnimationState,
     entityPickedUp,
@@ -106,10 +110,21 @@ class ServerNotification
         virtual ~ServerNotification()
         {}
 
+        //! \brief Notifications are allocated from a pool (see NotificationPool) because
+        //! a lot of them are created and destroyed each turn
+        static void* operator new(std::size_t size);
+        static void operator delete(void* block, std::size_t size);
+
         ODPacket mPacket;
 
         static std::string typeString(ServerNotificationType type);
 
+        //! \brief Returns the counters of the notification pool (for logging)
+        static std::string getPoolStats();
+
+        //! \brief Returns the number of notifications created since the game started
+        static uint64_t getNbCreated();
+
     private:
         ServerNotificationType mType;
         Player *mConcernedPlayer;
@@ -85,6 +85,23 @@ void Room::removeFromGameMap()
     getGameMap()->removeActiveObject(this);
 }
 
+void Room::setSeat(Seat* seat)
+{
+    Seat* oldSeat = getSeat();
+    GameEntity::setSeat(seat);
+    if((oldSeat == nullptr) || (oldSeat == seat))
+        return;
+
+    // Only the rooms added to the gamemap are indexed
+    if(oldSeat->getStats().removeRoom(this) && (seat != nullptr))
+        seat->getStats().addRoom(this, getType(), getTotalGoldStored(), getTotalGoldStorage());
+}
+
+void Room::updateSeatStatsGold()
+{
+    getSeat()->getStats().updateRoomGold(this, getTotalGoldStored(), getTotalGoldStorage());
+}
+
 void Room::absorbRoom(Room *r)
 {
     OD_LOG_INF(getGameMap()->serverStr() + "Room=" + getName() + " is absorbing room=" + r->getName());
@@ -131,6 +148,10 @@ void Room::absorbRoom(Room *r)
     r->mCoveredTilesDestroyed.insert(r->mCoveredTilesDestroyed.end(), r->mCoveredTiles.begin(), r->mCoveredTiles.end());
     r->mCoveredTiles.clear();
 
+    // The gold stored in the absorbed room tiles now belongs to this room too
+    updateSeatStatsGold();
+    r->updateSeatStatsGold();
+
     // We fire the dead event so that if there are creatures heading for this room or
     // whatever, we release them before the remove from gamemap event
     r->fireEntityDead();
@@ -673,6 +694,7 @@ void Room::repairRoom()
         tile->setCoveringBuilding(this);
     }
 
+    updateSeatStatsGold();
     updateActiveSpots();
 }
 
@@ -50,8 +50,14 @@ public:
     virtual void addToGameMap();
     virtual void removeFromGameMap() override;
 
+    //! \brief Moves the room (and its gold) to the new seat stats if it is indexed
+    virtual void setSeat(Seat* seat) override;
+
     virtual void absorbRoom(Room* r);
 
+    //! \brief Reports the gold stored in the room to the seat stats. Should be called when it changes
+    void updateSeatStatsGold();
+
     //! \brief By default, we consider that creatures using the room are working and
     //! should be forced to work in the new room (if possible). If not, this function
     //! should be overriden
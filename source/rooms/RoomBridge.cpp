@@ -231,7 +231,7 @@ bool BridgeRoomFactory::readBridgeFromPacket(std::vector<Tile*>& tiles, GameMap*
             break;
         }
 
-        const std::vector<Tile*>& neighs = tile->getAllNeighbors();
+        TileNeighbors neighs = tile->getAllNeighbors();
         bool isOk = isEditor;
         // We check if it is the next tile from the bridge
         if(!tiles.empty() &&
@@ -285,7 +285,7 @@ void RoomBridge::setupRoom(const std::string& name, Seat* seat, const std::vecto
 
     mClaimedValue = static_cast<double>(tiles.size()) * CLAIMED_VALUE_PER_TILE;
 
-    for(Seat* s : getGameMap()->getSeats())
+    for(Seat* s : getGameMap()->getFloodFillLayerSeats())
         updateFloodFillPathCreated(s, tiles);
 }
 
@@ -293,7 +293,7 @@ void RoomBridge::restoreInitialEntityState()
 {
     Room::restoreInitialEntityState();
 
-    for(Seat* s : getGameMap()->getSeats())
+    for(Seat* s : getGameMap()->getFloodFillLayerSeats())
         updateFloodFillPathCreated(s, getCoveredTiles());
 }
 
@@ -336,7 +336,7 @@ bool RoomBridge::removeCoveredTile(Tile* t)
     if(mClaimedValue > CLAIMED_VALUE_PER_TILE)
         mClaimedValue -= CLAIMED_VALUE_PER_TILE;
 
-    for(Seat* seat : getGameMap()->getSeats())
+    for(Seat* seat : getGameMap()->getFloodFillLayerSeats())
         updateFloodFillTileRemoved(seat, t);
 
     return true;
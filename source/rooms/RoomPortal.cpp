@@ -210,6 +210,11 @@ void RoomPortal::doUpkeep()
     // Call the super class Room::doUpkeep() function to do any generic upkeep common to all rooms.
     Room::doUpkeep();
 
+    if(!mRandomStream.isSeeded())
+        mRandomStream.seed(Random::getStreamSeed(RandomStreamType::roomPortal, getName()));
+
+    RandomStream::Scope randomScope(mRandomStream);
+
     if(mSpawnCreatureCountdown > 0)
     {
         --mSpawnCreatureCountdown;
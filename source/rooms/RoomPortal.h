@@ -20,6 +20,7 @@
 
 #include "rooms/Room.h"
 #include "rooms/RoomType.h"
+#include "utils/RandomStream.h"
 
 class RoomPortal: public Room
 {
@@ -84,6 +85,9 @@ private:
 
     double mClaimedValue;
 
+    //! \brief Random stream used during the portal upkeep. Seeded from the game seed and the room name
+    RandomStream mRandomStream;
+
     uint32_t mNbCreatureMaxIncrease;
 
     //! \brief Updates the portal mesh position.
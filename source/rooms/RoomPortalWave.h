@@ -20,6 +20,7 @@
 
 #include "rooms/Room.h"
 #include "rooms/RoomType.h"
+#include "utils/RandomStream.h"
 
 #include <vector>
 
@@ -129,6 +130,9 @@ private:
 
     double mClaimedValue;
 
+    //! \brief Random stream used during the portal upkeep. Seeded from the game seed and the room name
+    RandomStream mRandomStream;
+
     //! Stores the spawnable waves
     std::vector<RoomPortalWaveData*> mRoomPortalWaveDataSpawnable;
 
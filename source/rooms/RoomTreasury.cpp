@@ -288,7 +288,9 @@ bool RoomTreasury::removeCoveredTile(Tile* t)
 
     roomTreasuryTileData->mMeshOfTile.clear();
     roomTreasuryTileData->mGoldInTile = 0;
-    return Room::removeCoveredTile(t);
+    bool isRemoved = Room::removeCoveredTile(t);
+    updateSeatStatsGold();
+    return isRemoved;
 }
 
 int RoomTreasury::getTotalGoldStorage() const
@@ -345,6 +347,7 @@ int RoomTreasury::depositGold(int gold, Tile *tile)
         return wasDeposited;
 
     mGoldChanged = true;
+    updateSeatStatsGold();
 
     // Tells the client to play a deposit gold sound. For now, we only send it to the players
     // with vision on tile
@@ -378,6 +381,7 @@ int RoomTreasury::withdrawGold(int gold)
         }
     }
 
+    updateSeatStatsGold();
     return withdrawlAmount;
 }
 
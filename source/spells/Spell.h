@@ -55,7 +55,7 @@ public:
 
     virtual void doUpkeep();
 
-    //! \brief Computes the visible tiles and tags them to know which are visible
+    //! \brief Computes the visible tiles and gives them to GameMap::updateVisionSource. Called each turn
     virtual void computeVisibleTiles()
     {}
 
@@ -91,8 +91,7 @@ void SpellEyeEvil::computeVisibleTiles()
     }
 
     std::vector<Tile*> tiles = getGameMap()->circularRegion(posTile->getX(), posTile->getY(), radius);
-    for(Tile* tile : tiles)
-        tile->notifyVision(getSeat());
+    getGameMap()->updateVisionSource(this, getSeat(), tiles, false);
 }
 
 void SpellEyeEvil::checkSpellCast(GameMap* gameMap, const InputManager& inputManager, InputCommand& inputCommand)
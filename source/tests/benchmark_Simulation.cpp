@@ -0,0 +1,366 @@
+/*
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*! \brief Headless benchmark of the server simulation.
+ *
+ * Loads levels in a server GameMap (without renderer nor sockets), gives every seat to a
+ * keeper AI and runs a fixed number of turns with a fixed random seed. The time spent in
+ * each phase of the turns is written as JSON so that optimizations can be compared on the
+ * same games.
+ *
+ * Usage: od-benchmark [--turns N] [--seed S] [--output file.json] level-or-directory...
+ * Directories are scanned recursively for .level files.
+ */
+
+#include "ai/KeeperAIType.h"
+#include "entities/Creature.h"
+#include "entities/Tile.h"
+#include "game/Player.h"
+#include "game/Seat.h"
+#include "gamemap/GameMap.h"
+#include "network/ODServer.h"
+#include "network/ServerNotification.h"
+#include "utils/ConfigManager.h"
+#include "utils/Helper.h"
+#include "utils/LogManager.h"
+#include "utils/LogSinkConsole.h"
+#include "utils/Random.h"
+#include "utils/ResourceManager.h"
+#include "ODApplication.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+//! \brief Phases of a server turn, in the order ODServer::startNewTurn runs them. The creatures
+//! sense, vision and active objects upkeep are reported by the GameMap and are not included in
+//! gameMapTurn. updateVisibleEntities tells the seats which entities they see; the tiles vision is
+//! computed in the vision phase
+enum class BenchmarkPhase
+{
+    updateAnimations,
+    gameMapTurn,
+    creaturesSense,
+    vision,
+    activeObjectsUpkeep,
+    playerAI,
+    updateVisibleEntities,
+    activeObjectsChanges,
+    deletionQueues,
+    nbPhases
+};
+
+const char* BENCHMARK_PHASE_NAMES[] =
+{
+    "updateAnimations",
+    "gameMapTurn",
+    "creaturesSense",
+    "vision",
+    "activeObjectsUpkeep",
+    "playerAI",
+    "updateVisibleEntities",
+    "activeObjectsChanges",
+    "deletionQueues"
+};
+
+struct BenchmarkResult
+{
+    std::string mLevel;
+    bool mIsLoaded = false;
+    int64_t mNbTurns = 0;
+    double mSetupMs = 0.0;
+    double mTotalMs = 0.0;
+    double mMaxTurnMs = 0.0;
+    double mPhasesMs[static_cast<uint32_t>(BenchmarkPhase::nbPhases)] = {};
+    unsigned int mNbPathCalls = 0;
+    unsigned int mNbPathCacheHits = 0;
+    uint64_t mNbNotifications = 0;
+    uint32_t mNbCreatures = 0;
+};
+
+double elapsedMs(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+//! \brief Configures the seats like ODServer does when a game is launched, except that every
+//! non rogue seat is given to a keeper AI
+void configureSeats(GameMap& gameMap)
+{
+    const std::vector<std::string>& factions = ConfigManager::getSingleton().getFactions();
+    for(Seat* seat : gameMap.getSeats())
+    {
+        if(seat->isRogueSeat())
+            continue;
+
+        if(seat->getFaction().compare(Seat::PLAYER_FACTION_CHOICE) == 0 ||
+           (std::find(factions.begin(), factions.end(), seat->getFaction()) == factions.end()))
+        {
+            seat->setFaction(factions.front());
+        }
+
+        Player* aiPlayer = new Player(&gameMap, 0);
+        aiPlayer->setNick("Keeper AI " + Helper::toString(seat->getId()));
+        gameMap.addPlayer(aiPlayer);
+        seat->setPlayer(aiPlayer);
+        gameMap.assignAI(*aiPlayer, KeeperAIType::normal);
+
+        const std::vector<int>& availableTeamIds = seat->getAvailableTeamIds();
+        if(!availableTeamIds.empty())
+            seat->setTeamId(availableTeamIds.front());
+
+        seat->setMapSize(gameMap.getMapSizeX(), gameMap.getMapSizeY());
+    }
+
+    for(Seat* seat : gameMap.getSeats())
+        seat->initSeat();
+
+    gameMap.notifySeatsConfigured();
+}
+
+//! \brief Starts the game like ODServer::serverThread does once the seats are configured
+void startGame(GameMap& gameMap)
+{
+    const std::vector<Seat*>& seats = gameMap.getSeats();
+    for (int jj = 0; jj < gameMap.getMapSizeY(); ++jj)
+    {
+        for (int ii = 0; ii < gameMap.getMapSizeX(); ++ii)
+            gameMap.getTile(ii, jj)->setSeats(seats);
+    }
+
+    for(Seat* seat : seats)
+    {
+        for(Seat* alliedSeat : seats)
+        {
+            if((alliedSeat != seat) && seat->isAlliedSeat(alliedSeat))
+                seat->addAlliedSeat(alliedSeat);
+        }
+    }
+
+    gameMap.setTurnNumber(0);
+    gameMap.setGamePaused(false);
+    gameMap.createAllEntities();
+
+    for(Seat* seat : seats)
+    {
+        if((seat->getPlayer() != nullptr) && (seat->getGold() > 0))
+            gameMap.addGoldToSeat(seat->getGold(), seat->getId());
+    }
+}
+
+BenchmarkResult runLevel(const std::string& levelPath, int64_t nbTurns, uint64_t seed)
+{
+    BenchmarkResult result;
+    result.mLevel = levelPath;
+
+    Random::initialize(seed);
+    std::chrono::steady_clock::time_point setupStart = std::chrono::steady_clock::now();
+    GameMap gameMap(true);
+    if(!gameMap.loadLevel(levelPath))
+    {
+        OD_LOG_ERR("Cannot load level=" + levelPath);
+        return result;
+    }
+    result.mIsLoaded = true;
+
+    configureSeats(gameMap);
+    startGame(gameMap);
+    result.mSetupMs = elapsedMs(setupStart);
+
+    unsigned int nbPathCallsStart = gameMap.getNumCallsToPath();
+    unsigned int nbPathCacheHitsStart = gameMap.getNumPathCacheHits();
+    uint64_t nbNotificationsStart = ServerNotification::getNbCreated();
+    double timeSinceLastTurn = 1.0 / ODApplication::turnsPerSecond;
+    for(int64_t turn = 1; turn <= nbTurns; ++turn)
+    {
+        std::chrono::steady_clock::time_point turnStart = std::chrono::steady_clock::now();
+        gameMap.setTurnNumber(turn);
+
+        std::chrono::steady_clock::time_point phaseStart = std::chrono::steady_clock::now();
+        auto endPhase = [&](BenchmarkPhase phase)
+        {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            result.mPhasesMs[static_cast<uint32_t>(phase)] += std::chrono::duration<double, std::milli>(now - phaseStart).count();
+            phaseStart = now;
+        };
+
+        gameMap.updateAnimations(static_cast<Ogre::Real>(timeSinceLastTurn));
+        endPhase(BenchmarkPhase::updateAnimations);
+        gameMap.doTurn(timeSinceLastTurn);
+        endPhase(BenchmarkPhase::gameMapTurn);
+        double senseMs = gameMap.getSenseUpkeepTime() / 1000.0;
+        double visionMs = gameMap.getVisionUpkeepTime() / 1000.0;
+        double activeObjectsUpkeepMs = gameMap.getActiveObjectsUpkeepTime() / 1000.0;
+        result.mPhasesMs[static_cast<uint32_t>(BenchmarkPhase::gameMapTurn)] -= senseMs + visionMs + activeObjectsUpkeepMs;
+        result.mPhasesMs[static_cast<uint32_t>(BenchmarkPhase::creaturesSense)] += senseMs;
+        result.mPhasesMs[static_cast<uint32_t>(BenchmarkPhase::vision)] += visionMs;
+        result.mPhasesMs[static_cast<uint32_t>(BenchmarkPhase::activeObjectsUpkeep)] += activeObjectsUpkeepMs;
+        gameMap.doPlayerAITurn(timeSinceLastTurn);
+        endPhase(BenchmarkPhase::playerAI);
+        gameMap.updateVisibleEntities();
+        endPhase(BenchmarkPhase::updateVisibleEntities);
+        gameMap.processActiveObjectsChanges();
+        endPhase(BenchmarkPhase::activeObjectsChanges);
+        gameMap.processDeletionQueues();
+        endPhase(BenchmarkPhase::deletionQueues);
+
+        double turnMs = elapsedMs(turnStart);
+        result.mTotalMs += turnMs;
+        result.mMaxTurnMs = std::max(result.mMaxTurnMs, turnMs);
+        ++result.mNbTurns;
+    }
+
+    result.mNbPathCalls = gameMap.getNumCallsToPath() - nbPathCallsStart;
+    result.mNbPathCacheHits = gameMap.getNumPathCacheHits() - nbPathCacheHitsStart;
+    result.mNbNotifications = ServerNotification::getNbCreated() - nbNotificationsStart;
+    result.mNbCreatures = static_cast<uint32_t>(gameMap.getCreatures().size());
+    return result;
+}
+
+std::string escapeJson(const std::string& str)
+{
+    std::string escaped;
+    for(char c : str)
+    {
+        if((c == '"') || (c == '\\'))
+            escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+void writeJson(std::ostream& os, int64_t nbTurns, uint64_t seed, const std::vector<BenchmarkResult>& results)
+{
+    os << "{\n  \"turns\": " << nbTurns << ",\n  \"seed\": " << seed << ",\n  \"levels\": [";
+    for(std::size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchmarkResult& result = results[i];
+        os << (i == 0 ? "\n" : ",\n");
+        os << "    {\n      \"level\": \"" << escapeJson(result.mLevel) << "\",\n"
+           << "      \"loaded\": " << (result.mIsLoaded ? "true" : "false") << ",\n"
+           << "      \"turns\": " << result.mNbTurns << ",\n"
+           << "      \"setupMs\": " << result.mSetupMs << ",\n"
+           << "      \"totalMs\": " << result.mTotalMs << ",\n"
+           << "      \"meanTurnMs\": " << (result.mNbTurns > 0 ? result.mTotalMs / result.mNbTurns : 0.0) << ",\n"
+           << "      \"maxTurnMs\": " << result.mMaxTurnMs << ",\n"
+           << "      \"phasesMs\": {";
+        for(uint32_t phase = 0; phase < static_cast<uint32_t>(BenchmarkPhase::nbPhases); ++phase)
+        {
+            os << (phase == 0 ? " " : ", ") << "\"" << BENCHMARK_PHASE_NAMES[phase] << "\": " << result.mPhasesMs[phase];
+        }
+        os << " },\n"
+           << "      \"pathCalls\": " << result.mNbPathCalls << ",\n"
+           << "      \"pathCacheHits\": " << result.mNbPathCacheHits << ",\n"
+           << "      \"notifications\": " << result.mNbNotifications << ",\n"
+           << "      \"creatures\": " << result.mNbCreatures << "\n"
+           << "    }";
+    }
+    os << "\n  ]\n}\n";
+}
+
+void findLevels(const std::string& path, std::vector<std::string>& levels)
+{
+    if(!boost::filesystem::is_directory(path))
+    {
+        levels.push_back(path);
+        return;
+    }
+
+    std::vector<std::string> found;
+    for(boost::filesystem::recursive_directory_iterator it(path), end; it != end; ++it)
+    {
+        if(boost::filesystem::is_regular_file(it->path()) && (it->path().extension() == ".level"))
+            found.push_back(it->path().string());
+    }
+    // We sort the levels to always get the same order
+    std::sort(found.begin(), found.end());
+    levels.insert(levels.end(), found.begin(), found.end());
+}
+}
+
+int main(int argc, char** argv)
+{
+    boost::program_options::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "produce help message")
+        ("turns", boost::program_options::value<int64_t>()->default_value(500), "Number of turns to run on each level")
+        ("output", boost::program_options::value<std::string>(), "JSON file to write (standard output if not set)")
+        ("levels", boost::program_options::value<std::vector<std::string>>(), "Level files or directories")
+    ;
+    ResourceManager::buildCommandOptions(desc);
+    boost::program_options::positional_options_description positional;
+    positional.add("levels", -1);
+
+    boost::program_options::variables_map options;
+    boost::program_options::store(boost::program_options::command_line_parser(argc, argv)
+        .options(desc).positional(positional).run(), options);
+    boost::program_options::notify(options);
+
+    if (options.count("help") || !options.count("levels"))
+    {
+        std::cout << desc << "\n";
+        return options.count("help") ? 0 : 1;
+    }
+
+    ResourceManager resMgr(options);
+    LogManager logMgr;
+    // Only problems are logged to not disturb the timings
+    logMgr.setLevel(LogMessageLevel::WARNING);
+    logMgr.addSink(std::unique_ptr<LogSink>(new LogSinkConsole()));
+
+    ConfigManager configManager(resMgr.getConfigPath(), "", resMgr.getSoundPath());
+    // The server is not started. It is only needed because the gamemap queues its notifications to it
+    ODServer server;
+
+    int64_t nbTurns = options["turns"].as<int64_t>();
+    // The seed option is declared by the ResourceManager. We use a fixed seed if it is not given
+    // so that the runs are comparable
+    uint64_t seed = resMgr.hasRandomSeed() ? resMgr.getRandomSeed() : 1;
+    std::vector<std::string> levels;
+    for(const std::string& path : options["levels"].as<std::vector<std::string>>())
+        findLevels(path, levels);
+
+    std::vector<BenchmarkResult> results;
+    for(const std::string& level : levels)
+    {
+        std::cerr << "Running " << level << "\n";
+        results.push_back(runLevel(level, nbTurns, seed));
+    }
+
+    if(options.count("output"))
+    {
+        std::ofstream file(options["output"].as<std::string>().c_str());
+        writeJson(file, nbTurns, seed, results);
+    }
+    else
+    {
+        writeJson(std::cout, nbTurns, seed, results);
+    }
+
+    bool isAllLoaded = std::all_of(results.begin(), results.end(),
+        [](const BenchmarkResult& result) { return result.mIsLoaded; });
+    return isAllLoaded ? 0 : 1;
+}
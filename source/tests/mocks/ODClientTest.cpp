@@ -17,6 +17,7 @@
 
 #include "ODClientTest.h"
 
+#include "entities/GameEntityType.h"
 #include "game/SeatData.h"
 #include "network/ClientNotification.h"
 #include "network/ServerMode.h"
@@ -394,15 +395,38 @@ bool ODClientTest::processMessage(ServerNotificationType cmd, ODPacket& packetRe
             BOOST_CHECK(packetReceived >> mPlayers[mLocalPlayerIndex].mGoals);
             break;
         }
-        case ServerNotificationType::setObjectAnimationState:
+        case ServerNotificationType::addEntity:
         {
+            // Entities are referenced by id in the other messages. We keep the creature
+            // names to be able to notify the tests with them
+            GameEntityType entityType;
+            uint32_t entityId;
+            BOOST_CHECK(packetReceived >> entityType >> entityId);
+            if(entityType != GameEntityType::creature)
+                break;
+
+            int seatId;
             std::string entityName;
+            BOOST_CHECK(packetReceived >> seatId >> entityName);
+            mEntityNames[entityId] = entityName;
+            break;
+        }
+        case ServerNotificationType::removeEntity:
+        {
+            uint32_t entityId;
+            BOOST_CHECK(packetReceived >> entityId);
+            mEntityNames.erase(entityId);
+            break;
+        }
+        case ServerNotificationType::setObjectAnimationState:
+        {
+            uint32_t entityId;
             std::string animState;
             bool loop;
             bool playIdleWhenAnimationEnds;
             bool shouldSetWalkDirection;
             Ogre::Vector3 walkDirection(0, 0, 0);
-            BOOST_CHECK(packetReceived >> entityName >> animState
+            BOOST_CHECK(packetReceived >> entityId >> animState
                 >> loop >> playIdleWhenAnimationEnds >> shouldSetWalkDirection);
 
             if(shouldSetWalkDirection)
@@ -410,18 +434,18 @@ bool ODClientTest::processMessage(ServerNotificationType cmd, ODPacket& packetRe
                 BOOST_CHECK(packetReceived >> walkDirection);
             }
 
-            animationPlayed(entityName, animState, loop, playIdleWhenAnimationEnds, shouldSetWalkDirection, walkDirection);
+            animationPlayed(getEntityName(entityId), animState, loop, playIdleWhenAnimationEnds, shouldSetWalkDirection, walkDirection);
             break;
         }
         case ServerNotificationType::animatedObjectSetWalkPath:
         {
-            std::string entityName;
+            uint32_t entityId;
             std::string walkAnim;
             std::string endAnim;
             bool loopEndAnim;
             bool playIdleWhenAnimationEnds;
             uint32_t nbDest;
-            BOOST_CHECK(packetReceived >> entityName >> walkAnim >> endAnim);
+            BOOST_CHECK(packetReceived >> entityId >> walkAnim >> endAnim);
             BOOST_CHECK(packetReceived >> loopEndAnim >> playIdleWhenAnimationEnds >> nbDest);
             std::vector<Ogre::Vector3> path;
             while(nbDest)
@@ -433,6 +457,7 @@ bool ODClientTest::processMessage(ServerNotificationType cmd, ODPacket& packetRe
             }
 
             //! We want to make sure animationPlayed is played for both animations (if required)
+            std::string entityName = getEntityName(entityId);
             if(!walkAnim.empty())
                 animationPlayed(entityName, walkAnim, true, false, false, Ogre::Vector3::ZERO);
             if(!endAnim.empty())
@@ -447,6 +472,15 @@ bool ODClientTest::processMessage(ServerNotificationType cmd, ODPacket& packetRe
     return false;
 }
 
+std::string ODClientTest::getEntityName(uint32_t entityId) const
+{
+    auto it = mEntityNames.find(entityId);
+    if(it == mEntityNames.end())
+        return std::string();
+
+    return it->second;
+}
+
 SeatData* ODClientTest::getLocalSeat() const
 {
     if(mLocalPlayerIndex >= mPlayers.size())
@@ -21,6 +21,8 @@
 
 #include "network/ODSocketClient.h"
 
+#include <cstdint>
+#include <map>
 #include <string>
 
 class SeatData;
@@ -66,6 +68,10 @@ public:
 
     SeatData* getLocalSeat() const;
 
+    //! \brief Returns the name of the creature with the given network id (or an empty
+    //! string if no creature with this id was received)
+    std::string getEntityName(uint32_t entityId) const;
+
     // Allows to check that the server correctly launched and sent new turns
     int64_t mTurnNum;
 
@@ -90,6 +96,8 @@ private:
     std::vector<PlayerInfo> mPlayers;
     std::vector<SeatData*> mSeats;
     uint32_t mLocalPlayerIndex;
+    //! \brief Names of the creatures received, indexed by network id
+    std::map<uint32_t, std::string> mEntityNames;
 };
 
 #endif // ODCLIENTTEST_H
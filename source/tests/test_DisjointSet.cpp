@@ -0,0 +1,102 @@
+/*
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "utils/DisjointSet.h"
+#include "utils/ThreadPool.h"
+
+#include <atomic>
+#include <vector>
+
+#define BOOST_TEST_MODULE DisjointSet
+#include "BoostTestTargetConfig.h"
+
+BOOST_AUTO_TEST_CASE(test_DisjointSet)
+{
+    DisjointSet set;
+    // Elements never merged are their own set
+    BOOST_CHECK(set.find(5) == 5);
+
+    set.mergeInto(1, 2);
+    BOOST_CHECK(set.find(1) == 2);
+    BOOST_CHECK(set.find(2) == 2);
+
+    // Merging elements of the same set changes nothing
+    set.mergeInto(3, 4);
+    set.mergeInto(4, 3);
+    BOOST_CHECK(set.find(3) == 4);
+
+    // The target representative is kept whatever the ranks are
+    set.mergeInto(5, 1);
+    BOOST_CHECK(set.find(5) == 2);
+    set.mergeInto(2, 6);
+    BOOST_CHECK(set.find(1) == 6);
+    BOOST_CHECK(set.find(5) == 6);
+    BOOST_CHECK(set.find(3) == 4);
+    set.mergeInto(6, 4);
+    BOOST_CHECK(set.find(1) == 4);
+
+    set.clear();
+    BOOST_CHECK(set.find(1) == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_DisjointSetParallelFind)
+{
+    // Like the floodfill colors: merges done on the main thread, then many reads from the workers
+    // sensing in parallel (see GameMap::senseCreaturesUpkeep). Blocks of 256 elements are merged
+    // by pairs of same size so that the trees are as deep as the ranks allow
+    const uint32_t nbElements = 4096;
+    const uint32_t blockSize = 256;
+    const uint32_t nbBlocks = nbElements / blockSize;
+    DisjointSet mergedSet;
+    for(uint32_t step = 1; step < blockSize; step *= 2)
+    {
+        for(uint32_t i = 0; i < nbElements; i += 2 * step)
+            mergedSet.mergeInto(i, i + step);
+    }
+
+    // Expected values computed on a copy so that the merged set is not compressed
+    DisjointSet compressedSet = mergedSet;
+    std::vector<uint32_t> expected(nbElements);
+    for(uint32_t i = 0; i < nbElements; ++i)
+    {
+        expected[i] = compressedSet.find(i);
+        BOOST_CHECK(mergedSet.findReadOnly(i) == expected[i]);
+        BOOST_CHECK((expected[i] / blockSize) == (i / blockSize));
+    }
+
+    ThreadPool pool(3);
+    std::atomic<uint32_t> nbErrors(0);
+    for(uint32_t run = 0; run < 20; ++run)
+    {
+        // Each run reads a set that was never searched
+        DisjointSet set = mergedSet;
+        // Consecutive indexes are spread over the blocks so that every thread reads every set
+        pool.parallelFor(nbElements, [&set, &expected, &nbErrors, blockSize, nbBlocks](uint32_t index)
+        {
+            // Makes sure the workers take part even if the calling thread is fast
+            if(index % blockSize == 0)
+                sf::sleep(sf::milliseconds(1));
+
+            uint32_t element = (index % nbBlocks) * blockSize + index / nbBlocks;
+            if(set.findReadOnly(element) != expected[element])
+                ++nbErrors;
+        });
+    }
+    BOOST_CHECK(nbErrors.load() == 0);
+
+    // Elements never merged are their own set
+    BOOST_CHECK(mergedSet.findReadOnly(nbElements + 10) == nbElements + 10);
+}
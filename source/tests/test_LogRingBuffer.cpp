@@ -0,0 +1,141 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils/LogRingBuffer.h"
+
+#include <SFML/System.hpp>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE LogRingBuffer
+#include "BoostTestTargetConfig.h"
+
+namespace
+{
+LogRecord makeRecord(int producer, uint32_t index)
+{
+    LogRecord record;
+    record.mLevel = LogMessageLevel::NORMAL;
+    record.mFilename = "test_LogRingBuffer.cpp";
+    record.mLine = producer;
+    record.mTime = static_cast<std::time_t>(index);
+    record.mMessage = "message " + std::to_string(index);
+    return record;
+}
+}
+
+BOOST_AUTO_TEST_CASE(test_LogRingBufferFull)
+{
+    // The capacity is rounded up to 8
+    LogRingBuffer buffer(5);
+    LogRecord record;
+    BOOST_CHECK(!buffer.pop(record));
+
+    for(uint32_t i = 0; i < 8; ++i)
+    {
+        record = makeRecord(0, i);
+        BOOST_CHECK(buffer.push(record));
+    }
+
+    // When the queue is full, the record is not moved
+    record = makeRecord(0, 8);
+    BOOST_CHECK(!buffer.push(record));
+    BOOST_CHECK(record.mMessage == "message 8");
+
+    // Once a record is read, there is room again
+    LogRecord popped;
+    BOOST_CHECK(buffer.pop(popped));
+    BOOST_CHECK(popped.mTime == 0);
+    BOOST_CHECK(buffer.push(record));
+    record = makeRecord(0, 9);
+    BOOST_CHECK(!buffer.push(record));
+
+    for(uint32_t i = 1; i <= 8; ++i)
+    {
+        BOOST_CHECK(buffer.pop(popped));
+        BOOST_CHECK(popped.mTime == static_cast<std::time_t>(i));
+        BOOST_CHECK(popped.mMessage == "message " + std::to_string(i));
+    }
+    BOOST_CHECK(!buffer.pop(popped));
+}
+
+BOOST_AUTO_TEST_CASE(test_LogRingBufferProducers)
+{
+    const int nbProducers = 4;
+    const uint32_t nbRecordsPerProducer = 20000;
+
+    // The buffer is small so that the producers often find it full and have to retry
+    LogRingBuffer buffer(64);
+    std::vector<std::unique_ptr<sf::Thread>> producers;
+    for(int producer = 0; producer < nbProducers; ++producer)
+    {
+        producers.emplace_back(new sf::Thread([&buffer, producer, nbRecordsPerProducer]()
+        {
+            for(uint32_t i = 0; i < nbRecordsPerProducer; ++i)
+            {
+                LogRecord record = makeRecord(producer, i);
+                while(!buffer.push(record))
+                    std::this_thread::yield();
+            }
+        }));
+    }
+    for(std::unique_ptr<sf::Thread>& thread : producers)
+        thread->launch();
+
+    // Every record is received once and the records from a given producer are received in order
+    std::vector<uint32_t> nextIndex(nbProducers, 0);
+    uint32_t nbReceived = 0;
+    bool isValid = true;
+    while(nbReceived < nbProducers * nbRecordsPerProducer)
+    {
+        LogRecord record;
+        if(!buffer.pop(record))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // We keep reading after an error so that the producers can finish
+        ++nbReceived;
+        if((record.mLine < 0) || (record.mLine >= nbProducers))
+        {
+            isValid = false;
+            continue;
+        }
+
+        uint32_t& expected = nextIndex[record.mLine];
+        if((record.mTime != static_cast<std::time_t>(expected)) ||
+           (record.mMessage != "message " + std::to_string(expected)))
+        {
+            isValid = false;
+        }
+        ++expected;
+    }
+
+    for(std::unique_ptr<sf::Thread>& thread : producers)
+        thread->wait();
+
+    BOOST_CHECK(isValid);
+    for(int producer = 0; producer < nbProducers; ++producer)
+        BOOST_CHECK(nextIndex[producer] == nbRecordsPerProducer);
+
+    LogRecord record;
+    BOOST_CHECK(!buffer.pop(record));
+}
@@ -0,0 +1,90 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "network/NotificationPool.h"
+
+#include <cstring>
+
+#define BOOST_TEST_MODULE NotificationPool
+#include "BoostTestTargetConfig.h"
+
+namespace
+{
+struct TestNotification
+{
+    char mData[40];
+};
+}
+
+BOOST_AUTO_TEST_CASE(test_NotificationPool)
+{
+    const std::size_t blockSize = 32;
+    NotificationPool pool(blockSize, 2);
+
+    // Nothing to reuse yet: the blocks come from the heap
+    void* block1 = pool.allocate(blockSize);
+    void* block2 = pool.allocate(blockSize);
+    void* block3 = pool.allocate(blockSize);
+    BOOST_REQUIRE((block1 != nullptr) && (block2 != nullptr) && (block3 != nullptr));
+    std::memset(block1, 0xAB, blockSize);
+    BOOST_CHECK(pool.getNbAllocations() == 3);
+    BOOST_CHECK(pool.getNbRecycled() == 0);
+    BOOST_CHECK(pool.getNbUsed() == 3);
+
+    // Only 2 released blocks are kept. The third one is freed
+    pool.release(block1, blockSize);
+    pool.release(block2, blockSize);
+    pool.release(block3, blockSize);
+    BOOST_CHECK(pool.getNbUsed() == 0);
+    BOOST_CHECK(pool.getStatsString() == "allocations=3 recycled=0 used=0 free=2");
+
+    // The last released blocks are reused first
+    BOOST_CHECK(pool.allocate(blockSize) == block2);
+    BOOST_CHECK(pool.allocate(blockSize) == block1);
+    void* block4 = pool.allocate(blockSize);
+    BOOST_CHECK(pool.getNbAllocations() == 4);
+    BOOST_CHECK(pool.getNbRecycled() == 2);
+    BOOST_CHECK(pool.getNbRequests() == 6);
+    BOOST_CHECK(pool.getNbUsed() == 3);
+
+    // Blocks bigger than the pool ones (like derived classes) do not go through the free list
+    void* bigBlock = pool.allocate(blockSize * 2);
+    std::memset(bigBlock, 0xCD, blockSize * 2);
+    pool.release(bigBlock, blockSize * 2);
+    BOOST_CHECK(pool.getNbRequests() == 6);
+    BOOST_CHECK(pool.getNbUsed() == 3);
+
+    pool.release(block1, blockSize);
+    pool.release(block2, blockSize);
+    pool.release(block4, blockSize);
+    pool.release(nullptr, blockSize);
+    BOOST_CHECK(pool.getNbUsed() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_NotificationPoolShared)
+{
+    // The pool of a given type is shared and sized to the type
+    NotificationPool& pool = NotificationPool::getPool<TestNotification>();
+    BOOST_CHECK(&pool == &NotificationPool::getPool<TestNotification>());
+
+    void* block = pool.allocate(sizeof(TestNotification));
+    std::memset(block, 0, sizeof(TestNotification));
+    pool.release(block, sizeof(TestNotification));
+    BOOST_CHECK(pool.allocate(sizeof(TestNotification)) == block);
+    pool.release(block, sizeof(TestNotification));
+    BOOST_CHECK(pool.getNbRecycled() == 1);
+}
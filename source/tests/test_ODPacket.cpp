@@ -35,6 +35,40 @@ BOOST_AUTO_TEST_CASE(test_ODPacket)
         std::string outString;
         packet >> outString;
         BOOST_CHECK(inString.compare(outString) == 0);
+        const int64_t inInt64 = -1234567890123LL;
+        const double inDouble = 3.25;
+        packet << inInt64 << inDouble;
+        int64_t outInt64 = 0;
+        double outDouble = 0.0;
+        BOOST_CHECK(packet >> outInt64 >> outDouble);
+        BOOST_CHECK(outInt64 == inInt64);
+        BOOST_CHECK(outDouble == inDouble);
+        BOOST_CHECK(!(packet >> outInt));
+    }
+    //Test bool and failed read
+    {
+        ODPacket packet;
+        packet << true << false;
+        bool outBool1 = false;
+        bool outBool2 = true;
+        BOOST_CHECK(packet >> outBool1 >> outBool2);
+        BOOST_CHECK(outBool1 && !outBool2);
+        // The value is not changed when nothing can be read
+        bool outBool3 = true;
+        BOOST_CHECK(!(packet >> outBool3));
+        BOOST_CHECK(outBool3);
+    }
+    //Test string reading without copy and move
+    {
+        ODPacket packet;
+        const std::string inString("view");
+        packet << inString;
+        ODPacket movedPacket(std::move(packet));
+        const char* data = nullptr;
+        uint32_t size = 0;
+        BOOST_CHECK(movedPacket.readString(data, size));
+        BOOST_CHECK(inString.compare(0, std::string::npos, data, size) == 0);
+        BOOST_CHECK(!movedPacket.readString(data, size));
     }
     //Test template input function
     {
@@ -53,4 +87,66 @@ BOOST_AUTO_TEST_CASE(test_ODPacket)
         BOOST_CHECK(inInt == outInt);
 
     }
+    //Test packets batch
+    {
+        ODPacket packet1;
+        ODPacket packet2;
+        const int32_t inInt = 42;
+        const std::string inString("batched");
+        packet1 << inInt;
+        packet2 << inString << inInt;
+
+        ODPacket batch;
+        batch.appendPacket(packet1);
+        batch.appendPacket(packet2);
+
+        ODPacket outPacket;
+        int32_t outInt = 0;
+        std::string outString;
+        BOOST_CHECK(batch.extractPacket(outPacket));
+        BOOST_CHECK(outPacket >> outInt);
+        BOOST_CHECK(outInt == inInt);
+        BOOST_CHECK(batch.extractPacket(outPacket));
+        outInt = 0;
+        BOOST_CHECK(outPacket >> outString >> outInt);
+        BOOST_CHECK(inString.compare(outString) == 0);
+        BOOST_CHECK(outInt == inInt);
+        BOOST_CHECK(!batch.extractPacket(outPacket));
+    }
+    //Test compression (small packets are not compressed but should be read back the same way)
+    {
+        ODPacket packet;
+        const std::string inString(2 * ODPacket::COMPRESSION_THRESHOLD, 'a');
+        const int32_t inInt = 7;
+        packet << inString << inInt;
+
+        ODPacket smallPacket;
+        smallPacket << inInt;
+
+        for(ODPacket* inPacket : {&packet, &smallPacket})
+        {
+            ODPacket compressedPacket;
+            inPacket->compressTo(compressedPacket, ODPacket::getBestCompression());
+            ODPacket outPacket;
+            BOOST_CHECK(compressedPacket.uncompressTo(outPacket));
+            if(inPacket == &packet)
+            {
+                std::string outString;
+                BOOST_CHECK(outPacket >> outString);
+                BOOST_CHECK(inString.compare(outString) == 0);
+            }
+            int32_t outInt = 0;
+            BOOST_CHECK(outPacket >> outInt);
+            BOOST_CHECK(outInt == inInt);
+        }
+
+        ODPacket invalidPacket;
+        ODPacket outPacket;
+        BOOST_CHECK(!invalidPacket.uncompressTo(outPacket));
+
+        // The uncompressed size is sent by the peer. A size that cannot match the data is rejected
+        ODPacket hugePacket;
+        hugePacket << ODPacketCompression::lz4 << static_cast<uint32_t>(0xFFFFFFFF) << inString;
+        BOOST_CHECK(!hugePacket.uncompressTo(outPacket));
+    }
 }
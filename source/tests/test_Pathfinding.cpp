@@ -18,7 +18,13 @@
 #define BOOST_TEST_MODULE Random
 #include "BoostTestTargetConfig.h"
 
+#include "gamemap/HierarchicalPathfinding.h"
+#include "gamemap/PathCache.h"
 #include "gamemap/Pathfinding.h"
+#include "gamemap/PathfindingEngine.h"
+
+#include <cstdlib>
+#include <vector>
 
 struct Point
 {
@@ -39,3 +45,325 @@ BOOST_AUTO_TEST_CASE(test_Pathfinding)
     BOOST_CHECK((Pathfinding::distanceTile(a, b) - std::sqrt(128.0f)) < 0.0001f);
     BOOST_CHECK(Pathfinding::squaredDistance(9,1,1,9) == 128);
 }
+
+BOOST_AUTO_TEST_CASE(test_PathfindingEngine)
+{
+    // 5x5 grid with a wall on x=2 except at y=4
+    const int sizeX = 5;
+    const int sizeY = 5;
+    auto isWall = [](int x, int y) { return (x == 2) && (y < 4); };
+
+    PathfindingEngine engine;
+    engine.setMapSize(sizeX, sizeY);
+
+    // We run the search twice to check that data from the previous search is not reused
+    for(int run = 0; run < 2; ++run)
+    {
+        engine.startSearch(0, 0, 4, 0);
+        bool found = false;
+        int x;
+        int y;
+        while(engine.popLowestCost(x, y))
+        {
+            if((x == 4) && (y == 0))
+            {
+                found = true;
+                break;
+            }
+
+            const int dx[4] = {-1, 1, 0, 0};
+            const int dy[4] = {0, 0, -1, 1};
+            for(int i = 0; i < 4; ++i)
+            {
+                int nx = x + dx[i];
+                int ny = y + dy[i];
+                if((nx < 0) || (ny < 0) || (nx >= sizeX) || (ny >= sizeY))
+                    continue;
+                if(isWall(nx, ny) || engine.isClosed(nx, ny))
+                    continue;
+
+                engine.pushOrDecrease(nx, ny, engine.getG(x, y) + 1.0, x, y);
+            }
+        }
+
+        BOOST_CHECK(found);
+        // Going around the wall takes 12 steps
+        BOOST_CHECK(engine.getG(4, 0) == 12.0);
+
+        int nbTiles = 1;
+        int px = 4;
+        int py = 0;
+        while(engine.getParent(px, py, px, py))
+        {
+            BOOST_CHECK(!isWall(px, py));
+            ++nbTiles;
+        }
+        BOOST_CHECK(nbTiles == 13);
+        BOOST_CHECK((px == 0) && (py == 0));
+    }
+
+    // Unreachable destination
+    engine.startSearch(0, 0, 4, 4);
+    int x;
+    int y;
+    int nbPopped = 0;
+    while(engine.popLowestCost(x, y))
+        ++nbPopped;
+    BOOST_CHECK(nbPopped == 1);
+    BOOST_CHECK(engine.isClosed(0, 0));
+    BOOST_CHECK(!engine.isClosed(1, 0));
+}
+
+//! \brief Map used to compare the hierarchical paths with the paths computed at tile level
+struct TestMap
+{
+    TestMap(int sizeX, int sizeY) :
+        mSizeX(sizeX),
+        mSizeY(sizeY),
+        mWalls(static_cast<uint32_t>(sizeX * sizeY), false)
+    {
+        mEngine.setMapSize(sizeX, sizeY);
+    }
+
+    bool isPassable(int x, int y) const
+    {
+        if((x < 0) || (y < 0) || (x >= mSizeX) || (y >= mSizeY))
+            return false;
+
+        return !mWalls[static_cast<uint32_t>(y * mSizeX + x)];
+    }
+
+    void setWall(int x, int y, bool isWall)
+    {
+        mWalls[static_cast<uint32_t>(y * mSizeX + x)] = isWall;
+    }
+
+    //! \brief Plain A* on the 4 adjacent tiles. Returns -1 if the destination cannot be reached
+    int computeDistance(int startX, int startY, int destX, int destY)
+    {
+        const int dx[4] = {-1, 1, 0, 0};
+        const int dy[4] = {0, 0, -1, 1};
+        mEngine.startSearch(startX, startY, destX, destY);
+        int x;
+        int y;
+        while(mEngine.popLowestCost(x, y))
+        {
+            if((x == destX) && (y == destY))
+                return static_cast<int>(mEngine.getG(x, y));
+
+            for(int i = 0; i < 4; ++i)
+            {
+                int nx = x + dx[i];
+                int ny = y + dy[i];
+                if(!isPassable(nx, ny) || mEngine.isClosed(nx, ny))
+                    continue;
+
+                mEngine.pushOrDecrease(nx, ny, mEngine.getG(x, y) + 1.0, x, y);
+            }
+        }
+        return -1;
+    }
+
+    //! \brief Computes the abstract path and refines it like GameMap::path does. Returns the length
+    //! of the refined path or -1 if no abstract path is found
+    int computeHierarchicalDistance(HierarchicalPathfinding& hierarchical, int startX, int startY, int destX, int destY)
+    {
+        std::vector<uint32_t> waypoints;
+        if(!hierarchical.findAbstractPath(startX, startY, destX, destY, 0, waypoints))
+            return -1;
+
+        waypoints.push_back(static_cast<uint32_t>(destY * mSizeX + destX));
+        int distance = 0;
+        int legX = startX;
+        int legY = startY;
+        for(uint32_t waypoint : waypoints)
+        {
+            int x = static_cast<int>(waypoint % static_cast<uint32_t>(mSizeX));
+            int y = static_cast<int>(waypoint / static_cast<uint32_t>(mSizeX));
+            BOOST_CHECK(isPassable(x, y));
+            int legDistance = computeDistance(legX, legY, x, y);
+            // Each leg should be refinable
+            BOOST_CHECK(legDistance >= 0);
+            if(legDistance < 0)
+                return -1;
+
+            distance += legDistance;
+            legX = x;
+            legY = y;
+        }
+        return distance;
+    }
+
+    int mSizeX;
+    int mSizeY;
+    std::vector<bool> mWalls;
+    PathfindingEngine mEngine;
+};
+
+BOOST_AUTO_TEST_CASE(test_HierarchicalPathfinding)
+{
+    // 3x2 clusters separated by walls. The walls can only be crossed through one tile wide doors so that
+    // the hierarchical paths should be as short as the ones computed at tile level
+    const int clusterSize = HierarchicalPathfinding::CLUSTER_SIZE;
+    TestMap map(3 * clusterSize, 2 * clusterSize);
+    for(int y = 0; y < map.mSizeY; ++y)
+    {
+        map.setWall(clusterSize, y, true);
+        map.setWall(2 * clusterSize, y, true);
+    }
+    for(int x = 0; x < map.mSizeX; ++x)
+        map.setWall(x, clusterSize, true);
+
+    const int doors[5][2] = {
+        {clusterSize, 5},
+        {clusterSize, clusterSize + 4},
+        {2 * clusterSize, clusterSize + 9},
+        {clusterSize / 2, clusterSize},
+        {2 * clusterSize + clusterSize / 2, clusterSize}
+    };
+    for(const int* door : doors)
+        map.setWall(door[0], door[1], false);
+
+    HierarchicalPathfinding hierarchical(1, [&map](int x, int y, uint32_t) { return map.isPassable(x, y); });
+    hierarchical.reset(map.mSizeX, map.mSizeY);
+
+    // The middle top cluster is a dead end. The path has to go through the bottom clusters
+    int optimal = map.computeDistance(2, 2, map.mSizeX - 3, 2);
+    BOOST_CHECK(optimal > 0);
+    BOOST_CHECK(map.computeHierarchicalDistance(hierarchical, 2, 2, map.mSizeX - 3, 2) == optimal);
+
+    std::vector<uint32_t> waypoints;
+    // Start and destination within the same cluster should be handled at tile level
+    BOOST_CHECK(!hierarchical.findAbstractPath(2, 2, 10, 10, 0, waypoints));
+    BOOST_CHECK(waypoints.empty());
+
+    // Every pair of tiles from different clusters gets the same distance as at tile level
+    for(int startY = 1; startY < map.mSizeY; startY += 7)
+    {
+        for(int startX = 1; startX < map.mSizeX; startX += 7)
+        {
+            if(!map.isPassable(startX, startY))
+                continue;
+
+            for(int destY = 2; destY < map.mSizeY; destY += 9)
+            {
+                for(int destX = 3; destX < map.mSizeX; destX += 9)
+                {
+                    if(!map.isPassable(destX, destY))
+                        continue;
+                    if((startX / clusterSize == destX / clusterSize) && (startY / clusterSize == destY / clusterSize))
+                        continue;
+
+                    BOOST_CHECK(map.computeHierarchicalDistance(hierarchical, startX, startY, destX, destY) ==
+                        map.computeDistance(startX, startY, destX, destY));
+                }
+            }
+        }
+    }
+
+    // Closing a door is taken into account once the tile is invalidated. The right clusters cannot be reached anymore
+    map.setWall(clusterSize, clusterSize + 4, true);
+    hierarchical.invalidateTile(clusterSize, clusterSize + 4);
+    BOOST_CHECK(map.computeDistance(2, 2, map.mSizeX - 3, 2) == -1);
+    BOOST_CHECK(!hierarchical.findAbstractPath(2, 2, map.mSizeX - 3, 2, 0, waypoints));
+
+    // Opening a door between the middle clusters gives another way
+    map.setWall(clusterSize + clusterSize / 2, clusterSize, false);
+    hierarchical.invalidateTile(clusterSize + clusterSize / 2, clusterSize);
+    optimal = map.computeDistance(2, 2, map.mSizeX - 3, 2);
+    BOOST_CHECK(optimal > 0);
+    BOOST_CHECK(map.computeHierarchicalDistance(hierarchical, 2, 2, map.mSizeX - 3, 2) == optimal);
+
+    // Walled in destination
+    const int destX = 2 * clusterSize + 5;
+    const int destY = 5;
+    map.setWall(destX - 1, destY, true);
+    map.setWall(destX + 1, destY, true);
+    map.setWall(destX, destY - 1, true);
+    map.setWall(destX, destY + 1, true);
+    hierarchical.invalidateTile(destX, destY);
+    BOOST_CHECK(map.computeDistance(2, 2, destX, destY) == -1);
+    BOOST_CHECK(!hierarchical.findAbstractPath(2, 2, destX, destY, 0, waypoints));
+}
+
+BOOST_AUTO_TEST_CASE(test_HierarchicalPathfindingOpenMap)
+{
+    // On a map without doors, the portals are not always on the shortest path. The hierarchical path
+    // should still be found whenever the destination can be reached and long paths should not be much longer
+    const int clusterSize = HierarchicalPathfinding::CLUSTER_SIZE;
+    TestMap map(3 * clusterSize, 3 * clusterSize);
+    for(int y = 0; y < map.mSizeY; ++y)
+    {
+        for(int x = 0; x < map.mSizeX; ++x)
+        {
+            // Some obstacles crossing the clusters borders
+            if(((x * 7 + y * 13) % 23 == 0) || ((x % 11 == 5) && (y % 17 < 12)))
+                map.setWall(x, y, true);
+        }
+    }
+
+    HierarchicalPathfinding hierarchical(1, [&map](int x, int y, uint32_t) { return map.isPassable(x, y); });
+    hierarchical.reset(map.mSizeX, map.mSizeY);
+
+    uint32_t nbPaths = 0;
+    for(int startY = 0; startY < map.mSizeY; startY += 5)
+    {
+        for(int startX = 0; startX < map.mSizeX; startX += 5)
+        {
+            if(!map.isPassable(startX, startY))
+                continue;
+
+            for(int destY = 1; destY < map.mSizeY; destY += 8)
+            {
+                for(int destX = 2; destX < map.mSizeX; destX += 8)
+                {
+                    if(!map.isPassable(destX, destY))
+                        continue;
+                    if((startX / clusterSize == destX / clusterSize) && (startY / clusterSize == destY / clusterSize))
+                        continue;
+
+                    int optimal = map.computeDistance(startX, startY, destX, destY);
+                    int distance = map.computeHierarchicalDistance(hierarchical, startX, startY, destX, destY);
+                    BOOST_CHECK((optimal < 0) == (distance < 0));
+                    if(optimal < 0)
+                        continue;
+
+                    BOOST_CHECK(distance >= optimal);
+                    // Short paths can make a big detour through the portals. GameMap only uses the
+                    // abstraction graph for long paths
+                    if(std::abs(destX - startX) + std::abs(destY - startY) <= 2 * clusterSize)
+                        continue;
+
+                    ++nbPaths;
+                    BOOST_CHECK(distance <= optimal + optimal / 4);
+                }
+            }
+        }
+    }
+    BOOST_CHECK(nbPaths > 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_PathCache)
+{
+    PathCache cache;
+    PathCache::Key key{1, 2, 0, 3, false, 1.0, 0.0, 0.0};
+    BOOST_CHECK(cache.find(key, 0) == nullptr);
+
+    // Tiles are only stored, never dereferenced
+    std::list<Tile*> path;
+    path.push_back(nullptr);
+    path.push_back(nullptr);
+    cache.store(key, path, 0);
+    const std::list<Tile*>* cachedPath = cache.find(key, 0);
+    BOOST_REQUIRE(cachedPath != nullptr);
+    BOOST_CHECK(cachedPath->size() == 2);
+
+    // A creature with other speeds should not use the cached path
+    PathCache::Key otherKey = key;
+    otherKey.mSpeedGround = 0.5;
+    BOOST_CHECK(cache.find(otherKey, 0) == nullptr);
+
+    // When the passability epoch changes, the cached paths are dropped
+    BOOST_CHECK(cache.find(key, 1) == nullptr);
+    BOOST_CHECK(cache.getNbEntries() == 0);
+}
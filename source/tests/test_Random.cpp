@@ -25,3 +25,32 @@ BOOST_AUTO_TEST_CASE(test_Random)
     Random::initialize();
     BOOST_CHECK (Random::Int(1, 2 ) <= 2);
 }
+
+BOOST_AUTO_TEST_CASE(test_RandomStreams)
+{
+    Random::initialize(1234);
+    uint64_t seedCreature = Random::getStreamSeed(RandomStreamType::creature, 1);
+    BOOST_CHECK(seedCreature == Random::getStreamSeed(RandomStreamType::creature, 1));
+    BOOST_CHECK(seedCreature != Random::getStreamSeed(RandomStreamType::creature, 2));
+    BOOST_CHECK(seedCreature != Random::getStreamSeed(RandomStreamType::keeperAI, 1));
+
+    // The same seed gives the same numbers whatever the other streams do
+    RandomStream stream1(seedCreature);
+    RandomStream stream2(seedCreature);
+    RandomStream other(Random::getStreamSeed(RandomStreamType::roomPortal, "Portal_1"));
+    for(int i = 0; i < 100; ++i)
+    {
+        int value;
+        {
+            RandomStream::Scope scope(stream1);
+            value = Random::Int(0, 1000);
+        }
+        BOOST_CHECK(value >= 0 && value <= 1000);
+        other.next();
+        BOOST_CHECK(value == stream2.Int(0, 1000));
+    }
+
+    // A different game seed gives different streams
+    Random::initialize(4321);
+    BOOST_CHECK(seedCreature != Random::getStreamSeed(RandomStreamType::creature, 1));
+}
@@ -0,0 +1,154 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE SeatStats
+#include "BoostTestTargetConfig.h"
+
+#include "game/SeatStats.h"
+#include "rooms/RoomType.h"
+#include "utils/LogManager.h"
+#include "utils/LogSinkConsole.h"
+
+// The stats only use the entities as keys
+class Creature
+{
+};
+class CreatureDefinition
+{
+};
+class Room
+{
+};
+
+BOOST_AUTO_TEST_CASE(test_SeatStatsCreatures)
+{
+    LogManager logMgr;
+    logMgr.addSink(std::unique_ptr<LogSink>(new LogSinkConsole()));
+
+    CreatureDefinition goblin;
+    CreatureDefinition troll;
+    Creature creature1;
+    Creature creature2;
+    Creature creature3;
+    Creature notIndexed;
+
+    SeatStats stats;
+    stats.addCreature(&creature1, &goblin);
+    stats.addCreature(&creature2, &goblin);
+    // Dead creatures are indexed but not counted
+    stats.addCreature(&creature3, nullptr);
+    BOOST_CHECK(stats.getCreatures().size() == 3);
+    BOOST_CHECK(stats.getNbCreatures(&goblin) == 2);
+    BOOST_CHECK(stats.getNbCreatures(&troll) == 0);
+
+    // A creature dying
+    stats.updateCreature(&creature1, nullptr);
+    BOOST_CHECK(stats.getNbCreatures(&goblin) == 1);
+    // A creature getting its definition once indexed
+    stats.updateCreature(&creature3, &troll);
+    BOOST_CHECK(stats.getNbCreatures(&troll) == 1);
+    // Updating with the same class does not count it twice
+    stats.updateCreature(&creature3, &troll);
+    BOOST_CHECK(stats.getNbCreatures(&troll) == 1);
+
+    // Creatures not indexed are ignored
+    stats.updateCreature(&notIndexed, &troll);
+    BOOST_CHECK(stats.getNbCreatures(&troll) == 1);
+    BOOST_CHECK(!stats.removeCreature(&notIndexed));
+    BOOST_CHECK(stats.getCreatures().size() == 3);
+
+    // Removing keeps the order of the other creatures
+    BOOST_CHECK(stats.removeCreature(&creature2));
+    BOOST_CHECK(!stats.removeCreature(&creature2));
+    BOOST_CHECK(stats.getNbCreatures(&goblin) == 0);
+    BOOST_REQUIRE(stats.getCreatures().size() == 2);
+    BOOST_CHECK(stats.getCreatures()[0] == &creature1);
+    BOOST_CHECK(stats.getCreatures()[1] == &creature3);
+
+    // Moving a creature to another seat like Creature::setSeat does
+    SeatStats otherStats;
+    BOOST_CHECK(stats.removeCreature(&creature3));
+    otherStats.addCreature(&creature3, &troll);
+    BOOST_CHECK(stats.getNbCreatures(&troll) == 0);
+    BOOST_CHECK(otherStats.getNbCreatures(&troll) == 1);
+    BOOST_CHECK(otherStats.getCreatures().size() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_SeatStatsRooms)
+{
+    LogManager logMgr;
+    logMgr.addSink(std::unique_ptr<LogSink>(new LogSinkConsole()));
+
+    Room treasury1;
+    Room treasury2;
+    Room dormitory;
+    Room notIndexed;
+
+    SeatStats stats;
+    stats.addRoom(&treasury1, RoomType::treasury, 100, 500);
+    stats.addRoom(&treasury2, RoomType::treasury, 0, 250);
+    stats.addRoom(&dormitory, RoomType::dormitory, 0, 0);
+    BOOST_CHECK(stats.getRooms(RoomType::treasury).size() == 2);
+    BOOST_CHECK(stats.getRooms(RoomType::dormitory).size() == 1);
+    BOOST_CHECK(stats.getRooms(RoomType::library).empty());
+    BOOST_CHECK(stats.getGoldStored() == 100);
+    BOOST_CHECK(stats.getGoldStorage() == 750);
+
+    // Gold deposited and withdrawn
+    stats.updateRoomGold(&treasury1, 300, 500);
+    stats.updateRoomGold(&treasury2, 50, 250);
+    BOOST_CHECK(stats.getGoldStored() == 350);
+    stats.updateRoomGold(&treasury1, 120, 500);
+    BOOST_CHECK(stats.getGoldStored() == 170);
+    // Room growing (or absorbing another one)
+    stats.updateRoomGold(&treasury2, 50, 750);
+    BOOST_CHECK(stats.getGoldStorage() == 1250);
+
+    // Rooms not indexed are ignored
+    stats.updateRoomGold(&notIndexed, 1000, 1000);
+    BOOST_CHECK(!stats.removeRoom(&notIndexed));
+    BOOST_CHECK(stats.getGoldStored() == 170);
+    BOOST_CHECK(stats.getGoldStorage() == 1250);
+    BOOST_CHECK(stats.getRooms(RoomType::treasury).size() == 2);
+
+    // Removing a room removes the gold it had the last time it was updated
+    BOOST_CHECK(stats.removeRoom(&treasury1));
+    BOOST_CHECK(!stats.removeRoom(&treasury1));
+    BOOST_CHECK(stats.getGoldStored() == 50);
+    BOOST_CHECK(stats.getGoldStorage() == 750);
+    BOOST_REQUIRE(stats.getRooms(RoomType::treasury).size() == 1);
+    BOOST_CHECK(stats.getRooms(RoomType::treasury)[0] == &treasury2);
+
+    // Moving a room to another seat like Room::setSeat does
+    SeatStats otherStats;
+    BOOST_CHECK(stats.removeRoom(&treasury2));
+    otherStats.addRoom(&treasury2, RoomType::treasury, 50, 750);
+    BOOST_CHECK(stats.getGoldStored() == 0);
+    BOOST_CHECK(stats.getGoldStorage() == 0);
+    BOOST_CHECK(otherStats.getGoldStored() == 50);
+    BOOST_CHECK(otherStats.getRooms(RoomType::treasury).size() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_SeatStatsClaimedTiles)
+{
+    SeatStats stats;
+    BOOST_CHECK(stats.getNbClaimedTiles() == 0);
+    stats.addClaimedTile();
+    stats.addClaimedTile();
+    stats.removeClaimedTile();
+    BOOST_CHECK(stats.getNbClaimedTiles() == 1);
+}
@@ -0,0 +1,50 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils/ThreadPool.h"
+
+#include <atomic>
+#include <vector>
+
+#define BOOST_TEST_MODULE ThreadPool
+#include "BoostTestTargetConfig.h"
+
+BOOST_AUTO_TEST_CASE(test_ThreadPool)
+{
+    for(uint32_t nbWorkers = 0; nbWorkers < 4; ++nbWorkers)
+    {
+        ThreadPool pool(nbWorkers);
+        for(uint32_t nbTasks = 0; nbTasks < 200; nbTasks += 7)
+        {
+            // Each index is processed once even if some tasks are much longer than the others
+            std::vector<std::atomic<uint32_t>> nbCalls(nbTasks);
+            for(std::atomic<uint32_t>& nbCall : nbCalls)
+                nbCall.store(0);
+
+            pool.parallelFor(nbTasks, [&nbCalls](uint32_t index)
+            {
+                if(index % 13 == 0)
+                    sf::sleep(sf::milliseconds(1));
+
+                ++nbCalls[index];
+            });
+
+            for(uint32_t i = 0; i < nbTasks; ++i)
+                BOOST_CHECK(nbCalls[i].load() == 1);
+        }
+    }
+}
@@ -246,6 +246,10 @@ void Trap::activate(Tile* tile)
 
     TrapTileData* trapTileData = static_cast<TrapTileData*>(mTileData[tile]);
     trapTileData->setActivated(true);
+    // Only doors change creature speeds and vision when activated. For the other traps, we do not
+    // want to drop the cached paths and sights
+    if(isDoor())
+        getGameMap()->tilePassabilityChanged(tile);
     trapTileData->setNbShootsBeforeDeactivation(mNbShootsBeforeDeactivation);
     trapTileData->setReloadTime(0);
 
@@ -263,6 +267,10 @@ void Trap::deactivate(Tile* tile)
 
     TrapTileData* trapTileData = static_cast<TrapTileData*>(mTileData[tile]);
     trapTileData->setActivated(false);
+    // Only doors change creature speeds and vision when activated. For the other traps, we do not
+    // want to drop the cached paths and sights
+    if(isDoor())
+        getGameMap()->tilePassabilityChanged(tile);
 
     BuildingObject* entity = getBuildingObjectFromTile(tile);
     if (entity == nullptr)
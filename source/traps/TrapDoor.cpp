@@ -371,6 +371,9 @@ void TrapDoor::notifyDoorSlapped(DoorEntity* doorEntity, Tile* tile)
 
 void TrapDoor::changeDoorState(DoorEntity* doorEntity, Tile* tile, bool locked)
 {
+    // Locked doors block vision even if not activated
+    getGameMap()->tilePassabilityChanged(tile);
+
     if(locked)
         doorEntity->setAnimationState(ANIMATION_CLOSE, false, Ogre::Vector3::ZERO, false);
     else
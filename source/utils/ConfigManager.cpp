@@ -44,6 +44,7 @@ ConfigManager::ConfigManager(const std::string& configPath, const std::string& u
         const std::string& soundPath) :
     mNetworkPort(0),
     mClientConnectionTimeout(5000),
+    mMaxTurnsAheadOfClients(0),
     mBaseSpawnPoint(10),
     mCreatureDeathCounter(10),
     mMaxCreaturesPerSeatAbsolute(30),
@@ -450,6 +451,13 @@ bool ConfigManager::loadGlobalGameConfig(std::stringstream& configFile)
             // Not mandatory
         }
 
+        if(nextParam == "MaxTurnsAheadOfClients")
+        {
+            configFile >> nextParam;
+            mMaxTurnsAheadOfClients = Helper::toUInt32(nextParam);
+            // Not mandatory
+        }
+
         if(nextParam == "CreatureDeathCounter")
         {
             configFile >> nextParam;
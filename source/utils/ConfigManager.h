@@ -127,6 +127,9 @@ public:
     inline uint32_t getClientConnectionTimeout() const
     { return mClientConnectionTimeout; }
 
+    inline uint32_t getMaxTurnsAheadOfClients() const
+    { return mMaxTurnsAheadOfClients; }
+
     inline uint32_t getBaseSpawnPoint() const
     { return mBaseSpawnPoint; }
 
@@ -282,6 +285,8 @@ private:
     std::string mFilenameUserCfg;
     uint32_t mNetworkPort;
     uint32_t mClientConnectionTimeout;
+    //! \brief Number of turns the server can be ahead of the slowest client before waiting for it
+    uint32_t mMaxTurnsAheadOfClients;
     uint32_t mBaseSpawnPoint;
     uint32_t mCreatureDeathCounter;
     uint32_t mMaxCreaturesPerSeatAbsolute;
@@ -0,0 +1,97 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils/DisjointSet.h"
+
+void DisjointSet::clear()
+{
+    mParents.clear();
+    mRanks.clear();
+    mLabels.clear();
+}
+
+uint32_t DisjointSet::find(uint32_t element)
+{
+    if(element >= mParents.size())
+        return element;
+
+    return mLabels[findRoot(element)];
+}
+
+uint32_t DisjointSet::findReadOnly(uint32_t element) const
+{
+    if(element >= mParents.size())
+        return element;
+
+    // Sets are linked by rank so the depth stays logarithmic even without compression
+    uint32_t root = element;
+    while(mParents[root] != root)
+        root = mParents[root];
+
+    return mLabels[root];
+}
+
+uint32_t DisjointSet::findRoot(uint32_t element)
+{
+    uint32_t root = element;
+    while(mParents[root] != root)
+        root = mParents[root];
+
+    // Path compression: every element on the way points directly to the root
+    while(mParents[element] != root)
+    {
+        uint32_t next = mParents[element];
+        mParents[element] = root;
+        element = next;
+    }
+
+    return root;
+}
+
+void DisjointSet::mergeInto(uint32_t element, uint32_t target)
+{
+    uint32_t maxElement = (element > target) ? element : target;
+    if(maxElement >= mParents.size())
+    {
+        uint32_t oldSize = static_cast<uint32_t>(mParents.size());
+        mParents.resize(maxElement + 1);
+        mRanks.resize(maxElement + 1, 0);
+        mLabels.resize(maxElement + 1);
+        for(uint32_t i = oldSize; i <= maxElement; ++i)
+        {
+            mParents[i] = i;
+            mLabels[i] = i;
+        }
+    }
+
+    uint32_t rootElement = findRoot(element);
+    uint32_t rootTarget = findRoot(target);
+    if(rootElement == rootTarget)
+        return;
+
+    uint32_t label = mLabels[rootTarget];
+    if(mRanks[rootElement] > mRanks[rootTarget])
+    {
+        mParents[rootTarget] = rootElement;
+        mLabels[rootElement] = label;
+        return;
+    }
+
+    mParents[rootElement] = rootTarget;
+    if(mRanks[rootElement] == mRanks[rootTarget])
+        ++mRanks[rootTarget];
+}
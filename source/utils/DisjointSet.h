@@ -0,0 +1,58 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DISJOINTSET_H
+#define DISJOINTSET_H
+
+#include <cstdint>
+#include <vector>
+
+/*! \brief Union-find structure over unsigned integers with path compression.
+ *
+ * Every element that has never been merged is its own set. The storage grows on demand
+ * up to the highest element merged.
+ * Sets are linked by rank so that find is O(alpha(n)) amortized. Because the tree root can then be any
+ * element of the set, each root carries a label which is the value returned by find. That allows
+ * the caller to choose which element identifies the merged set.
+ */
+class DisjointSet
+{
+public:
+    //! \brief Every element becomes its own set again
+    void clear();
+
+    //! \brief Returns the representative of the set containing the given element
+    uint32_t find(uint32_t element);
+
+    //! \brief Same as find but without path compression. As it does not modify the set, it can be
+    //! called from several threads at the same time as long as no merge happens
+    uint32_t findReadOnly(uint32_t element) const;
+
+    //! \brief Merges the set containing element into the set containing target. The representative
+    //! of the target set is kept as representative of the merged set.
+    void mergeInto(uint32_t element, uint32_t target);
+
+private:
+    std::vector<uint32_t> mParents;
+    std::vector<uint8_t> mRanks;
+    //! \brief Representative of the set for root elements (unused for the others)
+    std::vector<uint32_t> mLabels;
+
+    uint32_t findRoot(uint32_t element);
+};
+
+#endif // DISJOINTSET_H
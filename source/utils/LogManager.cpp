@@ -17,88 +17,154 @@
 
 #include "utils/LogManager.h"
 
-#include <boost/filesystem.hpp>
-
-#include <iomanip>
+#include <cstring>
+#include <ctime>
 
 template<> LogManager* Ogre::Singleton<LogManager>::msSingleton = nullptr;
 
 //! \brief Log filename used when OD Application throws errors without using Ogre default logger.
 const std::string LogManager::GAMELOG_NAME = "gameLog";
 
-LogManager::LogManager()
-    : mLevel(LogMessageLevel::NORMAL)
+namespace
+{
+// Number of messages that can be waiting to be written. If the queue is full, the logging
+// threads wait for the background thread
+const std::size_t LOG_RECORDS_CAPACITY = 4096;
+// Time the background thread sleeps when there is nothing to write
+const int32_t LOG_IDLE_SLEEP_MS = 2;
+// Max time flush waits for the background thread. If it is stuck (for example, if a sink
+// crashed), we don't want to wait forever
+const int32_t LOG_FLUSH_TIMEOUT_MS = 1000;
+
+//! \brief Returns the length of the module name (the file name without the extension)
+std::size_t getModuleLength(const char* filename)
 {
+    const char* extension = std::strrchr(filename, '.');
+    if(extension == nullptr)
+        return std::strlen(filename);
 
+    return static_cast<std::size_t>(extension - filename);
+}
 }
 
-LogManager::~LogManager()
+LogManager::LogManager() :
+    mLevel(LogMessageLevel::NORMAL),
+    mHasModuleLevel(false),
+    mRecords(LOG_RECORDS_CAPACITY),
+    mNbRecordsPushed(0),
+    mNbRecordsWritten(0),
+    mIsRunning(true),
+    mThread(&LogManager::writeRecords, this)
 {
+    mThread.launch();
+}
 
+LogManager::~LogManager()
+{
+    mIsRunning.store(false);
+    mThread.wait();
 }
 
 void LogManager::addSink(std::unique_ptr<LogSink> sink)
 {
+    sf::Lock locked(mSinksLock);
     mSinks.push_back(std::move(sink));
 }
 
 void LogManager::setLevel(LogMessageLevel level)
 {
-    mLevel = level;
+    mLevel.store(level);
 }
 
 void LogManager::setModuleLevel(const char* module, LogMessageLevel level)
 {
+    std::lock_guard<std::mutex> lock(mModuleLevelLock);
     mModuleLevel[module] = level;
+    mHasModuleLevel.store(true);
+}
+
+bool LogManager::isModuleLogged(LogMessageLevel level, const char* filename) const
+{
+    std::string module(filename, getModuleLength(filename));
+    std::lock_guard<std::mutex> lock(mModuleLevelLock);
+    auto found = mModuleLevel.find(module);
+    if (found == mModuleLevel.end() ||
+        found->second > level)
+    {
+        return false;
+    }
+
+    return true;
 }
 
 void LogManager::logMessage(LogMessageLevel level, const char* filepath, int line, const std::string& message)
 {
-    sf::Lock locked(mLock);
+    const char* filename = getFilename(filepath);
+    if(!isLogged(level, filename))
+        return;
 
-    // module
+    LogRecord record;
+    record.mLevel = level;
+    record.mFilename = filename;
+    record.mLine = line;
+    record.mTime = ::time(0);
+    record.mMessage = message;
 
-    const boost::filesystem::path strippedPath(filepath);
-    std::string module = strippedPath.stem().string();
+    while(!mRecords.push(record))
+        sf::sleep(sf::milliseconds(1));
 
-    // Check if the message fails the global threshold.
+    ++mNbRecordsPushed;
+}
 
-    if (mLevel > level)
+void LogManager::flush()
+{
+    uint64_t nbRecords = mNbRecordsPushed.load();
+    for(int32_t waited = 0; waited < LOG_FLUSH_TIMEOUT_MS; ++waited)
     {
-        // Allow per-module overrides of the global logging level.
-
-        if (mModuleLevel.empty())
-        {
+        if(mNbRecordsWritten.load() >= nbRecords)
             return;
-        }
 
-        auto found = mModuleLevel.find(module);
-        if (found == mModuleLevel.end() ||
-            found->second > level)
-        {
-            return;
-        }
+        sf::sleep(sf::milliseconds(1));
     }
+}
 
-    // filename
-
-    std::string filename = strippedPath.filename().string();
+void LogManager::writeRecords()
+{
+    LogRecord record;
+    while(true)
+    {
+        // We read the flag before emptying the queue to be sure that messages logged
+        // before the destruction are written
+        bool isRunning = mIsRunning.load();
+        bool hasWritten = false;
+        while(mRecords.pop(record))
+        {
+            writeRecord(record);
+            ++mNbRecordsWritten;
+            hasWritten = true;
+        }
 
-    // timestamp
+        if(!isRunning)
+            break;
 
-    time_t current_time = ::time(0);
-    struct tm* now = ::localtime(&current_time);
+        if(!hasWritten)
+            sf::sleep(sf::milliseconds(LOG_IDLE_SLEEP_MS));
+    }
+}
 
-    mTimestampStream.str("");
-    mTimestampStream
-        << std::setfill('0') << std::setw(2) << now->tm_hour << ':'
-        << std::setfill('0') << std::setw(2) << now->tm_min << ':'
-        << std::setfill('0') << std::setw(2) << now->tm_sec;
+void LogManager::writeRecord(const LogRecord& record)
+{
+    std::string module(record.mFilename, getModuleLength(record.mFilename));
+    std::string filename(record.mFilename);
 
-    std::string timestamp = mTimestampStream.str();
+    // timestamp. localtime is only called from this thread
+    char timestamp[16];
+    struct tm* now = ::localtime(&record.mTime);
+    std::strftime(timestamp, sizeof(timestamp), "%H:%M:%S", now);
 
+    sf::Lock locked(mSinksLock);
     for (const auto& sink : mSinks)
     {
-        sink->write(level, module, timestamp, filename, line, message);
+        sink->write(record.mLevel, module, timestamp, filename, record.mLine, record.mMessage);
     }
 }
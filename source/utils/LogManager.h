@@ -18,9 +18,12 @@
 #ifndef LOGMANAGER_H
 #define LOGMANAGER_H
 
+#include <atomic>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include <SFML/System.hpp>
 
@@ -28,17 +31,38 @@
 
 #include "utils/Helper.h"
 #include "utils/LogMessageLevel.h"
+#include "utils/LogRingBuffer.h"
 #include "utils/LogSink.h"
 
-#define OD_LOG_ERR(_message)                      LogManager::getSingleton().logMessage(LogMessageLevel::CRITICAL, __FILE__, __LINE__, (std::string("") + _message))
-#define OD_LOG_WRN(_message)                      LogManager::getSingleton().logMessage(LogMessageLevel::WARNING, __FILE__, __LINE__, (std::string("") + _message))
-#define OD_LOG_INF(_message)                      LogManager::getSingleton().logMessage(LogMessageLevel::NORMAL, __FILE__, __LINE__, (std::string("") + _message))
-#define OD_LOG_DBG(_message)                      LogManager::getSingleton().logMessage(LogMessageLevel::TRIVIAL, __FILE__, __LINE__, (std::string("") + _message))
+//! \brief Messages with a level lower than OD_LOG_MIN_LEVEL (see LogMessageLevel) are removed at
+//! compile time. Release builds define it to drop the debug messages.
+#ifndef OD_LOG_MIN_LEVEL
+#define OD_LOG_MIN_LEVEL 0
+#endif
+
+//! \brief The level is checked before the message is built so that filtered messages cost nothing.
+//! The file name is computed at compile time.
+#define OD_LOG_MESSAGE(_level, _message) \
+    do \
+    { \
+        if(static_cast<int>(_level) >= OD_LOG_MIN_LEVEL) \
+        { \
+            constexpr const char* odLogFilename = LogManager::getFilename(__FILE__); \
+            if(LogManager::getSingleton().isLogged(_level, odLogFilename)) \
+                LogManager::getSingleton().logMessage(_level, odLogFilename, __LINE__, (std::string("") + _message)); \
+        } \
+    } while(false)
+
+#define OD_LOG_ERR(_message)                      OD_LOG_MESSAGE(LogMessageLevel::CRITICAL, _message)
+#define OD_LOG_WRN(_message)                      OD_LOG_MESSAGE(LogMessageLevel::WARNING, _message)
+#define OD_LOG_INF(_message)                      OD_LOG_MESSAGE(LogMessageLevel::NORMAL, _message)
+#define OD_LOG_DBG(_message)                      OD_LOG_MESSAGE(LogMessageLevel::TRIVIAL, _message)
 
 #define OD_ASSERT_TRUE(_condition)                if (!(_condition)) LogManager::getSingleton().logMessage(LogMessageLevel::CRITICAL, __FILE__, __LINE__, std::string(#_condition))
 #define OD_ASSERT_TRUE_MSG(_condition, _message)  if (!(_condition)) LogManager::getSingleton().logMessage(LogMessageLevel::CRITICAL, __FILE__, __LINE__, (std::string("") + _message))
 
-//! \brief Helper/wrapper class to provide thread-safe logging when ogre is compiled without threads.
+//! \brief Thread-safe logging. Messages are queued in a lock-free ring buffer and written to the
+//! sinks by a background thread so that logging threads never wait for the sinks.
 class LogManager : public Ogre::Singleton<LogManager>
 {
 public:
@@ -54,19 +78,66 @@ public:
     //! \brief Set the minimum logging level per module.
     void setModuleLevel(const char* module, LogMessageLevel level);
 
-    //! \brief Log a message to the sinks.
+    //! \brief Returns true if a message with the given level logged from the given file
+    //! would be written
+    inline bool isLogged(LogMessageLevel level, const char* filename) const
+    {
+        if(level >= mLevel.load(std::memory_order_relaxed))
+            return true;
+
+        // Allow per-module overrides of the global logging level.
+        if(!mHasModuleLevel.load(std::memory_order_relaxed))
+            return false;
+
+        return isModuleLogged(level, filename);
+    }
+
+    //! \brief Log a message to the sinks. filepath should be a string literal (__FILE__) as
+    //! it is written asynchronously.
     void logMessage(LogMessageLevel level, const char* filepath, int line, const std::string& message);
 
+    //! \brief Waits until every message logged before the call has been written to the sinks
+    //! (or until a timeout). Useful before crashing.
+    void flush();
+
+    //! \brief Returns the file name part of filepath
+    static constexpr const char* getFilename(const char* filepath)
+    {
+        return getFilename(filepath, filepath);
+    }
+
     static const std::string GAMELOG_NAME;
 private:
     LogManager(const LogManager&) = delete;
     LogManager& operator=(const LogManager&) = delete;
 
-    LogMessageLevel mLevel;
+    static constexpr const char* getFilename(const char* current, const char* filename)
+    {
+        return (*current == '\0') ? filename :
+            getFilename(current + 1, ((*current == '/') || (*current == '\\')) ? current + 1 : filename);
+    }
+
+    bool isModuleLogged(LogMessageLevel level, const char* filename) const;
+
+    //! \brief Background thread writing the queued messages to the sinks
+    void writeRecords();
+
+    void writeRecord(const LogRecord& record);
+
+    std::atomic<LogMessageLevel> mLevel;
+    std::atomic<bool> mHasModuleLevel;
     std::map<std::string, LogMessageLevel> mModuleLevel;
-    sf::Mutex mLock;
+    mutable std::mutex mModuleLevelLock;
+
+    //! \brief Protects the sinks that can be added while the background thread writes
+    sf::Mutex mSinksLock;
     std::vector<std::unique_ptr<LogSink>> mSinks;
-    std::stringstream mTimestampStream;
+
+    LogRingBuffer mRecords;
+    std::atomic<uint64_t> mNbRecordsPushed;
+    std::atomic<uint64_t> mNbRecordsWritten;
+    std::atomic<bool> mIsRunning;
+    sf::Thread mThread;
 };
 
 #endif // LOGMANAGER_H
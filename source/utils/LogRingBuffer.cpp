@@ -0,0 +1,90 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "utils/LogRingBuffer.h"
+
+#include <utility>
+
+namespace
+{
+std::size_t roundToPowerOf2(std::size_t value)
+{
+    std::size_t result = 1;
+    while(result < value)
+        result <<= 1;
+
+    return result;
+}
+}
+
+LogRingBuffer::LogRingBuffer(std::size_t capacity) :
+    mMask(roundToPowerOf2(capacity) - 1),
+    mSlots(new Slot[mMask + 1]),
+    mWriteIndex(0),
+    mReadIndex(0)
+{
+    for(std::size_t i = 0; i <= mMask; ++i)
+        mSlots[i].mSequence.store(i, std::memory_order_relaxed);
+}
+
+LogRingBuffer::~LogRingBuffer()
+{
+}
+
+bool LogRingBuffer::push(LogRecord& record)
+{
+    std::size_t index = mWriteIndex.load(std::memory_order_relaxed);
+    Slot* slot;
+    while(true)
+    {
+        slot = &mSlots[index & mMask];
+        std::size_t sequence = slot->mSequence.load(std::memory_order_acquire);
+        if(sequence == index)
+        {
+            // The slot is free. We try to take it
+            if(mWriteIndex.compare_exchange_weak(index, index + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if(sequence < index)
+        {
+            // The slot has not been read yet: the queue is full
+            return false;
+        }
+        else
+        {
+            // Another producer took the slot
+            index = mWriteIndex.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->mRecord = std::move(record);
+    slot->mSequence.store(index + 1, std::memory_order_release);
+    return true;
+}
+
+bool LogRingBuffer::pop(LogRecord& record)
+{
+    Slot& slot = mSlots[mReadIndex & mMask];
+    if(slot.mSequence.load(std::memory_order_acquire) != mReadIndex + 1)
+        return false;
+
+    record = std::move(slot.mRecord);
+    slot.mSequence.store(mReadIndex + mMask + 1, std::memory_order_release);
+    ++mReadIndex;
+    return true;
+}
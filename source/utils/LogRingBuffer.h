@@ -0,0 +1,76 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LOGRINGBUFFER_H
+#define LOGRINGBUFFER_H
+
+#include "utils/LogMessageLevel.h"
+
+#include <atomic>
+#include <cstddef>
+#include <ctime>
+#include <memory>
+#include <string>
+
+//! \brief A log message waiting to be written to the sinks
+struct LogRecord
+{
+    LogMessageLevel mLevel;
+    //! \brief File name (without the path) of the source file. Points to a string literal (__FILE__)
+    const char* mFilename;
+    int mLine;
+    std::time_t mTime;
+    std::string mMessage;
+};
+
+//! \brief Bounded lock-free queue used to pass the log records from the threads logging messages
+//! to the thread writing them to the sinks. Any thread can push records but only one can pop them.
+//! Each slot holds a sequence number telling if it is ready to be written or to be read so that
+//! producers only compete on the write index.
+class LogRingBuffer
+{
+public:
+    //! \brief capacity is rounded up to the next power of 2
+    LogRingBuffer(std::size_t capacity);
+    ~LogRingBuffer();
+
+    //! \brief Moves record in the queue. Returns false if the queue is full. In this case, record
+    //! is left untouched
+    bool push(LogRecord& record);
+
+    //! \brief Moves the oldest record in record. Returns false if the queue is empty.
+    //! Must only be called by the consumer thread
+    bool pop(LogRecord& record);
+
+private:
+    LogRingBuffer(const LogRingBuffer&) = delete;
+    LogRingBuffer& operator=(const LogRingBuffer&) = delete;
+
+    struct Slot
+    {
+        std::atomic<std::size_t> mSequence;
+        LogRecord mRecord;
+    };
+
+    std::size_t mMask;
+    std::unique_ptr<Slot[]> mSlots;
+    std::atomic<std::size_t> mWriteIndex;
+    std::size_t mReadIndex;
+};
+
+#endif // LOGRINGBUFFER_H
@@ -21,90 +21,75 @@
  */
 
 #include "utils/Random.h"
-#include "utils/Helper.h"
 
-#include <algorithm>
-#include <cmath>
+#include <atomic>
 #include <ctime>
 
-unsigned long myRandomSeed;
-const unsigned long MAX = 32768;
-
-static unsigned long randgen()
+namespace
 {
-    myRandomSeed = myRandomSeed * 1103515245 + 12345;
-    //TODO: What is the purpose of the cast?
-    unsigned long returnVal = static_cast<unsigned int>(myRandomSeed / 65536) % MAX;
-
-    return returnVal;
-}
+std::atomic<uint64_t> gameSeed(0);
 
-//! \brief uniformly distributed number [0;1)
-static double uniform()
+uint64_t mix(uint64_t value)
 {
-    return randgen() * 1.0 / static_cast<double>(MAX);
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
 }
 
-//! \brief uniformly distributed number [lo;hi)
-static double uniform(double lo, double hi)
+namespace Random
 {
-    return uniform() * (hi - lo) + lo;
-}
 
-//! \brief random integer [lo;hi]
-static int randint(int lo, int hi)
+void initialize()
 {
-    return static_cast<int>(uniform() * (hi - lo + 1) + lo);
+    initialize(static_cast<uint64_t>(std::time(0)));
 }
 
-//! \brief random unsigned integer [lo;hi]
-static unsigned int randuint(unsigned int lo, unsigned int hi)
+void initialize(uint64_t seed)
 {
-    return static_cast<unsigned int>(uniform() * (hi - lo + 1) + lo);
+    gameSeed.store(seed);
 }
 
-
-namespace Random
+uint64_t getSeed()
 {
+    return gameSeed.load();
+}
 
-void initialize()
+uint64_t getStreamSeed(RandomStreamType type, uint64_t id)
 {
-    myRandomSeed = static_cast<unsigned long>(std::time(0));
+    return mix(getSeed() ^ mix((static_cast<uint64_t>(type) << 56) ^ mix(id)));
 }
 
-double Double(double min, double max)
+uint64_t getStreamSeed(RandomStreamType type, const std::string& name)
 {
-    if (min > max)
+    // FNV-1a to get the same id on every platform
+    uint64_t id = 0xCBF29CE484222325ULL;
+    for(char c : name)
     {
-        std::swap(min, max);
+        id ^= static_cast<uint8_t>(c);
+        id *= 0x100000001B3ULL;
     }
+    return getStreamSeed(type, id);
+}
 
-    return uniform(min, max);
+double Double(double min, double max)
+{
+    return RandomStream::getCurrent().Double(min, max);
 }
 
 int Int(int min, int max)
 {
-    if (min > max)
-    {
-        std::swap(min, max);
-    }
-
-    return randint(min, max);
+    return RandomStream::getCurrent().Int(min, max);
 }
 
 unsigned int Uint(unsigned int min, unsigned int max)
 {
-    if (min > max)
-    {
-        std::swap(min, max);
-    }
-
-    return randuint(min, max);
+    return RandomStream::getCurrent().Uint(min, max);
 }
 
 double gaussianRandomDouble()
 {
-    return std::sqrt(-2.0 * log(Double(0.0, 1.0))) * cos(2.0 * PI * Double(0.0, 1.0));
+    return RandomStream::getCurrent().gaussianRandomDouble();
 }
 
 } // namespace Random
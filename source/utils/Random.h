@@ -23,11 +23,29 @@
 #ifndef RANDOM_H_
 #define RANDOM_H_
 
+#include "utils/RandomStream.h"
+
+#include <cstdint>
+#include <string>
+
+//! \brief The functions use the random stream of the current thread (see RandomStream::Scope).
+//! Systems needing results independent of the evaluation order own a stream seeded with getStreamSeed.
 namespace Random
 {
-    //! \brief initializes the semaphore and seeds the generator
+    //! \brief seeds the generator with the current time
     void initialize();
 
+    //! \brief seeds the generator with the given seed. Useful to get reproducible games
+    void initialize(uint64_t seed);
+
+    //! \brief Returns the game seed given to initialize
+    uint64_t getSeed();
+
+    //! \brief Returns the seed of the stream owned by the given system. The same system id always
+    //! gets the same stream for a given game seed
+    uint64_t getStreamSeed(RandomStreamType type, uint64_t id);
+    uint64_t getStreamSeed(RandomStreamType type, const std::string& name);
+
     /*! \brief generate a random double
      *
      *  \param min, max One or both can be negative
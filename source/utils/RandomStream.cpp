@@ -0,0 +1,153 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "utils/RandomStream.h"
+
+#include "utils/Random.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+const double PI = 3.141592653589793238462643;
+
+//! \brief Stream made current by RandomStream::Scope. If null, the thread default stream is used
+thread_local RandomStream* currentStream = nullptr;
+
+uint64_t splitMix64(uint64_t& state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+inline uint64_t rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+}
+
+RandomStream::Scope::Scope(RandomStream& stream) :
+    mPreviousStream(currentStream)
+{
+    currentStream = &stream;
+}
+
+RandomStream::Scope::~Scope()
+{
+    currentStream = mPreviousStream;
+}
+
+RandomStream::RandomStream() :
+    mState{0, 0, 0, 0},
+    mIsSeeded(false)
+{
+}
+
+RandomStream::RandomStream(uint64_t seed) :
+    mState{0, 0, 0, 0},
+    mIsSeeded(false)
+{
+    this->seed(seed);
+}
+
+void RandomStream::seed(uint64_t seed)
+{
+    // The state is filled with splitmix64 as recommended by the xoshiro authors. It cannot be all zeros
+    uint64_t state = seed;
+    for(uint64_t& value : mState)
+        value = splitMix64(state);
+
+    mIsSeeded = true;
+}
+
+uint64_t RandomStream::next()
+{
+    const uint64_t result = rotl(mState[1] * 5, 7) * 9;
+    const uint64_t t = mState[1] << 17;
+
+    mState[2] ^= mState[0];
+    mState[3] ^= mState[1];
+    mState[1] ^= mState[2];
+    mState[0] ^= mState[3];
+    mState[2] ^= t;
+    mState[3] = rotl(mState[3], 45);
+
+    return result;
+}
+
+double RandomStream::uniform()
+{
+    // The 53 upper bits fill the double mantissa
+    return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+double RandomStream::Double(double min, double max)
+{
+    if (min > max)
+        std::swap(min, max);
+
+    return uniform() * (max - min) + min;
+}
+
+int RandomStream::Int(int min, int max)
+{
+    if (min > max)
+        std::swap(min, max);
+
+    uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(max) - static_cast<int64_t>(min)) + 1;
+    return static_cast<int>(static_cast<int64_t>(min) + static_cast<int64_t>(next() % range));
+}
+
+unsigned int RandomStream::Uint(unsigned int min, unsigned int max)
+{
+    if (min > max)
+        std::swap(min, max);
+
+    uint64_t range = static_cast<uint64_t>(max - min) + 1;
+    return min + static_cast<unsigned int>(next() % range);
+}
+
+double RandomStream::gaussianRandomDouble()
+{
+    // Box-Muller. We use (0, 1] for the logarithm
+    double u1 = 1.0 - uniform();
+    double u2 = uniform();
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * PI * u2);
+}
+
+RandomStream& RandomStream::getCurrent()
+{
+    if(currentStream != nullptr)
+        return *currentStream;
+
+    // Each thread has its own default stream so that threads not using a scope do not share state.
+    // It is seeded again if the game seed changes
+    thread_local RandomStream defaultStream;
+    thread_local uint64_t defaultStreamGameSeed = 0;
+    uint64_t gameSeed = Random::getSeed();
+    if(!defaultStream.isSeeded() || (defaultStreamGameSeed != gameSeed))
+    {
+        defaultStream.seed(Random::getStreamSeed(RandomStreamType::server, 0));
+        defaultStreamGameSeed = gameSeed;
+    }
+
+    return defaultStream;
+}
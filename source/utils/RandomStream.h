@@ -0,0 +1,100 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef RANDOMSTREAM_H
+#define RANDOMSTREAM_H
+
+#include <cstdint>
+#include <limits>
+
+//! \brief Systems owning their own random stream. Used to derive the stream seeds from the game seed
+enum class RandomStreamType : uint32_t
+{
+    server,
+    creature,
+    keeperAI,
+    roomPortal
+};
+
+//! \brief Random number generator (xoshiro256**). Each system owning a stream gets the same numbers
+//! for the same game seed whatever the order the systems are processed in (or the thread they run in).
+//! The Random::Int/Uint/Double functions use the stream made current with a RandomStream::Scope.
+//! It can be used as a uniform random bit generator by the standard algorithms (like std::shuffle).
+class RandomStream
+{
+public:
+    typedef uint64_t result_type;
+    //! \brief Makes the given stream the one used by the Random functions in the current thread
+    //! while in scope
+    class Scope
+    {
+    public:
+        Scope(RandomStream& stream);
+        ~Scope();
+
+    private:
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        RandomStream* mPreviousStream;
+    };
+
+    //! \brief Creates a stream that is not seeded. seed should be called before using it
+    RandomStream();
+    RandomStream(uint64_t seed);
+
+    void seed(uint64_t seed);
+
+    inline bool isSeeded() const
+    { return mIsSeeded; }
+
+    //! \brief Returns the next 64 random bits
+    uint64_t next();
+
+    //! \brief Uniform random bit generator interface
+    static constexpr result_type min()
+    { return 0; }
+    static constexpr result_type max()
+    { return std::numeric_limits<result_type>::max(); }
+    inline result_type operator()()
+    { return next(); }
+
+    //! \brief Returns a double in [min, max)
+    double Double(double min, double max);
+
+    //! \brief Returns an integer in [min, max]
+    int Int(int min, int max);
+
+    //! \brief Returns an unsigned integer in [min, max]
+    unsigned int Uint(unsigned int min, unsigned int max);
+
+    //! \brief Returns a gaussian distributed double
+    double gaussianRandomDouble();
+
+    //! \brief Returns the stream used by the Random functions in the current thread
+    static RandomStream& getCurrent();
+
+private:
+    //! \brief Returns a double in [0, 1)
+    double uniform();
+
+    uint64_t mState[4];
+    bool mIsSeeded;
+};
+
+#endif // RANDOMSTREAM_H
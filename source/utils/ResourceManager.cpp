@@ -86,6 +86,8 @@ ResourceManager::ResourceManager(boost::program_options::variables_map& options)
         mServerMode(false),
         mForcedNetworkPort(-1),
         mLogLevel(LogMessageLevel::NORMAL),
+        mHasRandomSeed(false),
+        mRandomSeed(0),
         mGameDataPath("./"),
         mUserDataPath("./"),
         mUserConfigPath("./")
@@ -357,6 +359,10 @@ void ResourceManager::setupUserDataFolders(boost::program_options::variables_map
         mOgreLogFile = mUserDataPath + LOGFILENAME;
     }
 
+    itOption = options.find("trace");
+    if(itOption != options.end())
+        mTraceFile = mUserDataPath + itOption->second.as<std::string>();
+
     itOption = options.find("server");
     if(itOption != options.end())
     {
@@ -433,6 +439,13 @@ void ResourceManager::setupUserDataFolders(boost::program_options::variables_map
     if(itOption != options.end())
         mLogLevel = static_cast<LogMessageLevel>(itOption->second.as<int32_t>());
 
+    itOption = options.find("seed");
+    if(itOption != options.end())
+    {
+        mHasRandomSeed = true;
+        mRandomSeed = itOption->second.as<uint64_t>();
+    }
+
     mUserConfigFile = mUserConfigPath + USERCFGFILENAME;
     mCeguiLogFile = mUserDataPath + CEGUILOGFILENAME;
     mShaderCachePath = mUserDataPath + SHADERCACHESUBPATH;
@@ -571,6 +584,7 @@ void ResourceManager::buildCommandOptions(boost::program_options::options_descri
 {
     desc.add_options()
         ("log", boost::program_options::value<std::string>(), "log file to use")
+        ("trace", boost::program_options::value<std::string>(), "Records a binary trace of the simulation events in the given file (see tools/trace-analysis.py)")
         ("server", boost::program_options::value<std::string>(), "Launches the game on server mode and opens the given level from official levels path")
         ("servercustom", boost::program_options::value<std::string>(), "Launches the game on server mode and opens the given level from custom levels path")
         ("serversave", boost::program_options::value<std::string>(), "Launches the game on server mode and opens the given saved game")
@@ -578,6 +592,7 @@ void ResourceManager::buildCommandOptions(boost::program_options::options_descri
         ("mscreator", boost::program_options::value<std::string>(), "Sets the creator for this map to connect to the master server. server/servercustom/serversave option needs to be on")
         ("port", boost::program_options::value<int32_t>(), "Sets the port used. Note that the port is used for both single and multi player")
         ("loglevel", boost::program_options::value<int32_t>(), "Sets the log level (between 0=Trivial and 3=Critical)")
+        ("seed", boost::program_options::value<uint64_t>(), "Sets the game seed. The same seed gives the same random streams to the game systems")
     ;
 }
 
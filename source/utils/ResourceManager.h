@@ -129,6 +129,10 @@ public:
     inline const std::string& getCeguiLogFile() const
     { return mCeguiLogFile; }
 
+    //! \brief Returns the trace file or an empty string if tracing is not enabled
+    inline const std::string& getTraceFile() const
+    { return mTraceFile; }
+
     std::string getGameLevelPathSkirmish() const;
     std::string getUserLevelPathSkirmish() const
     { return mUserSkirmishLevelsPath; }
@@ -151,6 +155,13 @@ public:
     inline LogMessageLevel getLogLevel() const
     { return mLogLevel; }
 
+    //! \brief Returns true if the game seed was given on the command line
+    inline bool hasRandomSeed() const
+    { return mHasRandomSeed; }
+
+    inline uint64_t getRandomSeed() const
+    { return mRandomSeed; }
+
 private:
     //! \brief used when the executable is launched in server mode
     bool mServerMode;
@@ -163,6 +174,10 @@ private:
     //! \brief The log level
     LogMessageLevel mLogLevel;
 
+    //! \brief used when the game seed is forced to replay the same game
+    bool mHasRandomSeed;
+    uint64_t mRandomSeed;
+
     //! \brief The application data path
     //! \example "/usr/share/game/opendungeons" on linux
     //! \example "C:/opendungeons" on windows
@@ -185,6 +200,7 @@ private:
     std::string mUserConfigFile;
     std::string mOgreLogFile;
     std::string mCeguiLogFile;
+    std::string mTraceFile;
     std::string mShaderCachePath;
 
     //! \brief Specific data sub-paths.
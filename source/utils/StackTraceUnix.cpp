@@ -196,6 +196,8 @@ void StackTracePrintPrivateData::critErrHandler(int sig_num, siginfo_t* info, vo
 
             logMgr->logMessage(LogMessageLevel::CRITICAL, __FILE__, __LINE__, log);
         }
+        // Messages are written asynchronously. We make sure they are before exiting
+        logMgr->flush();
     }
 
     // Set the stream at beginning
@@ -185,6 +185,8 @@ LONG WINAPI StackTracePrintPrivateData::exceptionFilter(LPEXCEPTION_POINTERS inf
 
             logMgr->logMessage(LogMessageLevel::CRITICAL, __FILE__, __LINE__, log);
         }
+        // Messages are written asynchronously. We make sure they are before exiting
+        logMgr->flush();
     }
 
     // Set the stream at beginning
@@ -0,0 +1,213 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils/ThreadPool.h"
+
+#include <thread>
+
+namespace
+{
+    inline uint64_t packRange(uint32_t begin, uint32_t end)
+    {
+        return (static_cast<uint64_t>(end) << 32) | begin;
+    }
+
+    inline uint32_t rangeBegin(uint64_t range)
+    {
+        return static_cast<uint32_t>(range);
+    }
+
+    inline uint32_t rangeEnd(uint64_t range)
+    {
+        return static_cast<uint32_t>(range >> 32);
+    }
+}
+
+ThreadPool::ThreadPool(uint32_t nbWorkers) :
+    mRanges(new TaskRange[nbWorkers + 1]),
+    mTask(nullptr),
+    mGeneration(0),
+    mNbWorkersDone(0),
+    mStop(false)
+{
+    for(uint32_t i = 0; i <= nbWorkers; ++i)
+        mRanges[i].mRange.store(packRange(0, 0));
+
+    for(uint32_t i = 0; i < nbWorkers; ++i)
+    {
+        mThreads.emplace_back(new sf::Thread(std::bind(&ThreadPool::workerThread, this, i)));
+        mThreads.back()->launch();
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mStop = true;
+    }
+    mWorkersCondition.notify_all();
+
+    for(std::unique_ptr<sf::Thread>& thread : mThreads)
+        thread->wait();
+}
+
+uint32_t ThreadPool::getDefaultNbWorkers()
+{
+    uint32_t nbThreads = std::thread::hardware_concurrency();
+    if(nbThreads <= 1)
+        return 0;
+
+    return nbThreads - 1;
+}
+
+void ThreadPool::parallelFor(uint32_t nbTasks, const std::function<void(uint32_t)>& task, uint32_t minTasksPerThread)
+{
+    uint32_t nbThreads = getNbWorkers() + 1;
+    if((nbThreads == 1) || (nbTasks < 2 * std::max(minTasksPerThread, 1u)))
+    {
+        for(uint32_t i = 0; i < nbTasks; ++i)
+            task(i);
+
+        return;
+    }
+
+    // Each thread starts with a contiguous share. The calling thread uses the last range
+    uint32_t begin = 0;
+    for(uint32_t i = 0; i < nbThreads; ++i)
+    {
+        uint32_t end = static_cast<uint32_t>(static_cast<uint64_t>(nbTasks) * (i + 1) / nbThreads);
+        mRanges[i].mRange.store(packRange(begin, end));
+        begin = end;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mTask = &task;
+        mNbWorkersDone = 0;
+        ++mGeneration;
+    }
+    mWorkersCondition.notify_all();
+
+    runTasks(nbThreads - 1);
+
+    // The task may still be running in the workers even if every range is empty
+    std::unique_lock<std::mutex> lock(mLock);
+    mDoneCondition.wait(lock, [this]() { return mNbWorkersDone == getNbWorkers(); });
+    mTask = nullptr;
+}
+
+void ThreadPool::workerThread(uint32_t index)
+{
+    uint64_t generation = 0;
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mLock);
+            mWorkersCondition.wait(lock, [this, generation]() { return mStop || (mGeneration != generation); });
+            if(mStop)
+                return;
+
+            generation = mGeneration;
+        }
+
+        runTasks(index);
+
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            ++mNbWorkersDone;
+        }
+        mDoneCondition.notify_one();
+    }
+}
+
+void ThreadPool::runTasks(uint32_t rangeIndex)
+{
+    const std::function<void(uint32_t)>& task = *mTask;
+    uint32_t index;
+    while(true)
+    {
+        while(popTask(mRanges[rangeIndex], index))
+            task(index);
+
+        if(!stealTasks(rangeIndex, index))
+            return;
+
+        task(index);
+    }
+}
+
+bool ThreadPool::popTask(TaskRange& range, uint32_t& task)
+{
+    uint64_t current = range.mRange.load();
+    while(true)
+    {
+        uint32_t begin = rangeBegin(current);
+        uint32_t end = rangeEnd(current);
+        if(begin >= end)
+            return false;
+
+        if(range.mRange.compare_exchange_weak(current, packRange(begin + 1, end)))
+        {
+            task = begin;
+            return true;
+        }
+    }
+}
+
+bool ThreadPool::stealTasks(uint32_t rangeIndex, uint32_t& task)
+{
+    uint32_t nbRanges = getNbWorkers() + 1;
+    while(true)
+    {
+        // We look for the biggest share left
+        uint32_t victim = nbRanges;
+        uint64_t victimRange = 0;
+        uint32_t victimSize = 0;
+        for(uint32_t i = 0; i < nbRanges; ++i)
+        {
+            if(i == rangeIndex)
+                continue;
+
+            uint64_t current = mRanges[i].mRange.load();
+            uint32_t begin = rangeBegin(current);
+            uint32_t end = rangeEnd(current);
+            if((begin < end) && (end - begin > victimSize))
+            {
+                victim = i;
+                victimRange = current;
+                victimSize = end - begin;
+            }
+        }
+
+        // Every index is processed or being processed
+        if(victim == nbRanges)
+            return false;
+
+        // We take the second half. If the owner or another thief changed the range in the meantime, we look again
+        uint32_t begin = rangeBegin(victimRange);
+        uint32_t end = rangeEnd(victimRange);
+        uint32_t middle = begin + victimSize / 2;
+        if(!mRanges[victim].mRange.compare_exchange_strong(victimRange, packRange(begin, middle)))
+            continue;
+
+        // Only the owner refills its range and it is empty. Thieves do not take from empty ranges
+        task = middle;
+        mRanges[rangeIndex].mRange.store(packRange(middle + 1, end));
+        return true;
+    }
+}
@@ -0,0 +1,100 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <SFML/System.hpp>
+
+/*! \brief Runs the same task over a range of indexes with worker threads.
+ *
+ * parallelFor splits the range between the workers and the calling thread, which takes part
+ * in the work. Each one processes its share from the front. When its share is empty, it steals
+ * the second half of the biggest remaining share so that cheap and expensive indexes even out.
+ * Workers sleep between 2 calls to parallelFor.
+ */
+class ThreadPool
+{
+public:
+    //! \brief Creates the given number of worker threads. If 0, parallelFor runs the tasks
+    //! in the calling thread
+    ThreadPool(uint32_t nbWorkers);
+    ~ThreadPool();
+
+    //! \brief Calls task with each index in [0, nbTasks) and returns once every call is done.
+    //! The calls may happen in any order and from several threads at the same time. Ranges smaller
+    //! than minTasksPerThread per thread are not worth waking the workers and run in the calling thread
+    void parallelFor(uint32_t nbTasks, const std::function<void(uint32_t)>& task, uint32_t minTasksPerThread = 1);
+
+    inline uint32_t getNbWorkers() const
+    { return static_cast<uint32_t>(mThreads.size()); }
+
+    //! \brief Returns the number of workers worth creating on this computer (the number
+    //! of hardware threads minus the calling one)
+    static uint32_t getDefaultNbWorkers();
+
+private:
+    //! \brief Indexes not processed yet by a thread. Begin is stored in the lower 32 bits and end
+    //! in the higher ones so that the owner (popping the front) and thieves (taking the back) can
+    //! update it with a single compare and swap. Padded to a cache line so that threads
+    //! working on their own range do not slow down each other
+    struct TaskRange
+    {
+        std::atomic<uint64_t> mRange;
+        char mPadding[64 - sizeof(std::atomic<uint64_t>)];
+    };
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    //! \brief Loop of the worker threads
+    void workerThread(uint32_t index);
+
+    //! \brief Processes the tasks of the given range and steals from the other ones until
+    //! there is nothing left
+    void runTasks(uint32_t rangeIndex);
+
+    bool popTask(TaskRange& range, uint32_t& task);
+    bool stealTasks(uint32_t rangeIndex, uint32_t& task);
+
+    std::vector<std::unique_ptr<sf::Thread>> mThreads;
+
+    //! \brief One range per worker + one for the calling thread (the last one)
+    std::unique_ptr<TaskRange[]> mRanges;
+
+    //! \brief Task given to parallelFor. Only valid while it runs
+    const std::function<void(uint32_t)>* mTask;
+
+    //! \brief Protects mGeneration, mNbWorkersDone and mStop
+    std::mutex mLock;
+    std::condition_variable mWorkersCondition;
+    std::condition_variable mDoneCondition;
+    //! \brief Incremented each time parallelFor gives work to the workers
+    uint64_t mGeneration;
+    uint32_t mNbWorkersDone;
+    bool mStop;
+};
+
+#endif // THREADPOOL_H
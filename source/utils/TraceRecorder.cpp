@@ -0,0 +1,278 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "utils/TraceRecorder.h"
+
+#include "utils/LogManager.h"
+
+template<> TraceRecorder* Ogre::Singleton<TraceRecorder>::msSingleton = nullptr;
+
+namespace
+{
+const char TRACE_MAGIC[8] = { 'O', 'D', 'T', 'R', 'A', 'C', 'E', '\0' };
+const uint32_t TRACE_VERSION = 1;
+
+// Record types. Payloads:
+// name:            uint8 category, uint32 id, uint16 length, chars
+// turnStarted:     int64 turn
+// phase:           uint8 phase, uint64 duration (the record time is the phase start)
+// pathRequest:     int16 x1, int16 y1, int16 x2, int16 y2, uint32 path length, uint8 cache hit, uint64 duration
+// creatureAction*: uint32 creature id, uint32 action type
+// packetSent:      int32 client id, uint32 size
+const uint8_t RECORD_NAME = 0;
+const uint8_t RECORD_TURN_STARTED = 1;
+const uint8_t RECORD_PHASE = 2;
+const uint8_t RECORD_PATH_REQUEST = 3;
+const uint8_t RECORD_CREATURE_ACTION_PUSHED = 4;
+const uint8_t RECORD_CREATURE_ACTION_POPPED = 5;
+const uint8_t RECORD_PACKET_SENT = 6;
+
+// Categories of the name records
+const uint8_t NAME_PHASE = 0;
+const uint8_t NAME_CREATURE_ACTION = 1;
+
+// When the buffer reaches that size, it is given to the background thread
+const std::size_t BUFFER_FLUSH_SIZE = 256 * 1024;
+// Time the background thread sleeps when there is nothing to write
+const int32_t WRITER_IDLE_SLEEP_MS = 10;
+}
+
+TraceRecorder::TraceRecorder(const std::string& filename) :
+    mFile(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc),
+    mStartTime(std::chrono::steady_clock::now()),
+    mIsRunning(true),
+    mThread(&TraceRecorder::writeBuffers, this)
+{
+    if(!mFile.is_open())
+        OD_LOG_ERR("Cannot open trace file=" + filename);
+
+    mBuffer.reserve(BUFFER_FLUSH_SIZE);
+    mBuffer.insert(mBuffer.end(), TRACE_MAGIC, TRACE_MAGIC + sizeof(TRACE_MAGIC));
+    {
+        std::lock_guard<std::mutex> lock(mBufferLock);
+        appendInteger(TRACE_VERSION);
+    }
+
+    for(uint32_t i = 0; i < static_cast<uint32_t>(TracePhase::nbPhases); ++i)
+        recordName(NAME_PHASE, i, getPhaseName(static_cast<TracePhase>(i)));
+
+    mThread.launch();
+}
+
+TraceRecorder::~TraceRecorder()
+{
+    mIsRunning.store(false);
+    mThread.wait();
+
+    // The background thread is stopped. We write what remains
+    mFile.write(mFullBuffer.data(), mFullBuffer.size());
+    mFile.write(mBuffer.data(), mBuffer.size());
+}
+
+TraceRecorder::PhaseScope::PhaseScope(TracePhase phase) :
+    mRecorder(TraceRecorder::getSingletonPtr()),
+    mPhase(phase),
+    mStartTime(mRecorder != nullptr ? mRecorder->getTime() : 0)
+{
+}
+
+TraceRecorder::PhaseScope::~PhaseScope()
+{
+    end();
+}
+
+void TraceRecorder::PhaseScope::end()
+{
+    if(mRecorder == nullptr)
+        return;
+
+    mRecorder->recordPhase(mPhase, mStartTime, mRecorder->getTime() - mStartTime);
+    mRecorder = nullptr;
+}
+
+uint64_t TraceRecorder::getTime() const
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - mStartTime).count());
+}
+
+template<typename T>
+void TraceRecorder::appendInteger(T value)
+{
+    for(std::size_t i = 0; i < sizeof(T); ++i)
+        mBuffer.push_back(static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xFF));
+}
+
+void TraceRecorder::beginRecord(uint8_t type, uint64_t time)
+{
+    appendInteger(type);
+    appendInteger(time);
+}
+
+void TraceRecorder::endRecord()
+{
+    if(mBuffer.size() < BUFFER_FLUSH_SIZE)
+        return;
+
+    // If the background thread has not written the previous buffer yet, we keep
+    // filling the current one
+    if(!mFullBuffer.empty())
+        return;
+
+    mFullBuffer.swap(mBuffer);
+}
+
+void TraceRecorder::recordName(uint8_t category, uint32_t id, const std::string& name)
+{
+    uint64_t time = getTime();
+    std::lock_guard<std::mutex> lock(mBufferLock);
+    beginRecord(RECORD_NAME, time);
+    appendInteger(category);
+    appendInteger(id);
+    appendInteger(static_cast<uint16_t>(name.size()));
+    mBuffer.insert(mBuffer.end(), name.begin(), name.end());
+    endRecord();
+}
+
+void TraceRecorder::recordTurnStarted(int64_t turn)
+{
+    uint64_t time = getTime();
+    std::lock_guard<std::mutex> lock(mBufferLock);
+    beginRecord(RECORD_TURN_STARTED, time);
+    appendInteger(turn);
+    endRecord();
+}
+
+void TraceRecorder::recordPhase(TracePhase phase, uint64_t startTime, uint64_t duration)
+{
+    std::lock_guard<std::mutex> lock(mBufferLock);
+    beginRecord(RECORD_PHASE, startTime);
+    appendInteger(static_cast<uint8_t>(phase));
+    appendInteger(duration);
+    endRecord();
+}
+
+void TraceRecorder::recordPathRequest(int x1, int y1, int x2, int y2, uint32_t pathLength, bool isCacheHit,
+    uint64_t startTime, uint64_t duration)
+{
+    std::lock_guard<std::mutex> lock(mBufferLock);
+    beginRecord(RECORD_PATH_REQUEST, startTime);
+    appendInteger(static_cast<int16_t>(x1));
+    appendInteger(static_cast<int16_t>(y1));
+    appendInteger(static_cast<int16_t>(x2));
+    appendInteger(static_cast<int16_t>(y2));
+    appendInteger(pathLength);
+    appendInteger(static_cast<uint8_t>(isCacheHit ? 1 : 0));
+    appendInteger(duration);
+    endRecord();
+}
+
+void TraceRecorder::recordCreatureAction(bool isPushed, uint32_t creatureId, uint32_t actionType, const std::string& actionName)
+{
+    uint64_t time = getTime();
+    bool isNameWritten;
+    {
+        std::lock_guard<std::mutex> lock(mBufferLock);
+        if(actionType >= mActionNamesWritten.size())
+            mActionNamesWritten.resize(actionType + 1, false);
+
+        isNameWritten = mActionNamesWritten[actionType];
+        mActionNamesWritten[actionType] = true;
+    }
+
+    if(!isNameWritten)
+        recordName(NAME_CREATURE_ACTION, actionType, actionName);
+
+    std::lock_guard<std::mutex> lock(mBufferLock);
+    beginRecord(isPushed ? RECORD_CREATURE_ACTION_PUSHED : RECORD_CREATURE_ACTION_POPPED, time);
+    appendInteger(creatureId);
+    appendInteger(actionType);
+    endRecord();
+}
+
+void TraceRecorder::recordPacketSent(int32_t clientId, uint32_t size)
+{
+    uint64_t time = getTime();
+    std::lock_guard<std::mutex> lock(mBufferLock);
+    beginRecord(RECORD_PACKET_SENT, time);
+    appendInteger(clientId);
+    appendInteger(size);
+    endRecord();
+}
+
+void TraceRecorder::writeBuffers()
+{
+    std::vector<char> buffer;
+    buffer.reserve(BUFFER_FLUSH_SIZE);
+    while(mIsRunning.load())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mBufferLock);
+            buffer.swap(mFullBuffer);
+        }
+
+        if(buffer.empty())
+        {
+            sf::sleep(sf::milliseconds(WRITER_IDLE_SLEEP_MS));
+            continue;
+        }
+
+        mFile.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+}
+
+std::string TraceRecorder::getPhaseName(TracePhase phase)
+{
+    switch(phase)
+    {
+        case TracePhase::serverTurn:
+            return "serverTurn";
+        case TracePhase::updateAnimations:
+            return "updateAnimations";
+        case TracePhase::refreshSeats:
+            return "refreshSeats";
+        case TracePhase::gameMapTurn:
+            return "gameMapTurn";
+        case TracePhase::miscUpkeep:
+            return "miscUpkeep";
+        case TracePhase::playersUpkeep:
+            return "playersUpkeep";
+        case TracePhase::playerAI:
+            return "playerAI";
+        case TracePhase::updateVisibleEntities:
+            return "updateVisibleEntities";
+        case TracePhase::activeObjectsChanges:
+            return "activeObjectsChanges";
+        case TracePhase::deletionQueues:
+            return "deletionQueues";
+        case TracePhase::serverNotifications:
+            return "serverNotifications";
+        case TracePhase::creaturesSense:
+            return "creaturesSense";
+        case TracePhase::activeObjectsUpkeep:
+            return "activeObjectsUpkeep";
+        case TracePhase::vision:
+            return "vision";
+        case TracePhase::nbPhases:
+            break;
+        default:
+            break;
+    }
+    return "unknown phase=" + Helper::toString(static_cast<uint32_t>(phase));
+}
@@ -0,0 +1,134 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <OgreSingleton.h>
+
+#include <SFML/System.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//! \brief Steps of a turn whose duration is traced. Names are written in the trace (see
+//! TraceRecorder::getPhaseName) so the analyzer does not depend on the values
+enum class TracePhase : uint8_t
+{
+    serverTurn,
+    updateAnimations,
+    refreshSeats,
+    gameMapTurn,
+    miscUpkeep,
+    playersUpkeep,
+    playerAI,
+    updateVisibleEntities,
+    activeObjectsChanges,
+    deletionQueues,
+    serverNotifications,
+    creaturesSense,
+    activeObjectsUpkeep,
+    vision,
+    nbPhases
+};
+
+//! \brief Records simulation events in a compact binary file that can be analyzed after
+//! the game (see tools/trace-analysis.py). It is only created when the game is launched with
+//! the --trace option. Events can be recorded from any thread. They are appended to a memory
+//! buffer that is written to the file by a background thread once full (double buffering).
+//!
+//! File format (little endian): "ODTRACE" + '\0', uint32 version, then records made of
+//! uint8 type, uint64 time in microseconds since the trace start and a payload depending
+//! on the type (see TraceRecorder.cpp).
+class TraceRecorder : public Ogre::Singleton<TraceRecorder>
+{
+public:
+    TraceRecorder(const std::string& filename);
+    ~TraceRecorder();
+
+    //! \brief Measures the time spent in a phase while in scope. Does nothing if
+    //! tracing is disabled.
+    class PhaseScope
+    {
+    public:
+        PhaseScope(TracePhase phase);
+        ~PhaseScope();
+
+        //! \brief Records the phase before the scope ends
+        void end();
+
+    private:
+        PhaseScope(const PhaseScope&) = delete;
+        PhaseScope& operator=(const PhaseScope&) = delete;
+
+        TraceRecorder* mRecorder;
+        TracePhase mPhase;
+        uint64_t mStartTime;
+    };
+
+    //! \brief Time in microseconds since the trace started
+    uint64_t getTime() const;
+
+    void recordTurnStarted(int64_t turn);
+    void recordPhase(TracePhase phase, uint64_t startTime, uint64_t duration);
+    void recordPathRequest(int x1, int y1, int x2, int y2, uint32_t pathLength, bool isCacheHit,
+        uint64_t startTime, uint64_t duration);
+    //! \brief actionName is only written the first time actionType is recorded
+    void recordCreatureAction(bool isPushed, uint32_t creatureId, uint32_t actionType, const std::string& actionName);
+    //! \brief clientId is the player id or -1 if not known yet
+    void recordPacketSent(int32_t clientId, uint32_t size);
+
+    static std::string getPhaseName(TracePhase phase);
+
+private:
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    //! \brief Must be called with mBufferLock held
+    void beginRecord(uint8_t type, uint64_t time);
+    //! \brief Must be called with mBufferLock held
+    void endRecord();
+    void recordName(uint8_t category, uint32_t id, const std::string& name);
+
+    template<typename T>
+    void appendInteger(T value);
+
+    //! \brief Background thread writing the full buffers to the file
+    void writeBuffers();
+
+    std::ofstream mFile;
+    const std::chrono::steady_clock::time_point mStartTime;
+
+    //! \brief Protects the buffers and mActionNamesWritten
+    std::mutex mBufferLock;
+    //! \brief Buffer the events are appended to
+    std::vector<char> mBuffer;
+    //! \brief Full buffer waiting to be written by the background thread
+    std::vector<char> mFullBuffer;
+    std::vector<bool> mActionNamesWritten;
+
+    std::atomic<bool> mIsRunning;
+    sf::Thread mThread;
+};
+
+#endif // TRACERECORDER_H
@@ -0,0 +1,239 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2011-2016  OpenDungeons Team
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""Analyzes a trace recorded by OpenDungeons with the --trace option.
+
+Usage:
+    trace-analysis.py TRACE              per-turn statistics and totals
+    trace-analysis.py --folded TRACE     folded stacks (phase;subphase microseconds) that
+                                         can be given to flamegraph.pl
+
+The file format is described in source/utils/TraceRecorder.cpp.
+"""
+
+import argparse
+import collections
+import struct
+import sys
+
+TRACE_MAGIC = b"ODTRACE\0"
+TRACE_VERSION = 1
+
+RECORD_NAME = 0
+RECORD_TURN_STARTED = 1
+RECORD_PHASE = 2
+RECORD_PATH_REQUEST = 3
+RECORD_CREATURE_ACTION_PUSHED = 4
+RECORD_CREATURE_ACTION_POPPED = 5
+RECORD_PACKET_SENT = 6
+
+NAME_PHASE = 0
+NAME_CREATURE_ACTION = 1
+
+RECORD_HEADER = struct.Struct("<BQ")
+PAYLOADS = {
+    RECORD_TURN_STARTED: struct.Struct("<q"),
+    RECORD_PHASE: struct.Struct("<BQ"),
+    RECORD_PATH_REQUEST: struct.Struct("<hhhhIBQ"),
+    RECORD_CREATURE_ACTION_PUSHED: struct.Struct("<II"),
+    RECORD_CREATURE_ACTION_POPPED: struct.Struct("<II"),
+    RECORD_PACKET_SENT: struct.Struct("<iI"),
+}
+NAME_PAYLOAD = struct.Struct("<BIH")
+
+
+class Turn:
+    def __init__(self, number, start):
+        self.number = number
+        self.start = start
+        self.duration = 0
+        # (start, duration, -index, name) of the phases and path requests, used for the folded stacks.
+        # Phases are recorded when they end so, for the same start and duration, the last recorded
+        # one is the parent
+        self.intervals = []
+        self.phase_times = collections.Counter()
+        self.nb_paths = 0
+        self.nb_path_cache_hits = 0
+        self.path_time = 0
+        self.actions_pushed = collections.Counter()
+        self.nb_actions_popped = 0
+        self.packets = collections.Counter()
+        self.packet_bytes = collections.Counter()
+
+
+def read_records(data):
+    if data[:len(TRACE_MAGIC)] != TRACE_MAGIC:
+        raise ValueError("not an OpenDungeons trace")
+    version, = struct.unpack_from("<I", data, len(TRACE_MAGIC))
+    if version != TRACE_VERSION:
+        raise ValueError("unsupported trace version %d" % version)
+
+    pos = len(TRACE_MAGIC) + 4
+    while pos + RECORD_HEADER.size <= len(data):
+        record_type, time = RECORD_HEADER.unpack_from(data, pos)
+        pos += RECORD_HEADER.size
+        if record_type == RECORD_NAME:
+            if pos + NAME_PAYLOAD.size > len(data):
+                break
+            category, identifier, length = NAME_PAYLOAD.unpack_from(data, pos)
+            pos += NAME_PAYLOAD.size
+            name = data[pos:pos + length].decode("utf-8", "replace")
+            pos += length
+            yield record_type, time, (category, identifier, name)
+            continue
+
+        payload = PAYLOADS.get(record_type)
+        if payload is None:
+            raise ValueError("unknown record type %d at offset %d" % (record_type, pos))
+        # The game may have been stopped while writing the last record
+        if pos + payload.size > len(data):
+            break
+        yield record_type, time, payload.unpack_from(data, pos)
+        pos += payload.size
+
+
+def load_turns(data):
+    names = {NAME_PHASE: {}, NAME_CREATURE_ACTION: {}}
+    turns = []
+    # Events before the first turn (loading, ...) are gathered in turn -1
+    current = Turn(-1, 0)
+    for record_type, time, values in read_records(data):
+        if record_type == RECORD_NAME:
+            category, identifier, name = values
+            names.setdefault(category, {})[identifier] = name
+        elif record_type == RECORD_TURN_STARTED:
+            current.duration = time - current.start
+            turns.append(current)
+            current = Turn(values[0], time)
+        elif record_type == RECORD_PHASE:
+            phase, duration = values
+            name = names[NAME_PHASE].get(phase, "phase%d" % phase)
+            current.phase_times[name] += duration
+            current.intervals.append((time, duration, -len(current.intervals), name))
+        elif record_type == RECORD_PATH_REQUEST:
+            cache_hit, duration = values[5], values[6]
+            current.nb_paths += 1
+            current.nb_path_cache_hits += cache_hit
+            current.path_time += duration
+            current.intervals.append((time, duration, -len(current.intervals), "path"))
+        elif record_type == RECORD_CREATURE_ACTION_PUSHED:
+            action = values[1]
+            current.actions_pushed[names[NAME_CREATURE_ACTION].get(action, "action%d" % action)] += 1
+        elif record_type == RECORD_CREATURE_ACTION_POPPED:
+            current.nb_actions_popped += 1
+        elif record_type == RECORD_PACKET_SENT:
+            client, size = values
+            current.packets[client] += 1
+            current.packet_bytes[client] += size
+
+    if current.intervals:
+        current.duration = max(start + duration for start, duration, _, _ in current.intervals) - current.start
+    turns.append(current)
+    return [turn for turn in turns if turn.number >= 0 or turn.intervals or turn.packets]
+
+
+def print_statistics(turns, out):
+    phases = []
+    for turn in turns:
+        for name in turn.phase_times:
+            if name not in phases:
+                phases.append(name)
+
+    columns = ["turn", "ms", "paths", "hits", "pathMs", "pushed", "popped", "packets", "bytes"] + phases
+    out.write("\t".join(columns) + "\n")
+    for turn in turns:
+        row = [turn.number, "%.2f" % (turn.duration / 1000.0), turn.nb_paths, turn.nb_path_cache_hits,
+               "%.2f" % (turn.path_time / 1000.0), sum(turn.actions_pushed.values()), turn.nb_actions_popped,
+               sum(turn.packets.values()), sum(turn.packet_bytes.values())]
+        row += ["%.2f" % (turn.phase_times[name] / 1000.0) for name in phases]
+        out.write("\t".join(str(value) for value in row) + "\n")
+
+    game_turns = [turn for turn in turns if turn.number >= 0]
+    if not game_turns:
+        return
+
+    durations = sorted(turn.duration for turn in game_turns)
+    out.write("\nturns=%d mean=%.2fms median=%.2fms p99=%.2fms max=%.2fms\n" % (
+        len(durations), sum(durations) / 1000.0 / len(durations), durations[len(durations) // 2] / 1000.0,
+        durations[min(len(durations) - 1, len(durations) * 99 // 100)] / 1000.0, durations[-1] / 1000.0))
+
+    out.write("\nTime per phase:\n")
+    for name in phases:
+        total = sum(turn.phase_times[name] for turn in game_turns)
+        out.write("  %-24s total=%.1fms mean=%.3fms\n" % (name, total / 1000.0, total / 1000.0 / len(game_turns)))
+
+    actions = collections.Counter()
+    packets = collections.Counter()
+    packet_bytes = collections.Counter()
+    for turn in game_turns:
+        actions.update(turn.actions_pushed)
+        packets.update(turn.packets)
+        packet_bytes.update(turn.packet_bytes)
+
+    out.write("\nCreature actions pushed:\n")
+    for name, count in actions.most_common():
+        out.write("  %-32s %d\n" % (name, count))
+
+    out.write("\nPackets sent per client:\n")
+    for client in sorted(packets):
+        out.write("  client=%d packets=%d bytes=%d\n" % (client, packets[client], packet_bytes[client]))
+
+
+def print_folded(turns, out):
+    """Phases and path requests are nested by time. Each line is a stack with its self time."""
+    stacks = collections.Counter()
+    for turn in turns:
+        # Longer intervals first when they start at the same time so that parents come before children
+        intervals = sorted(turn.intervals, key=lambda interval: (interval[0], -interval[1], interval[2]))
+        # Stack of [end, name, self time]
+        opened = []
+
+        def close(until):
+            while opened and opened[-1][0] <= until:
+                end, name, self_time = opened.pop()
+                stacks[";".join([entry[1] for entry in opened] + [name])] += max(self_time, 0)
+
+        for start, duration, _, name in intervals:
+            close(start)
+            if opened:
+                opened[-1][2] -= duration
+            opened.append([start + duration, name, duration])
+        close(float("inf"))
+
+    for stack, time in sorted(stacks.items()):
+        out.write("%s %d\n" % (stack, time))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Analyzes an OpenDungeons simulation trace")
+    parser.add_argument("trace", help="trace file recorded with the --trace option")
+    parser.add_argument("--folded", action="store_true",
+                        help="outputs folded stacks for flame graphs instead of statistics")
+    args = parser.parse_args()
+
+    with open(args.trace, "rb") as trace_file:
+        data = trace_file.read()
+
+    turns = load_turns(data)
+    if args.folded:
+        print_folded(turns, sys.stdout)
+    else:
+        print_statistics(turns, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()